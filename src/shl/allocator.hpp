@@ -20,14 +20,24 @@ Example usage:
     allocator_dealloc(a, x, sizeof(int) * 2);
     allocator_dealloc_T(a, y, int, 2);
 
+    // growing without moving, only succeeds if the allocator supports it
+    if (allocator_try_expand(a, x, sizeof(int), sizeof(int) * 4))
+        ; // x now has space for 4 ints
+
 
 Typedefs and Structs
 
 alloc_function is the generic allocation function type used to allocate,
 deallocate and reallocate memory.
 
-allocator is a struct with an alloc_function and a user data pointer which
-is passed to the alloc function.
+expand_function is the optional function type used to grow (or shrink) an
+allocation without moving it. It returns true if the memory at ptr now holds
+new_size bytes, and false (leaving ptr untouched) if the allocation cannot be
+resized in place, in which case callers fall back to reallocating.
+
+allocator is a struct with an alloc_function, a user data pointer which
+is passed to the alloc function, and an optional expand_function (try_expand)
+which may be nullptr if the allocator cannot expand allocations in place.
 
 default_alloc is an alloc_function that uses the default global heap allocator,
 currently malloc.
@@ -39,6 +49,8 @@ when used.
 Other Allocators
 
 arena_allocator (defined in shl/allocator_arena.hpp) - stack-like allocator.
+page_allocator (defined in shl/allocator_page.hpp) - allocates whole pages from
+                                                    the OS, grows with mremap.
 */
 
 #include "shl/macros.hpp"
@@ -46,17 +58,19 @@ arena_allocator (defined in shl/allocator_arena.hpp) - stack-like allocator.
 #include "shl/number_types.hpp"
 
 typedef void *(*alloc_function)(void *data, void *ptr, s64 old_size, s64 new_size);
+typedef bool  (*expand_function)(void *data, void *ptr, s64 old_size, s64 new_size);
 
 struct allocator
 {
     alloc_function alloc;   
     void *data;
+    expand_function try_expand;
 };
 
 void *default_alloc(void *data, void *ptr, s64 old_size, s64 new_size);
 
-const allocator default_allocator{.alloc = default_alloc, .data = nullptr};
-const allocator null_allocator{.alloc = (alloc_function)nullptr, .data = nullptr};
+const allocator default_allocator{.alloc = default_alloc, .data = nullptr, .try_expand = nullptr};
+const allocator null_allocator{.alloc = (alloc_function)nullptr, .data = nullptr, .try_expand = nullptr};
 
 // helpers
 #define allocator_alloc(A, Size)\
@@ -89,3 +103,9 @@ const allocator null_allocator{.alloc = (alloc_function)nullptr, .data = nullptr
     (reinterpret_cast<decltype(Ptr)>(allocator_dealloc((A), (Ptr), sizeof(Type) * (Count))))
 
 #define allocator_dealloc_T(...) GET_MACRO3(__VA_ARGS__, _allocator_dealloc_TCount, _allocator_dealloc_T, _allocator_dealloc_TNotEnoughArgs)(__VA_ARGS__)
+
+#define allocator_try_expand(A, Ptr, OldSize, NewSize)\
+    ((A).try_expand != nullptr && (A).try_expand((A).data, (Ptr), (OldSize), (NewSize)))
+
+#define allocator_try_expand_T(A, Ptr, Type, OldCount, NewCount)\
+    allocator_try_expand((A), (Ptr), sizeof(Type) * (OldCount), sizeof(Type) * (NewCount))
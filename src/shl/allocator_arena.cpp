@@ -107,3 +107,23 @@ void *arena_alloc(void *data, void *ptr, s64 old_size, s64 new_size)
 
     return _arena_realloc(a, (char*)ptr, old_size, new_size);
 }
+
+bool arena_try_expand(void *data, void *ptr, s64 old_size, s64 new_size)
+{
+    assert(data != nullptr);
+    assert(old_size >= 0);
+    assert(new_size >= 0);
+
+    arena *a = (arena*)data;
+
+    if (ptr == nullptr || (char*)ptr + old_size != a->start)
+        return new_size <= old_size;
+
+    s64 diff = new_size - old_size;
+
+    if (diff > 0 && arena_remaining_size(*a) < diff)
+        return false;
+
+    a->start += diff;
+    return true;
+}
@@ -33,7 +33,10 @@ s64 arena_remaining_size(arena a);
 
 void *arena_alloc(void *data, void *ptr, s64 old_size, s64 new_size);
 
+// only succeeds if ptr is the last allocation in the arena
+bool arena_try_expand(void *data, void *ptr, s64 old_size, s64 new_size);
+
 inline static allocator arena_allocator(arena *a)
 {
-    return allocator{.alloc = arena_alloc, .data = (void*)a};
+    return allocator{.alloc = arena_alloc, .data = (void*)a, .try_expand = arena_try_expand};
 }
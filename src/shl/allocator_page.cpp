@@ -0,0 +1,115 @@
+#include "shl/assert.hpp"
+#include "shl/platform.hpp"
+#include "shl/math.hpp"
+#include "shl/memory.hpp"
+#include "shl/allocator_page.hpp"
+
+#if Linux
+#include "shl/impl/linux/memory.hpp"
+#elif Windows
+#include <windows.h>
+#endif
+
+static inline s64 _page_size(s64 size)
+{
+    return ceil_multiple2(size, get_system_pagesize());
+}
+
+static void *_page_alloc(s64 size)
+{
+    if (size == 0)
+        return nullptr;
+
+#if Linux
+    void *ret = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS);
+
+    if (MMAP_IS_ERROR(ret))
+        return nullptr;
+
+    return ret;
+#elif Windows
+    return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#endif
+}
+
+static void *_page_free(void *ptr, [[maybe_unused]] s64 size)
+{
+#if Linux
+    ::munmap(ptr, size);
+#elif Windows
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#endif
+
+    return nullptr;
+}
+
+static void *_page_realloc(void *ptr, s64 old_size, s64 new_size)
+{
+    if (old_size == new_size)
+        return ptr;
+
+#if Linux
+    void *ret = ::mremap(ptr, old_size, new_size, MREMAP_MAYMOVE);
+
+    if (MMAP_IS_ERROR(ret))
+        return nullptr;
+
+    return ret;
+#elif Windows
+    // no mremap on windows, allocate new pages and copy.
+    void *ret = _page_alloc(new_size);
+
+    if (ret == nullptr)
+        return nullptr;
+
+    copy_memory(ptr, ret, old_size < new_size ? old_size : new_size);
+    _page_free(ptr, old_size);
+
+    return ret;
+#endif
+}
+
+void *page_alloc([[maybe_unused]] void *data, void *ptr, s64 old_size, s64 new_size)
+{
+    assert(old_size >= 0);
+    assert(new_size >= 0);
+
+    old_size = _page_size(old_size);
+    new_size = _page_size(new_size);
+
+    if (ptr == nullptr)
+        return _page_alloc(new_size);
+
+    if (new_size == 0)
+        return _page_free(ptr, old_size);
+
+    return _page_realloc(ptr, old_size, new_size);
+}
+
+bool page_try_expand([[maybe_unused]] void *data, void *ptr, s64 old_size, s64 new_size)
+{
+    assert(old_size >= 0);
+    assert(new_size >= 0);
+
+    if (ptr == nullptr)
+        return false;
+
+    old_size = _page_size(old_size);
+    new_size = _page_size(new_size);
+
+    if (old_size == new_size)
+        return true;
+
+    if (new_size == 0)
+        return false;
+
+#if Linux
+    // without MREMAP_MAYMOVE, the mapping is only resized if it can
+    // stay at the same address.
+    void *ret = ::mremap(ptr, old_size, new_size, 0);
+
+    return !MMAP_IS_ERROR(ret) && ret == ptr;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+/* allocator_page.hpp
+
+Defines page_allocator, an allocator which allocates memory directly from the
+OS in multiples of the system page size (mmap on Linux, VirtualAlloc on
+Windows).
+
+Example usage:
+
+    allocator al = page_allocator;
+    char *x = (char*)allocator_alloc(al, 1 << 20);
+
+    // on Linux, this remaps the pages of x instead of copying them
+    x = (char*)allocator_realloc(al, x, 1 << 20, 1 << 30);
+
+    allocator_dealloc(al, x, 1 << 30);
+
+page_allocator is intended for large allocations, e.g. the memory of very
+large arrays (see shl/array.hpp): growing an allocation with page_alloc never
+copies the memory on Linux, since the pages are moved to a new virtual address
+with mremap if they cannot be extended in place, and page_try_expand extends
+the mapping without moving it if the virtual address space after the mapping
+is free.
+
+Every allocation takes up at least one page, so page_allocator is not suitable
+for small allocations.
+*/
+
+#include "shl/allocator.hpp"
+#include "shl/number_types.hpp"
+
+void *page_alloc(void *data, void *ptr, s64 old_size, s64 new_size);
+bool page_try_expand(void *data, void *ptr, s64 old_size, s64 new_size);
+
+const allocator page_allocator{.alloc = page_alloc, .data = nullptr, .try_expand = page_try_expand};
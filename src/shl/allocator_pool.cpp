@@ -0,0 +1,154 @@
+#include "shl/assert.hpp"
+#include "shl/bits.hpp"
+#include "shl/math.hpp"
+#include "shl/memory.hpp"
+#include "shl/program_context.hpp"
+#include "shl/allocator_pool.hpp"
+
+// a block starts with a pointer to the next block, followed by the elements
+// at the next multiple of the alignment of the pool. blocks are at least
+// pointer aligned, so the elements start within alignment bytes.
+static inline s64 _block_size(pool *p)
+{
+    return p->alignment + p->element_size * p->elements_per_block;
+}
+
+static inline char *_block_elements(pool *p, char *block)
+{
+    return (char*)ceil_multiple2((u64)(block + sizeof(void*)), (u64)p->alignment);
+}
+
+void init(pool *p, s64 element_size, s64 elements_per_block, s64 alignment)
+{
+    assert(p != nullptr);
+    assert(element_size > 0);
+    assert(elements_per_block > 0);
+    assert(alignment > 0 && is_pow2(alignment));
+
+    // the free list is kept within the elements
+    if (element_size < (s64)sizeof(void*))
+        element_size = (s64)sizeof(void*);
+
+    if (alignment < (s64)sizeof(void*))
+        alignment = (s64)sizeof(void*);
+
+    p->element_size = ceil_multiple2(element_size, alignment);
+    p->elements_per_block = elements_per_block;
+    p->alignment = alignment;
+    p->free_list = nullptr;
+    p->blocks = nullptr;
+    p->allocator = get_context_pointer()->allocator;
+}
+
+void free(pool *p)
+{
+    if (p == nullptr)
+        return;
+
+    s64 block_size = _block_size(p);
+    void *block = p->blocks;
+
+    while (block != nullptr)
+    {
+        void *next = *(void**)block;
+        allocator_dealloc(p->allocator, block, block_size);
+        block = next;
+    }
+
+    p->free_list = nullptr;
+    p->blocks = nullptr;
+}
+
+static bool _pool_add_block(pool *p)
+{
+    char *block = (char*)allocator_alloc(p->allocator, _block_size(p));
+
+    if (block == nullptr)
+        return false;
+
+    *(void**)block = p->blocks;
+    p->blocks = block;
+
+    // chain elements in address order so that consecutive allocations
+    // are next to each other in memory.
+    char *elements = _block_elements(p, block);
+    s64 last = p->elements_per_block - 1;
+
+    for (s64 i = 0; i < last; ++i)
+        *(void**)(elements + i * p->element_size) = elements + (i + 1) * p->element_size;
+
+    *(void**)(elements + last * p->element_size) = p->free_list;
+    p->free_list = elements;
+
+    return true;
+}
+
+static void *_pool_alloc(pool *p)
+{
+    if (p->free_list == nullptr && !_pool_add_block(p))
+        return nullptr;
+
+    void *ret = p->free_list;
+    p->free_list = *(void**)ret;
+
+    return ret;
+}
+
+static void *_pool_free(pool *p, void *ptr)
+{
+    *(void**)ptr = p->free_list;
+    p->free_list = ptr;
+
+    return nullptr;
+}
+
+void *pool_alloc(void *data, void *ptr, s64 old_size, s64 new_size)
+{
+    assert(data != nullptr);
+    assert(old_size >= 0);
+    assert(new_size >= 0);
+
+    pool *p = (pool*)data;
+    bool old_in_pool = ptr != nullptr && old_size <= p->element_size;
+    bool new_in_pool = new_size <= p->element_size;
+
+    if (ptr == nullptr)
+    {
+        if (new_size == 0)
+            return nullptr;
+
+        if (new_in_pool)
+            return _pool_alloc(p);
+
+        return allocator_alloc(p->allocator, new_size);
+    }
+
+    if (new_size == 0)
+    {
+        if (old_in_pool)
+            return _pool_free(p, ptr);
+
+        return allocator_dealloc(p->allocator, ptr, old_size);
+    }
+
+    if (old_in_pool && new_in_pool)
+        return ptr;
+
+    if (!old_in_pool && !new_in_pool)
+        return allocator_realloc(p->allocator, ptr, old_size, new_size);
+
+    // moving between pool and backing allocator
+    void *ret = new_in_pool ? _pool_alloc(p) : allocator_alloc(p->allocator, new_size);
+
+    if (ret == nullptr)
+        return nullptr;
+
+    copy_memory(ptr, ret, old_size < new_size ? old_size : new_size);
+
+    if (old_in_pool)
+        _pool_free(p, ptr);
+    else
+        allocator_dealloc(p->allocator, ptr, old_size);
+
+    return ret;
+}
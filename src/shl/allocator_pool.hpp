@@ -0,0 +1,78 @@
+#pragma once
+
+/* allocator_pool.hpp
+
+Defines pool and pool_allocator, an allocator for many objects of the same
+(maximum) size, e.g. the nodes of a linked_list.
+A pool allocates its memory in contiguous blocks of elements_per_block
+elements from its backing allocator (the context allocator when calling
+init), and keeps deallocated elements in a free list to be reused.
+Allocating or deallocating an element is O(1) and never calls the backing
+allocator, except when a new block is needed.
+
+Example usage:
+
+    pool p{};
+    init(&p, sizeof(list_node<int>), 1024);
+
+    linked_list<int> list{};
+
+    with_allocator(pool_allocator(&p))
+        init(&list);
+
+    // nodes are now allocated from p, 1024 nodes per block
+    add_elements(&list, 10000);
+
+    free(&list);
+    free(&p);
+
+Allocations larger than the element size of the pool (and reallocations to a
+larger size) are passed to the backing allocator, so a pool_allocator may be
+used with any container, though only allocations up to the element size
+benefit from the pool.
+Since allocators are not told the alignment of what they allocate, elements
+are aligned to the alignment given to init (POOL_ALIGNMENT_DEFAULT, 8 bytes,
+by default). Use a larger alignment for over-aligned types, e.g.
+init(&p, sizeof(T), 1024, alignof(T)). Allocations passed to the backing
+allocator have the alignment of the backing allocator.
+
+Functions:
+
+init(*pool, ElementSize, ElementsPerBlock[, Alignment])
+    Initializes the pool to allocate elements of ElementSize bytes, in blocks
+    of ElementsPerBlock elements. Elements are aligned to Alignment, a power
+    of two; the element size is rounded up to a multiple of it.
+    Does not allocate any memory yet.
+
+free(*pool) Frees all blocks of the pool, invalidating every element that
+            was allocated from the pool.
+
+pool_allocator(*pool) Returns an allocator using the pool.
+*/
+
+#include "shl/allocator.hpp"
+#include "shl/number_types.hpp"
+
+#ifndef POOL_ALIGNMENT_DEFAULT
+#  define POOL_ALIGNMENT_DEFAULT 8
+#endif
+
+struct pool
+{
+    s64 element_size;
+    s64 elements_per_block;
+    s64 alignment;
+    void *free_list;
+    void *blocks;
+    ::allocator allocator;
+};
+
+void init(pool *p, s64 element_size, s64 elements_per_block, s64 alignment = POOL_ALIGNMENT_DEFAULT);
+void free(pool *p);
+
+void *pool_alloc(void *data, void *ptr, s64 old_size, s64 new_size);
+
+inline static allocator pool_allocator(pool *p)
+{
+    return allocator{.alloc = pool_alloc, .data = (void*)p, .try_expand = nullptr};
+}
@@ -153,6 +153,26 @@ free(*arr) Frees memory of the array and sets arr.size and arr.reserved_size to
            memory of the _array_, whereas free_values frees the memory that
            the individual entries may have allocated.
 
+growth:
+
+When an array has to grow, the number of reserved elements is determined
+by the growth policy of the element type, array_growth_policy<T>:
+
+    array_growth::Exp2       next power of 2 (default).
+    array_growth::Factor1_5  1.5 times the reserved size.
+    array_growth::Page       1.5 times the reserved size, rounded up to a
+                             multiple of the system page size.
+
+The policy may be changed per type by specializing array_growth_policy, e.g.
+
+    template<> constexpr array_growth array_growth_policy<my_struct> = array_growth::Page;
+
+add_elements and reserve first try to expand the memory of the array in place
+using the try_expand function of the arrays allocator, if it has one, and only
+reallocate if that fails. Use page_allocator (see shl/allocator_page.hpp) for
+very large arrays, which grows using mremap on Linux and thus never copies
+the elements.
+
 other functions:
 
 search(*arr, *key, eq) Returns a pointer to an element where eq(elem, key)
@@ -226,6 +246,68 @@ bool operator==(const array<T> &lhs, const array<T> &rhs)
     return true;
 }
 
+enum class array_growth : u8
+{
+    Exp2,       // grow to the next power of 2 of reserved_size + n
+    Factor1_5,  // grow by a factor of 1.5, or to exactly the required size
+    Page        // like Factor1_5, rounded up to a multiple of the page size
+};
+
+// growth policy of array<T>, specialize for large or performance critical
+// element types, e.g.:
+// template<> constexpr array_growth array_growth_policy<my_struct> = array_growth::Page;
+template<typename T>
+constexpr array_growth array_growth_policy = array_growth::Exp2;
+
+// returns the new number of reserved elements of an array with the given
+// size and reserved_size that needs to fit n_elements more elements.
+inline s64 _array_grow_size(array_growth policy, s64 element_size, s64 size, s64 reserved_size, s64 n_elements)
+{
+    if (policy == array_growth::Exp2)
+        return ceil_exp2(reserved_size + n_elements);
+
+    s64 required = size + n_elements;
+    s64 grown = reserved_size + (reserved_size >> 1);
+
+    if (grown < required)
+        grown = required;
+
+    if (policy == array_growth::Page)
+    {
+        s64 pagesize = get_system_pagesize();
+        s64 bytes = grown * element_size;
+        bytes = (bytes + (pagesize - 1)) & (-pagesize);
+        grown = bytes / element_size;
+    }
+
+    return grown;
+}
+
+// grows arr to exactly new_reserved_size elements, in place if the
+// allocator supports it (see allocator_try_expand in shl/allocator.hpp).
+template<typename T>
+bool _array_grow_reserved(array<T> *arr, s64 new_reserved_size)
+{
+    _set_allocator_if_not_set(arr);
+
+    if (arr->data != nullptr
+     && allocator_try_expand_T(arr->allocator, arr->data, T, arr->reserved_size, new_reserved_size))
+    {
+        arr->reserved_size = new_reserved_size;
+        return true;
+    }
+
+    T *n = allocator_realloc_T(arr->allocator, arr->data, T, arr->reserved_size, new_reserved_size);
+
+    if (n == nullptr)
+        return false;
+
+    arr->data = n;
+    arr->reserved_size = new_reserved_size;
+
+    return true;
+}
+
 template<typename T>
 void init(array<T> *arr)
 {
@@ -268,24 +350,17 @@ T *add_elements(array<T> *arr, s64 n_elements)
         return ret;
     }
 
-    s64 new_reserved_size = ceil_exp2(arr->reserved_size + n_elements);
-
-    _set_allocator_if_not_set(arr);
+    s64 new_reserved_size = _array_grow_size(array_growth_policy<T>, sizeof(T), arr->size, arr->reserved_size, n_elements);
 
-    T *n = allocator_realloc_T(arr->allocator, arr->data, T, arr->reserved_size, new_reserved_size);
-
-    if (n == nullptr)
+    if (!_array_grow_reserved(arr, new_reserved_size))
         return nullptr;
 
-    arr->data = n;
-
     T *ret = arr->data;
 
     if (ret != nullptr)
         ret += arr->size;
 
     arr->size = nsize;
-    arr->reserved_size = new_reserved_size;
 
     return ret;
 }
@@ -496,17 +571,7 @@ bool reserve(array<T> *arr, s64 size)
     if (arr->reserved_size >= size)
         return true;
 
-    _set_allocator_if_not_set(arr);
-
-    T *n = allocator_realloc_T(arr->allocator, arr->data, T, arr->reserved_size, size);
-
-    if (n == nullptr)
-        return false;
-
-    arr->data = n;
-    arr->reserved_size = size;
-
-    return true;
+    return _array_grow_reserved(arr, size);
 }
 
 template<typename T>
@@ -32,9 +32,21 @@ popcnt(x) number of bits set to 1 in a 32 bit unsigned integer
 clz(x)    counts the number of leading zeroes in a 32 bit unsigned integer
 ctz(x)    counts the number of trailing zeroes in a 32 bit unsigned integer
 
+popcnt64(x) number of bits set to 1 in a 64 bit unsigned integer
+clz64(x)    counts the number of leading zeroes in a 64 bit unsigned integer
+ctz64(x)    counts the number of trailing zeroes in a 64 bit unsigned integer
+
+popcnt64, clz64 and ctz64 use compiler builtins if available, which compile
+to single instructions on most targets. clz64(0) and ctz64(0) return 64.
+
+mul64_full(a, b, *high) multiplies two 64 bit unsigned integers, returns the
+                        lower 64 bits of the 128 bit product and sets *high
+                        to the upper 64 bits.
+
  */
 
 #include "shl/number_types.hpp"
+#include "shl/compiler.hpp"
 
 template<typename T>
 constexpr inline T const_log2(T x)
@@ -249,3 +261,61 @@ static constexpr inline u32 ctz(u32 x)
 {
     return popcnt((x & -x) - 1);
 }
+
+static constexpr inline u32 popcnt64(u64 x)
+{
+#if GNU || Clang
+    return (u32)__builtin_popcountll(x);
+#else
+    return popcnt((u32)x) + popcnt((u32)(x >> 32));
+#endif
+}
+
+static constexpr inline u32 clz64(u64 x)
+{
+    if (x == 0)
+        return 64;
+
+#if GNU || Clang
+    return (u32)__builtin_clzll(x);
+#else
+    u32 hi = (u32)(x >> 32);
+    return hi != 0 ? clz(hi) : 32 + clz((u32)x);
+#endif
+}
+
+static constexpr inline u32 ctz64(u64 x)
+{
+    if (x == 0)
+        return 64;
+
+#if GNU || Clang
+    return (u32)__builtin_ctzll(x);
+#else
+    u32 lo = (u32)x;
+    return lo != 0 ? ctz(lo) : 32 + ctz((u32)(x >> 32));
+#endif
+}
+
+static inline u64 mul64_full(u64 a, u64 b, u64 *high)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *high = (u64)(r >> 64);
+    return (u64)r;
+#else
+    u64 a_lo = a & 0xffffffffull;
+    u64 a_hi = a >> 32;
+    u64 b_lo = b & 0xffffffffull;
+    u64 b_hi = b >> 32;
+
+    u64 lo_lo = a_lo * b_lo;
+    u64 hi_lo = a_hi * b_lo;
+    u64 lo_hi = a_lo * b_hi;
+    u64 hi_hi = a_hi * b_hi;
+
+    u64 cross = (lo_lo >> 32) + (hi_lo & 0xffffffffull) + lo_hi;
+    *high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    return (cross << 32) | (lo_lo & 0xffffffffull);
+#endif
+}
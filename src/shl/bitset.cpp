@@ -0,0 +1,173 @@
+#include "shl/bitset.hpp"
+
+s64 _bits_popcount(const u64 *words, s64 word_count)
+{
+    s64 ret = 0;
+
+    for (s64 i = 0; i < word_count; ++i)
+        ret += popcnt64(words[i]);
+
+    return ret;
+}
+
+s64 _bits_rank(const u64 *words, s64 bit)
+{
+    s64 word = bit >> 6;
+    s64 ret = _bits_popcount(words, word);
+
+    if (bit & 63)
+        ret += popcnt64(words[word] & ((1ull << (bit & 63)) - 1));
+
+    return ret;
+}
+
+s64 _bits_select(const u64 *words, s64 word_count, s64 k)
+{
+    if (k < 0)
+        return -1;
+
+    for (s64 i = 0; i < word_count; ++i)
+    {
+        u64 w = words[i];
+        s64 count = popcnt64(w);
+
+        if (k >= count)
+        {
+            k -= count;
+            continue;
+        }
+
+        // clear the k lowest set bits, the next one is the result
+        while (k-- > 0)
+            w &= w - 1;
+
+        return (i << 6) + ctz64(w);
+    }
+
+    return -1;
+}
+
+s64 _bits_next_set(const u64 *words, s64 bit_count, s64 bit)
+{
+    if (bit < 0)
+        bit = 0;
+
+    if (bit >= bit_count)
+        return -1;
+
+    s64 word_count = _bit_word_count(bit_count);
+    s64 i = bit >> 6;
+    u64 w = words[i] & (~0ull << (bit & 63));
+
+    while (w == 0)
+    {
+        if (++i >= word_count)
+            return -1;
+
+        w = words[i];
+    }
+
+    return (i << 6) + ctz64(w);
+}
+
+void _bits_clear_unused(u64 *words, s64 bit_count)
+{
+    if (bit_count & 63)
+        words[bit_count >> 6] &= (1ull << (bit_count & 63)) - 1;
+}
+
+void _bits_fill(u64 *words, s64 bit_count, bool value)
+{
+    s64 word_count = _bit_word_count(bit_count);
+    u64 w = value ? ~0ull : 0ull;
+
+    for (s64 i = 0; i < word_count; ++i)
+        words[i] = w;
+
+    _bits_clear_unused(words, bit_count);
+}
+
+// these loops are trivially vectorized by the compiler (SSE2 / AVX2 / NEON
+// depending on the target).
+void _bits_and(u64 *dst, const u64 *other, s64 word_count)
+{
+    for (s64 i = 0; i < word_count; ++i)
+        dst[i] &= other[i];
+}
+
+void _bits_or(u64 *dst, const u64 *other, s64 word_count)
+{
+    for (s64 i = 0; i < word_count; ++i)
+        dst[i] |= other[i];
+}
+
+void _bits_xor(u64 *dst, const u64 *other, s64 word_count)
+{
+    for (s64 i = 0; i < word_count; ++i)
+        dst[i] ^= other[i];
+}
+
+void _bits_andnot(u64 *dst, const u64 *other, s64 word_count)
+{
+    for (s64 i = 0; i < word_count; ++i)
+        dst[i] &= ~other[i];
+}
+
+void _bits_not(u64 *dst, s64 bit_count)
+{
+    s64 word_count = _bit_word_count(bit_count);
+
+    for (s64 i = 0; i < word_count; ++i)
+        dst[i] = ~dst[i];
+
+    _bits_clear_unused(dst, bit_count);
+}
+
+void init(bit_array *arr)
+{
+    assert(arr != nullptr);
+
+    init(&arr->words);
+    arr->size = 0;
+}
+
+void init(bit_array *arr, s64 bit_count)
+{
+    assert(arr != nullptr);
+
+    init(arr);
+    resize(arr, bit_count);
+}
+
+bool resize(bit_array *arr, s64 bit_count)
+{
+    assert(arr != nullptr);
+
+    if (bit_count < 0)
+        bit_count = 0;
+
+    s64 old_word_count = arr->words.size;
+    s64 word_count = _bit_word_count(bit_count);
+
+    if (word_count != old_word_count && !resize(&arr->words, word_count))
+        return false;
+
+    // new words are 0, and bits beyond the new size in the last word too
+    if (word_count > old_word_count)
+        fill_memory(arr->words.data + old_word_count, 0, (word_count - old_word_count) * sizeof(u64));
+
+    arr->size = bit_count;
+
+    if (word_count > 0)
+        _bits_clear_unused(arr->words.data, bit_count);
+
+    return true;
+}
+
+void free(bit_array *arr)
+{
+    assert(arr != nullptr);
+
+    free(&arr->words);
+    arr->size = 0;
+}
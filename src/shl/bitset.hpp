@@ -0,0 +1,260 @@
+#pragma once
+
+/* bitset.hpp
+
+Bit containers. bitset<N> is a fixed size set of N bits, bit_array is a
+dynamically sized array of bits. Both store their bits in 64 bit words,
+bit i is bit (i % 64) of word (i / 64). Unused bits of the last word are
+always 0.
+
+    template<s64 N>
+    struct bitset
+    {
+        u64 words[word_count];
+    }
+
+    struct bit_array
+    {
+        array<u64> words;
+        s64 size; // number of bits
+    }
+
+Example usage:
+
+    bitset<256> visited{};
+
+    set_bit(&visited, 10);
+    set_bit(&visited, 200);
+
+    if (is_bit_set(&visited, 10))
+        ...
+
+    for_each_set_bit(i, &visited)
+        printf("%ld\n", i); // 10, 200
+
+    bit_array a{};
+    bit_array b{};
+    init(&a, 1000);
+    init(&b, 1000);
+    ...
+    bits_and(&a, &b); // a = a & b
+
+    free(&a);
+    free(&b);
+
+Functions (for both bitset and bit_array):
+
+set_bit(*bits, I)           sets bit I to 1.
+set_bit(*bits, I, Value)    sets bit I to Value.
+unset_bit(*bits, I)         sets bit I to 0.
+toggle_bit(*bits, I)        flips bit I.
+is_bit_set(*bits, I)        returns whether bit I is 1.
+
+fill_bits(*bits, Value)     sets all bits to Value.
+count_set_bits(*bits)       returns the number of bits set to 1 (popcount).
+
+bit_rank(*bits, I)          returns the number of bits set to 1 before
+                            bit I, i.e. in the range [0, I[.
+bit_select(*bits, K)        returns the index of the Kth (starting at 0) bit
+                            set to 1, or -1 if fewer than K + 1 bits are set.
+
+next_set_bit(*bits, I)      returns the index of the first bit set to 1 at
+                            or after I, or -1 if there is none.
+
+bits_and(*dst, *other)      dst = dst & other
+bits_or(*dst, *other)       dst = dst | other
+bits_xor(*dst, *other)      dst = dst ^ other
+bits_andnot(*dst, *other)   dst = dst & ~other
+bits_not(*dst)              dst = ~dst
+    The set operations work on whole words and are written so the compiler
+    vectorizes them. For bit_array, other must have at least as many bits
+    as dst.
+
+for_each_set_bit(I, *bits)  iterates the indices I of all bits set to 1 in
+                            ascending order, using ctz to skip zero bits.
+
+bit_array functions:
+
+init(*arr)      initializes an empty bit_array.
+init(*arr, N)   initializes a bit_array with N bits set to 0.
+resize(*arr, N) sets the number of bits to N, new bits are 0.
+free(*arr)      frees the memory of the bit_array.
+ */
+
+#include "shl/assert.hpp"
+#include "shl/number_types.hpp"
+#include "shl/array.hpp"
+#include "shl/bits.hpp"
+
+#define _bit_word_count(Bits) (((Bits) + 63) / 64)
+
+template<s64 N>
+struct bitset
+{
+    static_assert(N > 0, "bitset must have at least 1 bit");
+
+    static constexpr s64 size = N;
+    static constexpr s64 word_count = _bit_word_count(N);
+
+    u64 words[word_count];
+};
+
+struct bit_array
+{
+    array<u64> words;
+    s64 size;
+};
+
+// word functions used by bitset and bit_array
+s64  _bits_popcount(const u64 *words, s64 word_count);
+s64  _bits_rank(const u64 *words, s64 bit);
+s64  _bits_select(const u64 *words, s64 word_count, s64 k);
+s64  _bits_next_set(const u64 *words, s64 bit_count, s64 bit);
+void _bits_fill(u64 *words, s64 bit_count, bool value);
+void _bits_and(u64 *dst, const u64 *other, s64 word_count);
+void _bits_or(u64 *dst, const u64 *other, s64 word_count);
+void _bits_xor(u64 *dst, const u64 *other, s64 word_count);
+void _bits_andnot(u64 *dst, const u64 *other, s64 word_count);
+void _bits_not(u64 *dst, s64 bit_count);
+void _bits_clear_unused(u64 *words, s64 bit_count);
+
+// bit_array
+void init(bit_array *arr);
+void init(bit_array *arr, s64 bit_count);
+bool resize(bit_array *arr, s64 bit_count);
+void free(bit_array *arr);
+
+inline u64 *_bits_words(bit_array *arr)             { return arr->words.data; }
+inline const u64 *_bits_words(const bit_array *arr) { return arr->words.data; }
+inline s64 _bits_size(const bit_array *arr)         { return arr->size; }
+
+template<s64 N> inline u64 *_bits_words(bitset<N> *set)             { return set->words; }
+template<s64 N> inline const u64 *_bits_words(const bitset<N> *set) { return set->words; }
+template<s64 N> inline s64 _bits_size(const bitset<N> *)            { return N; }
+
+// generic functions for bitset and bit_array
+template<typename Bits>
+inline bool is_bit_set(const Bits *bits, s64 index)
+{
+    assert(bits != nullptr);
+    assert(index >= 0 && index < _bits_size(bits));
+
+    return (_bits_words(bits)[index >> 6] >> (index & 63)) & 1;
+}
+
+template<typename Bits>
+inline void set_bit(Bits *bits, s64 index)
+{
+    assert(bits != nullptr);
+    assert(index >= 0 && index < _bits_size(bits));
+
+    _bits_words(bits)[index >> 6] |= (1ull << (index & 63));
+}
+
+template<typename Bits>
+inline void unset_bit(Bits *bits, s64 index)
+{
+    assert(bits != nullptr);
+    assert(index >= 0 && index < _bits_size(bits));
+
+    _bits_words(bits)[index >> 6] &= ~(1ull << (index & 63));
+}
+
+template<typename Bits>
+inline void set_bit(Bits *bits, s64 index, bool value)
+{
+    if (value)
+        set_bit(bits, index);
+    else
+        unset_bit(bits, index);
+}
+
+template<typename Bits>
+inline void toggle_bit(Bits *bits, s64 index)
+{
+    assert(bits != nullptr);
+    assert(index >= 0 && index < _bits_size(bits));
+
+    _bits_words(bits)[index >> 6] ^= (1ull << (index & 63));
+}
+
+template<typename Bits>
+inline void fill_bits(Bits *bits, bool value)
+{
+    assert(bits != nullptr);
+    _bits_fill(_bits_words(bits), _bits_size(bits), value);
+}
+
+template<typename Bits>
+inline s64 count_set_bits(const Bits *bits)
+{
+    assert(bits != nullptr);
+    return _bits_popcount(_bits_words(bits), _bit_word_count(_bits_size(bits)));
+}
+
+template<typename Bits>
+inline s64 bit_rank(const Bits *bits, s64 index)
+{
+    assert(bits != nullptr);
+    assert(index >= 0 && index <= _bits_size(bits));
+
+    return _bits_rank(_bits_words(bits), index);
+}
+
+template<typename Bits>
+inline s64 bit_select(const Bits *bits, s64 k)
+{
+    assert(bits != nullptr);
+    return _bits_select(_bits_words(bits), _bit_word_count(_bits_size(bits)), k);
+}
+
+template<typename Bits>
+inline s64 next_set_bit(const Bits *bits, s64 index)
+{
+    assert(bits != nullptr);
+    return _bits_next_set(_bits_words(bits), _bits_size(bits), index);
+}
+
+template<typename Bits>
+inline void bits_and(Bits *dst, const Bits *other)
+{
+    assert(dst != nullptr && other != nullptr);
+    assert(_bits_size(other) >= _bits_size(dst));
+    _bits_and(_bits_words(dst), _bits_words(other), _bit_word_count(_bits_size(dst)));
+}
+
+template<typename Bits>
+inline void bits_or(Bits *dst, const Bits *other)
+{
+    assert(dst != nullptr && other != nullptr);
+    assert(_bits_size(other) >= _bits_size(dst));
+    _bits_or(_bits_words(dst), _bits_words(other), _bit_word_count(_bits_size(dst)));
+    _bits_clear_unused(_bits_words(dst), _bits_size(dst));
+}
+
+template<typename Bits>
+inline void bits_xor(Bits *dst, const Bits *other)
+{
+    assert(dst != nullptr && other != nullptr);
+    assert(_bits_size(other) >= _bits_size(dst));
+    _bits_xor(_bits_words(dst), _bits_words(other), _bit_word_count(_bits_size(dst)));
+    _bits_clear_unused(_bits_words(dst), _bits_size(dst));
+}
+
+template<typename Bits>
+inline void bits_andnot(Bits *dst, const Bits *other)
+{
+    assert(dst != nullptr && other != nullptr);
+    assert(_bits_size(other) >= _bits_size(dst));
+    _bits_andnot(_bits_words(dst), _bits_words(other), _bit_word_count(_bits_size(dst)));
+}
+
+template<typename Bits>
+inline void bits_not(Bits *dst)
+{
+    assert(dst != nullptr);
+    _bits_not(_bits_words(dst), _bits_size(dst));
+}
+
+#define for_each_set_bit(I_Var, BITS)\
+    for (s64 I_Var = next_set_bit(BITS, 0); I_Var >= 0; I_Var = next_set_bit(BITS, I_Var + 1))
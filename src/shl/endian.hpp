@@ -8,6 +8,10 @@ Everyone's favorite header.
 Defines the macro IS_LITTLE_ENDIAN and IS_BIG_ENDIAN to check if the system
 is little or big endian, and force_big_endian and force_little_endian functions
 to convert a value if the system is not of the desired endianness.
+
+byte_swap(Value) reverses the order of the bytes of a u32 or u64 value.
+Compilers turn the shifts into a single instruction (e.g. bswap) where there
+is one.
 */
 
 #include "shl/number_types.hpp"
@@ -15,20 +19,36 @@ to convert a value if the system is not of the desired endianness.
 #define IS_LITTLE_ENDIAN  ('ABCD'==0x41424344ul) 
 #define IS_BIG_ENDIAN     ('ABCD'==0x44434241ul)
 
+constexpr u32 byte_swap(u32 value)
+{
+    u32 ret = 0;
+    ret |= ((value & 0xff) << 24);
+    ret |= (((value >> 8) & 0xff)  << 16);
+    ret |= (((value >> 16) & 0xff) << 8);
+    ret |= (((value >> 24) & 0xff) << 0);
+
+    return ret;
+}
+
+constexpr u64 byte_swap(u64 value)
+{
+    return ((u64)byte_swap((u32)value) << 32) | (u64)byte_swap((u32)(value >> 32));
+}
+
 constexpr u32 force_big_endian(u32 value)
 {
     if constexpr (IS_BIG_ENDIAN)
         return value;
     else
-    {
-        u32 ret = 0;
-        ret |= ((value & 0xff) << 24);
-        ret |= (((value >> 8) & 0xff)  << 16);
-        ret |= (((value >> 16) & 0xff) << 8);
-        ret |= (((value >> 24) & 0xff) << 0);
-
-        return ret;
-    }
+        return byte_swap(value);
+}
+
+constexpr u64 force_big_endian(u64 value)
+{
+    if constexpr (IS_BIG_ENDIAN)
+        return value;
+    else
+        return byte_swap(value);
 }
 
 constexpr u32 force_little_endian(u32 value)
@@ -36,13 +56,13 @@ constexpr u32 force_little_endian(u32 value)
     if constexpr (IS_LITTLE_ENDIAN)
         return value;
     else
-    {
-        u32 ret = 0;
-        ret |= ((value & 0xff) << 24);
-        ret |= (((value >> 8) & 0xff)  << 16);
-        ret |= (((value >> 16) & 0xff) << 8);
-        ret |= (((value >> 24) & 0xff) << 0);
-
-        return ret;
-    }
+        return byte_swap(value);
+}
+
+constexpr u64 force_little_endian(u64 value)
+{
+    if constexpr (IS_LITTLE_ENDIAN)
+        return value;
+    else
+        return byte_swap(value);
 }
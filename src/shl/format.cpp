@@ -1,8 +1,9 @@
 
 #include "shl/string_encoding.hpp"
-#include "shl/exit.hpp"
 #include "shl/bits.hpp"
+#include "shl/number_format.hpp"
 #include "shl/format.hpp"
+#include "shl/thread.hpp"
 
 /*
 #define LIT(C, Literal)\
@@ -11,50 +12,6 @@
 
 #define as_array_ptr(C, str) (array<C>*)(str)
 
-static const c8 *hex_letters      = "0123456789abcdef";
-static const c8 *hex_letters_caps = "0123456789ABCDEF";
-
-template<typename C>
-static inline s64 _string_copy_reverse(const C *src, C *dst, s64 size)
-{
-    s64 i = size;
-	while (i > 0)
-    {
-        *dst = src[i - 1];
-        i--;
-        dst++;
-	}
-
-    return size;
-}
-
-template<typename C>
-static inline s64 _string_copy_reverse_checked(const C *src, s64 src_size, C *dst, s64 dst_size)
-{
-    s64 ssize = 0;
-
-    if (dst_size < src_size)
-    {
-        // we advance src here because src is in reverse.
-        // if dst_size is smaller, we would be copying src from the wrong end.
-        src += (src_size - dst_size);
-        ssize = dst_size;
-    }
-    else
-        ssize = src_size;
-
-    return _string_copy_reverse(src, dst, ssize);
-}
-
-template<typename C>
-static inline s64 _string_copy_reverse_checked(const C *src, s64 src_size, C *dst, s64 dst_size, s64 dst_offset)
-{
-    if (dst_offset >= dst_size)
-        return 0;
-
-    return _string_copy_reverse_checked(src, src_size, dst + dst_offset, dst_size - dst_offset);
-}
-
 template<typename C>
 static inline s64 _string_copy_checked(const C *src, s64 src_size, C *dst, s64 dst_size)
 {
@@ -346,95 +303,47 @@ s64 _to_string(u16string *s, const_u32string x, s64 offset, format_options<c16>
 s64 _to_string(u32string *s, const_string    x, s64 offset, format_options<c32> opt) _to_string_s_body(_encoding_to_string, s, x, offset, opt)
 s64 _to_string(u32string *s, const_u16string x, s64 offset, format_options<c32> opt) _to_string_s_body(_encoding_to_string, s, x, offset, opt)
 
-template<typename N>
-static inline int _get_number_of_int_digits_required(N value, int base)
+template<typename C>
+static inline s64 _c8_copy_checked(const c8 *src, s64 src_size, C *dst, s64 dst_size)
 {
-    if (value == 0)
-        return 1;
+    s64 n = src_size < dst_size ? src_size : dst_size;
 
-    int ret = 0;
-
-    switch (base)
-    {
-    case 2:
-    case 8:
-    case 16:
-    {
-        s64 shift = const_log2(base);
-
-        while (value > 0)
-        {
-            value >>= shift;
-            ret += 1;
-        }
-
-        break;
-    }
-
-    case 10:
-    {
-        while (value > 0)
-        {
-            value /= 10;
-            ret += 1;
-        }
-
-        break;
-    }
-
-    default:
-        ret = -1;
-        break;
-    }
+    if constexpr (sizeof(C) == sizeof(c8))
+        copy_memory(src, dst, n);
+    else
+        for (s64 i = 0; i < n; ++i)
+            dst[i] = (C)src[i];
 
-    return ret;
+    return n;
 }
 
-template<u8 Pow, typename C, typename N>
-static inline s64 _c_unsigned_pow2_to_string_reverse(C *s, N x, bool caps_letters = false)
+template<typename N>
+static inline bool _integer_is_negative(N x)
 {
-    static_assert(Pow <= 16);
-
-    const c8 *letters = caps_letters ? hex_letters_caps : hex_letters;
-
-    int i = 0;
-
-    if (x == 0)
-    {
-        s[i++] = '0';
-        return i;
-    }
-
-    constexpr u64 Shift = const_log2(Pow);
-    constexpr u64 mask = bitmask<u64>(0, Shift - 1);
-
-    while (x > 0)
-    {
-        s[i++] = letters[x & mask];
-        x >>= Shift;
-    }
-
-    return i;
+    if constexpr (is_signed(N))
+        return x < 0;
+    else
+        return false;
 }
 
-template<typename C, typename N>
-static inline s64 _c_unsigned_decimal_to_string_reverse(C *s, N x)
+template<typename N>
+static inline u64 _integer_magnitude(N x)
 {
-    int i = 0;
-
-    if (x == 0)
-    {
-        s[i++] = '0';
-        return i;
-    }
+    // negating in u64 also works for the smallest s64
+    return _integer_is_negative(x) ? (u64)0 - (u64)x : (u64)x;
+}
 
-    while (x > 0)
+// writes the digits of x forwards, see shl/number_format.hpp
+static inline s64 _integer_digits(c8 *buf, u64 x, integer_format_options iopt)
+{
+    switch (iopt.base)
     {
-        s[i++] = '0' + (x % 10);
-        x /= 10;
+    case 2:  return write_integer_binary(buf, x);
+    case 8:  return write_integer_octal(buf, x);
+    case 10: return write_integer_decimal(buf, x);
+    case 16: return write_integer_hex(buf, x, iopt.caps_letters);
+    default: return -1;
     }
-
-    return i;
 }
 
 template<typename C, typename N>
@@ -444,15 +353,13 @@ static inline s64 _integer_to_c_string(C *s, s64 ssize, N x, s64 offset, format_
         opt.precision = DEFAULT_INT_PRECISION;
 
     s64 buf_write_size = 0;
-    u64 no_sign_x = x < 0 ? -x : x;
-    int digit_count = _get_number_of_int_digits_required(no_sign_x, iopt.base);
+    bool negative = _integer_is_negative(x);
+    c8 buf[INTEGER_DIGITS_BUFFER_SIZE];
+    s64 digit_count = _integer_digits(buf, _integer_magnitude(x), iopt);
 
     if (digit_count < 0)
         return -1;
 
-    if (digit_count == 0)
-        return 0;
-
     if (iopt.include_prefix)
     switch (iopt.base)
     {
@@ -461,21 +368,10 @@ static inline s64 _integer_to_c_string(C *s, s64 ssize, N x, s64 offset, format_
     case 16: buf_write_size += 2; break;
     } 
 
-    if (x < 0 || opt.sign == '+')
+    if (negative || opt.sign == '+')
         buf_write_size += 1;
 
-    buf_write_size += Max(opt.precision, digit_count);
-    
-    // buf is in reverse
-    C buf[64];
-
-    switch (iopt.base)
-    {
-    case 2:  _c_unsigned_pow2_to_string_reverse<2>(buf,  no_sign_x); break;
-    case 8:  _c_unsigned_pow2_to_string_reverse<8>(buf,  no_sign_x); break;
-    case 10: _c_unsigned_decimal_to_string_reverse(buf,  no_sign_x); break;
-    case 16: _c_unsigned_pow2_to_string_reverse<16>(buf, no_sign_x, iopt.caps_letters); break;
-    }
+    buf_write_size += Max((s64)opt.precision, digit_count);
 
     s64 i = offset;
 
@@ -486,14 +382,9 @@ static inline s64 _integer_to_c_string(C *s, s64 ssize, N x, s64 offset, format_
 
     // sign, can be forced (+ or -), or negative numbers
     if (opt.sign == '+')
-    {
-        s[i++] = (x < 0) ? '-' : '+';
-    }
-    else if constexpr (is_signed(N))
-    {
-        if (x < 0)
-            s[i++] = '-';
-    }
+        s[i++] = negative ? '-' : '+';
+    else if (negative)
+        s[i++] = '-';
 
     if (i >= ssize) return i - offset;
 
@@ -525,8 +416,7 @@ static inline s64 _integer_to_c_string(C *s, s64 ssize, N x, s64 offset, format_
 
     i += pad_string(s, ssize, (C)'0', opt.precision - digit_count, i);
 
-    s64 copied_len = _string_copy_reverse_checked(buf, digit_count, s + i, ssize - i);
-    i += copied_len;
+    i += _c8_copy_checked(buf, digit_count, s + i, ssize - i);
 
     return i - offset;
 }
@@ -541,7 +431,7 @@ static inline s64 _integer_to_c_string_conv(C *s, s64 ssize, N x, s64 offset, fo
     }
     else
     {
-        s64 val = x;
+        u64 val = x;
         return _integer_to_c_string(s, ssize, val, offset, opt, iopt);
     }
 }
@@ -579,15 +469,11 @@ static inline s64 _integer_to_string(string_base<C> *s, N x, s64 offset, format_
         opt.precision = DEFAULT_INT_PRECISION;
 
     s64 bytes_to_reserve = 0;
-    u64 no_sign_x = x < 0 ? -x : x;
-    int digit_count = _get_number_of_int_digits_required(no_sign_x, iopt.base);
+    s32 digit_count = integer_digit_count(_integer_magnitude(x), iopt.base);
 
     if (digit_count < 0)
         return -1;
 
-    if (digit_count == 0)
-        return 0;
-
     if (iopt.include_prefix)
     switch (iopt.base)
     {
@@ -596,7 +482,7 @@ static inline s64 _integer_to_string(string_base<C> *s, N x, s64 offset, format_
     case 16: bytes_to_reserve += 2; break;
     } 
 
-    if (x < 0 || opt.sign == '+')
+    if (_integer_is_negative(x) || opt.sign == '+')
         bytes_to_reserve += 1;
 
     bytes_to_reserve += Max(opt.precision, digit_count);
@@ -620,7 +506,7 @@ static inline s64 _integer_to_string_conv(string_base<C> *s, N x, s64 offset, fo
     }
     else
     {
-        s64 val = x;
+        u64 val = x;
         return _integer_to_string(s, val, offset, opt, iopt);
     }
 }
@@ -651,6 +537,82 @@ s64 to_string(u32string *s, s16 x, s64 offset, format_options<c32> opt, integer_
 s64 to_string(u32string *s, s32 x, s64 offset, format_options<c32> opt, integer_format_options iopt) _to_string_s_body(_integer_to_string_conv, s, x, offset, opt, iopt);
 s64 to_string(u32string *s, s64 x, s64 offset, format_options<c32> opt, integer_format_options iopt) _to_string_s_body(_integer_to_string_conv, s, x, offset, opt, iopt);
 
+// batch
+template<typename N>
+static inline s64 _integers_to_c_string(c8 *s, s64 ssize, const N *values, s64 count, const_string delimiter, s64 offset)
+{
+    s64 i = offset;
+    c8 buf[INTEGER_DIGITS_BUFFER_SIZE];
+
+    for (s64 v = 0; v < count && i < ssize; ++v)
+    {
+        if (v > 0 && delimiter.size == 1)
+        {
+            s[i++] = delimiter.c_str[0];
+
+            if (i >= ssize)
+                break;
+        }
+        else if (v > 0 && delimiter.size > 1)
+        {
+            i += _string_copy_checked(delimiter.c_str, delimiter.size, s, ssize, i);
+
+            if (i >= ssize)
+                break;
+        }
+
+        N x = values[v];
+
+        if (_integer_is_negative(x))
+        {
+            s[i++] = '-';
+
+            if (i >= ssize)
+                break;
+        }
+
+        // 20 digits is the most a u64 can have
+        if (ssize - i >= 20)
+            i += write_integer_decimal(s + i, _integer_magnitude(x));
+        else
+        {
+            s64 digit_count = write_integer_decimal(buf, _integer_magnitude(x));
+            i += _c8_copy_checked(buf, digit_count, s + i, ssize - i);
+        }
+    }
+
+    return i - offset;
+}
+
+template<typename N>
+static inline s64 _integers_to_string(string *s, const array<N> *values, const_string delimiter, s64 offset)
+{
+    s64 size = 0;
+
+    for (s64 v = 0; v < values->size; ++v)
+        size += _integer_is_negative(values->data[v]) + integer_digit_count(_integer_magnitude(values->data[v]), 10);
+
+    if (values->size > 1)
+        size += (values->size - 1) * delimiter.size;
+
+    string_reserve(s, offset + size);
+
+    s64 written = _integers_to_c_string(s->data, s->reserved_size, values->data, values->size, delimiter, offset);
+
+    if (written + offset >= s->size)
+    {
+        s->size = written + offset;
+        s->data[s->size] = '\0';
+    }
+
+    return written;
+}
+
+s64 to_string(c8 *s, s64 ssize, const u64 *values, s64 count, const_string delimiter, s64 offset) { return _integers_to_c_string(s, ssize, values, count, delimiter, offset); }
+s64 to_string(c8 *s, s64 ssize, const s64 *values, s64 count, const_string delimiter, s64 offset) { return _integers_to_c_string(s, ssize, values, count, delimiter, offset); }
+s64 to_string(string *s, const array<u64> *values, const_string delimiter, s64 offset) { return _integers_to_string(s, values, delimiter, offset); }
+s64 to_string(string *s, const array<s64> *values, const_string delimiter, s64 offset) { return _integers_to_string(s, values, delimiter, offset); }
+
 template<typename C>
 static inline s64 _pointer_to_c_string(C *s, s64 ssize, const void *x, s64 offset, format_options<C> opt)
 {
@@ -687,113 +649,72 @@ s64 to_string(string    *s, const void *x, s64 offset, format_options<c8>  opt)
 s64 to_string(u16string *s, const void *x, s64 offset, format_options<c16> opt) _to_string_s_body(_pointer_to_string, s, x, offset, opt);
 s64 to_string(u32string *s, const void *x, s64 offset, format_options<c32> opt) _to_string_s_body(_pointer_to_string, s, x, offset, opt);
 
-template<typename C, typename N>
-static inline s64 _c_remainder_to_string_reverse(C *s, N x, int precision, [[maybe_unused]] bool ignore_trailing_zeroes)
+template<typename N>
+static inline bool _float_is_negative(N x)
 {
-    if (precision > FLOAT_MAX_PRECISION)
-        precision = FLOAT_MAX_PRECISION;
-
-    if (precision <= 0)
-        return 0;
-
-    s64 i = 0;
-    u64 cap = 1;
-
-	for (int _pow10 = 0; _pow10 < precision; _pow10++)
-		cap *= 10;
-
-	double round = x * static_cast<double>(cap);
-	u64 whole = static_cast<u64>(round);
+    // sign bit, so -0.0 is negative too
+    static_assert(sizeof(N) == sizeof(u32) || sizeof(N) == sizeof(u64));
 
-	if ((static_cast<u64>((round - static_cast<double>(whole)) * 10.0)) >= 5)
+    if constexpr (sizeof(N) == sizeof(u64))
     {
-		whole++;
-
-		if(whole >= cap)
-			whole = cap - 1;
-	}
-
-	i += _c_unsigned_decimal_to_string_reverse(s, whole);
+        u64 bits = 0;
+        copy_memory(&x, &bits, sizeof(bits));
+        return (bits >> 63) != 0;
+    }
+    else
+    {
+        u32 bits = 0;
+        copy_memory(&x, &bits, sizeof(bits));
+        return (bits >> 31) != 0;
+    }
+}
 
-    while (i < precision)
-        s[i++] = '0';
+// writes the absolute value of x into buf, see shl/number_format.hpp
+template<typename N>
+static inline s64 _float_to_decimal(c8 *buf, N x, int precision, float_format_options fopt)
+{
+    if (precision < 0)
+        precision = DEFAULT_FLOAT_PRECISION;
 
-    s[i++] = '.';
+    if (precision > FLOAT_MAX_PRECISION)
+        precision = FLOAT_MAX_PRECISION;
 
-    return i;
+    switch (fopt.mode)
+    {
+    case float_format_mode::scientific:
+        return write_float_scientific(buf, x, precision, fopt.ignore_trailing_zeroes);
+    case float_format_mode::shortest:
+        return write_float_shortest(buf, x);
+    case float_format_mode::fixed:
+    default:
+        return write_float_fixed(buf, x, precision, fopt.ignore_trailing_zeroes);
+    }
 }
 
-#define FLOAT_BUFFER_SIZE 64
-
 template<typename C, typename N>
 static inline s64 _float_to_c_string(C *s, s64 ssize, N x, s64 offset, format_options<C> opt, float_format_options fopt)
 {
-    if (opt.precision < 0)
-        opt.precision = DEFAULT_FLOAT_PRECISION;
-
-    C buf[FLOAT_BUFFER_SIZE];
-    s64 buf_size = -1;
-
-    double no_sign_x = x < 0 ? -x : x;
-
-    u64 whole = static_cast<u64>(no_sign_x);
-    double remainder = no_sign_x - static_cast<double>(whole);
+    c8 buf[FLOAT_DECIMAL_BUFFER_SIZE];
+    s64 buf_size = _float_to_decimal(buf, x, opt.precision, fopt);
+    bool negative = _float_is_negative(x);
 
-    s64 remainder_size = _c_remainder_to_string_reverse(buf, remainder, opt.precision, fopt.ignore_trailing_zeroes);
-    s64 whole_size = _c_unsigned_decimal_to_string_reverse(buf + remainder_size, whole);
+    s64 buf_write_size = buf_size;
 
-    buf_size = remainder_size + whole_size;
-
-    if (buf_size < 0)
-        return -1;
-
-    if (buf_size == 0)
-        return 0;
-
-    s64 buf_write_size = 0;
-
-    if (opt.sign == '+' || x < 0)
+    if (opt.sign == '+' || negative)
         buf_write_size += 1;
 
-    buf_write_size += whole_size;
-    buf_write_size += remainder_size;
-
-    s64 copy_start = 0;
-
-    if (fopt.ignore_trailing_zeroes)
-        while (copy_start < FLOAT_BUFFER_SIZE)
-        {
-            C c = buf[copy_start];
-
-            if (c == '0')
-            {
-                copy_start++;
-                continue;
-            }
-
-            if (c == '.')
-            {
-                copy_start++;
-                break;
-            }
-
-            break;
-        }
-
-    buf_write_size -= copy_start;
-
     s64 i = offset;
 
     i += pad_string(s, ssize, opt.pad_char, opt.pad_length - buf_write_size, offset);
 
     if (i >= ssize) return i - offset;
 
-    if (opt.sign == '+') s[i++] = (x < 0.0) ? '-' : '+';
-    else if (x < 0.0)    s[i++] = '-';
+    if (opt.sign == '+') s[i++] = negative ? '-' : '+';
+    else if (negative)   s[i++] = '-';
 
     if (i >= ssize) return i - offset;
 
-    i += _string_copy_reverse_checked(buf + copy_start, buf_size - copy_start, s + i, ssize - i);
+    i += _c8_copy_checked(buf, buf_size, s + i, ssize - i);
 
     return i - offset;
 }
@@ -808,36 +729,15 @@ s64 to_string(c32 *s, s64 ssize, double x, s64 offset, format_options<c32> opt,
 template<typename C, typename N>
 static inline s64 _float_to_string(string_base<C> *s, N x, s64 offset, format_options<C> opt, float_format_options fopt)
 {
-    if (opt.precision < 0)
-        opt.precision = DEFAULT_FLOAT_PRECISION;
-
-    C buf[FLOAT_BUFFER_SIZE];
-    s64 buf_size = -1;
-
-    double no_sign_x = x < 0 ? -x : x;
+    c8 buf[FLOAT_DECIMAL_BUFFER_SIZE];
+    s64 buf_size = _float_to_decimal(buf, x, opt.precision, fopt);
+    bool negative = _float_is_negative(x);
 
-    u64 whole = static_cast<u64>(no_sign_x);
-    double remainder = no_sign_x - static_cast<double>(whole);
+    s64 bytes_to_reserve = buf_size;
 
-    s64 remainder_size = _c_remainder_to_string_reverse(buf, remainder, opt.precision, fopt.ignore_trailing_zeroes);
-    s64 whole_size = _c_unsigned_decimal_to_string_reverse(buf + remainder_size, whole);
-
-    buf_size = remainder_size + whole_size;
-
-    if (buf_size < 0)
-        return -1;
-
-    if (buf_size == 0)
-        return 0;
-
-    s64 bytes_to_reserve = 0;
-
-    if (opt.sign == '+' || x < 0)
+    if (opt.sign == '+' || negative)
         bytes_to_reserve += 1;
 
-    bytes_to_reserve += whole_size;
-    bytes_to_reserve += remainder_size;
-
     s64 buf_write_size = bytes_to_reserve;
 
     if (opt.pad_length > 0 && bytes_to_reserve < opt.pad_length)
@@ -845,39 +745,14 @@ static inline s64 _float_to_string(string_base<C> *s, N x, s64 offset, format_op
 
     string_reserve(s, offset + bytes_to_reserve);
 
-    s64 copy_start = 0;
-
-    if (fopt.ignore_trailing_zeroes)
-        while (copy_start < FLOAT_BUFFER_SIZE)
-        {
-            C c = buf[copy_start];
-
-            if (c == '0')
-            {
-                copy_start++;
-                continue;
-            }
-
-            if (c == '.')
-            {
-                copy_start++;
-                break;
-            }
-
-            break;
-        }
-
-    buf_write_size -= copy_start;
-
     s64 i = offset + pad_string(s, opt.pad_char, opt.pad_length - buf_write_size, offset);
 
     if (opt.sign == '+')
-        s->data[i++] = (x < 0.0) ? '-' : '+';
-    else if (x < 0.0)
+        s->data[i++] = negative ? '-' : '+';
+    else if (negative)
         s->data[i++] = '-';
 
-    s64 copied_len = _string_copy_reverse_checked(buf + copy_start, buf_size - copy_start, s->data + i, s->reserved_size - i);
-    i += copied_len;
+    i += _c8_copy_checked(buf, buf_size, s->data + i, s->reserved_size - i);
 
     return i - offset;
 }
@@ -915,6 +790,9 @@ static inline s64 _format_c_s(s64 i, s64 written, C *s, s64 ssize, s64 offset, c
                 {
                     s[offset++] = '\\';
                     written++;
+
+                    if (offset >= ssize)
+                        break;
                 }
             }
 
@@ -1033,6 +911,13 @@ static inline s64 _format_skip_until_placeholder_c_s(s64 *_i, internal::_placeho
             }
             else if (fmt[i] != '%')
             {
+                if (offset + 1 >= ssize)
+                {
+                    // no space for both characters, stop at the backslash
+                    *_i = i - 1;
+                    return written;
+                }
+
                 s[offset++] = '\\';
                 written++;
                 c = fmt[i];
@@ -1120,7 +1005,7 @@ static inline s64 _format_skip_until_placeholder_c_s(s64 *_i, internal::_placeho
         
         while (c >= '0' && c <= '9')
         {
-            pl->options.precision += (pl->options.precision * 10) + (c - '0');
+            pl->options.precision = (pl->options.precision * 10) + (c - '0');
             j++;
 
             if_at_end_goto(j, fmt_end);
@@ -1211,51 +1096,95 @@ s64 internal::_format_skip_until_placeholder(s64 *i, _placeholder_info<c32> *pl,
     return ::_format_skip_until_placeholder_s(i, pl, s, offset, fmt);
 }
 
-void _format_buffer_cleanup();
-
 #define TFORMAT_RING_BUFFER_MIN_SIZE 4096
 
-template<typename C>
-static inline internal::tformat_buffer *_get_static_format_buffer(bool free_buffer = false)
+static s64 _tformat_buffer_min_size = TFORMAT_RING_BUFFER_MIN_SIZE;
+
+// one buffer per character type, allocated on first use and freed when the
+// thread exits.
+struct _thread_tformat_buffers
 {
-    static internal::tformat_buffer _buf{};
+    internal::tformat_buffer buffers[3];
 
-    if (free_buffer && _buf.buffer.data != nullptr)
+    ~_thread_tformat_buffers()
     {
-        free(&_buf.buffer);
-        _buf.offset = 0;
+        for (internal::tformat_buffer &buf : buffers)
+            if (buf.buffer.data != nullptr)
+            {
+                free(&buf.buffer);
+                buf.offset = 0;
+            }
     }
-    else if (!free_buffer && _buf.buffer.data == nullptr)
+};
+
+static thread_local _thread_tformat_buffers _tl_tformat_buffers{};
+
+static void _free_slot_tformat_buffers(void *data)
+{
+    _thread_tformat_buffers *bufs = (_thread_tformat_buffers*)data;
+    bufs->~_thread_tformat_buffers();
+    allocator_dealloc(default_allocator, bufs, sizeof(_thread_tformat_buffers));
+}
+
+// threads started with thread_start share the thread_local buffers of the
+// thread that created them, so they keep their own in a thread data slot.
+static _thread_tformat_buffers *_get_thread_tformat_buffers()
+{
+    thread_data_slot *slot = get_thread_data_slot(THREAD_DATA_SLOT_TFORMAT);
+
+    if (slot == nullptr)
+        return &_tl_tformat_buffers;
+
+    if (slot->data == nullptr)
     {
-        if (!init(&_buf.buffer, TFORMAT_RING_BUFFER_MIN_SIZE, 2))
+        _thread_tformat_buffers *bufs = (_thread_tformat_buffers*)allocator_alloc(default_allocator, sizeof(_thread_tformat_buffers));
+
+        if (bufs == nullptr)
             return nullptr;
 
-        ::register_exit_function(_format_buffer_cleanup);
+        fill_memory(bufs, 0);
+        slot->data = bufs;
+        slot->cleanup = _free_slot_tformat_buffers;
     }
 
-    return &_buf;
+    return (_thread_tformat_buffers*)slot->data;
 }
 
-void _format_buffer_cleanup()
+static internal::tformat_buffer *_get_thread_format_buffer(s64 index)
 {
-    _get_static_format_buffer<c8>(true);
-    _get_static_format_buffer<c16>(true);
-    _get_static_format_buffer<c32>(true);
+    _thread_tformat_buffers *bufs = _get_thread_tformat_buffers();
+
+    if (bufs == nullptr)
+        return nullptr;
+
+    internal::tformat_buffer *buf = bufs->buffers + index;
+
+    if (buf->buffer.data == nullptr)
+    {
+        s64 min_size = __atomic_load_n(&_tformat_buffer_min_size, __ATOMIC_RELAXED);
+
+        if (!init(&buf->buffer, min_size, 2))
+            return nullptr;
+
+        buf->offset = 0;
+    }
+
+    return buf;
 }
 
 internal::tformat_buffer *internal::_get_tformat_buffer_c8()
 {
-    return _get_static_format_buffer<c8>(false);
+    return _get_thread_format_buffer(0);
 }
 
 internal::tformat_buffer *internal::_get_tformat_buffer_c16()
 {
-    return _get_static_format_buffer<c16>(false);
+    return _get_thread_format_buffer(1);
 }
 
 internal::tformat_buffer *internal::_get_tformat_buffer_c32()
 {
-    return _get_static_format_buffer<c32>(false);
+    return _get_thread_format_buffer(2);
 }
 
 s64 get_tformat_buffer_size()
@@ -1268,3 +1197,24 @@ s64 get_tformat_buffer_size()
 
     return buf->buffer.size;
 }
+
+void set_tformat_buffer_size(s64 min_size)
+{
+    if (min_size < TFORMAT_RING_BUFFER_MIN_SIZE)
+        min_size = TFORMAT_RING_BUFFER_MIN_SIZE;
+
+    __atomic_store_n(&_tformat_buffer_min_size, min_size, __ATOMIC_RELAXED);
+
+    _thread_tformat_buffers *bufs = _get_thread_tformat_buffers();
+
+    if (bufs == nullptr)
+        return;
+
+    // the buffers of this thread are allocated again with the new size
+    for (internal::tformat_buffer &buf : bufs->buffers)
+        if (buf.buffer.data != nullptr && buf.buffer.size < min_size)
+        {
+            free(&buf.buffer);
+            buf.offset = 0;
+        }
+}
@@ -43,19 +43,45 @@ These functions will only write up to ssize characters, which means that if the
 buffers don't have enough memory to format the value / format string, the
 return value will be ssize (or rather, ssize - offset if offset is not 0).
 
+format_size(fmt, ...) returns the exact number of characters format(fmt, ...)
+would produce, without writing them anywhere (or -1 if the arguments don't
+match fmt), e.g. to reserve a string or allocate a buffer once and then
+format into it with the C* overloads:
+
+     s64 size = format_size("% %"_cs, name, value);
+     string_reserve(&str, size);
+     str.size = format(str.data, size, "% %"_cs, name, value);
+     str.data[str.size] = '\0';
+
+format_size formats in chunks of FORMAT_CHUNK_BUFFER_SIZE bytes on the stack,
+see also format_to_io in shl/print.hpp, which formats in chunks directly to
+an io_handle.
+
 format() also accepts options for placeholders, similar to (sn)printf, although
 more limited.
 See tests/format.tests for examples.
 
 tformat(fmt, ...) is a function that returns a const_string to a formatted
-string using the arguments. The first time this function is called, a ring buffer
-is allocated which has at least 4096 bytes of space, or more depending on the
-page size of the system. When the program exits, the buffer is free'd.
+string using the arguments. The first time this function is called in a thread,
+a ring buffer is allocated for that thread which has at least 4096 bytes of
+space (see set_tformat_buffer_size), or more depending on the page size of the
+system. When the thread (or program) exits, the buffer is free'd.
+Since every thread has its own buffers, tformat needs no synchronization and
+strings returned by tformat in one thread are never overwritten by another
+thread. pthreads keep their buffers in thread_local storage, threads started
+with thread_start (see shl/thread.hpp) in their thread data slots.
 Because the buffer is a ring buffer, it will continuously write to the same
 buffer, then wrap back to the start, overwriting old formatted strings, hence
 the name tformat (temporary format).
 If you need the string for longer than the immediate use, copy the string.
 All tformatted strings are null terminated.
+
+get_tformat_buffer_size() returns the size of the tformat buffer of the current
+thread.
+set_tformat_buffer_size(MinSize) sets the minimum size of tformat buffers
+allocated from now on. Buffers of the current thread that are smaller are
+allocated again on their next use, invalidating all strings previously
+returned by tformat in the current thread.
 */
 
 #pragma once
@@ -227,6 +253,13 @@ s64 to_string(u32string *s, s16 x, s64 offset = 0, format_options<c32> opt = def
 s64 to_string(u32string *s, s32 x, s64 offset = 0, format_options<c32> opt = default_format_options<c32>, integer_format_options ioptions = default_integer_options);
 s64 to_string(u32string *s, s64 x, s64 offset = 0, format_options<c32> opt = default_format_options<c32>, integer_format_options ioptions = default_integer_options);
 
+// batch, writes all values in decimal separated by delimiter, e.g. 1,2,3.
+// The string overloads reserve the exact size once.
+s64 to_string(c8 *s, s64 ssize, const u64 *values, s64 count, const_string delimiter, s64 offset = 0);
+s64 to_string(c8 *s, s64 ssize, const s64 *values, s64 count, const_string delimiter, s64 offset = 0);
+s64 to_string(string *s, const array<u64> *values, const_string delimiter, s64 offset = 0);
+s64 to_string(string *s, const array<s64> *values, const_string delimiter, s64 offset = 0);
+
 // pointer
 s64 to_string(c8  *s, s64 ssize, const void *x, s64 offset = 0, format_options<c8>  opt = default_format_options<c8>);
 s64 to_string(c16 *s, s64 ssize, const void *x, s64 offset = 0, format_options<c16> opt = default_format_options<c16>);
@@ -236,16 +269,27 @@ s64 to_string(u16string *s, const void *x, s64 offset = 0, format_options<c16> o
 s64 to_string(u32string *s, const void *x, s64 offset = 0, format_options<c32> opt = default_format_options<c32>);
 
 // float
+// see shl/number_format.hpp for the forms
+enum class float_format_mode : u8
+{
+    fixed,      // 123.456000, precision digits after the decimal point
+    scientific, // 1.234560e+02, precision digits after the decimal point
+    shortest    // 123.456, shortest text that reads back as the same number,
+                // ignores precision
+};
+
 struct float_format_options
 {
     bool ignore_trailing_zeroes;    // if true, e.g. 0.1000 becomes 0.1
+    float_format_mode mode;
 };
 
 #define FLOAT_MAX_PRECISION 19
 
 inline constexpr float_format_options default_float_options = 
 {
-    .ignore_trailing_zeroes = true
+    .ignore_trailing_zeroes = true,
+    .mode = float_format_mode::fixed
 };
 
 s64 to_string(c8  *s, s64 ssize, float  x, s64 offset = 0, format_options<c8>  opt = default_format_options<c8>,    float_format_options foptions = default_float_options);
@@ -312,45 +356,29 @@ auto best_type_match(T &&arg)
         return best_type_match<T, Ts...>(forward<T>(arg));
 }
 
-// this is probably really bad for the stack but idk
-template<typename C, typename T, typename... Ts>
-s64 _format(s64 i, s64 written, C *s, s64 ssize, s64 offset, const_string_base<C> fmt, T &&arg, Ts &&...args)
+// formats arg into s at offset for the placeholder whose type character (if
+// any) is at fmt[*i] and advances *i past the type character.
+// Returns -1 if the type of arg does not match the placeholder.
+template<typename C, typename T>
+s64 _format_argument(s64 *i, const _placeholder_info<C> *pl, C *s, s64 ssize, s64 offset, const_string_base<C> fmt, T &&arg)
 {
-    if (i >= fmt.size || offset >= ssize)
-        return written;
-
-    _placeholder_info<C> pl;
-    pl.options = default_format_options<C>;
-    pl.has_placeholder = false;
-    pl.alternative = false;
-
-    s64 pl_written = _format_skip_until_placeholder(&i, &pl, s, ssize, offset, fmt);
-    written += pl_written;
-    offset += pl_written;
-
-    if (offset >= ssize)
-        return written;
-
-    s64 tostring_written = 0;
-
-    if (i < fmt.size)
+    if (*i < fmt.size)
     {
-        // skiped all non-placeholder characters and we're not at the end
-        C c = fmt[i];
+        C c = fmt[*i];
 
         switch (c)
         {
         case 'f':
         {
             float_format_options fopt = default_float_options;
-            fopt.ignore_trailing_zeroes = !pl.alternative;
+            fopt.ignore_trailing_zeroes = !pl->alternative;
 
             auto ptr = best_type_match<T, double, float>(forward<T>(arg));
 
             if constexpr (!is_same(decltype(ptr), void*))
             {
-                tostring_written = to_string(s, ssize, *ptr, offset, pl.options, fopt);
-                return _format(++i, written + tostring_written, s, ssize, offset + tostring_written, fmt, forward<Ts>(args)...);
+                *i += 1;
+                return to_string(s, ssize, *ptr, offset, pl->options, fopt);
             }
             else
                 return -1;
@@ -367,9 +395,9 @@ s64 _format(s64 i, s64 written, C *s, s64 ssize, s64 offset, const_string_base<C
 \
             if constexpr (!is_same(decltype(ptr), void*))\
             {\
-                iopt.include_prefix = pl.alternative && (*ptr != 0);\
-                tostring_written = to_string(s, ssize, *ptr, offset, pl.options, iopt);\
-                return _format(++i, written + tostring_written, s, ssize, offset + tostring_written, fmt, forward<Ts>(args)...);\
+                iopt.include_prefix = pl->alternative && (*ptr != 0);\
+                *i += 1;\
+                return to_string(s, ssize, *ptr, offset, pl->options, iopt);\
             }\
             else\
                 return -1;\
@@ -383,14 +411,39 @@ s64 _format(s64 i, s64 written, C *s, s64 ssize, s64 offset, const_string_base<C
         case 'd':
         case 'u':
         case 'p':
-            i++;
+            *i += 1;
             break;
         }
     }
-    else if (!pl.has_placeholder)
+
+    return to_string(s, ssize, forward<T>(arg), offset, pl->options);
+}
+
+// this is probably really bad for the stack but idk
+template<typename C, typename T, typename... Ts>
+s64 _format(s64 i, s64 written, C *s, s64 ssize, s64 offset, const_string_base<C> fmt, T &&arg, Ts &&...args)
+{
+    if (i >= fmt.size || offset >= ssize)
+        return written;
+
+    _placeholder_info<C> pl;
+    pl.options = default_format_options<C>;
+    pl.has_placeholder = false;
+    pl.alternative = false;
+
+    s64 pl_written = _format_skip_until_placeholder(&i, &pl, s, ssize, offset, fmt);
+    written += pl_written;
+    offset += pl_written;
+
+    // either at the end of fmt or s is full
+    if (!pl.has_placeholder || offset >= ssize)
         return written;
 
-    tostring_written = to_string(s, ssize, forward<T>(arg), offset, pl.options);
+    s64 tostring_written = _format_argument(&i, &pl, s, ssize, offset, fmt, forward<T>(arg));
+
+    if (tostring_written < 0)
+        return -1;
+
     return _format(i, written + tostring_written, s, ssize, offset + tostring_written, fmt, forward<Ts>(args)...);
 }
 
@@ -553,6 +606,173 @@ string_base<C> new_format(const_string_base<C> fmt, Ts &&...args)
     return _ret;
 }
 
+// chunked format
+#ifndef FORMAT_CHUNK_BUFFER_SIZE
+#define FORMAT_CHUNK_BUFFER_SIZE 4096
+#endif
+
+namespace internal
+{
+template<typename C>
+struct _format_chunks
+{
+    C *buffer;
+    s64 size;
+    s64 used;
+    s64 flushed;
+
+    // writes the used part of buffer, nullptr discards it (measuring)
+    bool (*flush)(_format_chunks<C> *chunks);
+    void *userdata;
+};
+
+template<typename C>
+bool _format_chunks_flush(_format_chunks<C> *chunks)
+{
+    if (chunks->used > 0 && chunks->flush != nullptr && !chunks->flush(chunks))
+        return false;
+
+    chunks->flushed += chunks->used;
+    chunks->used = 0;
+    return true;
+}
+
+template<typename C>
+s64 _format_chunked(_format_chunks<C> *chunks, s64 i, const_string_base<C> fmt);
+
+// copies the text before the next placeholder, flushing whenever the buffer
+// is full. Returns false if a flush failed.
+template<typename C>
+bool _format_chunked_text(_format_chunks<C> *chunks, s64 *i, _placeholder_info<C> *pl, const_string_base<C> fmt)
+{
+    while (true)
+    {
+        pl->options = default_format_options<C>;
+        pl->has_placeholder = false;
+        pl->alternative = false;
+
+        chunks->used += _format_skip_until_placeholder(i, pl, chunks->buffer, chunks->size, chunks->used, fmt);
+
+        if (pl->has_placeholder || *i >= fmt.size)
+            return true;
+
+        if (!_format_chunks_flush(chunks))
+            return false;
+    }
+}
+
+template<typename C, typename T>
+s64 _format_chunked_argument(_format_chunks<C> *chunks, s64 *i, const _placeholder_info<C> *pl, const_string_base<C> fmt, T &&arg)
+{
+    s64 start = *i;
+    s64 written = _format_argument(i, pl, chunks->buffer, chunks->size, chunks->used, fmt, forward<T>(arg));
+
+    if (written < 0)
+        return -1;
+
+    if (chunks->used + written < chunks->size)
+    {
+        chunks->used += written;
+        return written;
+    }
+
+    // may have been cut off, flush and format it again at the start
+    if (!_format_chunks_flush(chunks))
+        return -1;
+
+    *i = start;
+    written = _format_argument(i, pl, chunks->buffer, chunks->size, 0, fmt, forward<T>(arg));
+
+    if (written < 0 || written < chunks->size)
+    {
+        chunks->used = written < 0 ? 0 : written;
+        return written;
+    }
+
+    // larger than the whole buffer, format into a temporary buffer that's
+    // large enough and flush that.
+    C *buffer = chunks->buffer;
+    s64 size = chunks->size;
+    s64 tmp_size = size;
+    C *tmp = nullptr;
+
+    do
+    {
+        if (tmp != nullptr)
+            dealloc_T<C>(tmp, tmp_size);
+
+        tmp_size *= 2;
+        tmp = alloc<C>(tmp_size);
+
+        *i = start;
+        written = _format_argument(i, pl, tmp, tmp_size, 0, fmt, forward<T>(arg));
+    }
+    while (written >= tmp_size);
+
+    chunks->buffer = tmp;
+    chunks->size = tmp_size;
+    chunks->used = written;
+    bool ok = _format_chunks_flush(chunks);
+    chunks->buffer = buffer;
+    chunks->size = size;
+
+    dealloc_T<C>(tmp, tmp_size);
+
+    return ok ? written : -1;
+}
+
+template<typename C, typename T, typename... Ts>
+s64 _format_chunked(_format_chunks<C> *chunks, s64 i, const_string_base<C> fmt, T &&arg, Ts &&...args)
+{
+    _placeholder_info<C> pl;
+
+    if (!_format_chunked_text(chunks, &i, &pl, fmt))
+        return -1;
+
+    if (!pl.has_placeholder)
+        return chunks->flushed + chunks->used;
+
+    if (_format_chunked_argument(chunks, &i, &pl, fmt, forward<T>(arg)) < 0)
+        return -1;
+
+    return _format_chunked(chunks, i, fmt, forward<Ts>(args)...);
+}
+
+template<typename C>
+s64 _format_chunked(_format_chunks<C> *chunks, s64 i, const_string_base<C> fmt)
+{
+    _placeholder_info<C> pl;
+
+    if (!_format_chunked_text(chunks, &i, &pl, fmt))
+        return -1;
+
+    // more placeholders than arguments
+    if (pl.has_placeholder)
+        return -1;
+
+    return chunks->flushed + chunks->used;
+}
+}
+
+// format_size
+template<typename C, typename... Ts>
+s64 format_size(const_string_base<C> fmt, Ts &&...args)
+{
+    C buffer[FORMAT_CHUNK_BUFFER_SIZE / sizeof(C)];
+
+    internal::_format_chunks<C> chunks{};
+    chunks.buffer = buffer;
+    chunks.size = FORMAT_CHUNK_BUFFER_SIZE / sizeof(C);
+
+    return internal::_format_chunked(&chunks, 0, fmt, forward<Ts>(args)...);
+}
+
+template<typename C, typename... Ts>
+s64 format_size(const C *fmt, Ts &&...args)
+{
+    return format_size(to_const_string(fmt), forward<Ts>(args)...);
+}
+
 // tformat
 namespace internal
 {
@@ -638,3 +858,7 @@ const_string_base<C> tformat(const C *fmt, Ts &&...args)
 }
 
 s64 get_tformat_buffer_size();
+void set_tformat_buffer_size(s64 min_size);
+
+// compile-time parsed format strings, "..."_fmt
+#include "shl/format_literal.hpp"
@@ -0,0 +1,495 @@
+#pragma once
+
+/* format_literal.hpp
+
+Format strings that are parsed at compile time.
+
+format() and tformat() (see shl/format.hpp) look for placeholders and parse
+their options every time they are called. When the format string is a
+literal, which it almost always is, this can instead be done once by the
+compiler: "..."_fmt (or fmt_literal<"...">{}) is an empty object whose type
+carries the format string, and the format, tformat, new_format and tprint
+overloads for it format using the placeholders, options and literal text
+(with escapes already resolved) that were parsed at compile time.
+Literal text is copied in segments of fixed size, and every argument is
+passed directly to the to_string overload of its placeholder.
+
+Format strings use the same syntax and produce the same output as the
+runtime format functions, with the exception that the number of arguments
+must match the number of placeholders, and typed placeholders (%f, %x, ...)
+must match the type of their argument, both of which are checked at
+compile time.
+
+Example:
+
+    string str{};
+    format(&str, "[%] % took %.3fms\n"_fmt, level, name, ms);
+
+    const_string s = tformat("% %"_fmt, "hello", 123);
+    tprint(u"%\n"_fmt, u"world");
+
+    // compile error: the format string has 2 placeholders, but 3 arguments
+    // are given.
+    tformat("% %"_fmt, 1, 2, 3);
+
+Types:
+
+fmt_literal<Str>    the type of Str"_fmt", Str is any string literal of c8,
+                    c16 or c32.
+
+Functions:
+
+format(*s, ssize[, offset], Fmt, ...)   formats into the buffer s of size ssize.
+format(*str[, offset], Fmt, ...)        formats into the string str.
+new_format(Fmt, ...)                    returns a new formatted string.
+tformat(Fmt, ...)                       formats into the tformat buffer.
+    All of these behave like their runtime counterparts in shl/format.hpp.
+
+format_literal_placeholder_count(Fmt)   returns the number of placeholders of
+                                        Fmt, at compile time.
+*/
+
+#include "shl/format.hpp"
+
+template<typename C, s64 N>
+struct format_string_literal
+{
+    C data[N];
+
+    constexpr format_string_literal(const C (&str)[N])
+    {
+        for (s64 i = 0; i < N; ++i)
+            data[i] = str[i];
+    }
+};
+
+template<format_string_literal Fmt>
+struct fmt_literal {};
+
+template<format_string_literal Fmt>
+constexpr fmt_literal<Fmt> operator ""_fmt()
+{
+    return fmt_literal<Fmt>{};
+}
+
+namespace internal
+{
+template<typename T>
+struct _format_string_literal_traits;
+
+template<typename C, s64 N>
+struct _format_string_literal_traits<format_string_literal<C, N>>
+{
+    using char_type = C;
+    static constexpr s64 size = N - 1;
+};
+
+template<typename C>
+struct _fmt_segment
+{
+    s64 text_start;         // literal text before the placeholder
+    s64 text_size;
+    bool has_placeholder;   // false for the last segment
+    bool alternative;       // #
+    C type;                 // f, b, B, o, O, x or X, or 0 for any type
+    format_options<C> options;
+};
+
+template<typename C>
+constexpr _fmt_segment<C> _fmt_empty_segment(s64 text_start)
+{
+    return _fmt_segment<C>{
+        .text_start = text_start,
+        .text_size = 0,
+        .has_placeholder = false,
+        .alternative = false,
+        .type = (C)0,
+        .options = default_format_options<C>
+    };
+}
+
+// parses fmt like _format_skip_until_placeholder in format.cpp does.
+// if text and segments are nullptr, only counts the text units and segments.
+template<typename C>
+constexpr void _fmt_parse(const C *fmt, s64 size, C *text, s64 *text_size, _fmt_segment<C> *segments, s64 *segment_count)
+{
+    s64 i = 0;
+    s64 t = 0;
+    s64 seg = 0;
+    _fmt_segment<C> cur = _fmt_empty_segment<C>(0);
+
+    auto emit = [&](C c)
+    {
+        if (text != nullptr)
+            text[t] = c;
+
+        t++;
+    };
+
+    while (i < size)
+    {
+        C c = fmt[i];
+
+        if (c == '\\')
+        {
+            i++;
+
+            if (i >= size)
+            {
+                emit('\\');
+                break;
+            }
+
+            if (fmt[i] != '%')
+                emit('\\');
+
+            emit(fmt[i]);
+            i++;
+            continue;
+        }
+
+        if (c != '%')
+        {
+            emit(c);
+            i++;
+            continue;
+        }
+
+        // %
+        cur.text_size = t - cur.text_start;
+        cur.has_placeholder = true;
+
+        s64 j = i + 1;
+
+        if (j < size && fmt[j] == '#')
+        {
+            cur.alternative = true;
+            j++;
+        }
+
+        if (j < size && (fmt[j] == '-' || fmt[j] == '+'))
+        {
+            cur.options.sign = fmt[j];
+            j++;
+        }
+
+        if (j < size && fmt[j] == '0')
+            cur.options.pad_char = '0';
+
+        while (j < size && fmt[j] >= '0' && fmt[j] <= '9')
+        {
+            cur.options.pad_length = (cur.options.pad_length * 10) + (fmt[j] - '0');
+            j++;
+        }
+
+        if (cur.options.sign == '-')
+            cur.options.pad_length = -cur.options.pad_length;
+
+        if (j < size && fmt[j] == '.')
+        {
+            j++;
+
+            if (j < size && fmt[j] >= '0' && fmt[j] <= '9')
+                cur.options.precision = 0;
+
+            while (j < size && fmt[j] >= '0' && fmt[j] <= '9')
+            {
+                cur.options.precision = (cur.options.precision * 10) + (fmt[j] - '0');
+                j++;
+            }
+        }
+
+        if (j < size)
+        {
+            switch (fmt[j])
+            {
+            case 'f':
+            case 'b': case 'B':
+            case 'o': case 'O':
+            case 'x': case 'X':
+                cur.type = fmt[j];
+                j++;
+                break;
+            case 'c':
+            case 's':
+            case 'd':
+            case 'u':
+            case 'p':
+                j++;
+                break;
+            }
+        }
+
+        if (segments != nullptr)
+            segments[seg] = cur;
+
+        seg++;
+        cur = _fmt_empty_segment<C>(t);
+        i = j;
+    }
+
+    cur.text_size = t - cur.text_start;
+
+    if (segments != nullptr)
+        segments[seg] = cur;
+
+    seg++;
+
+    *text_size = t;
+    *segment_count = seg;
+}
+
+template<typename C, s64 TextSize, s64 SegmentCount>
+struct _fmt_parsed
+{
+    C text[TextSize + 1];
+    _fmt_segment<C> segments[SegmentCount];
+};
+
+template<format_string_literal Fmt>
+struct _fmt_compiled
+{
+    using traits = _format_string_literal_traits<typename remove_const(decltype(Fmt))>;
+    using char_type = typename traits::char_type;
+
+    static constexpr s64 _count(bool segments)
+    {
+        s64 text_size = 0;
+        s64 segment_count = 0;
+        _fmt_parse<char_type>(Fmt.data, traits::size, nullptr, &text_size, nullptr, &segment_count);
+
+        return segments ? segment_count : text_size;
+    }
+
+    static constexpr s64 text_size = _count(false);
+    static constexpr s64 segment_count = _count(true);
+    static constexpr s64 placeholder_count = segment_count - 1;
+
+    static constexpr _fmt_parsed<char_type, text_size, segment_count> _parse()
+    {
+        _fmt_parsed<char_type, text_size, segment_count> ret{};
+        s64 tsize = 0;
+        s64 scount = 0;
+        _fmt_parse<char_type>(Fmt.data, traits::size, ret.text, &tsize, ret.segments, &scount);
+
+        return ret;
+    }
+
+    static constexpr _fmt_parsed<char_type, text_size, segment_count> parsed = _parse();
+};
+
+// writes Size units of text, or as many as fit into s
+template<s64 Size, typename C>
+inline s64 _fmt_write_text(C *s, s64 ssize, s64 offset, const C *text)
+{
+    s64 count = Size;
+
+    if (offset + Size > ssize)
+        count = ssize - offset;
+
+    // the loop with a constant count compiles to a few moves
+    if (count == Size)
+        for (s64 i = 0; i < Size; ++i)
+            s[offset + i] = text[i];
+    else
+        for (s64 i = 0; i < count; ++i)
+            s[offset + i] = text[i];
+
+    return count;
+}
+
+template<s64 Size, typename C>
+inline s64 _fmt_write_text(string_base<C> *s, s64, s64 offset, const C *text)
+{
+    string_reserve(s, offset + Size);
+
+    for (s64 i = 0; i < Size; ++i)
+        s->data[offset + i] = text[i];
+
+    return Size;
+}
+
+template<typename C, typename T, typename... Opts>
+inline s64 _fmt_write_value(C *s, s64 ssize, s64 offset, T &&x, Opts... opts)
+{
+    return to_string(s, ssize, forward<T>(x), offset, opts...);
+}
+
+template<typename C, typename T, typename... Opts>
+inline s64 _fmt_write_value(string_base<C> *s, s64, s64 offset, T &&x, Opts... opts)
+{
+    return to_string(s, forward<T>(x), offset, opts...);
+}
+
+// the last segment, only text
+template<format_string_literal Fmt, s64 Seg, typename Out>
+inline s64 _format_literal(Out s, s64 ssize, s64 offset)
+{
+    using P = _fmt_compiled<Fmt>;
+    constexpr _fmt_segment<typename P::char_type> seg = P::parsed.segments[Seg];
+
+    static_assert(!seg.has_placeholder);
+
+    if constexpr (seg.text_size > 0)
+    {
+        if (offset >= ssize)
+            return 0;
+
+        return _fmt_write_text<seg.text_size>(s, ssize, offset, P::parsed.text + seg.text_start);
+    }
+    else
+        return 0;
+}
+
+template<format_string_literal Fmt, s64 Seg, typename Out, typename T, typename... Ts>
+inline s64 _format_literal(Out s, s64 ssize, s64 offset, T &&arg, Ts &&...args)
+{
+    using P = _fmt_compiled<Fmt>;
+    constexpr _fmt_segment<typename P::char_type> seg = P::parsed.segments[Seg];
+
+    static_assert(seg.has_placeholder);
+
+    s64 written = 0;
+
+    if (offset >= ssize)
+        return 0;
+
+    if constexpr (seg.text_size > 0)
+    {
+        written = _fmt_write_text<seg.text_size>(s, ssize, offset, P::parsed.text + seg.text_start);
+        offset += written;
+
+        if (offset >= ssize)
+            return written;
+    }
+
+    s64 value_written = 0;
+
+    if constexpr (seg.type == 'f')
+    {
+        float_format_options fopt = default_float_options;
+        fopt.ignore_trailing_zeroes = !seg.alternative;
+
+        auto ptr = best_type_match<T, double, float>(forward<T>(arg));
+        static_assert(!is_same(decltype(ptr), void*), "argument of %f placeholder is not a floating point number");
+
+        value_written = _fmt_write_value(s, ssize, offset, *ptr, seg.options, fopt);
+    }
+    else if constexpr (seg.type != 0)
+    {
+        integer_format_options iopt = default_integer_options;
+        iopt.base = (seg.type == 'b' || seg.type == 'B') ? 2 : (seg.type == 'o' || seg.type == 'O') ? 8 : 16;
+        iopt.caps_letters = (seg.type == 'B' || seg.type == 'O' || seg.type == 'X');
+
+        auto ptr = best_type_match<T, u64, u32, u16, u8>(forward<T>(arg));
+        static_assert(!is_same(decltype(ptr), void*), "argument of %b, %o or %x placeholder is not an integer");
+
+        iopt.include_prefix = seg.alternative && (*ptr != 0);
+        value_written = _fmt_write_value(s, ssize, offset, *ptr, seg.options, iopt);
+    }
+    else
+        value_written = _fmt_write_value(s, ssize, offset, forward<T>(arg), seg.options);
+
+    return written + value_written + _format_literal<Fmt, Seg + 1>(s, ssize, offset + value_written, forward<Ts>(args)...);
+}
+
+template<format_string_literal Fmt, typename... Ts>
+constexpr void _format_literal_check_arguments()
+{
+    static_assert(_fmt_compiled<Fmt>::placeholder_count == sizeof...(Ts),
+                  "number of format arguments does not match the number of placeholders in the format string");
+}
+}
+
+template<format_string_literal Fmt>
+constexpr s64 format_literal_placeholder_count(fmt_literal<Fmt>)
+{
+    return internal::_fmt_compiled<Fmt>::placeholder_count;
+}
+
+// c string format
+template<typename C, format_string_literal Fmt, typename... Ts>
+s64 format(C *s, s64 ssize, s64 offset, fmt_literal<Fmt>, Ts &&...args)
+{
+    static_assert(is_same(C, typename internal::_fmt_compiled<Fmt>::char_type), "format string and output have different character types");
+    internal::_format_literal_check_arguments<Fmt, Ts...>();
+
+    return internal::_format_literal<Fmt, 0>(s, ssize, offset, forward<Ts>(args)...);
+}
+
+template<typename C, format_string_literal Fmt, typename... Ts>
+s64 format(C *s, s64 ssize, fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    return format(s, ssize, 0, fmt, forward<Ts>(args)...);
+}
+
+// string format
+template<typename C, format_string_literal Fmt, typename... Ts>
+s64 format(string_base<C> *s, s64 offset, fmt_literal<Fmt>, Ts &&...args)
+{
+    static_assert(is_same(C, typename internal::_fmt_compiled<Fmt>::char_type), "format string and output have different character types");
+    internal::_format_literal_check_arguments<Fmt, Ts...>();
+
+    // strings grow while formatting, so the bound only keeps the size and
+    // the terminator addressable.
+    constexpr s64 max_size = max_value(s64) / (s64)sizeof(C) - 1;
+
+    string_reserve(s, offset + internal::_fmt_compiled<Fmt>::text_size);
+    s64 written = internal::_format_literal<Fmt, 0>(s, max_size, offset, forward<Ts>(args)...);
+
+    if (written < 0)
+        return -1;
+
+    s64 size = offset + written;
+
+    if (size > s->size)
+    {
+        string_reserve(s, size);
+        assert(size < s->reserved_size);
+
+        s->size = size;
+        s->data[size] = '\0';
+    }
+
+    return written;
+}
+
+template<typename C, format_string_literal Fmt, typename... Ts>
+s64 format(string_base<C> *s, fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    return format(s, 0, fmt, forward<Ts>(args)...);
+}
+
+template<format_string_literal Fmt, typename... Ts>
+auto new_format(fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    string_base<typename internal::_fmt_compiled<Fmt>::char_type> _ret{};
+    format(&_ret, 0, fmt, forward<Ts>(args)...);
+
+    return _ret;
+}
+
+template<format_string_literal Fmt, typename... Ts>
+auto tformat(fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    using C = typename internal::_fmt_compiled<Fmt>::char_type;
+
+    internal::tformat_buffer *buf = internal::_get_tformat_buffer<C>();
+
+    if (buf == nullptr)
+        return const_string_base<C>{nullptr, 0};
+
+    C *data = internal::_buffer_data<C>(buf);
+    s64 size = internal::_buffer_unit_count<C>(buf);
+    s64 offset = internal::_buffer_offset<C>(buf);
+
+    s64 written = format(data + offset, size, 0, fmt, forward<Ts>(args)...);
+
+    data[offset + written] = '\0';
+
+    const_string_base<C> ret{data + offset, written};
+
+    internal::_buffer_advance<C>(buf, written + 1);
+
+    return ret;
+}
@@ -32,3 +32,12 @@ sys_int munmap(void *address, sys_int length)
                                    address,
                                    (void*)length);
 }
+
+void *mremap(void *old_address, sys_int old_length, sys_int new_length, sys_int flags)
+{
+    return linux_syscall4(SYS_mremap,
+                          old_address,
+                          (void*)old_length,
+                          (void*)new_length,
+                          (void*)flags);
+}
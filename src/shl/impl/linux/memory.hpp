@@ -15,6 +15,9 @@ void *mmap(void *address, sys_int length, sys_int protection, sys_int flags, int
 
 sys_int munmap(void *address, sys_int length);
 
+// returns the new address of the mapping, check the result with MMAP_IS_ERROR.
+void *mremap(void *old_address, sys_int old_length, sys_int new_length, sys_int flags);
+
 #ifndef PROT_READ
 #  define PROT_NONE       0x0
 #  define PROT_READ       0x1
@@ -39,3 +42,9 @@ sys_int munmap(void *address, sys_int length);
 #  define MAP_HUGETLB       0x40000
 #  define MAP_SYNC          0x80000
 #endif
+
+#ifndef MREMAP_MAYMOVE
+#  define MREMAP_MAYMOVE    0x1
+#  define MREMAP_FIXED      0x2
+#  define MREMAP_DONTUNMAP  0x4
+#endif
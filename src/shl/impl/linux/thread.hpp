@@ -94,6 +94,8 @@ struct __attribute((aligned(16))) thread_stack_head
     s32 state;
 
     ::clone_args clone_args;
+
+    void *data_slots; // used by thread_create / thread_start, see shl/thread.hpp
 };
 
 thread_stack_head *get_thread_stack_head(void *stack, s64 size, s64 extra_size = 0);
@@ -1,6 +1,7 @@
 
 #include "shl/string.hpp"
 #include "shl/memory.hpp"
+#include "shl/compare.hpp"
 #include "shl/io.hpp"
 
 #if Linux
@@ -337,6 +338,67 @@ s64 io_write(io_handle h, const char *buf, u64 size, error *err)
     return ret;
 }
 
+// most systems do not accept more buffers in a single writev
+#define IO_MAX_GATHER_BUFFERS 1024
+
+#if !Windows
+// io_write_gather passes the buffers to writev as they are
+static_assert(sizeof(io_write_buffer) == sizeof(vec_buf));
+static_assert(offset_of(io_write_buffer, data) == offset_of(vec_buf, data));
+static_assert(offset_of(io_write_buffer, size) == offset_of(vec_buf, size));
+static_assert(sizeof(((io_write_buffer*)nullptr)->size) == sizeof(((vec_buf*)nullptr)->size));
+#endif
+
+s64 io_write_gather(io_handle h, const io_write_buffer *buffers, s64 buffer_count, error *err)
+{
+    s64 ret = 0;
+
+#if Windows
+    for (s64 i = 0; i < buffer_count; ++i)
+    {
+        s64 written = io_write(h, (const char*)buffers[i].data, (u64)buffers[i].size, err);
+
+        if (written < 0)
+            return ret > 0 ? ret : -1;
+
+        ret += written;
+
+        if (written < buffers[i].size)
+            break;
+    }
+#else
+    while (buffer_count > 0)
+    {
+        s64 count = Min(buffer_count, (s64)IO_MAX_GATHER_BUFFERS);
+        s64 expected = 0;
+
+        for (s64 i = 0; i < count; ++i)
+            expected += buffers[i].size;
+
+        s64 written = writev(h, (vec_buf*)buffers, count);
+
+        if (written < 0)
+        {
+            if (ret > 0)
+                return ret;
+
+            set_error_by_code(err, -written);
+            return -1;
+        }
+
+        ret += written;
+
+        if (written < expected)
+            break;
+
+        buffers += count;
+        buffer_count -= count;
+    }
+#endif
+
+    return ret;
+}
+
 s64 io_seek(io_handle h, s64 offset, int whence, error *err)
 {
     s64 ret = 0;
@@ -26,6 +26,12 @@ io_read(h, *buffer, max_read_size[, *err])  reads up to max_read_size bytes from
 io_write(h, *buffer, write_size[, *err])    writes up to write_size bytes from the
     buffer into the handle. Returns number of bytes written, or -1 on error.
 
+io_write_gather(h, *buffers, buffer_count[, *err])  writes the buffer_count
+    io_write_buffers one after another into the handle with a single call
+    (writev) where possible. Like io_write, may write fewer bytes than the
+    total size of the buffers. Returns number of bytes written, or -1 on error.
+    WINDOWS: writes every buffer with a separate call.
+
 io_seek(h, offset, [whence[, *err]])    offsets the handle position by the offset,
     depending on whence. whence may be one of IO_SEEK_SET, IO_SEEK_CUR or IO_SEEK_END.
     Returns the new position, or -1 on error.
@@ -134,6 +140,15 @@ bool io_close(io_handle h, error *err = nullptr);
 
 s64 io_read(io_handle h, char *buf, u64 size, error *err = nullptr);
 s64 io_write(io_handle h, const char *buf, u64 size, error *err = nullptr);
+
+// same layout as struct iovec on Linux
+struct io_write_buffer
+{
+    const void *data;
+    s64 size;
+};
+
+s64 io_write_gather(io_handle h, const io_write_buffer *buffers, s64 buffer_count, error *err = nullptr);
 s64 io_seek(io_handle h, s64 offset, int whence = IO_SEEK_SET, error *err = nullptr);
 s64 io_tell(io_handle h, error *err = nullptr);
 
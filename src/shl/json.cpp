@@ -0,0 +1,925 @@
+
+#include "shl/assert.hpp"
+#include "shl/bits.hpp"
+#include "shl/memory.hpp"
+#include "shl/simd.hpp"
+#include "shl/number_format.hpp"
+#include "shl/string_encoding.hpp"
+#include "shl/string_search.hpp"
+#include "shl/program_context.hpp"
+#include "shl/json.hpp"
+
+// returns the index of the first quote, backslash or control character in
+// s[0, size[, or size if there is none.
+static s64 _json_scan_string(const c8 *s, s64 size)
+{
+    s64 i = 0;
+
+#if Simd != SIMD_NONE
+    const simd_vec quote = simd_broadcast((c8)'"');
+    const simd_vec backslash = simd_broadcast((c8)'\\');
+    // unsigned x < 0x20 as signed comparison: (x ^ 0x80) < (0x20 ^ 0x80)
+    const simd_vec flip = simd_broadcast((u8)0x80);
+    const simd_vec control_limit = simd_broadcast((u8)(0x20 ^ 0x80));
+
+    for (; i + 16 <= size; i += 16)
+    {
+        simd_vec v = simd_load(s + i);
+        simd_vec special = simd_or(simd_or(simd_equal<c8>(v, quote), simd_equal<c8>(v, backslash)),
+                                   simd_greater_s8(control_limit, simd_xor(v, flip)));
+        u64 mask = simd_mask(special);
+
+        if (mask != 0)
+            return i + (s64)(ctz64(mask) / simd_mask_bits_per_byte);
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        u8 c = (u8)s[i];
+
+        if (c == '"' || c == '\\' || c < 0x20)
+            return i;
+    }
+
+    return size;
+}
+
+// writer
+static void _json_write_output(json_writer *w, const c8 *data, s64 size)
+{
+    if (size <= 0 || w->failed)
+        return;
+
+    s64 written = 0;
+
+    switch (w->output_type)
+    {
+    case json_output::memory_stream:
+        written = write((memory_stream*)w->output, data, size);
+        break;
+    case json_output::file_stream:
+        written = write((file_stream*)w->output, data, size);
+        break;
+    case json_output::io_handle:
+        while (written < size)
+        {
+            s64 ret = io_write(w->handle, data + written, size - written);
+
+            if (ret <= 0)
+                break;
+
+            written += ret;
+        }
+        break;
+    case json_output::string:
+        string_append((string*)w->output, const_string{data, size});
+        written = size;
+        break;
+    }
+
+    if (written != size)
+        w->failed = true;
+}
+
+static void _json_flush_buffer(json_writer *w)
+{
+    _json_write_output(w, w->buffer, w->size);
+    w->size = 0;
+}
+
+static inline void _json_put(json_writer *w, const c8 *data, s64 size)
+{
+    if (w->size + size > json_writer_buffer_size)
+    {
+        _json_flush_buffer(w);
+
+        if (size > json_writer_buffer_size)
+        {
+            _json_write_output(w, data, size);
+            return;
+        }
+    }
+
+    copy_memory(data, w->buffer + w->size, size);
+    w->size += size;
+}
+
+static inline void _json_put(json_writer *w, c8 c)
+{
+    if (w->size >= json_writer_buffer_size)
+        _json_flush_buffer(w);
+
+    w->buffer[w->size++] = c;
+}
+
+// returns space for at least size units in the buffer
+static inline c8 *_json_reserve(json_writer *w, s64 size)
+{
+    assert(size <= json_writer_buffer_size);
+
+    if (w->size + size > json_writer_buffer_size)
+        _json_flush_buffer(w);
+
+    return w->buffer + w->size;
+}
+
+static inline bool _json_bit(const u64 *bits, s32 index)
+{
+    return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+static inline void _json_set_bit(u64 *bits, s32 index, bool value)
+{
+    u64 bit = (u64)1 << (index % 64);
+
+    if (value)
+        bits[index / 64] |= bit;
+    else
+        bits[index / 64] &= ~bit;
+}
+
+// writes the comma before a value, if any
+static void _json_before_value(json_writer *w)
+{
+    if (w->after_key)
+    {
+        w->after_key = false;
+        return;
+    }
+
+    if (w->depth == 0)
+        return;
+
+    assert(!_json_bit(w->is_object, w->depth - 1) && "values in objects need a key");
+
+    if (_json_bit(w->has_elements, w->depth - 1))
+        _json_put(w, ',');
+    else
+        _json_set_bit(w->has_elements, w->depth - 1, true);
+}
+
+static void _json_after_value(json_writer *w)
+{
+    if (w->depth == 0)
+        _json_put(w, '\n');
+}
+
+static void _json_write_escaped(json_writer *w, const c8 *s, s64 size)
+{
+    static const c8 hex[] = "0123456789abcdef";
+
+    _json_put(w, '"');
+
+    while (size > 0)
+    {
+        s64 i = _json_scan_string(s, size);
+        _json_put(w, s, i);
+
+        if (i == size)
+            break;
+
+        c8 c = s[i];
+        c8 esc[6] = {'\\', 0, '0', '0', 0, 0};
+        s64 esc_size = 2;
+
+        switch (c)
+        {
+        case '"':  esc[1] = '"';  break;
+        case '\\': esc[1] = '\\'; break;
+        case '\n': esc[1] = 'n';  break;
+        case '\r': esc[1] = 'r';  break;
+        case '\t': esc[1] = 't';  break;
+        case '\b': esc[1] = 'b';  break;
+        case '\f': esc[1] = 'f';  break;
+        default:
+            esc[1] = 'u';
+            esc[4] = hex[((u8)c >> 4) & 0xf];
+            esc[5] = hex[(u8)c & 0xf];
+            esc_size = 6;
+            break;
+        }
+
+        _json_put(w, esc, esc_size);
+        s += i + 1;
+        size -= i + 1;
+    }
+
+    _json_put(w, '"');
+}
+
+static void _json_init(json_writer *w, json_output type, void *output)
+{
+    assert(w != nullptr);
+
+    fill_memory(w, 0);
+    w->output_type = type;
+    w->output = output;
+    w->allocator = get_context_pointer()->allocator;
+    w->buffer = (c8*)allocator_alloc(w->allocator, json_writer_buffer_size);
+}
+
+void init(json_writer *w, memory_stream *out)
+{
+    _json_init(w, json_output::memory_stream, out);
+}
+
+void init(json_writer *w, file_stream *out)
+{
+    _json_init(w, json_output::file_stream, out);
+}
+
+void init(json_writer *w, io_handle out)
+{
+    _json_init(w, json_output::io_handle, nullptr);
+    w->handle = out;
+}
+
+void init(json_writer *w, string *out)
+{
+    _json_init(w, json_output::string, out);
+}
+
+void free(json_writer *w)
+{
+    assert(w != nullptr);
+
+    if (w->buffer == nullptr)
+        return;
+
+    _json_flush_buffer(w);
+    allocator_dealloc(w->allocator, w->buffer, json_writer_buffer_size);
+    w->buffer = nullptr;
+}
+
+bool json_flush(json_writer *w, error *err)
+{
+    assert(w != nullptr);
+
+    _json_flush_buffer(w);
+
+    if (w->failed)
+    {
+        set_error(err, 5 /* eio */, "Could not write JSON output");
+        return false;
+    }
+
+    return true;
+}
+
+static void _json_begin(json_writer *w, bool object)
+{
+    assert(w->depth < JSON_MAX_DEPTH);
+
+    _json_before_value(w);
+    _json_put(w, object ? '{' : '[');
+    _json_set_bit(w->is_object, w->depth, object);
+    _json_set_bit(w->has_elements, w->depth, false);
+    w->depth++;
+}
+
+static void _json_end(json_writer *w, bool object)
+{
+    assert(w->depth > 0);
+    assert(_json_bit(w->is_object, w->depth - 1) == object);
+    assert(!w->after_key && "key without value");
+
+    w->depth--;
+    _json_put(w, object ? '}' : ']');
+    _json_after_value(w);
+}
+
+void json_begin_object(json_writer *w)
+{
+    _json_begin(w, true);
+}
+
+void json_end_object(json_writer *w)
+{
+    _json_end(w, true);
+}
+
+void json_begin_array(json_writer *w)
+{
+    _json_begin(w, false);
+}
+
+void json_end_array(json_writer *w)
+{
+    _json_end(w, false);
+}
+
+void json_key(json_writer *w, const_string key)
+{
+    assert(w->depth > 0 && _json_bit(w->is_object, w->depth - 1));
+    assert(!w->after_key);
+
+    if (_json_bit(w->has_elements, w->depth - 1))
+        _json_put(w, ',');
+    else
+        _json_set_bit(w->has_elements, w->depth - 1, true);
+
+    _json_write_escaped(w, key.c_str, key.size);
+    _json_put(w, ':');
+    w->after_key = true;
+}
+
+void json_key(json_writer *w, const c8 *key)
+{
+    json_key(w, to_const_string(key));
+}
+
+void json_value(json_writer *w, const_string x)
+{
+    _json_before_value(w);
+    _json_write_escaped(w, x.c_str, x.size);
+    _json_after_value(w);
+}
+
+void json_value(json_writer *w, const c8 *x)
+{
+    if (x == nullptr)
+        json_null(w);
+    else
+        json_value(w, to_const_string(x));
+}
+
+void json_value(json_writer *w, const string *x)
+{
+    json_value(w, to_const_string(x));
+}
+
+static void _json_write_literal(json_writer *w, const_string literal)
+{
+    _json_before_value(w);
+    _json_put(w, literal.c_str, literal.size);
+    _json_after_value(w);
+}
+
+void json_value(json_writer *w, bool x)
+{
+    _json_write_literal(w, x ? "true"_cs : "false"_cs);
+}
+
+static void _json_write_integer(json_writer *w, u64 magnitude, bool negative)
+{
+    _json_before_value(w);
+
+    c8 *out = _json_reserve(w, INTEGER_DIGITS_BUFFER_SIZE + 1);
+    s64 n = 0;
+
+    if (negative)
+        out[n++] = '-';
+
+    n += write_integer_decimal(out + n, magnitude);
+    w->size += n;
+
+    _json_after_value(w);
+}
+
+void json_value(json_writer *w, s32 x)
+{
+    json_value(w, (s64)x);
+}
+
+void json_value(json_writer *w, u32 x)
+{
+    json_value(w, (u64)x);
+}
+
+void json_value(json_writer *w, s64 x)
+{
+    _json_write_integer(w, x < 0 ? (u64)0 - (u64)x : (u64)x, x < 0);
+}
+
+void json_value(json_writer *w, u64 x)
+{
+    _json_write_integer(w, x, false);
+}
+
+template<typename T>
+static void _json_write_float(json_writer *w, T x)
+{
+    // NaN is the only value not equal to itself, x - x is NaN for infinities
+    if (x != x || (x - x) != (x - x))
+    {
+        json_null(w);
+        return;
+    }
+
+    _json_before_value(w);
+
+    c8 *out = _json_reserve(w, FLOAT_DECIMAL_BUFFER_SIZE + 1);
+    s64 n = 0;
+
+    if (x < 0)
+        out[n++] = '-';
+
+    n += write_float_shortest(out + n, x);
+    w->size += n;
+
+    _json_after_value(w);
+}
+
+void json_value(json_writer *w, float x)
+{
+    _json_write_float(w, x);
+}
+
+void json_value(json_writer *w, double x)
+{
+    _json_write_float(w, x);
+}
+
+void json_value(json_writer *w, decltype(nullptr))
+{
+    json_null(w);
+}
+
+void json_null(json_writer *w)
+{
+    _json_write_literal(w, "null"_cs);
+}
+
+// reader
+enum _json_state : u8
+{
+    _json_expect_value,
+    _json_expect_first_value_or_end,    // after [
+    _json_expect_first_key_or_end,      // after {
+    _json_expect_comma_or_end           // after values in containers
+};
+
+void init(json_reader *r, const_string data)
+{
+    assert(r != nullptr);
+
+    fill_memory(r, 0);
+    r->data = data.c_str;
+    r->size = data.size;
+    r->state = _json_expect_value;
+}
+
+static bool _json_error(json_reader *r, const c8 *message)
+{
+    r->token = json_token::error;
+    r->error_message = message;
+    r->error_position = r->position;
+    r->text = const_string{nullptr, 0};
+    return false;
+}
+
+static inline bool _json_is_space(c8 c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline void _json_skip_space(json_reader *r)
+{
+    while (r->position < r->size && _json_is_space(r->data[r->position]))
+        r->position++;
+}
+
+// numbers and literals must be followed by one of these
+static inline bool _json_is_delimiter(const json_reader *r, s64 position)
+{
+    if (position >= r->size)
+        return true;
+
+    c8 c = r->data[position];
+    return _json_is_space(c) || c == ',' || c == ']' || c == '}';
+}
+
+static inline bool _json_is_digit(c8 c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline s64 _json_skip_digits(const c8 *s, s64 i, s64 size)
+{
+    while (i < size && _json_is_digit(s[i]))
+        ++i;
+
+    return i;
+}
+
+static inline bool _json_is_hex(c8 c)
+{
+    return _json_is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// reads the string starting at the quote at r->position into r->text
+static bool _json_read_string(json_reader *r)
+{
+    const c8 *s = r->data;
+    s64 start = r->position + 1;
+    s64 i = start;
+    r->escaped = false;
+
+    while (true)
+    {
+        i += _json_scan_string(s + i, r->size - i);
+
+        if (i >= r->size)
+        {
+            r->position = r->size;
+            return _json_error(r, "Unterminated string");
+        }
+
+        c8 c = s[i];
+
+        if (c == '"')
+            break;
+
+        if (c != '\\')
+        {
+            r->position = i;
+            return _json_error(r, "Control character in string");
+        }
+
+        r->escaped = true;
+
+        if (i + 1 >= r->size)
+        {
+            r->position = i;
+            return _json_error(r, "Unterminated string");
+        }
+
+        switch (s[i + 1])
+        {
+        case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+            i += 2;
+            break;
+        case 'u':
+            if (i + 6 > r->size || !_json_is_hex(s[i + 2]) || !_json_is_hex(s[i + 3])
+                                || !_json_is_hex(s[i + 4]) || !_json_is_hex(s[i + 5]))
+            {
+                r->position = i;
+                return _json_error(r, "Invalid unicode escape sequence");
+            }
+
+            i += 6;
+            break;
+        default:
+            r->position = i;
+            return _json_error(r, "Invalid escape sequence");
+        }
+    }
+
+    r->text = const_string{s + start, i - start};
+    r->position = i + 1;
+    return true;
+}
+
+static bool _json_read_number(json_reader *r)
+{
+    const c8 *s = r->data;
+    s64 size = r->size;
+    s64 start = r->position;
+    s64 i = start;
+
+    if (s[i] == '-')
+        ++i;
+
+    if (i >= size || !_json_is_digit(s[i]))
+        return _json_error(r, "Invalid number");
+
+    if (s[i] == '0')
+        ++i;
+    else
+        i = _json_skip_digits(s, i, size);
+
+    if (i < size && s[i] == '.')
+    {
+        s64 digits = ++i;
+        i = _json_skip_digits(s, i, size);
+
+        if (i == digits)
+        {
+            r->position = i;
+            return _json_error(r, "Invalid number");
+        }
+    }
+
+    if (i < size && (s[i] == 'e' || s[i] == 'E'))
+    {
+        ++i;
+
+        if (i < size && (s[i] == '+' || s[i] == '-'))
+            ++i;
+
+        s64 digits = i;
+        i = _json_skip_digits(s, i, size);
+
+        if (i == digits)
+        {
+            r->position = i;
+            return _json_error(r, "Invalid number");
+        }
+    }
+
+    if (!_json_is_delimiter(r, i))
+    {
+        r->position = i;
+        return _json_error(r, "Invalid number");
+    }
+
+    r->token = json_token::number;
+    r->text = const_string{s + start, i - start};
+    r->position = i;
+    return true;
+}
+
+static bool _json_read_literal(json_reader *r, const_string literal, json_token token)
+{
+    if (r->size - r->position < literal.size)
+        return _json_error(r, "Invalid literal");
+
+    for (s64 i = 0; i < literal.size; ++i)
+        if (r->data[r->position + i] != literal.c_str[i])
+            return _json_error(r, "Invalid literal");
+
+    if (!_json_is_delimiter(r, r->position + literal.size))
+        return _json_error(r, "Invalid literal");
+
+    r->token = token;
+    r->text = const_string{r->data + r->position, literal.size};
+    r->position += literal.size;
+    return true;
+}
+
+static void _json_after_value(json_reader *r)
+{
+    r->state = r->depth > 0 ? _json_expect_comma_or_end : _json_expect_value;
+}
+
+static bool _json_read_value(json_reader *r)
+{
+    c8 c = r->data[r->position];
+
+    switch (c)
+    {
+    case '{':
+    case '[':
+    {
+        if (r->depth >= JSON_MAX_DEPTH)
+            return _json_error(r, "Nesting too deep");
+
+        bool object = c == '{';
+        _json_set_bit(r->is_object, r->depth, object);
+        r->depth++;
+        r->position++;
+        r->token = object ? json_token::object_begin : json_token::array_begin;
+        r->text = const_string{r->data + r->position - 1, 1};
+        r->state = object ? _json_expect_first_key_or_end : _json_expect_first_value_or_end;
+        return true;
+    }
+    case '"':
+        if (!_json_read_string(r))
+            return false;
+
+        r->token = json_token::string;
+        break;
+    case 't':
+        if (!_json_read_literal(r, "true"_cs, json_token::boolean))
+            return false;
+
+        r->boolean = true;
+        break;
+    case 'f':
+        if (!_json_read_literal(r, "false"_cs, json_token::boolean))
+            return false;
+
+        r->boolean = false;
+        break;
+    case 'n':
+        if (!_json_read_literal(r, "null"_cs, json_token::null))
+            return false;
+
+        break;
+    default:
+        if (c != '-' && !_json_is_digit(c))
+            return _json_error(r, "Unexpected character");
+
+        if (!_json_read_number(r))
+            return false;
+
+        break;
+    }
+
+    _json_after_value(r);
+    return true;
+}
+
+static bool _json_read_key(json_reader *r)
+{
+    if (r->data[r->position] != '"')
+        return _json_error(r, "Expected key");
+
+    if (!_json_read_string(r))
+        return false;
+
+    _json_skip_space(r);
+
+    if (r->position >= r->size || r->data[r->position] != ':')
+        return _json_error(r, "Expected ':'");
+
+    r->position++;
+    r->token = json_token::key;
+    r->state = _json_expect_value;
+    return true;
+}
+
+static bool _json_read_end(json_reader *r)
+{
+    c8 c = r->data[r->position];
+    bool object = _json_bit(r->is_object, r->depth - 1);
+
+    if (c != (object ? '}' : ']'))
+        return _json_error(r, object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+
+    r->depth--;
+    r->position++;
+    r->token = object ? json_token::object_end : json_token::array_end;
+    r->text = const_string{r->data + r->position - 1, 1};
+    _json_after_value(r);
+    return true;
+}
+
+bool json_next(json_reader *r)
+{
+    assert(r != nullptr);
+
+    if (r->token == json_token::error)
+        return false;
+
+    _json_skip_space(r);
+
+    if (r->position >= r->size)
+    {
+        if (r->depth > 0 || r->state != _json_expect_value)
+            return _json_error(r, "Unexpected end of data");
+
+        r->token = json_token::end;
+        r->text = const_string{nullptr, 0};
+        return false;
+    }
+
+    c8 c = r->data[r->position];
+
+    switch (r->state)
+    {
+    case _json_expect_value:
+        return _json_read_value(r);
+
+    case _json_expect_first_value_or_end:
+        if (c == ']')
+            return _json_read_end(r);
+
+        return _json_read_value(r);
+
+    case _json_expect_first_key_or_end:
+        if (c == '}')
+            return _json_read_end(r);
+
+        return _json_read_key(r);
+
+    case _json_expect_comma_or_end:
+    default:
+        if (c != ',')
+            return _json_read_end(r);
+
+        r->position++;
+        _json_skip_space(r);
+
+        if (r->position >= r->size)
+            return _json_error(r, "Unexpected end of data");
+
+        if (_json_bit(r->is_object, r->depth - 1))
+            return _json_read_key(r);
+
+        return _json_read_value(r);
+    }
+}
+
+bool json_skip(json_reader *r)
+{
+    assert(r != nullptr);
+
+    if (r->token != json_token::object_begin && r->token != json_token::array_begin)
+        return r->token != json_token::error;
+
+    s32 depth = r->depth - 1;
+
+    // the end of data within a container is an error
+    while (r->depth > depth)
+        if (!json_next(r))
+            return false;
+
+    return true;
+}
+
+static s32 _json_hex_value(const c8 *s)
+{
+    s32 x = 0;
+
+    for (s64 i = 0; i < 4; ++i)
+    {
+        c8 c = s[i];
+        x <<= 4;
+
+        if (c >= '0' && c <= '9')      x |= c - '0';
+        else if (c >= 'a' && c <= 'f') x |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') x |= c - 'A' + 10;
+        else return -1;
+    }
+
+    return x;
+}
+
+bool json_unescape(const_string text, string *out)
+{
+    assert(out != nullptr);
+
+    clear(out);
+    string_reserve(out, text.size);
+
+    const c8 *s = text.c_str;
+    s64 size = text.size;
+    c8 *o = out->data;
+    s64 n = 0;
+
+    // unescaped text is never longer than the escaped text
+    while (size > 0)
+    {
+        s64 i = search_unit(s, size, '\\');
+
+        if (i < 0)
+            i = size;
+
+        copy_memory(s, o + n, i);
+        n += i;
+
+        if (i == size)
+            break;
+
+        if (i + 1 >= size)
+            return false;
+
+        s64 consumed = 2;
+
+        switch (s[i + 1])
+        {
+        case '"':  o[n++] = '"';  break;
+        case '\\': o[n++] = '\\'; break;
+        case '/':  o[n++] = '/';  break;
+        case 'b':  o[n++] = '\b'; break;
+        case 'f':  o[n++] = '\f'; break;
+        case 'n':  o[n++] = '\n'; break;
+        case 'r':  o[n++] = '\r'; break;
+        case 't':  o[n++] = '\t'; break;
+        case 'u':
+        {
+            if (i + 6 > size)
+                return false;
+
+            s32 cp = _json_hex_value(s + i + 2);
+            consumed = 6;
+
+            if (cp < 0)
+                return false;
+
+            // characters outside the basic multilingual plane are escaped
+            // as UTF-16 surrogate pairs
+            if (cp >= 0xd800 && cp <= 0xdbff)
+            {
+                if (i + 12 > size || s[i + 6] != '\\' || s[i + 7] != 'u')
+                    return false;
+
+                s32 low = _json_hex_value(s + i + 8);
+
+                if (low < 0xdc00 || low > 0xdfff)
+                    return false;
+
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                consumed = 12;
+            }
+            else if (cp >= 0xdc00 && cp <= 0xdfff)
+                return false;
+
+            // at most 4 bytes for the at least 6 escaped units
+            n += utf8_encode((u32)cp, o + n);
+            break;
+        }
+        default:
+            return false;
+        }
+
+        s += i + consumed;
+        size -= i + consumed;
+    }
+
+    out->size = n;
+    out->data[n] = '\0';
+    return true;
+}
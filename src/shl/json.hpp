@@ -0,0 +1,215 @@
+#pragma once
+
+/* json.hpp
+
+Streaming JSON writer and pull (SAX-style) JSON reader.
+
+json_writer writes JSON directly to a memory_stream, file_stream, io_handle or
+string through a buffer of json_writer_buffer_size bytes, without building
+the document first. Commas, colons and quotes are written by the writer,
+strings are escaped: the writer searches 16 bytes at a time (see
+shl/simd.hpp) for quotes, backslashes and control characters and copies
+everything in between as is. UTF-8 is written unchanged.
+Numbers are written with the integer and shortest float functions of
+shl/number_format.hpp. NaN and infinity are written as null.
+Every top-level value is followed by a newline, so writing several
+top-level values produces newline-delimited JSON.
+
+json_reader reads JSON from a string in memory, one token at a time, without
+copying or allocating anything: the text of keys, strings and numbers is a
+const_string pointing into the input. The contents of strings are searched
+for the closing quote with the same vector search as the writer.
+Strings that contain escape sequences have reader.escaped set and can be
+decoded with json_unescape. Numbers are validated and can be converted with
+string_to_s64 or string_to_double (see shl/string.hpp).
+The input may contain any number of top-level values separated by
+whitespace, e.g. newline-delimited JSON.
+
+Containers may be nested up to JSON_MAX_DEPTH levels.
+
+Writer example:
+
+    json_writer w{};
+    init(&w, &mem_stream);
+
+    json_begin_object(&w);
+    json_key(&w, "name");
+    json_value(&w, "shl");
+    json_key(&w, "tags");
+    json_begin_array(&w);
+    json_value(&w, 1);
+    json_value(&w, 2.5);
+    json_value(&w, nullptr);
+    json_end_array(&w);
+    json_end_object(&w);
+
+    free(&w); // flushes, mem_stream contains {"name":"shl","tags":[1,2.5,null]}\n
+
+Reader example:
+
+    json_reader r{};
+    init(&r, R"({"a": [1, "x\n"]})"_cs);
+
+    while (json_next(&r))
+    {
+        // r.token is one of object_begin, key "a", array_begin, number "1",
+        // string "x\n" (escaped), array_end, object_end.
+    }
+
+    if (r.token == json_token::error)
+        // r.error_message, r.error_position
+
+Writer functions:
+
+init(*w, *memory_stream)
+init(*w, *file_stream)
+init(*w, io_handle)
+init(*w, *string)
+    initializes w to write to the given output, allocating its buffer
+    with the allocator of the current program context. Strings are
+    appended to.
+free(*w)    flushes w and frees its buffer.
+
+json_flush(*w[, *err])
+    writes the buffered output. Returns false if any write of w failed,
+    e.g. because a memory_stream is full.
+
+json_begin_object(*w), json_end_object(*w)
+json_begin_array(*w), json_end_array(*w)
+    begin and end objects and arrays.
+
+json_key(*w, Key)   writes the key of the next value in an object.
+json_value(*w, X)   writes X, which may be a string (const c8*,
+                    const_string or string*), bool, number or nullptr.
+json_null(*w)       writes null.
+
+Reader functions:
+
+init(*r, Data)  initializes r to read the JSON values in Data, which must
+                stay valid while r is used.
+
+json_next(*r)   reads the next token into r.token and r.text, returns false
+                at the end of Data (r.token == json_token::end) or on errors
+                (r.token == json_token::error).
+json_skip(*r)   if the current token begins an object or array, skips to the
+                matching end token. Returns false on errors.
+
+json_unescape(Text, *out)
+    decodes the escape sequences of the string token Text into out
+    (replacing its contents). Returns false if Text contains invalid
+    escape sequences.
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/allocator.hpp"
+#include "shl/error.hpp"
+#include "shl/io.hpp"
+#include "shl/string.hpp"
+#include "shl/memory_stream.hpp"
+#include "shl/file_stream.hpp"
+
+#define JSON_MAX_DEPTH 256
+
+#ifndef json_writer_buffer_size
+#define json_writer_buffer_size 65536
+#endif
+
+enum class json_output : u8
+{
+    memory_stream,
+    file_stream,
+    io_handle,
+    string
+};
+
+struct json_writer
+{
+    c8 *buffer;
+    s64 size;
+
+    json_output output_type;
+    void *output;
+    io_handle handle;
+
+    // one bit per depth
+    u64 is_object[JSON_MAX_DEPTH / 64];
+    u64 has_elements[JSON_MAX_DEPTH / 64];
+    s32 depth;
+    bool after_key;
+    bool failed;
+
+    ::allocator allocator;
+};
+
+void init(json_writer *w, memory_stream *out);
+void init(json_writer *w, file_stream *out);
+void init(json_writer *w, io_handle out);
+void init(json_writer *w, string *out);
+void free(json_writer *w);
+
+bool json_flush(json_writer *w, error *err = nullptr);
+
+void json_begin_object(json_writer *w);
+void json_end_object(json_writer *w);
+void json_begin_array(json_writer *w);
+void json_end_array(json_writer *w);
+
+void json_key(json_writer *w, const_string key);
+void json_key(json_writer *w, const c8 *key);
+
+void json_value(json_writer *w, const_string x);
+void json_value(json_writer *w, const c8 *x);
+void json_value(json_writer *w, const string *x);
+void json_value(json_writer *w, bool x);
+void json_value(json_writer *w, s32 x);
+void json_value(json_writer *w, u32 x);
+void json_value(json_writer *w, s64 x);
+void json_value(json_writer *w, u64 x);
+void json_value(json_writer *w, float x);
+void json_value(json_writer *w, double x);
+void json_value(json_writer *w, decltype(nullptr));
+void json_null(json_writer *w);
+
+enum class json_token : u8
+{
+    none,
+    object_begin,
+    object_end,
+    array_begin,
+    array_end,
+    key,
+    string,
+    number,
+    boolean,
+    null,
+    end,
+    error
+};
+
+struct json_reader
+{
+    const c8 *data;
+    s64 size;
+    s64 position;
+
+    json_token token;
+    // key, string (without quotes, escape sequences not decoded), number,
+    // true, false or null
+    const_string text;
+    bool boolean;
+    bool escaped;
+
+    u64 is_object[JSON_MAX_DEPTH / 64];
+    s32 depth;
+    u8 state;
+
+    const c8 *error_message;
+    s64 error_position;
+};
+
+void init(json_reader *r, const_string data);
+
+bool json_next(json_reader *r);
+bool json_skip(json_reader *r);
+
+bool json_unescape(const_string text, string *out);
@@ -19,6 +19,19 @@ Example, writing 0..4 to linked list.
 
 initialize a list with init(*list, size), free with free(*list).
 
+Every node is allocated separately with list.allocator. To allocate nodes in
+contiguous blocks instead, use a pool_allocator (see shl/allocator_pool.hpp)
+as the allocator of the list:
+
+    pool p{};
+    init(&p, sizeof(list_node<int>), 1024);
+
+    with_allocator(pool_allocator(&p))
+        init(&list);
+
+For lists that are mostly iterated, consider unrolled_list
+(see shl/unrolled_list.hpp) which stores multiple elements per node.
+
 add_at_start(*list) returns a pointer to the node of the newly inserted value,
                     which is always list.first.
 add_at_start(*list, V) adds the value V at the end of the list.
@@ -0,0 +1,595 @@
+
+#include "shl/platform.hpp"
+#include "shl/assert.hpp"
+#include "shl/bits.hpp"
+#include "shl/memory.hpp"
+#include "shl/logger.hpp"
+
+#if Linux
+#include "shl/impl/linux/futex.hpp"
+#endif
+
+namespace internal
+{
+// written by one producer thread and read by the background thread of the
+// logger. Positions only increase, the offset in data is position & mask.
+struct _log_ring
+{
+    _log_ring *next;
+    u8 *data;
+    u64 mask;
+    u64 cached_read_position;   // producer only
+
+    alignas(64) u64 write_position;
+    alignas(64) u64 read_position;
+    u64 dropped;
+    s32 closed;                 // set when the producer thread exits
+};
+}
+
+using internal::_log_ring;
+using internal::_log_record;
+
+// loggers that are initialized, so exiting threads only close rings of
+// loggers that are still alive.
+#define _max_loggers 64
+static u64 _logger_ids[_max_loggers]{};
+static u64 _next_logger_id = 1;
+static s32 _loggers_lock = 0;
+
+static void _lock_loggers()
+{
+    while (__atomic_exchange_n(&_loggers_lock, 1, __ATOMIC_ACQUIRE) != 0)
+        while (__atomic_load_n(&_loggers_lock, __ATOMIC_RELAXED) != 0)
+            ;
+}
+
+static void _unlock_loggers()
+{
+    __atomic_store_n(&_loggers_lock, 0, __ATOMIC_RELEASE);
+}
+
+static bool _register_logger(logger *lg)
+{
+    bool registered = false;
+    _lock_loggers();
+
+    for (s64 i = 0; i < _max_loggers; ++i)
+        if (_logger_ids[i] == 0)
+        {
+            lg->id = _next_logger_id++;
+            _logger_ids[i] = lg->id;
+            registered = true;
+            break;
+        }
+
+    _unlock_loggers();
+    return registered;
+}
+
+static void _unregister_logger(logger *lg)
+{
+    _lock_loggers();
+
+    for (s64 i = 0; i < _max_loggers; ++i)
+        if (_logger_ids[i] == lg->id)
+            _logger_ids[i] = 0;
+
+    _unlock_loggers();
+}
+
+// rings of the current thread
+#define _max_thread_log_rings 8
+
+struct _thread_log_rings
+{
+    struct
+    {
+        u64 logger_id;
+        _log_ring *ring;
+    } entries[_max_thread_log_rings];
+
+    s32 count;
+
+    ~_thread_log_rings()
+    {
+        // the background thread frees closed rings once they are drained
+        _lock_loggers();
+
+        for (s32 e = 0; e < count; ++e)
+        for (s64 i = 0; i < _max_loggers; ++i)
+            if (_logger_ids[i] == entries[e].logger_id)
+            {
+                __atomic_store_n(&entries[e].ring->closed, 1, __ATOMIC_RELEASE);
+                break;
+            }
+
+        count = 0;
+        _unlock_loggers();
+    }
+};
+
+static thread_local _thread_log_rings _tl_log_rings{};
+
+static void _free_slot_log_rings(void *data)
+{
+    _thread_log_rings *rings = (_thread_log_rings*)data;
+    rings->~_thread_log_rings();
+    allocator_dealloc(default_allocator, rings, sizeof(_thread_log_rings));
+}
+
+// threads started with thread_start share the thread_local rings of the
+// thread that created them, so they keep their own in a thread data slot.
+static _thread_log_rings *_get_thread_log_rings()
+{
+    thread_data_slot *slot = get_thread_data_slot(THREAD_DATA_SLOT_LOG);
+
+    if (slot == nullptr)
+        return &_tl_log_rings;
+
+    if (slot->data == nullptr)
+    {
+        _thread_log_rings *rings = (_thread_log_rings*)allocator_alloc(default_allocator, sizeof(_thread_log_rings));
+
+        if (rings == nullptr)
+            return nullptr;
+
+        fill_memory(rings, 0);
+        slot->data = rings;
+        slot->cleanup = _free_slot_log_rings;
+    }
+
+    return (_thread_log_rings*)slot->data;
+}
+
+static _log_ring *_create_ring(logger *lg)
+{
+    _log_ring *ring = (_log_ring*)allocator_alloc(lg->allocator, sizeof(_log_ring));
+
+    if (ring == nullptr)
+        return nullptr;
+
+    fill_memory(ring, 0);
+    ring->data = (u8*)allocator_alloc(lg->allocator, lg->ring_size);
+
+    if (ring->data == nullptr)
+    {
+        allocator_dealloc(lg->allocator, ring, sizeof(_log_ring));
+        return nullptr;
+    }
+
+    ring->mask = (u64)lg->ring_size - 1;
+
+    // push to the front, only the background thread removes rings
+    _log_ring *head = __atomic_load_n(&lg->rings, __ATOMIC_RELAXED);
+
+    do
+        ring->next = head;
+    while (!__atomic_compare_exchange_n(&lg->rings, &head, ring, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    return ring;
+}
+
+static void _free_ring(logger *lg, _log_ring *ring)
+{
+    allocator_dealloc(lg->allocator, ring->data, lg->ring_size);
+    allocator_dealloc(lg->allocator, ring, sizeof(_log_ring));
+}
+
+static _log_ring *_get_thread_ring(logger *lg)
+{
+    _thread_log_rings *rings = _get_thread_log_rings();
+
+    if (rings == nullptr)
+        return nullptr;
+
+    for (s32 i = 0; i < rings->count; ++i)
+        if (rings->entries[i].logger_id == lg->id)
+            return rings->entries[i].ring;
+
+    // entries of loggers that were freed can be reused
+    s32 index = rings->count;
+
+    if (index >= _max_thread_log_rings)
+    {
+        _lock_loggers();
+
+        for (index = 0; index < rings->count; ++index)
+        {
+            bool alive = false;
+
+            for (s64 i = 0; i < _max_loggers && !alive; ++i)
+                alive = _logger_ids[i] == rings->entries[index].logger_id;
+
+            if (!alive)
+                break;
+        }
+
+        _unlock_loggers();
+
+        if (index >= _max_thread_log_rings)
+            return nullptr;
+    }
+
+    _log_ring *ring = _create_ring(lg);
+
+    if (ring == nullptr)
+        return nullptr;
+
+    rings->entries[index].logger_id = lg->id;
+    rings->entries[index].ring = ring;
+
+    if (index == rings->count)
+        rings->count++;
+
+    return ring;
+}
+
+u8 *internal::_log_reserve(logger *lg, s64 size)
+{
+    assert(size == internal::_log_align(size));
+
+    _log_ring *ring = _get_thread_ring(lg);
+
+    if (ring == nullptr)
+        return nullptr;
+
+    u64 capacity = ring->mask + 1;
+    u64 w = ring->write_position;
+    u64 offset = w & ring->mask;
+    u64 contiguous = capacity - offset;
+
+    // records are never split, the end of the ring is padded instead
+    u64 needed = (u64)size + ((u64)size > contiguous ? contiguous : 0);
+
+    if (needed > capacity - (w - ring->cached_read_position))
+    {
+        ring->cached_read_position = __atomic_load_n(&ring->read_position, __ATOMIC_ACQUIRE);
+
+        if (needed > capacity - (w - ring->cached_read_position))
+        {
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return nullptr;
+        }
+    }
+
+    if ((u64)size > contiguous)
+    {
+        _log_record *padding = (_log_record*)(ring->data + offset);
+        padding->size = (u32)contiguous;
+        padding->level = _log_padding;
+        offset = 0;
+        ring->write_position = w + contiguous;
+    }
+
+    return ring->data + offset;
+}
+
+void internal::_log_commit(logger *lg, u8 *record, s64 size)
+{
+    // the ring of this thread was found by _log_reserve
+    _thread_log_rings *rings = _get_thread_log_rings();
+    _log_ring *ring = nullptr;
+
+    assert(rings != nullptr);
+
+    for (s32 i = 0; i < rings->count; ++i)
+        if (rings->entries[i].logger_id == lg->id)
+            ring = rings->entries[i].ring;
+
+    assert(ring != nullptr);
+    assert(record == ring->data + (ring->write_position & ring->mask));
+
+    __atomic_store_n(&ring->write_position, ring->write_position + (u64)size, __ATOMIC_RELEASE);
+}
+
+// background thread
+static bool _write_output(logger *lg)
+{
+    s64 written = 0;
+
+    while (written < lg->output_size)
+    {
+        s64 ret = io_write(lg->handle, lg->output + written, lg->output_size - written);
+
+        if (ret <= 0)
+            break;
+
+        written += ret;
+    }
+
+    lg->output_size = 0;
+    return written > 0;
+}
+
+static const c8 *_log_level_names[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "FATAL"};
+
+// the longest line prefix, "<20 digits>.<6 digits> LEVEL "
+#define _log_prefix_size 40
+
+// out must hold at least _log_prefix_size units
+static s64 _format_prefix(c8 *out, const timespan *time, u8 level)
+{
+    s64 n = format(out, _log_prefix_size, "%"_fmt, time->seconds);
+    out[n++] = '.';
+    n += format(out + n, _log_prefix_size - n, "%06 % "_fmt, time->nanoseconds / 1000, _log_level_names[level]);
+    return n;
+}
+
+static void _format_record(logger *lg, const _log_record *record)
+{
+    if (logger_output_buffer_size - lg->output_size < _log_prefix_size + 256)
+        _write_output(lg);
+
+    c8 *out = lg->output + lg->output_size;
+    s64 out_size = logger_output_buffer_size - lg->output_size;
+
+    s64 n = _format_prefix(out, &record->time, record->level);
+
+    n += record->site->write(out + n, out_size - n - 1, (const u8*)(record + 1));
+
+    // lines that do not fit are written on their own, truncated to the buffer
+    if (n >= out_size - 1 && lg->output_size > 0)
+    {
+        _write_output(lg);
+        _format_record(lg, record);
+        return;
+    }
+
+    out[n++] = '\n';
+    lg->output_size += n;
+}
+
+static s64 _drain_ring(logger *lg, _log_ring *ring)
+{
+    s64 count = 0;
+    u64 r = ring->read_position;
+    u64 w = __atomic_load_n(&ring->write_position, __ATOMIC_ACQUIRE);
+
+    while (r < w)
+    {
+        const _log_record *record = (const _log_record*)(ring->data + (r & ring->mask));
+
+        if (record->level != _log_padding)
+        {
+            _format_record(lg, record);
+            count++;
+        }
+
+        r += record->size;
+    }
+
+    __atomic_store_n(&ring->read_position, r, __ATOMIC_RELEASE);
+
+    if (u64 dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED); dropped > 0)
+    {
+        if (logger_output_buffer_size - lg->output_size < _log_prefix_size + 64)
+            _write_output(lg);
+
+        timespan t{};
+        get_time(&t);
+
+        c8 *out = lg->output + lg->output_size;
+        s64 n = _format_prefix(out, &t, (u8)log_level::warning);
+        n += format(out + n, logger_output_buffer_size - lg->output_size - n, "logger dropped % messages\n"_fmt, dropped);
+        lg->output_size += n;
+    }
+
+    return count;
+}
+
+static s64 _drain(logger *lg)
+{
+    s64 count = 0;
+    _log_ring *prev = nullptr;
+    _log_ring *ring = __atomic_load_n(&lg->rings, __ATOMIC_ACQUIRE);
+
+    while (ring != nullptr)
+    {
+        bool closed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) != 0;
+        count += _drain_ring(lg, ring);
+
+        _log_ring *next = ring->next;
+
+        if (!closed)
+        {
+            prev = ring;
+            ring = next;
+            continue;
+        }
+
+        // unlink, producers only ever push to the front
+        if (prev != nullptr)
+            prev->next = next;
+        else
+        {
+            _log_ring *expected = ring;
+
+            if (!__atomic_compare_exchange_n(&lg->rings, &expected, next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                // new rings were pushed, find the predecessor
+                prev = expected;
+
+                while (prev->next != ring)
+                    prev = prev->next;
+
+                prev->next = next;
+            }
+        }
+
+        _free_ring(lg, ring);
+        ring = next;
+    }
+
+    return count;
+}
+
+static void _wait_for_wake(logger *lg, s32 wake)
+{
+#if Linux
+    timespan timeout = lg->flush_interval;
+    futex_wait(&lg->wake, wake, &timeout);
+#else
+    if (__atomic_load_n(&lg->wake, __ATOMIC_ACQUIRE) == wake)
+        sleep(&lg->flush_interval);
+#endif
+}
+
+static void _wake(s32 *addr)
+{
+#if Linux
+    futex_wake(addr);
+#else
+    (void)addr;
+#endif
+}
+
+static void *_logger_thread(void *arg)
+{
+    logger *lg = (logger*)arg;
+
+    while (true)
+    {
+        s32 wake = __atomic_load_n(&lg->wake, __ATOMIC_ACQUIRE);
+        s32 flush = __atomic_load_n(&lg->flush_requested, __ATOMIC_ACQUIRE);
+        bool stop = __atomic_load_n(&lg->stop, __ATOMIC_ACQUIRE) != 0;
+
+        s64 count = _drain(lg);
+
+        if (lg->output_size > 0)
+            _write_output(lg);
+
+        if (__atomic_load_n(&lg->flush_completed, __ATOMIC_RELAXED) != flush)
+        {
+            __atomic_store_n(&lg->flush_completed, flush, __ATOMIC_RELEASE);
+            _wake(&lg->flush_completed);
+        }
+
+        // everything logged before stop was set has been written
+        if (stop)
+            break;
+
+        if (count == 0)
+            _wait_for_wake(lg, wake);
+    }
+
+    return nullptr;
+}
+
+bool init(logger *lg, io_handle h, log_level level, s64 ring_size, error *err)
+{
+    assert(lg != nullptr);
+    assert(ring_size >= 256);
+
+    fill_memory(lg, 0);
+    lg->handle = h;
+    lg->level = (u8)level;
+    lg->ring_size = (s64)((u64)1 << (64 - clz64((u64)ring_size - 1)));
+    lg->flush_interval = timespan{.seconds = 0, .nanoseconds = 1000000};
+    lg->allocator = get_context_pointer()->allocator;
+
+    if (!_register_logger(lg))
+    {
+        set_error(err, 1, "too many loggers");
+        return false;
+    }
+
+    lg->output = (c8*)allocator_alloc(lg->allocator, logger_output_buffer_size);
+
+    program_context *ctx = get_context_pointer();
+
+    if (!thread_create(&lg->thread, _logger_thread, lg, err)
+     || !thread_start(&lg->thread, err))
+    {
+        _unregister_logger(lg);
+        allocator_dealloc(lg->allocator, lg->output, logger_output_buffer_size);
+        lg->output = nullptr;
+        return false;
+    }
+
+    // threads without their own thread_local storage set the context pointer
+    // of this thread when they start, which would point into the stack of the
+    // background thread after free.
+    while (!thread_is_running(&lg->thread))
+        ;
+
+    set_context_pointer(ctx);
+
+    return true;
+}
+
+void free(logger *lg)
+{
+    assert(lg != nullptr);
+
+    if (lg->output == nullptr)
+        return;
+
+    // exiting threads no longer touch the rings
+    _unregister_logger(lg);
+
+    __atomic_store_n(&lg->stop, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&lg->wake, 1, __ATOMIC_RELEASE);
+    _wake(&lg->wake);
+
+    thread_stop(&lg->thread);
+    thread_destroy(&lg->thread);
+
+    _log_ring *ring = lg->rings;
+
+    while (ring != nullptr)
+    {
+        _log_ring *next = ring->next;
+        _free_ring(lg, ring);
+        ring = next;
+    }
+
+    allocator_dealloc(lg->allocator, lg->output, logger_output_buffer_size);
+    lg->rings = nullptr;
+    lg->output = nullptr;
+}
+
+void set_log_level(logger *lg, log_level level)
+{
+    assert(lg != nullptr);
+    __atomic_store_n(&lg->level, (u8)level, __ATOMIC_RELAXED);
+}
+
+void log_flush(logger *lg)
+{
+    assert(lg != nullptr);
+
+    s32 ticket = __atomic_add_fetch(&lg->flush_requested, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&lg->wake, 1, __ATOMIC_RELEASE);
+    _wake(&lg->wake);
+
+    while (true)
+    {
+        s32 completed = __atomic_load_n(&lg->flush_completed, __ATOMIC_ACQUIRE);
+
+        // completed and ticket may wrap around
+        if ((s32)((u32)completed - (u32)ticket) >= 0)
+            break;
+
+#if Linux
+        timespan timeout = lg->flush_interval;
+        futex_wait(&lg->flush_completed, completed, &timeout);
+#else
+        sleep(&lg->flush_interval);
+#endif
+    }
+}
+
+const_string log_level_name(log_level level)
+{
+    switch (level)
+    {
+    case log_level::trace:   return "TRACE"_cs;
+    case log_level::debug:   return "DEBUG"_cs;
+    case log_level::info:    return "INFO"_cs;
+    case log_level::warning: return "WARNING"_cs;
+    case log_level::error:   return "ERROR"_cs;
+    case log_level::fatal:   return "FATAL"_cs;
+    default:                 return "OFF"_cs;
+    }
+}
@@ -0,0 +1,363 @@
+#pragma once
+
+/* logger.hpp
+
+Asynchronous logger. Logging a message on a thread does not format or write
+anything: the arguments are copied as a binary record (a pointer to the
+static description of the call site and the raw argument bytes) into a ring
+of the calling thread, and a background thread of the logger formats the
+records and writes them to the handle of the logger.
+
+Every thread that logs gets its own single-producer single-consumer ring per
+logger, created on its first message, so producers never wait for each other
+or for the background thread, and never make system calls. If the ring of a
+thread is full, the message is dropped and counted, and the background thread
+writes the number of dropped messages instead.
+Rings of threads that exit are drained and freed by the background thread.
+Threads started with thread_start keep their rings in a thread data slot
+(see get_thread_data_slot in shl/thread.hpp), so they may log as well.
+
+The level check happens before anything else and is a single comparison, so
+messages below the level of the logger cost next to nothing.
+
+Format strings must be "..."_fmt literals (see shl/format_literal.hpp), the
+number of arguments is checked at compile time. Arguments are copied by
+value, strings (const c8*, const_string, string, string*, and their c16 and
+c32 counterparts) are copied by content, so they may be changed or freed
+after the call. All other argument types must be trivially copyable, and
+pointers other than strings and void pointers (which are logged as
+addresses) are rejected at compile time, since the background thread would
+read what they point to after the call.
+
+The background thread wakes up every flush_interval (default 1ms), or when
+log_flush() or free() is called, drains all rings, formats the records of a
+ring in order and writes them to the handle with as few writes as possible.
+Lines look like this:
+
+    1760000000.123456 INFO  request 12 took 0.35ms
+
+Messages of different threads are not ordered with respect to each other.
+
+Example:
+
+    logger lg{};
+    init(&lg, stderr_handle(), log_level::info);
+
+    log_message(&lg, log_level::info, "request % took %ms"_fmt, id, ms);
+    log_message(&lg, log_level::debug, "not logged"_fmt);
+
+    // the logger of the program context, see shl/program_context.hpp
+    get_context_pointer()->logger = &lg;
+    log_warning("% retries left"_fmt, n);
+
+    free(&lg); // writes everything that was logged
+
+Functions:
+
+init(*lg, Handle[, Level[, RingSize[, *err]]])
+    initializes the logger and starts its background thread. Messages
+    below Level are discarded. Every thread that logs allocates a ring of
+    RingSize bytes (default logger_default_ring_size, rounded up to a power
+    of two). Returns false if the thread could not be started.
+free(*lg)   stops the background thread after it wrote all logged messages,
+            and frees all rings. No thread may log to lg during or after
+            free.
+
+set_log_level(*lg, Level)   changes the level of lg, safe to call from any
+                            thread.
+log_flush(*lg)  waits until everything logged before the call (by any thread)
+                has been written.
+
+log_message(*lg, Level, Fmt, ...)
+    logs the message Fmt with the arguments at Level, if Level is at least
+    the level of lg. Does nothing if lg is nullptr.
+log_message(Level, Fmt, ...)
+    same as above, with the logger of the program context.
+log_trace(Fmt, ...), log_debug(Fmt, ...), log_info(Fmt, ...),
+log_warning(Fmt, ...), log_error(Fmt, ...), log_fatal(Fmt, ...)
+    log at the respective level with the logger of the program context.
+
+log_level_name(Level)   returns the name of Level, e.g. "INFO".
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/allocator.hpp"
+#include "shl/error.hpp"
+#include "shl/io.hpp"
+#include "shl/time.hpp"
+#include "shl/thread.hpp"
+#include "shl/program_context.hpp"
+#include "shl/format.hpp"
+
+#ifndef logger_default_ring_size
+#define logger_default_ring_size 65536
+#endif
+
+// size of the buffer the background thread formats into
+#ifndef logger_output_buffer_size
+#define logger_output_buffer_size 65536
+#endif
+
+enum class log_level : u8
+{
+    trace,
+    debug,
+    info,
+    warning,
+    error,
+    fatal,
+    off
+};
+
+namespace internal
+{
+struct _log_ring;
+}
+
+struct logger
+{
+    io_handle handle;
+    u8 level;               // log_level, read without synchronization
+    u64 id;                 // unique per init, see logger.cpp
+    s64 ring_size;
+    timespan flush_interval;
+    ::allocator allocator;
+
+    internal::_log_ring *rings;
+    c8 *output;
+    s64 output_size;
+
+    s32 wake;               // futex the background thread waits on
+    s32 stop;
+    s32 flush_requested;
+    s32 flush_completed;
+
+    ::thread thread;
+};
+
+bool init(logger *lg, io_handle h, log_level level = log_level::info, s64 ring_size = logger_default_ring_size, error *err = nullptr);
+void free(logger *lg);
+
+void set_log_level(logger *lg, log_level level);
+void log_flush(logger *lg);
+
+const_string log_level_name(log_level level);
+
+namespace internal
+{
+// description of a log call site, one per format string and argument types
+struct _log_site
+{
+    // formats the encoded arguments into out, returns the number of units written
+    s64 (*write)(c8 *out, s64 out_size, const u8 *args);
+};
+
+// header of every record in a ring, followed by the encoded arguments.
+// Records are aligned to 8 bytes.
+struct _log_record
+{
+    u32 size;       // including the header
+    u8 level;       // _log_padding for padding at the end of the ring
+    u8 _unused[3];
+    const _log_site *site;
+    timespan time;
+};
+
+#define _log_padding 0xff
+
+static constexpr s64 _log_align(s64 size)
+{
+    return (size + 7) & ~(s64)7;
+}
+
+// returns memory for a record of size bytes in the ring of the calling
+// thread, or nullptr if it does not fit (the message is counted as dropped).
+u8 *_log_reserve(logger *lg, s64 size);
+// makes the record visible to the background thread
+void _log_commit(logger *lg, u8 *record, s64 size);
+
+// argument encoding
+template<typename T>
+struct _log_arg
+{
+    static_assert(__is_trivially_copyable(T), "log arguments must be trivially copyable or strings");
+    static_assert(is_same(T, typename remove_pointer(T)) || is_same(typename remove_const(typename remove_pointer(T)), void),
+                  "pointer log arguments must be strings or void pointers, the pointee is formatted later on the logger thread");
+
+    typedef T decoded_type;
+
+    static s64 size(const T &)
+    {
+        return _log_align(sizeof(T));
+    }
+
+    static u8 *encode(u8 *p, const T &x)
+    {
+        copy_memory(&x, p, sizeof(T));
+        return p + _log_align(sizeof(T));
+    }
+
+    static T decode(const u8 **p)
+    {
+        T x;
+        copy_memory(*p, &x, sizeof(T));
+        *p += _log_align(sizeof(T));
+        return x;
+    }
+};
+
+// strings are stored as their size followed by their units
+template<typename C>
+struct _log_string_arg
+{
+    typedef const_string_base<C> decoded_type;
+
+    static s64 size(const_string_base<C> x)
+    {
+        return (s64)sizeof(s64) + _log_align(x.size * (s64)sizeof(C));
+    }
+
+    static u8 *encode(u8 *p, const_string_base<C> x)
+    {
+        copy_memory(&x.size, p, sizeof(s64));
+
+        if (x.size > 0)
+            copy_memory(x.c_str, p + sizeof(s64), x.size * sizeof(C));
+
+        return p + size(x);
+    }
+
+    static const_string_base<C> decode(const u8 **p)
+    {
+        const_string_base<C> x{};
+        copy_memory(*p, &x.size, sizeof(s64));
+        x.c_str = (const C*)(*p + sizeof(s64));
+        *p += size(x);
+        return x;
+    }
+};
+
+template<typename C>
+static inline const_string_base<C> _log_c_string(const C *s)
+{
+    return s == nullptr ? const_string_base<C>{nullptr, 0} : const_string_base<C>{s, string_length(s)};
+}
+
+#define _log_string_arg_type(T, C, Conversion)\
+template<> struct _log_arg<T> : _log_string_arg<C>\
+{\
+    static s64 size(T x)            { return _log_string_arg<C>::size(Conversion); }\
+    static u8 *encode(u8 *p, T x)   { return _log_string_arg<C>::encode(p, Conversion); }\
+};
+
+#define _log_string_arg_types(C)\
+    _log_string_arg_type(const C*, C, _log_c_string(x))\
+    _log_string_arg_type(C*, C, _log_c_string((const C*)x))\
+    _log_string_arg_type(const_string_base<C>, C, x)\
+    _log_string_arg_type(string_base<C>, C, to_const_string(&x))\
+    _log_string_arg_type(string_base<C>*, C, to_const_string(x))\
+    _log_string_arg_type(const string_base<C>*, C, to_const_string(x))
+
+_log_string_arg_types(c8)
+_log_string_arg_types(c16)
+_log_string_arg_types(c32)
+
+#undef _log_string_arg_types
+#undef _log_string_arg_type
+
+// string literals decay to pointers
+template<typename T>
+struct _log_arg_type { typedef typename remove_const(typename remove_reference(T)) type; };
+
+template<typename C, s64 N>
+struct _log_arg_type<const C (&)[N]> { typedef const C *type; };
+
+template<typename C, s64 N>
+struct _log_arg_type<C (&)[N]> { typedef const C *type; };
+
+template<typename T>
+using _log_arg_of = _log_arg<typename _log_arg_type<T>::type>;
+
+// decodes the arguments one after another, then formats them
+template<format_string_literal Fmt, typename... Ts>
+struct _log_decoder;
+
+template<format_string_literal Fmt>
+struct _log_decoder<Fmt>
+{
+    template<typename... Decoded>
+    static s64 write(c8 *out, s64 out_size, const u8 *, Decoded... decoded)
+    {
+        return format(out, out_size, fmt_literal<Fmt>{}, decoded...);
+    }
+};
+
+template<format_string_literal Fmt, typename T, typename... Ts>
+struct _log_decoder<Fmt, T, Ts...>
+{
+    template<typename... Decoded>
+    static s64 write(c8 *out, s64 out_size, const u8 *args, Decoded... decoded)
+    {
+        auto x = _log_arg_of<T>::decode(&args);
+        return _log_decoder<Fmt, Ts...>::write(out, out_size, args, decoded..., x);
+    }
+};
+
+template<format_string_literal Fmt, typename... Ts>
+static s64 _log_write(c8 *out, s64 out_size, const u8 *args)
+{
+    return _log_decoder<Fmt, Ts...>::write(out, out_size, args);
+}
+
+template<format_string_literal Fmt, typename... Ts>
+inline constexpr _log_site _log_site_of{ .write = _log_write<Fmt, Ts...> };
+}
+
+template<format_string_literal Fmt, typename... Ts>
+void log_message(logger *lg, log_level level, fmt_literal<Fmt>, Ts &&...args)
+{
+    static_assert(is_same(typename internal::_fmt_compiled<Fmt>::char_type, c8), "log format strings must be c8 strings");
+    internal::_format_literal_check_arguments<Fmt, Ts...>();
+
+    if (lg == nullptr || (u8)level < __atomic_load_n(&lg->level, __ATOMIC_RELAXED))
+        return;
+
+    s64 size = (s64)sizeof(internal::_log_record) + (0 + ... + internal::_log_arg_of<Ts>::size(args));
+    u8 *record = internal::_log_reserve(lg, size);
+
+    if (record == nullptr)
+        return;
+
+    internal::_log_record *header = (internal::_log_record*)record;
+    header->size = (u32)size;
+    header->level = (u8)level;
+    header->site = &internal::_log_site_of<Fmt, Ts...>;
+    get_time(&header->time);
+
+    [[maybe_unused]] u8 *p = record + sizeof(internal::_log_record);
+    ((p = internal::_log_arg_of<Ts>::encode(p, args)), ...);
+
+    internal::_log_commit(lg, record, size);
+}
+
+template<format_string_literal Fmt, typename... Ts>
+void log_message(log_level level, fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    log_message(get_context_pointer()->logger, level, fmt, forward<Ts>(args)...);
+}
+
+#define _define_log_level_function(Name, Level)\
+template<format_string_literal Fmt, typename... Ts>\
+void Name(fmt_literal<Fmt> fmt, Ts &&...args)\
+{\
+    log_message(get_context_pointer()->logger, Level, fmt, forward<Ts>(args)...);\
+}
+
+_define_log_level_function(log_trace,   log_level::trace)
+_define_log_level_function(log_debug,   log_level::debug)
+_define_log_level_function(log_info,    log_level::info)
+_define_log_level_function(log_warning, log_level::warning)
+_define_log_level_function(log_error,   log_level::error)
+_define_log_level_function(log_fatal,   log_level::fatal)
+
+#undef _define_log_level_function
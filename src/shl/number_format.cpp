@@ -0,0 +1,802 @@
+
+#include <string.h> // memcpy
+
+#include "shl/assert.hpp"
+#include "shl/bits.hpp"
+#include "shl/simd.hpp"
+#include "shl/number_parse.hpp"
+#include "shl/number_format.hpp"
+
+static const u64 _powers_of_ten[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+    10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+    100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+    100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull
+};
+
+static const c8 _digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline s32 _decimal_digit_count(u64 x)
+{
+    // floor(log10(x)) is either floor(log2(x) * log10(2)) or one more
+    u32 bits = 64 - clz64(x | 1);
+    u32 t = (bits * 1233) >> 12;
+
+    return (s32)(t + 1) - ((x | 1) < _powers_of_ten[t]);
+}
+
+// writes exactly count digits of x, including leading zeroes
+static inline void _write_digits(c8 *out, u64 x, s32 count)
+{
+    s32 i = count;
+
+    while (x > 0xffffffffull)
+    {
+        u64 pair = (x % 100) * 2;
+        x /= 100;
+        i -= 2;
+        out[i] = _digit_pairs[pair];
+        out[i + 1] = _digit_pairs[pair + 1];
+    }
+
+    // 32 bit divisions are cheaper
+    u32 y = (u32)x;
+
+    while (i >= 2)
+    {
+        u32 pair = (y % 100) * 2;
+        y /= 100;
+        i -= 2;
+        out[i] = _digit_pairs[pair];
+        out[i + 1] = _digit_pairs[pair + 1];
+    }
+
+    if (i == 1)
+        out[0] = (c8)('0' + y % 10);
+}
+
+static inline s64 _write_exponent(c8 *out, s32 exp, s32 min_digits)
+{
+    s64 i = 0;
+    out[i++] = 'e';
+    out[i++] = exp < 0 ? '-' : '+';
+
+    u64 abs_exp = (u64)(exp < 0 ? -exp : exp);
+    s32 count = _decimal_digit_count(abs_exp);
+
+    if (count < min_digits)
+        count = min_digits;
+
+    _write_digits(out + i, abs_exp, count);
+
+    return i + count;
+}
+
+static inline s64 _write_special(c8 *out, bool is_nan)
+{
+    const c8 *text = is_nan ? "nan" : "inf";
+    out[0] = text[0];
+    out[1] = text[1];
+    out[2] = text[2];
+
+    return 3;
+}
+
+static inline s64 _trim_zeroes(c8 *out, s64 size, s64 point)
+{
+    if (point < 0)
+        return size;
+
+    while (size > point + 1 && out[size - 1] == '0')
+        size--;
+
+    if (size == point + 1)
+        size--;
+
+    return size;
+}
+
+// integers
+s32 integer_digit_count(u64 x, s32 base)
+{
+    u32 bits = 64 - clz64(x | 1);
+
+    switch (base)
+    {
+    case 10: return _decimal_digit_count(x);
+    case 16: return (s32)(bits + 3) / 4;
+    case 8:  return (s32)(bits + 2) / 3;
+    case 2:  return (s32)bits;
+    default: return -1;
+    }
+}
+
+s64 write_integer_decimal(c8 *out, u64 x)
+{
+    s32 count = _decimal_digit_count(x);
+    _write_digits(out, x, count);
+
+    return count;
+}
+
+s64 write_integer_hex(c8 *out, u64 x, bool caps)
+{
+    s32 count = integer_digit_count(x, 16);
+
+#if Simd != SIMD_NONE
+    c8 digits[16];
+    simd_store(digits, simd_hex_digits_u64(x, caps));
+    memcpy(out, digits + 16 - count, count);
+#else
+    const c8 *letters = caps ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    for (s32 i = count - 1; i >= 0; --i)
+    {
+        out[i] = letters[x & 0xf];
+        x >>= 4;
+    }
+#endif
+
+    return count;
+}
+
+s64 write_integer_octal(c8 *out, u64 x)
+{
+    s32 count = integer_digit_count(x, 8);
+
+    for (s32 i = count - 1; i >= 0; --i)
+    {
+        out[i] = (c8)('0' + (x & 7));
+        x >>= 3;
+    }
+
+    return count;
+}
+
+s64 write_integer_binary(c8 *out, u64 x)
+{
+    s32 count = integer_digit_count(x, 2);
+
+#if Simd != SIMD_NONE
+    c8 digits[64];
+    simd_store(digits,      simd_binary_digits_u16((u16)(x >> 48)));
+    simd_store(digits + 16, simd_binary_digits_u16((u16)(x >> 32)));
+    simd_store(digits + 32, simd_binary_digits_u16((u16)(x >> 16)));
+    simd_store(digits + 48, simd_binary_digits_u16((u16)x));
+    memcpy(out, digits + 64 - count, count);
+#else
+    for (s32 i = count - 1; i >= 0; --i)
+    {
+        out[i] = (c8)('0' + (x & 1));
+        x >>= 1;
+    }
+#endif
+
+    return count;
+}
+
+// Schubfach
+static inline s32 _floor_log2_pow10(s32 e)
+{
+    return (e * 1741647) >> 19;
+}
+
+static inline s32 _floor_log10_pow2(s32 e)
+{
+    return (e * 1262611) >> 22;
+}
+
+static inline s32 _floor_log10_three_quarters_pow2(s32 e)
+{
+    return (e * 1262611 - 524031) >> 22;
+}
+
+// g = floor(10^k / 2^r) + 1, normalized to [2^127, 2^128[.
+// 10^k and 5^k have the same normalized significand.
+static inline void _pow10_significand(s32 k, u64 *hi, u64 *lo)
+{
+    assert(k >= _smallest_power_of_five && k <= _largest_power_of_five_128);
+
+    const u64 *power = _power_of_five_128 + 2 * (k - _smallest_power_of_five);
+    *hi = power[0];
+    *lo = power[1];
+
+    // 5^-27 to 5^-1 are already rounded up in the table
+    if (k >= 0 || k < -27)
+    {
+        *lo += 1;
+        *hi += (*lo == 0);
+    }
+}
+
+static inline u64 _round_to_odd(u64 g_hi, u64 g_lo, u64 cp)
+{
+    u64 x_hi = 0;
+    u64 y_hi = 0;
+
+    mul64_full(g_lo, cp, &x_hi);
+    u64 y_lo = mul64_full(g_hi, cp, &y_hi);
+
+    u64 z = y_lo + x_hi;
+    u64 vbp = y_hi + (z < y_lo);
+
+    return vbp | (z > 1);
+}
+
+// finds the shortest decimal in the rounding interval of c * 2^q
+static void _shortest_decimal(u64 c, s32 q, bool lower_boundary_is_closer, u64 *out_digits, s32 *out_exponent)
+{
+    bool is_even = (c % 2) == 0;
+
+    u64 cbl = 4 * c - 2 + lower_boundary_is_closer;
+    u64 cb  = 4 * c;
+    u64 cbr = 4 * c + 2;
+
+    s32 k = lower_boundary_is_closer ? _floor_log10_three_quarters_pow2(q) : _floor_log10_pow2(q);
+    s32 h = q + _floor_log2_pow10(-k) + 1;
+
+    u64 g_hi = 0;
+    u64 g_lo = 0;
+    _pow10_significand(-k, &g_hi, &g_lo);
+
+    u64 vbl = _round_to_odd(g_hi, g_lo, cbl << h);
+    u64 vb  = _round_to_odd(g_hi, g_lo, cb  << h);
+    u64 vbr = _round_to_odd(g_hi, g_lo, cbr << h);
+
+    u64 lower = vbl + !is_even;
+    u64 upper = vbr - !is_even;
+
+    u64 s = vb / 4;
+
+    if (s >= 10)
+    {
+        // one digit less
+        u64 sp = s / 10;
+        bool up_inside = lower <= 40 * sp;
+        bool wp_inside = 40 * sp + 40 <= upper;
+
+        if (up_inside != wp_inside)
+        {
+            *out_digits = sp + wp_inside;
+            *out_exponent = k + 1;
+            return;
+        }
+    }
+
+    bool u_inside = lower <= 4 * s;
+    bool w_inside = 4 * s + 4 <= upper;
+
+    if (u_inside != w_inside)
+    {
+        *out_digits = s + w_inside;
+        *out_exponent = k;
+        return;
+    }
+
+    // both or neither are inside, take the closer one
+    u64 mid = 4 * s + 2;
+    bool round_up = vb > mid || (vb == mid && (s & 1) != 0);
+
+    *out_digits = s + round_up;
+    *out_exponent = k;
+}
+
+static inline void _remove_trailing_zeroes(u64 *digits, s32 *exponent)
+{
+    if (*digits == 0)
+        return;
+
+    while (*digits % 10 == 0)
+    {
+        *digits /= 10;
+        *exponent += 1;
+    }
+}
+
+// significand bits, exponent bias (including the significand bits) and
+// maximum biased exponent
+template<typename N> struct _float_traits;
+template<> struct _float_traits<double> { typedef u64 bits_type; static constexpr s32 significand_bits = 52; static constexpr s32 bias = 1075; static constexpr u32 max_exponent = 0x7ff; };
+template<> struct _float_traits<float>  { typedef u32 bits_type; static constexpr s32 significand_bits = 23; static constexpr s32 bias = 150;  static constexpr u32 max_exponent = 0xff; };
+
+template<typename N>
+static inline void _decompose(N x, u64 *significand, u32 *biased_exponent)
+{
+    typedef _float_traits<N> traits;
+    typename traits::bits_type bits;
+    memcpy(&bits, &x, sizeof(bits));
+
+    *significand = (u64)bits & (((u64)1 << traits::significand_bits) - 1);
+    *biased_exponent = (u32)(bits >> traits::significand_bits) & traits::max_exponent;
+}
+
+template<typename N>
+static inline void _float_to_shortest_decimal(N x, u64 *digits, s32 *exponent)
+{
+    typedef _float_traits<N> traits;
+
+    u64 m = 0;
+    u32 e = 0;
+    _decompose(x, &m, &e);
+
+    assert(e != traits::max_exponent);
+
+    *digits = 0;
+    *exponent = 0;
+
+    if (e == 0 && m == 0)
+        return;
+
+    u64 c = m;
+    s32 q = 1 - traits::bias;
+
+    if (e != 0)
+    {
+        c = m | ((u64)1 << traits::significand_bits);
+        q = (s32)e - traits::bias;
+
+        // small integers
+        if (q <= 0 && -q <= traits::significand_bits)
+        {
+            u64 f = c >> -q;
+
+            if ((f << -q) == c)
+            {
+                *digits = f;
+                _remove_trailing_zeroes(digits, exponent);
+                return;
+            }
+        }
+    }
+
+    _shortest_decimal(c, q, m == 0 && e > 1, digits, exponent);
+    _remove_trailing_zeroes(digits, exponent);
+}
+
+void float_to_shortest_decimal(double x, u64 *digits, s32 *exponent) { _float_to_shortest_decimal(x, digits, exponent); }
+void float_to_shortest_decimal(float  x, u64 *digits, s32 *exponent) { _float_to_shortest_decimal(x, digits, exponent); }
+
+template<typename N>
+static inline bool _is_special(N x, bool *is_nan)
+{
+    u64 m = 0;
+    u32 e = 0;
+    _decompose(x, &m, &e);
+
+    *is_nan = m != 0;
+
+    return e == _float_traits<N>::max_exponent;
+}
+
+// shortest
+template<typename N>
+static inline s64 _write_float_shortest(c8 *out, N x)
+{
+    bool is_nan = false;
+
+    if (_is_special(x, &is_nan))
+        return _write_special(out, is_nan);
+
+    u64 digits = 0;
+    s32 exponent = 0;
+    _float_to_shortest_decimal(x, &digits, &exponent);
+
+    if (digits == 0)
+    {
+        out[0] = '0';
+        return 1;
+    }
+
+    s32 k = _decimal_digit_count(digits);
+    s32 n = k + exponent; // position of the decimal point
+
+    if (k <= n && n <= 21)
+    {
+        // 1234500
+        _write_digits(out, digits, k);
+
+        for (s32 i = k; i < n; ++i)
+            out[i] = '0';
+
+        return n;
+    }
+
+    if (0 < n && n <= 21)
+    {
+        // 123.45
+        _write_digits(out, digits / _powers_of_ten[k - n], n);
+        out[n] = '.';
+        _write_digits(out + n + 1, digits % _powers_of_ten[k - n], k - n);
+
+        return k + 1;
+    }
+
+    if (-6 < n && n <= 0)
+    {
+        // 0.0012345
+        out[0] = '0';
+        out[1] = '.';
+
+        for (s32 i = 0; i < -n; ++i)
+            out[2 + i] = '0';
+
+        _write_digits(out + 2 - n, digits, k);
+
+        return 2 - n + k;
+    }
+
+    // 1.2345e+30
+    s64 i = 0;
+    _write_digits(out, digits / _powers_of_ten[k - 1], 1);
+    i++;
+
+    if (k > 1)
+    {
+        out[i++] = '.';
+        _write_digits(out + i, digits % _powers_of_ten[k - 1], k - 1);
+        i += k - 1;
+    }
+
+    return i + _write_exponent(out + i, n - 1, 1);
+}
+
+s64 write_float_shortest(c8 *out, double x) { return _write_float_shortest(out, x); }
+s64 write_float_shortest(c8 *out, float  x) { return _write_float_shortest(out, x); }
+
+// fixed
+template<typename N>
+static inline s64 _write_float_fixed(c8 *out, N x, s32 precision, bool trim_zeroes)
+{
+    assert(precision >= 0 && precision <= FLOAT_DECIMAL_MAX_PRECISION);
+
+    bool is_nan = false;
+
+    if (_is_special(x, &is_nan))
+        return _write_special(out, is_nan);
+
+    s64 i = 0;
+    u64 fraction_digits = 0;
+
+    if (x < (N)0)
+        x = -x;
+
+    if (x < (N)18446744073709551616.0)
+    {
+        // exact: x = c * 2^q, whole = floor(x), fraction * 10^precision
+        // rounded to nearest, ties to even.
+        u64 m = 0;
+        u32 e = 0;
+        _decompose((double)x, &m, &e);
+
+        u64 c = e == 0 ? m : (m | ((u64)1 << 52));
+        s32 q = e == 0 ? -1074 : (s32)e - 1075;
+        u64 whole = 0;
+
+        if (q >= 0)
+            whole = c << q;
+        else
+        {
+            s32 shift = -q;
+            u64 fraction = c;
+
+            if (shift < 64)
+            {
+                whole = c >> shift;
+                fraction = c & (((u64)1 << shift) - 1);
+            }
+
+            // fraction * 10^precision / 2^shift, with remainder
+            u64 p_hi = 0;
+            u64 p_lo = mul64_full(fraction, _powers_of_ten[precision], &p_hi);
+            bool round_up = false;
+
+            if (shift < 64)
+            {
+                u64 rem = p_lo & (((u64)1 << shift) - 1);
+                u64 half = (u64)1 << (shift - 1);
+                fraction_digits = (p_lo >> shift) | (shift > 0 ? p_hi << (64 - shift) : 0);
+                round_up = rem > half || (rem == half && ((precision > 0 ? fraction_digits : whole) & 1));
+            }
+            else if (shift == 64)
+            {
+                u64 half = (u64)1 << 63;
+                fraction_digits = p_hi;
+                round_up = p_lo > half || (p_lo == half && ((precision > 0 ? fraction_digits : whole) & 1));
+            }
+            else if (shift < 128)
+            {
+                s32 hi_shift = shift - 64;
+                u64 rem_hi = p_hi & (((u64)1 << hi_shift) - 1);
+                u64 half_hi = (u64)1 << (hi_shift - 1);
+                fraction_digits = p_hi >> hi_shift;
+                round_up = rem_hi > half_hi || (rem_hi == half_hi && (p_lo > 0 || ((precision > 0 ? fraction_digits : whole) & 1)));
+            }
+            // else: the product is below 2^117 and the half at least 2^127
+
+            if (round_up)
+            {
+                fraction_digits++;
+
+                if (fraction_digits >= _powers_of_ten[precision])
+                {
+                    fraction_digits = 0;
+                    whole++;
+                }
+            }
+        }
+
+        s32 count = _decimal_digit_count(whole);
+        _write_digits(out, whole, count);
+        i += count;
+    }
+    else
+    {
+        u64 digits = 0;
+        s32 exponent = 0;
+        _float_to_shortest_decimal(x, &digits, &exponent);
+
+        s32 count = _decimal_digit_count(digits);
+        _write_digits(out, digits, count);
+        i += count;
+
+        for (s32 z = 0; z < exponent; ++z)
+            out[i++] = '0';
+    }
+
+    if (precision == 0)
+        return i;
+
+    s64 point = i;
+    out[i++] = '.';
+    _write_digits(out + i, fraction_digits, precision);
+    i += precision;
+
+    if (trim_zeroes)
+        i = _trim_zeroes(out, i, point);
+
+    return i;
+}
+
+s64 write_float_fixed(c8 *out, double x, s32 precision, bool trim_zeroes) { return _write_float_fixed(out, x, precision, trim_zeroes); }
+s64 write_float_fixed(c8 *out, float  x, s32 precision, bool trim_zeroes) { return _write_float_fixed(out, x, precision, trim_zeroes); }
+
+// scientific
+// exact decimal digits of c * 2^q with a small big integer: the numbers are
+// at most about 10 * 2^1074 (or 10 * 10^324), 40 32-bit limbs are enough.
+#define _BIG_LIMBS 40
+
+struct _big
+{
+    u32 limbs[_BIG_LIMBS];
+    s32 size;
+};
+
+static inline void _big_set(_big *b, u64 x)
+{
+    b->limbs[0] = (u32)x;
+    b->limbs[1] = (u32)(x >> 32);
+    b->size = b->limbs[1] != 0 ? 2 : (b->limbs[0] != 0 ? 1 : 0);
+}
+
+static inline void _big_mul_small(_big *b, u32 m)
+{
+    u64 carry = 0;
+
+    for (s32 i = 0; i < b->size; ++i)
+    {
+        u64 p = (u64)b->limbs[i] * m + carry;
+        b->limbs[i] = (u32)p;
+        carry = p >> 32;
+    }
+
+    if (carry != 0)
+    {
+        assert(b->size < _BIG_LIMBS);
+        b->limbs[b->size++] = (u32)carry;
+    }
+}
+
+static inline void _big_mul_pow10(_big *b, s32 n)
+{
+    for (; n >= 9; n -= 9)
+        _big_mul_small(b, 1000000000u);
+
+    if (n > 0)
+        _big_mul_small(b, (u32)_powers_of_ten[n]);
+}
+
+static inline void _big_shift_left(_big *b, s32 n)
+{
+    if (b->size == 0)
+        return;
+
+    s32 limbs = n / 32;
+    s32 bits = n % 32;
+    s32 size = b->size + limbs + 1;
+
+    assert(size <= _BIG_LIMBS);
+
+    b->limbs[size - 1] = 0;
+
+    for (s32 i = b->size - 1; i >= 0; --i)
+    {
+        u64 x = (u64)b->limbs[i] << bits;
+        b->limbs[i + limbs + 1] |= (u32)(x >> 32);
+        b->limbs[i + limbs] = (u32)x;
+    }
+
+    for (s32 i = 0; i < limbs; ++i)
+        b->limbs[i] = 0;
+
+    b->size = size;
+
+    while (b->size > 0 && b->limbs[b->size - 1] == 0)
+        b->size--;
+}
+
+static inline s32 _big_compare(const _big *a, const _big *b)
+{
+    if (a->size != b->size)
+        return a->size < b->size ? -1 : 1;
+
+    for (s32 i = a->size - 1; i >= 0; --i)
+        if (a->limbs[i] != b->limbs[i])
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+
+    return 0;
+}
+
+// a -= b, a >= b
+static inline void _big_subtract(_big *a, const _big *b)
+{
+    s64 borrow = 0;
+
+    for (s32 i = 0; i < a->size; ++i)
+    {
+        s64 d = (s64)a->limbs[i] - (i < b->size ? b->limbs[i] : 0) - borrow;
+        borrow = d < 0;
+        a->limbs[i] = (u32)(d + (borrow << 32));
+    }
+
+    while (a->size > 0 && a->limbs[a->size - 1] == 0)
+        a->size--;
+}
+
+// writes the first count significant digits of the finite, non-zero x,
+// rounded to nearest (ties to even) like printf, returns the decimal exponent
+// of the first digit.
+static s32 _exact_scientific_digits(double x, c8 *digits, s32 count)
+{
+    u64 m = 0;
+    u32 e = 0;
+    _decompose(x, &m, &e);
+
+    u64 c = e == 0 ? m : (m | ((u64)1 << 52));
+    s32 q = e == 0 ? -1074 : (s32)e - 1075;
+
+    // the shortest representation has the same exponent, or one more if it
+    // rounded up to a power of ten.
+    u64 shortest = 0;
+    s32 shortest_exponent = 0;
+    _float_to_shortest_decimal(x, &shortest, &shortest_exponent);
+    s32 exp10 = shortest_exponent + _decimal_digit_count(shortest) - 1;
+
+    // x / 10^exp10 = num / den
+    _big num;
+    _big den;
+    _big_set(&num, c);
+    _big_set(&den, 1);
+
+    if (q > 0)
+        _big_shift_left(&num, q);
+    else
+        _big_shift_left(&den, -q);
+
+    if (exp10 > 0)
+        _big_mul_pow10(&den, exp10);
+    else
+        _big_mul_pow10(&num, -exp10);
+
+    if (_big_compare(&num, &den) < 0)
+    {
+        _big_mul_small(&num, 10);
+        exp10--;
+    }
+
+    for (s32 i = 0; i < count; ++i)
+    {
+        c8 d = 0;
+
+        while (_big_compare(&num, &den) >= 0)
+        {
+            _big_subtract(&num, &den);
+            d++;
+        }
+
+        assert(d < 10);
+        digits[i] = '0' + d;
+
+        if (i + 1 < count)
+            _big_mul_small(&num, 10);
+    }
+
+    // compare the remainder with den / 2
+    _big_mul_small(&num, 2);
+    s32 cmp = _big_compare(&num, &den);
+
+    if (cmp > 0 || (cmp == 0 && ((digits[count - 1] - '0') & 1)))
+    {
+        s32 i = count - 1;
+
+        while (i >= 0 && digits[i] == '9')
+            digits[i--] = '0';
+
+        if (i >= 0)
+            digits[i]++;
+        else
+        {
+            // 9.99 -> 10.0
+            digits[0] = '1';
+            exp10++;
+        }
+    }
+
+    return exp10;
+}
+
+template<typename N>
+static inline s64 _write_float_scientific(c8 *out, N x, s32 precision, bool trim_zeroes)
+{
+    assert(precision >= 0 && precision <= FLOAT_DECIMAL_MAX_PRECISION);
+
+    bool is_nan = false;
+
+    if (_is_special(x, &is_nan))
+        return _write_special(out, is_nan);
+
+    if (x < (N)0)
+        x = -x;
+
+    c8 digits[FLOAT_DECIMAL_MAX_PRECISION + 1];
+    s32 exp10 = 0;
+
+    if (x == (N)0)
+    {
+        for (s32 i = 0; i <= precision; ++i)
+            digits[i] = '0';
+    }
+    else
+        exp10 = _exact_scientific_digits((double)x, digits, precision + 1);
+
+    s64 i = 0;
+    out[i++] = digits[0];
+
+    if (precision > 0)
+    {
+        s64 point = i;
+        out[i++] = '.';
+
+        for (s32 d = 1; d <= precision; ++d)
+            out[i++] = digits[d];
+
+        if (trim_zeroes)
+            i = _trim_zeroes(out, i, point);
+    }
+
+    return i + _write_exponent(out + i, exp10, 2);
+}
+
+s64 write_float_scientific(c8 *out, double x, s32 precision, bool trim_zeroes) { return _write_float_scientific(out, x, precision, trim_zeroes); }
+s64 write_float_scientific(c8 *out, float  x, s32 precision, bool trim_zeroes) { return _write_float_scientific(out, x, precision, trim_zeroes); }
@@ -0,0 +1,100 @@
+#pragma once
+
+/* number_format.hpp
+
+Conversion of integers and floating point numbers to text, used by to_string
+in shl/format.hpp.
+
+Integers are written with a known length: the number of digits is computed
+from the number of leading zero bits (see clz64 in shl/bits.hpp) and one
+comparison with a power of ten, then decimal digits are written two at a time
+from a table of digit pairs, and hexadecimal and binary digits are converted
+16 at a time with vector instructions where available (see shl/simd.hpp).
+
+The shortest representation of a float or double is the decimal number with
+the fewest significant digits that converts back to exactly the same float or
+double, and of those the one closest to it. It is computed with the Schubfach
+algorithm (R. Giulietti, "The Schubfach way to render doubles"), which needs
+three 64x128 bit multiplications with a power of ten from the table of 128 bit
+powers of five in shl/number_parse.hpp, and no loops or big integers.
+
+Numbers are written in one of three forms:
+
+fixed       digits, a decimal point and Precision digits, e.g. 123.456000.
+            Numbers below 2^64 are rounded exactly (to nearest, ties to even,
+            same as printf). Larger numbers are written as their shortest
+            representation followed by zeroes.
+scientific  one digit, a decimal point, Precision digits and a decimal
+            exponent of at least two digits, e.g. 1.234560e+02.
+            The digits are the exact value rounded to Precision + 1
+            significant digits (to nearest, ties to even, same as printf),
+            generated with a small big integer.
+shortest    the shortest representation, in the same form JavaScript uses
+            for numbers: fixed notation for 1e-7 <= x < 1e21 and scientific
+            notation without padding otherwise, e.g. 0.1, 123.456, 1e+21,
+            5e-324. Converting the text back always yields the same number.
+
+If trim_zeroes is true, trailing zeroes after the decimal point are removed,
+and the decimal point as well if no digits remain after it.
+
+The functions write the absolute value of x (the caller writes the sign)
+into out, which must hold at least FLOAT_DECIMAL_BUFFER_SIZE units, and
+return the number of units written. Infinity is written as "inf" and NaN as
+"nan". Precision must be between 0 and FLOAT_DECIMAL_MAX_PRECISION.
+
+Functions:
+
+integer_digit_count(x, Base)
+    returns the number of digits of x in Base (2, 8, 10 or 16), at least 1.
+    Returns -1 if Base is not supported.
+
+write_integer_decimal(*out, x)
+write_integer_hex(*out, x, caps)
+write_integer_octal(*out, x)
+write_integer_binary(*out, x)
+    write the digits of x, without prefix, to out, which must hold at least
+    INTEGER_DIGITS_BUFFER_SIZE units, and return the number of units written.
+    caps writes hexadecimal letters in uppercase.
+
+float_to_shortest_decimal(x, *digits, *exponent)
+    Sets *digits and *exponent such that digits * 10^exponent is the shortest
+    representation of the finite number |x|. digits has no trailing zeroes
+    (0 for x = 0, with exponent 0).
+
+write_float_shortest(*out, x)
+write_float_fixed(*out, x, Precision, trim_zeroes)
+write_float_scientific(*out, x, Precision, trim_zeroes)
+    write x in the respective form, see above.
+
+All float functions have overloads for float and double.
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/char_types.hpp"
+
+// 64 binary digits
+#define INTEGER_DIGITS_BUFFER_SIZE 64
+
+s32 integer_digit_count(u64 x, s32 base);
+
+s64 write_integer_decimal(c8 *out, u64 x);
+s64 write_integer_hex(c8 *out, u64 x, bool caps = false);
+s64 write_integer_octal(c8 *out, u64 x);
+s64 write_integer_binary(c8 *out, u64 x);
+
+#define FLOAT_DECIMAL_MAX_PRECISION 19
+// 309 integer digits of the largest double in fixed form, decimal point and
+// precision, rounded up.
+#define FLOAT_DECIMAL_BUFFER_SIZE 352
+
+void float_to_shortest_decimal(double x, u64 *digits, s32 *exponent);
+void float_to_shortest_decimal(float  x, u64 *digits, s32 *exponent);
+
+s64 write_float_shortest(c8 *out, double x);
+s64 write_float_shortest(c8 *out, float  x);
+
+s64 write_float_fixed(c8 *out, double x, s32 precision, bool trim_zeroes);
+s64 write_float_fixed(c8 *out, float  x, s32 precision, bool trim_zeroes);
+
+s64 write_float_scientific(c8 *out, double x, s32 precision, bool trim_zeroes);
+s64 write_float_scientific(c8 *out, float  x, s32 precision, bool trim_zeroes);
@@ -0,0 +1,56 @@
+#pragma once
+
+/* number_parse.hpp
+
+Decimal number parsing kernels, used by string_to_s32, string_to_double,
+string_to_numbers and others in shl/string.hpp.
+All functions work on units (c8, c16 or c32). Digits, signs, decimal points
+and exponents are always single units, so no UTF decoding is needed.
+
+Decimal digits of c8 strings are parsed 8 at a time: 8 bytes are loaded as a
+single u64, checked to all be digits and combined into their value with three
+multiplications (SWAR). The remaining digits are parsed one by one.
+
+Floating point numbers are converted using the Eisel-Lemire algorithm, which
+computes the correctly rounded double from up to 19 significant decimal
+digits and a decimal exponent using a table of 128 bit powers of five.
+Numbers that are exactly representable with a double mantissa and a small
+exponent use exact double arithmetic instead (Clinger's fast path). In the
+very rare cases the algorithm cannot decide the rounding (e.g. more than 19
+significant digits right between two doubles), the number is converted with
+strtod.
+
+Functions:
+
+parse_decimal_digits(const C *s, s64 size, u64 limit, u64 *out, bool *overflow)
+    Parses the decimal digits at the start of s[0, size[ into *out.
+    Returns the number of digits, which is 0 if s does not start with a digit.
+    If the number is larger than limit, sets *overflow to true and continues
+    to consume the remaining digits, *out is undefined in that case.
+
+parse_decimal_float(const C *s, s64 size, double *out, bool *out_of_range)
+    Parses [+-]digits[.digits][(e|E)[+-]digits] at the start of s[0, size[
+    into *out, rounding to the nearest double.
+    Returns the number of units parsed, or 0 if there are no digits (*out
+    is set to 0 in that case). An exponent without digits is not parsed.
+    Sets *out_of_range to true if the number is too large for a double,
+    *out is set to (signed) infinity in that case.
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/char_types.hpp"
+
+s64 parse_decimal_digits(const c8  *s, s64 size, u64 limit, u64 *out, bool *overflow);
+s64 parse_decimal_digits(const c16 *s, s64 size, u64 limit, u64 *out, bool *overflow);
+s64 parse_decimal_digits(const c32 *s, s64 size, u64 limit, u64 *out, bool *overflow);
+
+s64 parse_decimal_float(const c8  *s, s64 size, double *out, bool *out_of_range);
+s64 parse_decimal_float(const c16 *s, s64 size, double *out, bool *out_of_range);
+s64 parse_decimal_float(const c32 *s, s64 size, double *out, bool *out_of_range);
+
+// 128 bit powers of five (high, low) of 5^q for q in
+// [_smallest_power_of_five, _largest_power_of_five_128], see number_parse.cpp.
+#define _smallest_power_of_five   -342
+#define _largest_power_of_five_128 324
+
+extern const u64 _power_of_five_128[];
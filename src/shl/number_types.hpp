@@ -36,6 +36,7 @@ with arithmetic operators.
 */
 
 #include "shl/architecture.hpp"
+#include "shl/macros.hpp" // offset_of
 
 #if Wordsize == 64 && !defined(_WIN32)
 #  define S64_LIT(c) c ## L
@@ -154,9 +155,6 @@ define_min_value(s64, S64_MIN);
 define_min_value(float,  FLOAT_MIN);
 define_min_value(double, DOUBLE_MIN);
 
-#ifndef offset_of
-#define offset_of(st, m) ((s64)&(((st *)0)->m))
-#endif
 
 // custom types
 #define define_explicit_number_type(T, Base)\
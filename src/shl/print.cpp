@@ -4,11 +4,11 @@
 
 s64 put(io_handle h, c8 c, error *err)
 {
-    return io_write(h, &c, sizeof(c8), err);
+    return _put(h, const_string{&c, 1}, err);
 }
 
-template<typename C>
-s64 _put_cs(io_handle h, const_string_base<C> s, error *err)
+template<typename Out, typename C>
+s64 _put_cs(Out out, const_string_base<C> s, error *err)
 {
     internal::tformat_buffer *buf = internal::_get_tformat_buffer_c8();
 
@@ -22,17 +22,68 @@ s64 _put_cs(io_handle h, const_string_base<C> s, error *err)
     
     internal::_buffer_advance<c8>(buf, bytes_written + 1);
 
-    return _put(h, const_string{start, bytes_written}, err);
+    return _put(out, const_string{start, bytes_written}, err);
 }
 
 s64 _put(io_handle h, const_string  s, error *err)
 {
+    if (is_print_buffered())
+    {
+        print_buffer *pb = get_print_buffer(h);
+
+        if (pb != nullptr)
+            return print_buffer_write(pb, s.c_str, s.size, err);
+    }
+
     return io_write(h, s.c_str, s.size, err);
 }
 
 s64 _put(io_handle h, const_u16string s, error *err) { return _put_cs(h, s, err); }
 s64 _put(io_handle h, const_u32string s, error *err) { return _put_cs(h, s, err); }
 
+bool internal::_format_to_io_flush(_format_chunks<c8> *chunks)
+{
+    io_handle h = *(io_handle*)chunks->userdata;
+    const c8 *data = chunks->buffer;
+    s64 size = chunks->used;
+
+    while (size > 0)
+    {
+        s64 written = _put(h, const_string{data, size}, nullptr);
+
+        if (written <= 0)
+            return false;
+
+        data += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+bool internal::_format_to_io_flush(_format_chunks<c16> *chunks)
+{
+    return _put(*(io_handle*)chunks->userdata, const_u16string{chunks->buffer, chunks->used}, nullptr) >= 0;
+}
+
+bool internal::_format_to_io_flush(_format_chunks<c32> *chunks)
+{
+    return _put(*(io_handle*)chunks->userdata, const_u32string{chunks->buffer, chunks->used}, nullptr) >= 0;
+}
+
+s64 put(print_buffer *pb, c8 c, error *err)
+{
+    return print_buffer_write(pb, &c, 1, err);
+}
+
+s64 _put(print_buffer *pb, const_string  s, error *err)
+{
+    return print_buffer_write(pb, s.c_str, s.size, err);
+}
+
+s64 _put(print_buffer *pb, const_u16string s, error *err) { return _put_cs(pb, s, err); }
+s64 _put(print_buffer *pb, const_u32string s, error *err) { return _put_cs(pb, s, err); }
+
 s64 put(c8 c, error *err) { return put(stdout_handle(), c, err); }
 s64 _put(const_string    s, error *err) { return _put(stdout_handle(), s, err); }
 s64 _put(const_u16string s, error *err) { return _put(stdout_handle(), s, err); }
@@ -17,10 +17,33 @@ tprint(h, fmt, ...) formats a string using tformat(fmt, ...) and prints the
 
 tprint(fmt, ...)    formats a string using tformat(fmt, ...) and prints the
                     string to stdout_handle().
+
+format_to_io(h, fmt, ...)
+format_to_io(h, *buffer, buffer_size, fmt, ...)
+    formats fmt and the arguments into buffer (or a buffer of
+    FORMAT_CHUNK_BUFFER_SIZE bytes on the stack) and writes the buffer to h
+    whenever it is full and at the end, without going through tformat.
+    Values that don't fit into the buffer are formatted into a temporary
+    allocation. buffer_size is in characters and must be at least 2.
+    Returns the number of characters formatted, or -1 on format or write
+    errors.
+
+tprint also accepts compile-time parsed format strings, e.g.
+tprint("hello %\n"_fmt, name), see shl/format_literal.hpp.
+
+put(*pb, x[, err]) and tprint(*pb, fmt, ...) do the same, but write to the
+print_buffer pb instead of a handle.
+
+By default, put and tprint write to the handle directly. After calling
+set_print_buffered(true), printing to stdout_handle() and stderr_handle()
+goes through the print buffers of the calling thread instead, see
+shl/print_buffer.hpp for flush modes.
 */
 
+#include "shl/assert.hpp"
 #include "shl/io.hpp"
 #include "shl/format.hpp"
+#include "shl/print_buffer.hpp"
 
 s64 put(io_handle  h, c8 c,              error *err = nullptr);
 s64 _put(io_handle h, const_string    s, error *err);
@@ -46,6 +69,18 @@ auto put(T str, error *err = nullptr)
     return _put(to_const_string(str), err);
 }
 
+s64 put(print_buffer  *pb, c8 c,              error *err = nullptr);
+s64 _put(print_buffer *pb, const_string    s, error *err);
+s64 _put(print_buffer *pb, const_u16string s, error *err);
+s64 _put(print_buffer *pb, const_u32string s, error *err);
+
+template<typename T>
+auto put(print_buffer *pb, T str, error *err = nullptr)
+    -> decltype(_put(pb, to_const_string(str), err))
+{
+    return _put(pb, to_const_string(str), err);
+}
+
 template<typename C, typename... Ts>
 s64 tprint(io_handle h, const_string_base<C> fmt, Ts &&...args)
 {
@@ -63,10 +98,93 @@ s64 tprint(io_handle h, const C *fmt, Ts &&...args)
     return tprint(h, to_const_string(fmt), forward<Ts>(args)...);
 }
 
+template<typename C, typename... Ts>
+s64 tprint(print_buffer *pb, const_string_base<C> fmt, Ts &&...args)
+{
+    auto res = tformat(fmt, forward<Ts>(args)...);
+
+    if (!res)
+        return -1;
+
+    return put(pb, res);
+}
+
+template<typename C, typename... Ts>
+s64 tprint(print_buffer *pb, const C *fmt, Ts &&...args)
+{
+    return tprint(pb, to_const_string(fmt), forward<Ts>(args)...);
+}
+
+namespace internal
+{
+bool _format_to_io_flush(_format_chunks<c8>  *chunks);
+bool _format_to_io_flush(_format_chunks<c16> *chunks);
+bool _format_to_io_flush(_format_chunks<c32> *chunks);
+}
+
+// buffer_size is a template parameter so that e.g. format_to_io(h, buf, 64, "%", x)
+// is not ambiguous with format_to_io(h, fmt, args...).
+template<typename C, typename N, typename... Ts>
+s64 format_to_io(io_handle h, C *buffer, N buffer_size, const_string_base<C> fmt, Ts &&...args)
+{
+    assert(buffer != nullptr);
+    assert(buffer_size >= 2);
+
+    internal::_format_chunks<C> chunks{};
+    chunks.buffer = buffer;
+    chunks.size = (s64)buffer_size;
+    chunks.flush = internal::_format_to_io_flush;
+    chunks.userdata = (void*)&h;
+
+    s64 written = internal::_format_chunked(&chunks, 0, fmt, forward<Ts>(args)...);
+
+    if (written < 0 || !internal::_format_chunks_flush(&chunks))
+        return -1;
+
+    return written;
+}
+
+template<typename C, typename N, typename... Ts>
+s64 format_to_io(io_handle h, C *buffer, N buffer_size, const C *fmt, Ts &&...args)
+{
+    return format_to_io(h, buffer, buffer_size, to_const_string(fmt), forward<Ts>(args)...);
+}
+
+template<typename C, typename... Ts>
+s64 format_to_io(io_handle h, const_string_base<C> fmt, Ts &&...args)
+{
+    C buffer[FORMAT_CHUNK_BUFFER_SIZE / sizeof(C)];
+    return format_to_io(h, buffer, FORMAT_CHUNK_BUFFER_SIZE / (s64)sizeof(C), fmt, forward<Ts>(args)...);
+}
+
+template<typename C, typename... Ts>
+s64 format_to_io(io_handle h, const C *fmt, Ts &&...args)
+{
+    return format_to_io(h, to_const_string(fmt), forward<Ts>(args)...);
+}
+
+template<format_string_literal Fmt, typename... Ts>
+s64 tprint(io_handle h, fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    return put(h, tformat(fmt, forward<Ts>(args)...));
+}
+
+template<format_string_literal Fmt, typename... Ts>
+s64 tprint(print_buffer *pb, fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    return put(pb, tformat(fmt, forward<Ts>(args)...));
+}
+
+template<format_string_literal Fmt, typename... Ts>
+s64 tprint(fmt_literal<Fmt> fmt, Ts &&...args)
+{
+    return tprint(stdout_handle(), fmt, forward<Ts>(args)...);
+}
+
 template<typename C, typename... Ts>
 s64 tprint(const_string_base<C> fmt, Ts &&...args)
 {
-    return tfprint(stdout_handle(), fmt, forward<Ts>(args)...);
+    return tprint(stdout_handle(), fmt, forward<Ts>(args)...);
 }
 
 template<typename C, typename... Ts>
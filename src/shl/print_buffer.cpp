@@ -0,0 +1,349 @@
+
+#include "shl/assert.hpp"
+#include "shl/array.hpp"
+#include "shl/memory.hpp"
+#include "shl/exit.hpp"
+#include "shl/string_search.hpp"
+#include "shl/program_context.hpp"
+#include "shl/thread.hpp"
+#include "shl/print_buffer.hpp"
+
+static bool _print_buffered = false;
+
+// all initialized print buffers, so they can be flushed at exit
+static array<print_buffer*> _print_buffers{};
+static s32 _print_buffers_lock = 0;
+
+static void _lock_print_buffers()
+{
+    while (__atomic_exchange_n(&_print_buffers_lock, 1, __ATOMIC_ACQUIRE) != 0)
+        while (__atomic_load_n(&_print_buffers_lock, __ATOMIC_RELAXED) != 0)
+            ;
+}
+
+static void _unlock_print_buffers()
+{
+    __atomic_store_n(&_print_buffers_lock, 0, __ATOMIC_RELEASE);
+}
+
+// the buffers are flushed at exit while other threads may still write to them
+static void _lock_print_buffer(print_buffer *pb)
+{
+    while (__atomic_exchange_n(&pb->lock, 1, __ATOMIC_ACQUIRE) != 0)
+        while (__atomic_load_n(&pb->lock, __ATOMIC_RELAXED) != 0)
+            ;
+}
+
+static void _unlock_print_buffer(print_buffer *pb)
+{
+    __atomic_store_n(&pb->lock, 0, __ATOMIC_RELEASE);
+}
+
+static bool _flush(print_buffer *pb, error *err);
+
+static void _flush_print_buffers_at_exit()
+{
+    _lock_print_buffers();
+
+    for_array(pb, &_print_buffers)
+        if ((*pb)->flush_at_exit)
+        {
+            _lock_print_buffer(*pb);
+            _flush(*pb, nullptr);
+            _unlock_print_buffer(*pb);
+        }
+
+    _unlock_print_buffers();
+}
+
+static void _register_print_buffer(print_buffer *pb)
+{
+    _lock_print_buffers();
+
+    if (_print_buffers.data == nullptr)
+    {
+        with_allocator(default_allocator)
+            init(&_print_buffers);
+
+        register_exit_function(_flush_print_buffers_at_exit);
+    }
+
+    with_allocator(default_allocator)
+        add_at_end(&_print_buffers, pb);
+
+    _unlock_print_buffers();
+}
+
+static void _unregister_print_buffer(print_buffer *pb)
+{
+    _lock_print_buffers();
+
+    s64 idx = index_of(&_print_buffers, pb);
+
+    if (idx != -1)
+        remove_elements(&_print_buffers, idx, 1);
+
+    _unlock_print_buffers();
+}
+
+void init(print_buffer *pb, io_handle h, print_flush_mode mode, s64 capacity)
+{
+    assert(pb != nullptr);
+    assert(capacity > 0);
+
+    pb->handle = h;
+    pb->allocator = get_context_pointer()->allocator;
+    pb->data = (c8*)allocator_alloc(pb->allocator, capacity);
+    pb->size = 0;
+    pb->capacity = capacity;
+    pb->flush_size = capacity;
+    pb->mode = mode;
+    pb->flush_at_exit = true;
+    pb->lock = 0;
+
+    _register_print_buffer(pb);
+}
+
+void free(print_buffer *pb)
+{
+    assert(pb != nullptr);
+
+    if (pb->data == nullptr)
+        return;
+
+    _unregister_print_buffer(pb);
+
+    _lock_print_buffer(pb);
+    _flush(pb, nullptr);
+    _unlock_print_buffer(pb);
+
+    allocator_dealloc(pb->allocator, pb->data, pb->capacity);
+    pb->data = nullptr;
+    pb->size = 0;
+    pb->capacity = 0;
+}
+
+// writes all buffers, retrying partial writes
+static bool _write_all(io_handle h, io_write_buffer *buffers, s64 count, error *err)
+{
+    s64 first = 0;
+
+    while (first < count)
+    {
+        s64 written = io_write_gather(h, buffers + first, count - first, err);
+
+        if (written <= 0)
+            return false;
+
+        while (first < count && written >= buffers[first].size)
+        {
+            written -= buffers[first].size;
+            first += 1;
+        }
+
+        if (first < count)
+        {
+            buffers[first].data = (const c8*)buffers[first].data + written;
+            buffers[first].size -= written;
+        }
+    }
+
+    return true;
+}
+
+// writes the first size bytes of the buffer and moves the rest to the front
+static bool _flush_front(print_buffer *pb, s64 size, error *err)
+{
+    io_write_buffer buffer{.data = pb->data, .size = size};
+    bool ok = _write_all(pb->handle, &buffer, 1, err);
+
+    if (!ok)
+    {
+        pb->size = 0;
+        return false;
+    }
+
+    if (size < pb->size)
+        move_memory(pb->data + size, pb->data, pb->size - size);
+
+    pb->size -= size;
+
+    return true;
+}
+
+static bool _flush(print_buffer *pb, error *err)
+{
+    if (pb->size == 0)
+        return true;
+
+    return _flush_front(pb, pb->size, err);
+}
+
+bool flush(print_buffer *pb, error *err)
+{
+    assert(pb != nullptr);
+
+    _lock_print_buffer(pb);
+    bool ok = _flush(pb, err);
+    _unlock_print_buffer(pb);
+
+    return ok;
+}
+
+static s64 _print_buffer_write(print_buffer *pb, const c8 *data, s64 size, error *err)
+{
+    if (pb->size + size > pb->capacity)
+    {
+        if (size >= pb->capacity)
+        {
+            io_write_buffer buffers[2] = {
+                {.data = pb->data, .size = pb->size},
+                {.data = data,     .size = size}
+            };
+
+            bool ok = pb->size > 0 ? _write_all(pb->handle, buffers, 2, err)
+                                   : _write_all(pb->handle, buffers + 1, 1, err);
+            pb->size = 0;
+
+            return ok ? size : -1;
+        }
+
+        if (!_flush(pb, err))
+            return -1;
+    }
+
+    copy_memory(data, pb->data + pb->size, size);
+    pb->size += size;
+
+    switch (pb->mode)
+    {
+    case print_flush_mode::on_newline:
+    {
+        s64 last_newline = search_last_unit(data, size, '\n');
+
+        if (last_newline >= 0 && !_flush_front(pb, pb->size - size + last_newline + 1, err))
+            return -1;
+
+        break;
+    }
+    case print_flush_mode::on_size:
+        if (pb->size >= pb->flush_size && !_flush(pb, err))
+            return -1;
+
+        break;
+    case print_flush_mode::manual:
+        break;
+    }
+
+    return size;
+}
+
+s64 print_buffer_write(print_buffer *pb, const c8 *data, s64 size, error *err)
+{
+    assert(pb != nullptr);
+    assert(pb->data != nullptr);
+
+    if (size <= 0)
+        return 0;
+
+    _lock_print_buffer(pb);
+    s64 ret = _print_buffer_write(pb, data, size, err);
+    _unlock_print_buffer(pb);
+
+    return ret;
+}
+
+struct _thread_print_buffers
+{
+    print_buffer out;
+    print_buffer err;
+
+    ~_thread_print_buffers()
+    {
+        free(&out);
+        free(&err);
+    }
+};
+
+static thread_local _thread_print_buffers _tl_print_buffers{};
+
+static void _free_slot_print_buffers(void *data)
+{
+    _thread_print_buffers *bufs = (_thread_print_buffers*)data;
+    bufs->~_thread_print_buffers();
+    allocator_dealloc(default_allocator, bufs, sizeof(_thread_print_buffers));
+}
+
+// threads started with thread_start share the thread_local buffers of the
+// thread that created them, so they keep their own in a thread data slot.
+static _thread_print_buffers *_get_thread_print_buffers()
+{
+    thread_data_slot *slot = get_thread_data_slot(THREAD_DATA_SLOT_PRINT_BUFFER);
+
+    if (slot == nullptr)
+        return &_tl_print_buffers;
+
+    if (slot->data == nullptr)
+    {
+        _thread_print_buffers *bufs = (_thread_print_buffers*)allocator_alloc(default_allocator, sizeof(_thread_print_buffers));
+        assert(bufs != nullptr);
+
+        fill_memory(bufs, 0);
+        slot->data = bufs;
+        slot->cleanup = _free_slot_print_buffers;
+    }
+
+    return (_thread_print_buffers*)slot->data;
+}
+
+print_buffer *get_stdout_print_buffer()
+{
+    print_buffer *pb = &_get_thread_print_buffers()->out;
+
+    if (pb->data == nullptr)
+        init(pb, stdout_handle());
+
+    return pb;
+}
+
+print_buffer *get_stderr_print_buffer()
+{
+    print_buffer *pb = &_get_thread_print_buffers()->err;
+
+    if (pb->data == nullptr)
+        init(pb, stderr_handle());
+
+    return pb;
+}
+
+print_buffer *get_print_buffer(io_handle h)
+{
+    if (h == stdout_handle())
+        return get_stdout_print_buffer();
+
+    if (h == stderr_handle())
+        return get_stderr_print_buffer();
+
+    return nullptr;
+}
+
+void set_print_buffered(bool buffered)
+{
+    if (!buffered)
+    {
+        _thread_print_buffers *bufs = _get_thread_print_buffers();
+
+        if (bufs->out.data != nullptr)
+            flush(&bufs->out);
+
+        if (bufs->err.data != nullptr)
+            flush(&bufs->err);
+    }
+
+    __atomic_store_n(&_print_buffered, buffered, __ATOMIC_RELEASE);
+}
+
+bool is_print_buffered()
+{
+    return __atomic_load_n(&_print_buffered, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+/* print_buffer.hpp
+
+Buffered output to an io_handle. Writes are collected in a buffer and written
+to the handle with as few write calls as possible, depending on the flush
+mode of the buffer:
+
+print_flush_mode::on_newline
+    Writes all complete lines whenever a write contains a newline, keeping
+    the incomplete last line in the buffer. Lines of different threads
+    therefore never interleave, as long as lines fit into the buffer.
+print_flush_mode::on_size
+    Writes the buffer once it contains at least flush_size bytes.
+print_flush_mode::manual
+    Only writes the buffer when flush() is called.
+
+Independent of the mode, the buffer is written when a write does not fit
+into it anymore. Writes that are larger than the buffer are written
+directly together with the buffered bytes, using a single gather write.
+
+If flush_at_exit is set (the default), the buffer is flushed when the
+process exits through exit() or by returning from main, using
+register_exit_function. exit_process does not flush buffers.
+print_buffer_write, flush and free lock the buffer, so a buffer may be written
+to by several threads, and flushing at exit does not race with threads that
+are still writing.
+
+Printing with put and tprint (see shl/print.hpp) is unbuffered by default.
+set_print_buffered(true) routes all put and tprint calls that print to
+stdout_handle() or stderr_handle() through the print buffers of the
+calling thread, which are returned by get_stdout_print_buffer() and
+get_stderr_print_buffer(). Every thread has its own print buffers, which
+are created on first use with the on_newline mode and are flushed and freed
+when the thread exits. Threads started with thread_start keep them in their
+thread data slots (see shl/thread.hpp).
+To print to other handles with a buffer, create a print_buffer and use the
+put(*pb, ...) and tprint(*pb, ...) overloads.
+
+Example:
+
+    set_print_buffered(true);
+
+    for (s64 i = 0; i < 100000; ++i)
+        tprint("line %\n", i);  // one write per buffer, not per line
+
+    get_stdout_print_buffer()->mode = print_flush_mode::manual;
+    put("not written yet");
+    flush(get_stdout_print_buffer());
+
+Functions:
+
+init(*pb, Handle[, Mode[, Capacity]])
+    initializes pb to buffer up to Capacity (default
+    print_buffer_default_capacity) bytes for Handle, flushing with Mode
+    (default on_newline). flush_size is set to Capacity.
+free(*pb)   flushes pb and frees its buffer.
+
+print_buffer_write(*pb, *data, Size[, *err])
+    buffers or writes Size bytes of data. Returns Size on success, or -1 if
+    writing to the handle failed, in which case the buffered bytes are
+    discarded.
+
+flush(*pb[, *err])  writes all buffered bytes to the handle. Returns false
+                    on error.
+
+get_stdout_print_buffer()   returns the stdout print buffer of the thread.
+get_stderr_print_buffer()   returns the stderr print buffer of the thread.
+get_print_buffer(Handle)    returns the print buffer of the thread for
+                            Handle if Handle is stdout_handle() or
+                            stderr_handle(), otherwise nullptr.
+
+set_print_buffered(Bool)    enables or disables buffering of put and
+                            tprint to stdout and stderr for all threads.
+                            Disabling flushes the buffers of the calling
+                            thread.
+is_print_buffered()         returns whether put and tprint are buffered.
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/allocator.hpp"
+#include "shl/error.hpp"
+#include "shl/io.hpp"
+
+#ifndef print_buffer_default_capacity
+#define print_buffer_default_capacity 8192
+#endif
+
+enum class print_flush_mode : u8
+{
+    on_newline,
+    on_size,
+    manual
+};
+
+struct print_buffer
+{
+    io_handle handle;
+    c8 *data;
+    s64 size;
+    s64 capacity;
+    s64 flush_size;
+    print_flush_mode mode;
+    bool flush_at_exit;
+    s32 lock;
+    ::allocator allocator;
+};
+
+void init(print_buffer *pb, io_handle h, print_flush_mode mode = print_flush_mode::on_newline, s64 capacity = print_buffer_default_capacity);
+void free(print_buffer *pb);
+
+s64 print_buffer_write(print_buffer *pb, const c8 *data, s64 size, error *err = nullptr);
+bool flush(print_buffer *pb, error *err = nullptr);
+
+print_buffer *get_stdout_print_buffer();
+print_buffer *get_stderr_print_buffer();
+print_buffer *get_print_buffer(io_handle h);
+
+void set_print_buffered(bool buffered);
+bool is_print_buffered();
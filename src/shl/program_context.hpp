@@ -6,8 +6,8 @@
 Defines the program_context struct, along with functions to access, modify and
 set the program context.
 
-program_context contains the (thread global) allocator, (future) logger and thread
-and user-supplied information.
+program_context contains the (thread global) allocator, logger (see
+shl/logger.hpp, nullptr by default) and thread and user-supplied information.
 
 By default, the program context is set to the default program_context which uses
 the default allocator (see shl/allocator.hpp).
@@ -46,6 +46,8 @@ set_context_pointer(*ctx)
 #include "shl/macros.hpp"
 #include "shl/defer.hpp"
 
+struct logger; // in shl/logger.hpp
+
 struct program_context
 {
     s32 thread_id;
@@ -55,14 +57,15 @@ struct program_context
     ::allocator allocator;
     ::allocator thread_storage_allocator;
 
-    // TODO: logger
+    ::logger *logger;
 };
 
 const program_context default_context{
     .thread_id = 0,
     .user_data = nullptr,
     .allocator = default_allocator,
-    .thread_storage_allocator = null_allocator
+    .thread_storage_allocator = null_allocator,
+    .logger = nullptr
 };
 
 program_context *get_context_pointer();
@@ -87,7 +90,8 @@ program_context *set_context_pointer(program_context *next);
               .thread_id = JOIN(_old_ptr, Line)->thread_id,\
               .user_data = JOIN(_old_ptr, Line)->user_data,\
               .allocator = (NewAlloc),\
-              .thread_storage_allocator = JOIN(_old_ptr, Line)->thread_storage_allocator\
+              .thread_storage_allocator = JOIN(_old_ptr, Line)->thread_storage_allocator,\
+              .logger = JOIN(_old_ptr, Line)->logger\
           }; true)\
       if constexpr ([[maybe_unused]] program_context *_toss##Line = set_context_pointer(&JOIN(_nctx, Line)); true)
 
@@ -0,0 +1,748 @@
+#pragma once
+
+/* rope.hpp
+
+String type for large texts that are edited often. Inserting into or removing
+from a string moves everything behind the edit, a rope stores its text in
+chunks of up to rope_chunk_size units which are kept in a balanced tree
+(a treap ordered by position), so inserting, removing, finding a position,
+splitting and concatenating are O(log n) in the number of chunks.
+
+    template<typename C>
+    struct rope_base
+    {
+        rope_node<C> *root;
+        s64 size;       // units, not codepoints or characters
+        u64 seed;       // state of the node priority generator
+        allocator allocator;
+    }
+
+    typedef rope_base<c8>  rope;
+    typedef rope_base<c16> u16rope;
+    typedef rope_base<c32> u32rope;
+
+Every node holds one chunk and the total number of units of its subtree.
+Small edits are done inside the chunk at the edit position if it has room
+(or enough units to remove), which only updates the sizes of the nodes on
+the path to the root. Larger edits split the tree at the edit position and
+merge the new chunks in. Removing and splitting merge chunks that became
+smaller than half of rope_chunk_size with their neighbours if both fit into
+one chunk.
+A zero-initialized rope may be used like an initialized one, the allocator
+and the seed are set on the first insertion.
+
+Example usage:
+
+    rope doc{};
+    init(&doc, "hello world");
+
+    rope_insert(&doc, 5, ",");         // "hello, world"
+    rope_remove(&doc, 0, 7);           // "world"
+    rope_append(&doc, "!");            // "world!"
+
+    for_rope_chunks(span, &doc)
+        put(span);                     // span is a const_string
+
+    string s = rope_to_string(&doc);   // "world!"
+
+    free(&s);
+    free(&doc);
+
+Functions:
+
+init(*rope)         initializes an empty rope.
+init(*rope, Str)    initializes a rope with the contents of Str.
+free(*rope)         frees all chunks of the rope.
+clear(*rope)        same as free, the rope can be used again afterwards.
+
+rope_insert(*rope, Pos, Str)    inserts Str at unit position Pos.
+rope_append(*rope, Str)         inserts Str at the end of the rope.
+rope_prepend(*rope, Str)        inserts Str at the start of the rope.
+rope_remove(*rope, Pos, N)      removes N units starting at Pos.
+    Pos is clamped to [0, rope.size], N to the number of units after Pos.
+    These (and init with Str and rope_split) return false if a chunk could
+    not be allocated, in which case the rope is unchanged.
+
+rope_at(*rope, Pos)             returns the unit at position Pos.
+
+rope_split(*rope, Pos, *out)    moves all units from Pos onwards into out,
+                                replacing the contents of out. O(log n).
+rope_concat(*rope, *other)      moves all units of other to the end of rope,
+                                leaving other empty. O(log n).
+                                Both ropes must use the same allocator.
+
+rope_substring(*rope, Pos, N, *out)
+    sets the string out to the N units starting at Pos, finding Pos in O(log n).
+rope_to_string(*rope)           returns a new string with the contents of rope.
+rope_to_string(*rope, *out)     sets the string out to the contents of rope.
+    The conversions reserve the size of out once and copy chunk by chunk.
+
+for_rope_chunks(Span, *rope)
+    iterates the chunks of rope in order, Span is a const_string_base<C>
+    of the units of the chunk.
+ */
+
+#include "shl/assert.hpp"
+#include "shl/number_types.hpp"
+#include "shl/program_context.hpp"
+#include "shl/memory.hpp"
+#include "shl/string.hpp"
+
+#ifndef rope_chunk_size
+#define rope_chunk_size 512
+#endif
+
+#define rope_default_seed 0x9e3779b97f4a7c15ull
+
+template<typename C>
+struct rope_node
+{
+    rope_node<C> *left;
+    rope_node<C> *right;
+    rope_node<C> *parent;
+    u64 priority;
+    s64 total_size; // units of the whole subtree
+    s64 size;       // units in data
+    C data[rope_chunk_size];
+};
+
+template<typename C>
+struct rope_base
+{
+    typedef C value_type;
+    typedef rope_node<C> node_type;
+
+    rope_node<C> *root;
+    s64 size;
+    u64 seed;
+    ::allocator allocator;
+};
+
+typedef rope_base<c8>  rope;
+typedef rope_base<c16> u16rope;
+typedef rope_base<c32> u32rope;
+
+template<typename C>
+inline s64 _rope_total_size(const rope_node<C> *n)
+{
+    return n != nullptr ? n->total_size : 0;
+}
+
+// recalculates the total size of n and sets the parent of its children.
+template<typename C>
+inline void _rope_update(rope_node<C> *n)
+{
+    n->total_size = _rope_total_size(n->left) + n->size + _rope_total_size(n->right);
+
+    if (n->left != nullptr)  n->left->parent = n;
+    if (n->right != nullptr) n->right->parent = n;
+}
+
+// xorshift64*, the seed is never 0.
+template<typename C>
+u64 _rope_next_random(rope_base<C> *r)
+{
+    r->seed ^= r->seed >> 12;
+    r->seed ^= r->seed << 25;
+    r->seed ^= r->seed >> 27;
+
+    return r->seed * 0x2545f4914f6cdd1dull;
+}
+
+template<typename C>
+rope_node<C> *_rope_new_node(rope_base<C> *r, const C *data, s64 size)
+{
+    assert(size >= 0 && size <= rope_chunk_size);
+    assert(r->seed != 0);
+
+    rope_node<C> *n = (rope_node<C>*)allocator_alloc(r->allocator, sizeof(rope_node<C>));
+
+    if (n == nullptr)
+        return nullptr;
+
+    n->left = nullptr;
+    n->right = nullptr;
+    n->parent = nullptr;
+    n->priority = _rope_next_random(r);
+    n->total_size = size;
+    n->size = size;
+
+    if (size > 0)
+        copy_memory(data, n->data, size * sizeof(C));
+
+    return n;
+}
+
+template<typename C>
+void _rope_free_nodes(rope_base<C> *r, rope_node<C> *n)
+{
+    if (n == nullptr)
+        return;
+
+    _rope_free_nodes(r, n->left);
+    _rope_free_nodes(r, n->right);
+    allocator_dealloc(r->allocator, n, sizeof(rope_node<C>));
+}
+
+template<typename C>
+rope_node<C> *_rope_merge(rope_node<C> *a, rope_node<C> *b)
+{
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+
+    if (a->priority > b->priority)
+    {
+        a->right = _rope_merge(a->right, b);
+        _rope_update(a);
+        return a;
+    }
+    else
+    {
+        b->left = _rope_merge(a, b->left);
+        _rope_update(b);
+        return b;
+    }
+}
+
+// splits n into the first pos units (*out_left) and the rest (*out_right).
+// If pos is inside a chunk, the units of the chunk after pos are moved into
+// *spare (see _rope_alloc_split_node), which is set to nullptr.
+template<typename C>
+void _rope_split(rope_base<C> *r, rope_node<C> *n, s64 pos, rope_node<C> **out_left, rope_node<C> **out_right, rope_node<C> **spare)
+{
+    if (n == nullptr)
+    {
+        *out_left = nullptr;
+        *out_right = nullptr;
+        return;
+    }
+
+    s64 left_size = _rope_total_size(n->left);
+
+    if (pos <= left_size)
+    {
+        rope_node<C> *right_of_left;
+        _rope_split(r, n->left, pos, out_left, &right_of_left, spare);
+        n->left = right_of_left;
+        _rope_update(n);
+        *out_right = n;
+    }
+    else if (pos >= left_size + n->size)
+    {
+        rope_node<C> *left_of_right;
+        _rope_split(r, n->right, pos - left_size - n->size, &left_of_right, out_right, spare);
+        n->right = left_of_right;
+        _rope_update(n);
+        *out_left = n;
+    }
+    else
+    {
+        // pos is inside the chunk of n
+        s64 cut = pos - left_size;
+        rope_node<C> *tail = *spare;
+        rope_node<C> *right = n->right;
+        assert(tail != nullptr);
+
+        *spare = nullptr;
+        copy_memory(n->data + cut, tail->data, (n->size - cut) * sizeof(C));
+        tail->size = n->size - cut;
+        tail->total_size = tail->size;
+
+        n->size = cut;
+        n->right = nullptr;
+        _rope_update(n);
+
+        *out_left = n;
+        *out_right = _rope_merge(tail, right);
+    }
+}
+
+// finds the node containing unit position pos and the offset of pos within
+// the node. if pos is at the boundary of two chunks, the node before the
+// boundary is returned (offset == node->size).
+template<typename C>
+rope_node<C> *_rope_find(const rope_base<C> *r, s64 pos, s64 *out_offset)
+{
+    rope_node<C> *n = r->root;
+
+    while (n != nullptr)
+    {
+        s64 left_size = _rope_total_size(n->left);
+
+        if (pos < left_size || (pos == left_size && n->left != nullptr))
+            n = n->left;
+        else if (pos <= left_size + n->size)
+        {
+            *out_offset = pos - left_size;
+            return n;
+        }
+        else
+        {
+            pos -= left_size + n->size;
+            n = n->right;
+        }
+    }
+
+    return nullptr;
+}
+
+template<typename C>
+rope_node<C> *_rope_first_node(const rope_base<C> *r)
+{
+    rope_node<C> *n = r->root;
+
+    if (n == nullptr)
+        return nullptr;
+
+    while (n->left != nullptr)
+        n = n->left;
+
+    return n;
+}
+
+template<typename C>
+rope_node<C> *_rope_next_node(rope_node<C> *n)
+{
+    if (n->right != nullptr)
+    {
+        n = n->right;
+
+        while (n->left != nullptr)
+            n = n->left;
+
+        return n;
+    }
+
+    while (n->parent != nullptr && n->parent->right == n)
+        n = n->parent;
+
+    return n->parent;
+}
+
+template<typename C>
+inline void _rope_add_to_path(rope_node<C> *n, s64 delta)
+{
+    for (; n != nullptr; n = n->parent)
+        n->total_size += delta;
+}
+
+template<typename C>
+rope_node<C> *_rope_last_node(const rope_base<C> *r)
+{
+    rope_node<C> *n = r->root;
+
+    if (n == nullptr)
+        return nullptr;
+
+    while (n->right != nullptr)
+        n = n->right;
+
+    return n;
+}
+
+template<typename C>
+rope_node<C> *_rope_prev_node(rope_node<C> *n)
+{
+    if (n->left != nullptr)
+    {
+        n = n->left;
+
+        while (n->right != nullptr)
+            n = n->right;
+
+        return n;
+    }
+
+    while (n->parent != nullptr && n->parent->left == n)
+        n = n->parent;
+
+    return n->parent;
+}
+
+// allocates the node that _rope_split needs if pos is inside a chunk.
+// returns false if the node could not be allocated.
+template<typename C>
+bool _rope_alloc_split_node(rope_base<C> *r, s64 pos, rope_node<C> **out)
+{
+    s64 offset = 0;
+    rope_node<C> *n = _rope_find(r, pos, &offset);
+
+    *out = nullptr;
+
+    if (n == nullptr || offset == 0 || offset >= n->size)
+        return true;
+
+    *out = _rope_new_node(r, (const C*)nullptr, 0);
+    return *out != nullptr;
+}
+
+// removes the node n from the tree of r and frees it.
+template<typename C>
+void _rope_remove_node(rope_base<C> *r, rope_node<C> *n)
+{
+    rope_node<C> *parent = n->parent;
+    rope_node<C> *sub = _rope_merge(n->left, n->right);
+
+    if (sub != nullptr)
+        sub->parent = parent;
+
+    if (parent == nullptr)
+        r->root = sub;
+    else if (parent->left == n)
+        parent->left = sub;
+    else
+        parent->right = sub;
+
+    _rope_add_to_path(parent, -n->size);
+    allocator_dealloc(r->allocator, n, sizeof(rope_node<C>));
+}
+
+// moves the chunk after n into n if one of them is smaller than half a chunk
+// and both fit into one chunk.
+template<typename C>
+void _rope_merge_with_next(rope_base<C> *r, rope_node<C> *n)
+{
+    if (n == nullptr)
+        return;
+
+    rope_node<C> *next = _rope_next_node(n);
+
+    if (next == nullptr
+     || (n->size >= rope_chunk_size / 2 && next->size >= rope_chunk_size / 2)
+     || n->size + next->size > rope_chunk_size)
+        return;
+
+    copy_memory(next->data, n->data + n->size, next->size * sizeof(C));
+    n->size += next->size;
+    _rope_add_to_path(n, next->size);
+    _rope_remove_node(r, next);
+}
+
+template<typename C>
+inline void _rope_set_defaults_if_not_set(rope_base<C> *r)
+{
+    _set_allocator_if_not_set(r);
+
+    if (r->seed == 0)
+        r->seed = rope_default_seed;
+}
+
+template<typename C>
+void init(rope_base<C> *r)
+{
+    assert(r != nullptr);
+
+    r->root = nullptr;
+    r->size = 0;
+    r->seed = rope_default_seed;
+    r->allocator = get_context_pointer()->allocator;
+}
+
+template<typename C>
+void free(rope_base<C> *r)
+{
+    assert(r != nullptr);
+
+    _rope_free_nodes(r, r->root);
+    r->root = nullptr;
+    r->size = 0;
+}
+
+template<typename C>
+void clear(rope_base<C> *r)
+{
+    free(r);
+}
+
+template<typename C>
+bool _rope_insert(rope_base<C> *r, s64 pos, const_string_base<C> str)
+{
+    assert(r != nullptr);
+
+    if (str.size <= 0)
+        return true;
+
+    if (pos < 0)       pos = 0;
+    if (pos > r->size) pos = r->size;
+
+    _rope_set_defaults_if_not_set(r);
+
+    s64 offset = 0;
+    rope_node<C> *n = _rope_find(r, pos, &offset);
+
+    if (n != nullptr && n->size + str.size <= rope_chunk_size)
+    {
+        // fits into the chunk at pos
+        move_memory(n->data + offset, n->data + offset + str.size, (n->size - offset) * sizeof(C));
+        copy_memory(str.c_str, n->data + offset, str.size * sizeof(C));
+        n->size += str.size;
+        _rope_add_to_path(n, str.size);
+        r->size += str.size;
+        return true;
+    }
+
+    rope_node<C> *middle = nullptr;
+    rope_node<C> *spare = nullptr;
+
+    for (s64 i = 0; i < str.size; i += rope_chunk_size)
+    {
+        s64 chunk_size = Min((s64)rope_chunk_size, str.size - i);
+        rope_node<C> *chunk = _rope_new_node(r, str.c_str + i, chunk_size);
+
+        if (chunk == nullptr)
+        {
+            _rope_free_nodes(r, middle);
+            return false;
+        }
+
+        middle = _rope_merge(middle, chunk);
+    }
+
+    if (!_rope_alloc_split_node(r, pos, &spare))
+    {
+        _rope_free_nodes(r, middle);
+        return false;
+    }
+
+    rope_node<C> *left;
+    rope_node<C> *right;
+    _rope_split(r, r->root, pos, &left, &right, &spare);
+
+    r->root = _rope_merge(_rope_merge(left, middle), right);
+    r->root->parent = nullptr;
+    r->size += str.size;
+
+    return true;
+}
+
+template<typename C>
+bool rope_remove(rope_base<C> *r, s64 pos, s64 count)
+{
+    assert(r != nullptr);
+
+    if (pos < 0)       pos = 0;
+    if (pos > r->size) pos = r->size;
+    if (count > r->size - pos) count = r->size - pos;
+
+    if (count <= 0)
+        return true;
+
+    s64 offset = 0;
+    rope_node<C> *n = _rope_find(r, pos, &offset);
+
+    if (n != nullptr && offset == n->size)
+    {
+        n = _rope_next_node(n);
+        offset = 0;
+    }
+
+    if (n != nullptr && offset + count <= n->size && count < n->size)
+    {
+        // only removes units inside the chunk at pos, without emptying it
+        move_memory(n->data + offset + count, n->data + offset, (n->size - offset - count) * sizeof(C));
+        n->size -= count;
+        _rope_add_to_path(n, -count);
+        r->size -= count;
+
+        rope_node<C> *prev = _rope_prev_node(n);
+        _rope_merge_with_next(r, n);
+        _rope_merge_with_next(r, prev);
+
+        return true;
+    }
+
+    // both split positions are looked up before splitting, pos + count is in
+    // the same chunk in the whole rope as in the part after pos.
+    rope_node<C> *spare_start = nullptr;
+    rope_node<C> *spare_end = nullptr;
+
+    if (!_rope_alloc_split_node(r, pos, &spare_start))
+        return false;
+
+    if (!_rope_alloc_split_node(r, pos + count, &spare_end))
+    {
+        _rope_free_nodes(r, spare_start);
+        return false;
+    }
+
+    rope_node<C> *left;
+    rope_node<C> *middle;
+    rope_node<C> *right;
+    _rope_split(r, r->root, pos, &left, &right, &spare_start);
+    _rope_split(r, right, count, &middle, &right, &spare_end);
+    _rope_free_nodes(r, middle);
+
+    if (left != nullptr)  left->parent = nullptr;
+    if (right != nullptr) right->parent = nullptr;
+
+    rope_node<C> *last_of_left = left;
+
+    while (last_of_left != nullptr && last_of_left->right != nullptr)
+        last_of_left = last_of_left->right;
+
+    r->root = _rope_merge(left, right);
+
+    if (r->root != nullptr)
+        r->root->parent = nullptr;
+
+    r->size -= count;
+
+    _rope_merge_with_next(r, last_of_left);
+
+    return true;
+}
+
+template<typename C, typename T>
+auto init(rope_base<C> *r, T str)
+    -> decltype(_rope_insert(r, 0, to_const_string(str)))
+{
+    init(r);
+    return _rope_insert(r, 0, to_const_string(str));
+}
+
+template<typename C, typename T>
+auto rope_insert(rope_base<C> *r, s64 pos, T str)
+    -> decltype(_rope_insert(r, pos, to_const_string(str)))
+{
+    return _rope_insert(r, pos, to_const_string(str));
+}
+
+template<typename C, typename T>
+auto rope_append(rope_base<C> *r, T str)
+    -> decltype(_rope_insert(r, 0, to_const_string(str)))
+{
+    return _rope_insert(r, r->size, to_const_string(str));
+}
+
+template<typename C, typename T>
+auto rope_prepend(rope_base<C> *r, T str)
+    -> decltype(_rope_insert(r, 0, to_const_string(str)))
+{
+    return _rope_insert(r, 0, to_const_string(str));
+}
+
+template<typename C>
+C rope_at(const rope_base<C> *r, s64 pos)
+{
+    assert(r != nullptr);
+    assert(pos >= 0 && pos < r->size);
+
+    s64 offset = 0;
+    rope_node<C> *n = _rope_find(r, pos, &offset);
+
+    // pos at the end of a chunk is the first unit of the next chunk
+    while (offset >= n->size)
+    {
+        offset -= n->size;
+        n = _rope_next_node(n);
+    }
+
+    return n->data[offset];
+}
+
+template<typename C>
+bool rope_split(rope_base<C> *r, s64 pos, rope_base<C> *out)
+{
+    assert(r != nullptr);
+    assert(out != nullptr);
+
+    if (pos < 0)       pos = 0;
+    if (pos > r->size) pos = r->size;
+
+    _rope_set_defaults_if_not_set(r);
+
+    rope_node<C> *spare = nullptr;
+
+    if (!_rope_alloc_split_node(r, pos, &spare))
+        return false;
+
+    free(out);
+    out->allocator = r->allocator;
+    out->seed = _rope_next_random(r);
+
+    rope_node<C> *left;
+    rope_node<C> *right;
+    _rope_split(r, r->root, pos, &left, &right, &spare);
+
+    if (left != nullptr)  left->parent = nullptr;
+    if (right != nullptr) right->parent = nullptr;
+
+    out->root = right;
+    out->size = r->size - pos;
+    r->root = left;
+    r->size = pos;
+
+    // the chunks at the split position may be small now
+    rope_node<C> *last = _rope_last_node(r);
+
+    if (last != nullptr)
+        _rope_merge_with_next(r, _rope_prev_node(last));
+
+    _rope_merge_with_next(out, _rope_first_node(out));
+
+    return true;
+}
+
+template<typename C>
+void rope_concat(rope_base<C> *r, rope_base<C> *other)
+{
+    assert(r != nullptr);
+    assert(other != nullptr);
+
+    r->root = _rope_merge(r->root, other->root);
+
+    if (r->root != nullptr)
+        r->root->parent = nullptr;
+
+    r->size += other->size;
+    other->root = nullptr;
+    other->size = 0;
+}
+
+template<typename C>
+void rope_substring(const rope_base<C> *r, s64 pos, s64 count, string_base<C> *out)
+{
+    assert(r != nullptr);
+    assert(out != nullptr);
+
+    if (pos < 0)       pos = 0;
+    if (pos > r->size) pos = r->size;
+    if (count > r->size - pos) count = r->size - pos;
+    if (count < 0)     count = 0;
+
+    string_reserve(out, count);
+    out->size = count;
+    out->data[count] = (C)'\0';
+
+    s64 offset = 0;
+    s64 written = 0;
+    rope_node<C> *n = _rope_find(r, pos, &offset);
+
+    while (n != nullptr && written < count)
+    {
+        s64 n_copy = Min(n->size - offset, count - written);
+        copy_memory(n->data + offset, out->data + written, n_copy * sizeof(C));
+        written += n_copy;
+        offset = 0;
+        n = _rope_next_node(n);
+    }
+}
+
+template<typename C>
+void rope_to_string(const rope_base<C> *r, string_base<C> *out)
+{
+    rope_substring(r, 0, r->size, out);
+}
+
+template<typename C>
+string_base<C> rope_to_string(const rope_base<C> *r)
+{
+    string_base<C> ret{};
+    init(&ret);
+    rope_to_string(r, &ret);
+    return ret;
+}
+
+#define for_rope_chunks(S_Var, ROPE)\
+    for (auto *S_Var##_node = _rope_first_node(ROPE); S_Var##_node != nullptr; S_Var##_node = _rope_next_node(S_Var##_node))\
+    if constexpr (auto S_Var = to_const_string(S_Var##_node->data, S_Var##_node->size); true)
@@ -0,0 +1,149 @@
+
+#include "shl/serialize.hpp"
+
+s64 write_varint(u8 *out, u64 x)
+{
+    s64 n = 0;
+
+    while (x >= 0x80)
+    {
+        out[n++] = (u8)(x | 0x80);
+        x >>= 7;
+    }
+
+    out[n++] = (u8)x;
+    return n;
+}
+
+s64 read_varint(const u8 *in, s64 size, u64 *out)
+{
+    u64 x = 0;
+
+    if (size > VARINT_MAX_SIZE)
+        size = VARINT_MAX_SIZE;
+
+    for (s64 i = 0; i < size; ++i)
+    {
+        u64 b = in[i];
+
+        // the 10th byte may only hold the highest bit of a u64
+        if (i == VARINT_MAX_SIZE - 1 && b > 1)
+            return 0;
+
+        x |= (b & 0x7f) << (7 * i);
+
+        if ((b & 0x80) == 0)
+        {
+            *out = x;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+void internal::_serialize_end_of_data(error *err)
+{
+    set_error(err, 61 /* enodata */, "Unexpected end of data");
+}
+
+void internal::_serialize_invalid_varint(error *err)
+{
+    set_error(err, 74 /* ebadmsg */, "Invalid varint");
+}
+
+bool internal::_serialize_write(memory_stream *s, const void *in, s64 size, error *err)
+{
+    if (size == 0)
+        return true;
+
+    if (s->size - s->position < size)
+    {
+        set_error(err, 28 /* enospc */, "Stream is full");
+        return false;
+    }
+
+    copy_memory(in, s->data + s->position, size);
+    s->position += size;
+    return true;
+}
+
+bool internal::_serialize_write(file_stream *s, const void *in, s64 size, error *err)
+{
+    if (size == 0)
+        return true;
+
+    s64 written = write(s, in, size, err);
+
+    if (written == size)
+        return true;
+
+    if (written >= 0)
+        set_error(err, 28 /* enospc */, "Could not write entire data");
+
+    return false;
+}
+
+bool internal::_serialize_read(memory_stream *s, void *out, s64 size, error *err)
+{
+    if (size == 0)
+        return true;
+
+    if (s->size - s->position < size)
+    {
+        _serialize_end_of_data(err);
+        return false;
+    }
+
+    copy_memory(s->data + s->position, out, size);
+    s->position += size;
+    return true;
+}
+
+bool internal::_serialize_read(file_stream *s, void *out, s64 size, error *err)
+{
+    if (size == 0)
+        return true;
+
+    s64 bytes_read = read(s, out, size, err);
+
+    if (bytes_read == size)
+        return true;
+
+    if (bytes_read >= 0)
+        _serialize_end_of_data(err);
+
+    return false;
+}
+
+bool internal::_deserialize_varint(memory_stream *s, u64 *out, error *err)
+{
+    s64 size = s->size - s->position;
+
+    if (size <= 0)
+    {
+        _serialize_end_of_data(err);
+        return false;
+    }
+
+    s64 n = read_varint((const u8*)s->data + s->position, size, out);
+
+    if (n == 0)
+    {
+        // all bytes up to the end have the high bit set
+        if (size < VARINT_MAX_SIZE)
+            _serialize_end_of_data(err);
+        else
+            _serialize_invalid_varint(err);
+
+        return false;
+    }
+
+    s->position += n;
+    return true;
+}
+
+s64 internal::_deserialize_remaining(memory_stream *s)
+{
+    return s->size - s->position;
+}
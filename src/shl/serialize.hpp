@@ -0,0 +1,645 @@
+#pragma once
+
+/* serialize.hpp
+
+Binary serialization of numbers, strings and containers to and from streams,
+the binary counterpart of to_string in shl/format.hpp.
+
+serialize(Stream, *x) writes x to Stream, deserialize(Stream, *out) reads a
+value written by serialize back into out. Stream is a memory_stream* or a
+file_stream*, or any type for which write(Stream, *in, Size) and
+read(Stream, *out, Size) exist. Both return whether the value was written or
+read completely, and set err otherwise (e.g. when a memory_stream is full or
+the data ends early).
+
+Encoding:
+
+numbers     little endian, sizeof(T) bytes. With the integer encoding set to
+            varint in the options, integers of 2 or more bytes are written
+            as LEB128 varints (7 bits per byte, high bit set if more bytes
+            follow), negative numbers sign extended to 64 bits.
+            With zigzag, signed integers are zigzag encoded first
+            (0, -1, 1, -2, ... as 0, 1, 2, 3, ...) so that small negative
+            numbers are short as well.
+            floats and doubles are always written as their bits.
+            bool is one byte, 0 or 1.
+sizes       the number of units of strings and elements of containers are
+            always written as varints.
+strings     size, then the units (c16 and c32 units little endian).
+            const c8*, const_string, string* and their c16 and c32
+            counterparts are all written the same and can be read into
+            string, u16string or u32string respectively.
+array, set  size, then the elements.
+hash_table  size, then key and value of every entry.
+
+Since single characters and C strings are both pointers to characters,
+serialize(Stream, "abc") writes a string. Characters are written as numbers
+of the same size.
+
+Arrays of numbers with fixed encoding are written and read with a single
+write or read on little endian systems.
+
+The options must be the same for serialize and deserialize.
+
+Containers read by deserialize may be zero-initialized or initialized,
+their elements are replaced by the read elements (without freeing the old
+ones). Elements are zero-initialized before they are read into.
+
+Custom types can be serialized by declaring serialize and deserialize
+overloads for pointers to them, which are then also used for containers of
+the custom type, e.g.:
+
+    struct vec2 { float x; float y; };
+
+    template<typename Stream>
+    bool serialize(Stream *s, const vec2 *v, serialize_options opt = default_serialize_options, error *err = nullptr)
+    {
+        return serialize(s, &v->x, opt, err) && serialize(s, &v->y, opt, err);
+    }
+
+    template<typename Stream>
+    bool deserialize(Stream *s, vec2 *v, serialize_options opt = default_serialize_options, error *err = nullptr)
+    {
+        return deserialize(s, &v->x, opt, err) && deserialize(s, &v->y, opt, err);
+    }
+
+Example:
+
+    memory_stream mem{};
+    init(&mem, 4096);
+
+    array<s32> arr{};
+    ...
+    serialize(&mem, &arr);
+    serialize(&mem, "hello");
+
+    seek_from_start(&mem, 0);
+
+    array<s32> arr2{};
+    string str{};
+    deserialize(&mem, &arr2);
+    deserialize(&mem, &str); // "hello"
+
+Functions:
+
+serialize(Stream, *x[, Options[, *err]])
+serialize(Stream, String[, Options[, *err]])
+    writes x or String to Stream.
+deserialize(Stream, *out[, Options[, *err]])
+    reads a value of the type of *out from Stream into out.
+
+write_varint(*out, x)
+    writes x as LEB128 varint to out, which must hold at least
+    VARINT_MAX_SIZE bytes. Returns the number of bytes written.
+read_varint(*in, Size, *out)
+    reads a varint from the Size bytes at in into out. Returns the number of
+    bytes read, or 0 if in does not start with a valid varint.
+
+zigzag_encode(x), zigzag_decode(x)
+    convert between signed integers and their zigzag encoding.
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/char_types.hpp"
+#include "shl/type_functions.hpp"
+#include "shl/endian.hpp"
+#include "shl/memory.hpp"
+#include "shl/error.hpp"
+#include "shl/string.hpp"
+#include "shl/array.hpp"
+#include "shl/set.hpp"
+#include "shl/hash_table.hpp"
+#include "shl/memory_stream.hpp"
+#include "shl/file_stream.hpp"
+
+enum class integer_encoding : u8
+{
+    fixed,
+    varint,
+    zigzag
+};
+
+struct serialize_options
+{
+    integer_encoding integers;
+};
+
+constexpr serialize_options default_serialize_options{
+    .integers = integer_encoding::fixed
+};
+
+#define VARINT_MAX_SIZE 10
+
+s64 write_varint(u8 *out, u64 x);
+s64 read_varint(const u8 *in, s64 size, u64 *out);
+
+constexpr u64 zigzag_encode(s64 x)
+{
+    return ((u64)x << 1) ^ (u64)(x >> 63);
+}
+
+constexpr s64 zigzag_decode(u64 x)
+{
+    return (s64)(x >> 1) ^ -(s64)(x & 1);
+}
+
+namespace internal
+{
+// stream access, with errors
+bool _serialize_write(memory_stream *s, const void *in, s64 size, error *err);
+bool _serialize_write(file_stream *s, const void *in, s64 size, error *err);
+bool _serialize_read(memory_stream *s, void *out, s64 size, error *err);
+bool _serialize_read(file_stream *s, void *out, s64 size, error *err);
+bool _deserialize_varint(memory_stream *s, u64 *out, error *err);
+
+// number of bytes left to read, or -1 if unknown.
+// Used to reject sizes that cannot be right before allocating.
+s64 _deserialize_remaining(memory_stream *s);
+
+void _serialize_end_of_data(error *err);
+void _serialize_invalid_varint(error *err);
+
+template<typename Stream>
+bool _serialize_write(Stream *s, const void *in, s64 size, error *err)
+{
+    if (size == 0 || write(s, in, size) == size)
+        return true;
+
+    set_error(err, 28 /* enospc */, "Stream is full");
+    return false;
+}
+
+template<typename Stream>
+bool _serialize_read(Stream *s, void *out, s64 size, error *err)
+{
+    if (size == 0 || read(s, out, size) == size)
+        return true;
+
+    _serialize_end_of_data(err);
+    return false;
+}
+
+template<typename Stream>
+s64 _deserialize_remaining(Stream *)
+{
+    return -1;
+}
+
+template<typename Stream>
+bool _deserialize_varint(Stream *s, u64 *out, error *err)
+{
+    u8 buf[VARINT_MAX_SIZE];
+
+    for (s64 i = 0; i < VARINT_MAX_SIZE; ++i)
+    {
+        if (!_serialize_read(s, buf + i, 1, err))
+            return false;
+
+        if ((buf[i] & 0x80) == 0 && read_varint(buf, i + 1, out) > 0)
+            return true;
+    }
+
+    _serialize_invalid_varint(err);
+    return false;
+}
+
+template<typename Stream>
+bool _serialize_varint(Stream *s, u64 x, error *err)
+{
+    u8 buf[VARINT_MAX_SIZE];
+    return _serialize_write(s, buf, write_varint(buf, x), err);
+}
+
+template<typename Stream>
+bool _serialize_size(Stream *s, s64 size, error *err)
+{
+    return _serialize_varint(s, (u64)size, err);
+}
+
+// reads a size of elements of at least min_element_size bytes each
+template<typename Stream>
+bool _deserialize_size(Stream *s, s64 min_element_size, s64 *out, error *err)
+{
+    u64 size = 0;
+
+    if (!_deserialize_varint(s, &size, err))
+        return false;
+
+    s64 remaining = _deserialize_remaining(s);
+
+    if (size > (u64)max_value(s64) / 16
+     || (remaining >= 0 && (s64)size * min_element_size > remaining))
+    {
+        _serialize_end_of_data(err);
+        return false;
+    }
+
+    *out = (s64)size;
+    return true;
+}
+
+// number types
+template<typename T> struct _serialize_number   { static constexpr bool value = false; };
+template<typename T> struct _serialize_unsigned { };
+
+#define _serialize_number_type(T, U)\
+    template<> struct _serialize_number<T>   { static constexpr bool value = true; };\
+    template<> struct _serialize_unsigned<T> { typedef U type; };
+
+_serialize_number_type(bool, u8)
+_serialize_number_type(s8,  u8)
+_serialize_number_type(u8,  u8)
+_serialize_number_type(s16, u16)
+_serialize_number_type(u16, u16)
+_serialize_number_type(s32, u32)
+_serialize_number_type(u32, u32)
+_serialize_number_type(s64, u64)
+_serialize_number_type(u64, u64)
+_serialize_number_type(float,  u32)
+_serialize_number_type(double, u64)
+
+#undef _serialize_number_type
+
+template<typename U>
+constexpr U _serialize_little_endian(U x)
+{
+    if constexpr (IS_LITTLE_ENDIAN || sizeof(U) == 1)
+        return x;
+    else if constexpr (sizeof(U) == 2)
+        return __builtin_bswap16(x);
+    else if constexpr (sizeof(U) == 4)
+        return __builtin_bswap32(x);
+    else
+        return __builtin_bswap64(x);
+}
+
+template<typename T>
+constexpr bool _serialize_is_float()
+{
+    return is_same(T, float) || is_same(T, double);
+}
+
+template<typename T>
+constexpr bool _serialize_is_fixed(serialize_options opt)
+{
+    return _serialize_is_float<T>() || sizeof(T) == 1 || opt.integers == integer_encoding::fixed;
+}
+
+// whether an array of T can be written and read as its memory
+template<typename T>
+constexpr bool _serialize_is_raw(serialize_options opt)
+{
+    if constexpr (!_serialize_number<T>::value || is_same(T, bool))
+        return false;
+    else
+        return IS_LITTLE_ENDIAN && _serialize_is_fixed<T>(opt);
+}
+
+template<typename T>
+static inline u64 _serialize_integer_to_varint(T x, serialize_options opt)
+{
+    if constexpr (is_signed(T))
+        return opt.integers == integer_encoding::zigzag ? zigzag_encode((s64)x) : (u64)(s64)x;
+    else
+        return (u64)x;
+}
+
+template<typename T>
+static inline T _serialize_integer_from_varint(u64 x, serialize_options opt)
+{
+    if constexpr (is_signed(T))
+        return (T)(opt.integers == integer_encoding::zigzag ? zigzag_decode(x) : (s64)x);
+    else
+        return (T)x;
+}
+
+template<typename Stream, typename T>
+bool _serialize_number_value(Stream *s, T x, serialize_options opt, error *err)
+{
+    typedef typename _serialize_unsigned<T>::type U;
+
+    if constexpr (is_same(T, bool))
+    {
+        u8 b = x ? 1 : 0;
+        return _serialize_write(s, &b, 1, err);
+    }
+    else if (_serialize_is_fixed<T>(opt))
+    {
+        U u;
+        copy_memory(&x, &u, sizeof(U));
+        u = _serialize_little_endian(u);
+        return _serialize_write(s, &u, sizeof(U), err);
+    }
+    else
+        return _serialize_varint(s, _serialize_integer_to_varint(x, opt), err);
+}
+
+template<typename Stream, typename T>
+bool _deserialize_number_value(Stream *s, T *out, serialize_options opt, error *err)
+{
+    typedef typename _serialize_unsigned<T>::type U;
+
+    if constexpr (is_same(T, bool))
+    {
+        u8 b = 0;
+
+        if (!_serialize_read(s, &b, 1, err))
+            return false;
+
+        *out = b != 0;
+        return true;
+    }
+    else if (_serialize_is_fixed<T>(opt))
+    {
+        U u;
+
+        if (!_serialize_read(s, &u, sizeof(U), err))
+            return false;
+
+        u = _serialize_little_endian(u);
+        copy_memory(&u, out, sizeof(U));
+        return true;
+    }
+    else
+    {
+        u64 v = 0;
+
+        if (!_deserialize_varint(s, &v, err))
+            return false;
+
+        *out = _serialize_integer_from_varint<T>(v, opt);
+        return true;
+    }
+}
+
+template<typename Stream, typename C>
+bool _serialize_string(Stream *s, const C *data, s64 size, error *err)
+{
+    if (!_serialize_size(s, size, err))
+        return false;
+
+    if constexpr (sizeof(C) == 1 || IS_LITTLE_ENDIAN)
+        return _serialize_write(s, data, size * (s64)sizeof(C), err);
+    else
+    {
+        typedef typename if_type(sizeof(C) == 2, u16, u32) U;
+
+        for (s64 i = 0; i < size; ++i)
+            if (!_serialize_number_value(s, (U)data[i], default_serialize_options, err))
+                return false;
+
+        return true;
+    }
+}
+}
+
+// numbers
+#define _define_serialize_number(T)\
+template<typename Stream>\
+bool serialize(Stream *s, const T *x, serialize_options opt = default_serialize_options, error *err = nullptr)\
+{\
+    return internal::_serialize_number_value(s, *x, opt, err);\
+}\
+\
+template<typename Stream>\
+bool deserialize(Stream *s, T *out, serialize_options opt = default_serialize_options, error *err = nullptr)\
+{\
+    return internal::_deserialize_number_value(s, out, opt, err);\
+}
+
+_define_serialize_number(bool)
+_define_serialize_number(s8)
+_define_serialize_number(u8)
+_define_serialize_number(s16)
+_define_serialize_number(u16)
+_define_serialize_number(s32)
+_define_serialize_number(u32)
+_define_serialize_number(s64)
+_define_serialize_number(u64)
+_define_serialize_number(float)
+_define_serialize_number(double)
+
+#undef _define_serialize_number
+
+// strings
+template<typename Stream, typename C>
+bool serialize(Stream *s, const_string_base<C> x, [[maybe_unused]] serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return internal::_serialize_string(s, x.c_str, x.size, err);
+}
+
+template<typename Stream, typename C>
+bool serialize(Stream *s, const const_string_base<C> *x, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return serialize(s, *x, opt, err);
+}
+
+template<typename Stream, typename C>
+bool serialize(Stream *s, const string_base<C> *x, [[maybe_unused]] serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return internal::_serialize_string(s, x->data, x->size, err);
+}
+
+#define _define_serialize_c_string(C)\
+template<typename Stream>\
+bool serialize(Stream *s, const C *x, [[maybe_unused]] serialize_options opt = default_serialize_options, error *err = nullptr)\
+{\
+    return internal::_serialize_string(s, x, x == nullptr ? 0 : string_length(x), err);\
+}
+
+_define_serialize_c_string(c8)
+_define_serialize_c_string(c16)
+_define_serialize_c_string(c32)
+
+#undef _define_serialize_c_string
+
+template<typename Stream, typename C>
+bool deserialize(Stream *s, string_base<C> *out, [[maybe_unused]] serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    s64 size = 0;
+
+    if (!internal::_deserialize_size(s, sizeof(C), &size, err))
+        return false;
+
+    string_reserve(out, size);
+    out->size = 0;
+    out->data[0] = (C)'\0';
+
+    if constexpr (sizeof(C) == 1 || IS_LITTLE_ENDIAN)
+    {
+        if (!internal::_serialize_read(s, out->data, size * (s64)sizeof(C), err))
+            return false;
+    }
+    else
+    {
+        typedef typename if_type(sizeof(C) == 2, u16, u32) U;
+
+        for (s64 i = 0; i < size; ++i)
+            if (!internal::_deserialize_number_value(s, (U*)(out->data + i), default_serialize_options, err))
+                return false;
+    }
+
+    out->size = size;
+    out->data[size] = (C)'\0';
+    return true;
+}
+
+// containers
+namespace internal
+{
+template<typename Stream, typename T>
+bool _serialize_elements(Stream *s, const T *data, s64 size, serialize_options opt, error *err)
+{
+    if (!_serialize_size(s, size, err))
+        return false;
+
+    if (_serialize_is_raw<T>(opt))
+        return _serialize_write(s, data, size * (s64)sizeof(T), err);
+
+    if constexpr (_serialize_number<T>::value && !_serialize_is_float<T>() && sizeof(T) > 1)
+    if (opt.integers != integer_encoding::fixed)
+    {
+        // varints are encoded in batches
+        u8 buf[1024];
+        s64 used = 0;
+
+        for (s64 i = 0; i < size; ++i)
+        {
+            if (used > (s64)sizeof(buf) - VARINT_MAX_SIZE)
+            {
+                if (!_serialize_write(s, buf, used, err))
+                    return false;
+
+                used = 0;
+            }
+
+            used += write_varint(buf + used, _serialize_integer_to_varint(data[i], opt));
+        }
+
+        return _serialize_write(s, buf, used, err);
+    }
+
+    for (s64 i = 0; i < size; ++i)
+        if (!serialize(s, data + i, opt, err))
+            return false;
+
+    return true;
+}
+
+// T is at least one byte when serialized
+template<typename Stream, typename T>
+bool _deserialize_elements(Stream *s, array<T> *out, serialize_options opt, error *err)
+{
+    s64 size = 0;
+
+    if (!_deserialize_size(s, 1, &size, err))
+        return false;
+
+    resize(out, size);
+
+    if (_serialize_is_raw<T>(opt))
+        return _serialize_read(s, out->data, size * (s64)sizeof(T), err);
+
+    if (size > 0)
+        fill_memory(out->data, 0, size * (s64)sizeof(T));
+
+    for (s64 i = 0; i < size; ++i)
+        if (!deserialize(s, out->data + i, opt, err))
+        {
+            resize(out, i);
+            return false;
+        }
+
+    return true;
+}
+}
+
+template<typename Stream, typename T>
+bool serialize(Stream *s, const array<T> *arr, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return internal::_serialize_elements(s, arr->data, arr->size, opt, err);
+}
+
+template<typename Stream, typename T>
+bool deserialize(Stream *s, array<T> *out, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return internal::_deserialize_elements(s, out, opt, err);
+}
+
+template<typename Stream, typename T>
+bool serialize(Stream *s, const set<T> *st, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return internal::_serialize_elements(s, st->data, st->size, opt, err);
+}
+
+// elements are inserted with the compare function of out (ascending if out
+// is zero-initialized), which is fast if they were written in that order.
+template<typename Stream, typename T>
+bool deserialize(Stream *s, set<T> *out, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    s64 size = 0;
+
+    if (!internal::_deserialize_size(s, 1, &size, err))
+        return false;
+
+    if (out->compare == nullptr)
+        init(out);
+
+    clear(out);
+    reserve(out, size);
+
+    for (s64 i = 0; i < size; ++i)
+    {
+        T x{};
+
+        if (!deserialize(s, &x, opt, err))
+            return false;
+
+        insert_element(out, &x);
+    }
+
+    return true;
+}
+
+template<typename Stream, typename TKey, typename TValue>
+bool serialize(Stream *s, const hash_table<TKey, TValue> *table, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    if (!internal::_serialize_size(s, table->size, err))
+        return false;
+
+    for_hash_table(k, v, table)
+        if (!serialize(s, k, opt, err) || !serialize(s, v, opt, err))
+            return false;
+
+    return true;
+}
+
+template<typename Stream, typename TKey, typename TValue>
+bool deserialize(Stream *s, hash_table<TKey, TValue> *out, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    s64 size = 0;
+
+    if (!internal::_deserialize_size(s, 2, &size, err))
+        return false;
+
+    if (out->data.data == nullptr)
+        init_for_n_items(out, size);
+    else
+        clear(out);
+
+    for (s64 i = 0; i < size; ++i)
+    {
+        TKey key{};
+
+        if (!deserialize(s, &key, opt, err))
+            return false;
+
+        TValue *value = add_element_by_key(out, &key);
+        fill_memory(value, 0);
+
+        if (!deserialize(s, value, opt, err))
+            return false;
+    }
+
+    return true;
+}
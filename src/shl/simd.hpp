@@ -0,0 +1,260 @@
+#pragma once
+
+/* simd.hpp
+
+Small set of 128 bit vector operations used internally by the vectorized
+string functions (see shl/string_search.hpp and shl/string_encoding.hpp)
+and integer formatting (see shl/number_format.hpp).
+
+Sets the 'Simd' preprocessor constant to the vector instruction set in use:
+
+    Simd == SIMD_SSE2   on x86_64 (and x86 with SSE2 enabled),
+    Simd == SIMD_NEON   on aarch64,
+    Simd == SIMD_NONE   otherwise, in which case none of the functions
+                        below are defined and callers use scalar loops.
+
+SSE2 and NEON are always available on x86_64 and aarch64 respectively,
+so no runtime detection is needed.
+
+Types:
+simd_vec    a 16 byte vector.
+
+Functions:
+simd_load(Ptr)          loads 16 unaligned bytes from Ptr.
+simd_store(Ptr, V)      stores V to 16 unaligned bytes at Ptr.
+simd_broadcast(C)       vector with every unit set to C, where C is
+                        c8, c16 or c32 (or u8, u16, u32).
+simd_equal<C>(A, B)     compares units of size sizeof(C), every unit of the
+                        result is all ones if equal, zero otherwise.
+simd_greater_s8(A, B)   compares signed bytes, every byte of the result is
+                        all ones if A > B, zero otherwise.
+simd_or(A, B), simd_and(A, B), simd_xor(A, B)
+
+simd_mask(V)            returns a bitmask of the bytes of V, where each byte
+                        that is all ones sets simd_mask_bits_per_byte bits.
+                        Bytes must either be all ones or zero (i.e. results of
+                        comparisons).
+simd_is_ascii(V)        returns whether all bytes of V are < 0x80.
+
+simd_widen_u8_u16(Src, Dst)     zero extends the 16 bytes at Src to 16 u16 at Dst.
+simd_widen_u8_u32(Src, Dst)     zero extends the 16 bytes at Src to 16 u32 at Dst.
+simd_narrow_ascii_u16_u8(Src, Dst)
+    if the 16 u16 at Src are all < 0x80, writes them as 16 bytes to Dst and
+    returns true, otherwise writes nothing and returns false.
+
+simd_hex_digits_u64(X, Caps)
+    the 16 hexadecimal digits of X as ASCII, most significant digit first,
+    with uppercase letters if Caps is true.
+simd_binary_digits_u16(X)
+    the 16 binary digits of X as ASCII, most significant digit first.
+*/
+
+#include "shl/architecture.hpp"
+#include "shl/number_types.hpp"
+#include "shl/endian.hpp"
+
+#define SIMD_NONE 0
+#define SIMD_SSE2 1
+#define SIMD_NEON 2
+
+#if Architecture == ARCH_x86_64 || (Architecture == ARCH_x86 && defined(__SSE2__))
+#define Simd SIMD_SSE2
+#elif Architecture == ARCH_aarch64
+#define Simd SIMD_NEON
+#else
+#define Simd SIMD_NONE
+#endif
+
+#if Simd == SIMD_SSE2
+#include <emmintrin.h>
+
+typedef __m128i simd_vec;
+
+constexpr u64 simd_mask_bits_per_byte = 1;
+
+static inline simd_vec simd_load(const void *p)      { return _mm_loadu_si128((const __m128i*)p); }
+static inline void simd_store(void *p, simd_vec v)   { _mm_storeu_si128((__m128i*)p, v); }
+
+template<typename C>
+static inline simd_vec simd_broadcast(C c)
+{
+    if constexpr (sizeof(C) == 1)      return _mm_set1_epi8((char)c);
+    else if constexpr (sizeof(C) == 2) return _mm_set1_epi16((short)c);
+    else                               return _mm_set1_epi32((int)c);
+}
+
+template<typename C>
+static inline simd_vec simd_equal(simd_vec a, simd_vec b)
+{
+    if constexpr (sizeof(C) == 1)      return _mm_cmpeq_epi8(a, b);
+    else if constexpr (sizeof(C) == 2) return _mm_cmpeq_epi16(a, b);
+    else                               return _mm_cmpeq_epi32(a, b);
+}
+
+static inline simd_vec simd_greater_s8(simd_vec a, simd_vec b) { return _mm_cmpgt_epi8(a, b); }
+static inline simd_vec simd_or(simd_vec a, simd_vec b)  { return _mm_or_si128(a, b); }
+static inline simd_vec simd_and(simd_vec a, simd_vec b) { return _mm_and_si128(a, b); }
+static inline simd_vec simd_xor(simd_vec a, simd_vec b) { return _mm_xor_si128(a, b); }
+
+static inline u64 simd_mask(simd_vec v) { return (u64)(u32)_mm_movemask_epi8(v); }
+static inline bool simd_is_ascii(simd_vec v) { return _mm_movemask_epi8(v) == 0; }
+
+static inline void simd_widen_u8_u16(const void *src, u16 *dst)
+{
+    simd_vec v = simd_load(src);
+    simd_vec zero = _mm_setzero_si128();
+
+    simd_store(dst,     _mm_unpacklo_epi8(v, zero));
+    simd_store(dst + 8, _mm_unpackhi_epi8(v, zero));
+}
+
+static inline void simd_widen_u8_u32(const void *src, u32 *dst)
+{
+    simd_vec v = simd_load(src);
+    simd_vec zero = _mm_setzero_si128();
+    simd_vec lo = _mm_unpacklo_epi8(v, zero);
+    simd_vec hi = _mm_unpackhi_epi8(v, zero);
+
+    simd_store(dst,      _mm_unpacklo_epi16(lo, zero));
+    simd_store(dst + 4,  _mm_unpackhi_epi16(lo, zero));
+    simd_store(dst + 8,  _mm_unpacklo_epi16(hi, zero));
+    simd_store(dst + 12, _mm_unpackhi_epi16(hi, zero));
+}
+
+static inline bool simd_narrow_ascii_u16_u8(const u16 *src, void *dst)
+{
+    simd_vec a = simd_load(src);
+    simd_vec b = simd_load(src + 8);
+    simd_vec high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16((short)0xff80));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xffff)
+        return false;
+
+    simd_store(dst, _mm_packus_epi16(a, b));
+    return true;
+}
+
+static inline simd_vec simd_hex_digits_u64(u64 x, bool caps)
+{
+    // most significant byte first, then interleave high and low nibbles.
+    // _mm_cvtsi64_si128 only exists on x86_64.
+    u64 be = force_big_endian(x);
+    simd_vec v = _mm_loadl_epi64((const simd_vec*)&be);
+    simd_vec low_nibbles = _mm_set1_epi8(0x0f);
+    simd_vec hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_nibbles);
+    simd_vec lo = _mm_and_si128(v, low_nibbles);
+    simd_vec nibbles = _mm_unpacklo_epi8(hi, lo);
+
+    simd_vec letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    simd_vec letter_offset = _mm_and_si128(letters, _mm_set1_epi8(caps ? 'A' - '0' - 10 : 'a' - '0' - 10));
+
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letter_offset);
+}
+
+static inline simd_vec simd_binary_digits_u16(u16 x)
+{
+    // high byte in the first 8 units, low byte in the last 8
+    simd_vec v = _mm_set_epi64x((long long)((x & 0xff) * 0x0101010101010101ull),
+                                (long long)((x >> 8)   * 0x0101010101010101ull));
+    simd_vec bits = _mm_set_epi64x(0x0102040810204080ll, 0x0102040810204080ll);
+    simd_vec set = _mm_cmpeq_epi8(_mm_and_si128(v, bits), bits);
+
+    // '0' - (-1) = '1'
+    return _mm_sub_epi8(_mm_set1_epi8('0'), set);
+}
+
+#elif Simd == SIMD_NEON
+#include <arm_neon.h>
+
+typedef uint8x16_t simd_vec;
+
+constexpr u64 simd_mask_bits_per_byte = 4;
+
+static inline simd_vec simd_load(const void *p)      { return vld1q_u8((const u8*)p); }
+static inline void simd_store(void *p, simd_vec v)   { vst1q_u8((u8*)p, v); }
+
+template<typename C>
+static inline simd_vec simd_broadcast(C c)
+{
+    if constexpr (sizeof(C) == 1)      return vdupq_n_u8((u8)c);
+    else if constexpr (sizeof(C) == 2) return vreinterpretq_u8_u16(vdupq_n_u16((u16)c));
+    else                               return vreinterpretq_u8_u32(vdupq_n_u32((u32)c));
+}
+
+template<typename C>
+static inline simd_vec simd_equal(simd_vec a, simd_vec b)
+{
+    if constexpr (sizeof(C) == 1)
+        return vceqq_u8(a, b);
+    else if constexpr (sizeof(C) == 2)
+        return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+    else
+        return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+}
+
+static inline simd_vec simd_greater_s8(simd_vec a, simd_vec b) { return vcgtq_s8(vreinterpretq_s8_u8(a), vreinterpretq_s8_u8(b)); }
+static inline simd_vec simd_or(simd_vec a, simd_vec b)  { return vorrq_u8(a, b); }
+static inline simd_vec simd_and(simd_vec a, simd_vec b) { return vandq_u8(a, b); }
+static inline simd_vec simd_xor(simd_vec a, simd_vec b) { return veorq_u8(a, b); }
+
+// NEON has no movemask, shifting each 16 bit lane right by 4 and narrowing
+// yields 4 bits per byte.
+static inline u64 simd_mask(simd_vec v)
+{
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(v), 4)), 0);
+}
+
+static inline bool simd_is_ascii(simd_vec v) { return vmaxvq_u8(v) < 0x80; }
+
+static inline void simd_widen_u8_u16(const void *src, u16 *dst)
+{
+    simd_vec v = simd_load(src);
+
+    vst1q_u16(dst,     vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(dst + 8, vmovl_u8(vget_high_u8(v)));
+}
+
+static inline void simd_widen_u8_u32(const void *src, u32 *dst)
+{
+    simd_vec v = simd_load(src);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+
+    vst1q_u32(dst,      vmovl_u16(vget_low_u16(lo)));
+    vst1q_u32(dst + 4,  vmovl_u16(vget_high_u16(lo)));
+    vst1q_u32(dst + 8,  vmovl_u16(vget_low_u16(hi)));
+    vst1q_u32(dst + 12, vmovl_u16(vget_high_u16(hi)));
+}
+
+static inline bool simd_narrow_ascii_u16_u8(const u16 *src, void *dst)
+{
+    uint16x8_t a = vld1q_u16(src);
+    uint16x8_t b = vld1q_u16(src + 8);
+
+    if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80)
+        return false;
+
+    vst1q_u8((u8*)dst, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    return true;
+}
+
+static inline simd_vec simd_hex_digits_u64(u64 x, bool caps)
+{
+    uint8x8_t v = vrev64_u8(vcreate_u8(x));
+    uint8x8x2_t zipped = vzip_u8(vshr_n_u8(v, 4), vand_u8(v, vdup_n_u8(0x0f)));
+    simd_vec nibbles = vcombine_u8(zipped.val[0], zipped.val[1]);
+
+    simd_vec letters = vcgtq_u8(nibbles, vdupq_n_u8(9));
+    simd_vec letter_offset = vandq_u8(letters, vdupq_n_u8(caps ? 'A' - '0' - 10 : 'a' - '0' - 10));
+
+    return vaddq_u8(vaddq_u8(nibbles, vdupq_n_u8('0')), letter_offset);
+}
+
+static inline simd_vec simd_binary_digits_u16(u16 x)
+{
+    simd_vec v = vcombine_u8(vdup_n_u8((u8)(x >> 8)), vdup_n_u8((u8)(x & 0xff)));
+    simd_vec bits = vreinterpretq_u8_u64(vdupq_n_u64(0x0102040810204080ull));
+
+    return vsubq_u8(vdupq_n_u8('0'), vtstq_u8(v, bits));
+}
+#endif
@@ -0,0 +1,655 @@
+#pragma once
+
+/* small_array.hpp
+
+Contiguous dynamic memory structure which stores the first N elements inline
+(e.g. on the stack) and only allocates once more than N elements are added.
+
+    template<typename T, s64 N>
+    struct small_array
+    {
+        T *data;
+        s64 size;
+        s64 reserved_size;
+        allocator allocator;
+        T inline_data[N];
+    }
+
+small_array has the same interface as array (see shl/array.hpp), and is
+intended for arrays that usually only hold a few elements, e.g. temporary
+per-call arrays, where allocating and deallocating memory for a handful of
+elements would be more expensive than the work done with the elements.
+
+As long as reserved_size <= N, the elements live in inline_data and no
+memory is allocated. Once the array needs more than N elements, the elements
+are moved to memory allocated with the arrays allocator (the context
+allocator by default), and from then on the small_array grows just like an
+array. Shrinking the array (resize, shrink_to_fit) to N or fewer elements
+moves the elements back into inline_data and deallocates the heap memory.
+
+Example usage:
+
+    small_array<int, 8> arr{};
+    init(&arr);
+
+    add_at_end(&arr, 1); // no allocation
+    add_at_end(&arr, 2); // no allocation
+
+    for_array(i, val, &arr)
+        printf("%lu: %d\n", i, *val);
+
+    free(&arr);
+
+Functions:
+
+All functions of array (init, add_at_start, add_at_end, add_elements,
+insert_elements, add_range, insert_range, remove_from_start, remove_from_end,
+remove_elements, reserve, reserve_exp2, resize, shrink_to_fit, at, clear,
+array_data, array_size, free_values, free, search, index_of, contains, hash
+and for_array) work the same way on small_array, see shl/array.hpp for
+documentation.
+
+additional functions:
+
+is_inline(*arr) Returns true if the elements of arr are stored in
+                arr.inline_data, false otherwise.
+
+------
+NOTES:
+
+When moving (copying the memory of) a small_array, the data member _may be
+invalidated_ if the elements are stored inline. All functions operating on
+small_array recompute the data member, so either use the functions, e.g.
+array_data(*arr) or at(*arr, N), instead of the data member after moving
+a small_array, or set data to inline_data manually.
+ */
+
+#include "shl/assert.hpp"
+#include "shl/macros.hpp"
+#include "shl/compare.hpp"
+#include "shl/type_functions.hpp"
+#include "shl/number_types.hpp"
+#include "shl/program_context.hpp"
+#include "shl/memory.hpp"
+#include "shl/hash.hpp"
+#include "shl/bits.hpp"
+
+template<typename T, s64 N>
+struct small_array
+{
+    static_assert(N > 0, "small_array must have at least one inline element, use array otherwise");
+
+    typedef T value_type;
+    static constexpr s64 inline_size = N;
+
+    T *data;
+    s64 size;
+    s64 reserved_size;
+    ::allocator allocator;
+    T inline_data[N];
+
+    T &operator[](s64 index) { return _small_array_data(this)[index]; }
+};
+
+template<typename T, s64 N>
+inline bool is_inline(const small_array<T, N> *arr)
+{
+    return arr->reserved_size <= N;
+}
+
+template<typename T, s64 N>
+inline T *_small_array_data(small_array<T, N> *arr)
+{
+    if (is_inline(arr))
+        arr->data = arr->inline_data;
+
+    return arr->data;
+}
+
+template<typename T, s64 N>
+inline const T *_small_array_data(const small_array<T, N> *arr)
+{
+    if (is_inline(arr))
+        return arr->inline_data;
+
+    return arr->data;
+}
+
+template<typename T, s64 N>
+bool operator==(const small_array<T, N> &lhs, const small_array<T, N> &rhs)
+{
+    if (lhs.size != rhs.size)
+        return false;
+
+    const T *ldata = _small_array_data(&lhs);
+    const T *rdata = _small_array_data(&rhs);
+
+    for (s64 i = 0; i < lhs.size; ++i)
+        if (!(ldata[i] == rdata[i]))
+            return false;
+
+    return true;
+}
+
+// moves the elements of arr to memory that can hold new_reserved_size
+// elements, which may be inline_data if new_reserved_size <= N.
+// arr->size is untouched, elements beyond new_reserved_size are lost.
+template<typename T, s64 N>
+bool _small_array_reallocate(small_array<T, N> *arr, s64 new_reserved_size)
+{
+    assert(arr != nullptr);
+
+    if (new_reserved_size < N)
+        new_reserved_size = N;
+
+    if (new_reserved_size == arr->reserved_size)
+        return true;
+
+    _set_allocator_if_not_set(arr);
+
+    if (is_inline(arr))
+    {
+        // inline -> heap
+        T *n = allocator_alloc_T(arr->allocator, T, new_reserved_size);
+
+        if (n == nullptr)
+            return false;
+
+        ::copy_memory((const void*)arr->inline_data, (void*)n, Min(arr->size, new_reserved_size) * sizeof(T));
+
+        arr->data = n;
+        arr->reserved_size = new_reserved_size;
+        return true;
+    }
+
+    if (new_reserved_size <= N)
+    {
+        // heap -> inline
+        ::copy_memory((const void*)arr->data, (void*)arr->inline_data, Min(arr->size, new_reserved_size) * sizeof(T));
+        allocator_dealloc_T(arr->allocator, arr->data, T, arr->reserved_size);
+
+        arr->data = arr->inline_data;
+        arr->reserved_size = N;
+        return true;
+    }
+
+    // heap -> heap
+    T *n = allocator_realloc_T(arr->allocator, arr->data, T, arr->reserved_size, new_reserved_size);
+
+    if (n == nullptr)
+        return false;
+
+    arr->data = n;
+    arr->reserved_size = new_reserved_size;
+    return true;
+}
+
+template<typename T, s64 N>
+void init(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    arr->data = arr->inline_data;
+    arr->size = 0;
+    arr->reserved_size = N;
+    arr->allocator = get_context_pointer()->allocator;
+}
+
+template<typename T, s64 N>
+void init(small_array<T, N> *arr, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (n_elements < 0)
+        n_elements = 0;
+
+    init(arr);
+
+    if (n_elements > N)
+    {
+        arr->data = allocator_alloc_T(arr->allocator, T, n_elements);
+        arr->reserved_size = n_elements;
+    }
+
+    arr->size = n_elements;
+}
+
+template<typename T, s64 N>
+T *add_elements(small_array<T, N> *arr, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (n_elements <= 0)
+        return nullptr;
+
+    s64 nsize = arr->size + n_elements;
+
+    if (nsize > arr->reserved_size
+     && !_small_array_reallocate(arr, ceil_exp2(arr->reserved_size + n_elements)))
+        return nullptr;
+
+    T *ret = _small_array_data(arr) + arr->size;
+    arr->size = nsize;
+
+    return ret;
+}
+
+template<typename T, s64 N>
+T *insert_elements(small_array<T, N> *arr, s64 index, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (index < 0)
+        return nullptr;
+    else if (index == arr->size)
+        return add_elements(arr, n_elements);
+    else if (index > arr->size)
+        return nullptr;
+
+    if (n_elements == 0)
+        return _small_array_data(arr) + index;
+
+    s64 prev_size = arr->size;
+    T *n = add_elements(arr, n_elements);
+
+    if (n == nullptr)
+        return nullptr;
+
+    T *data = _small_array_data(arr);
+    void *start = reinterpret_cast<void*>(data + index);
+    void *new_start = reinterpret_cast<void*>(data + index + n_elements);
+    s64 elem_count = prev_size - index;
+
+    ::move_memory(start, new_start, elem_count * sizeof(T));
+
+    return data + index;
+}
+
+template<typename T, s64 N>
+T *add_range(small_array<T, N> *arr, const T *elements, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (elements == nullptr || n_elements == 0)
+        return nullptr;
+
+    T *ret = add_elements(arr, n_elements);
+
+    if (ret == nullptr)
+        return nullptr;
+
+    ::copy_memory((const void*)elements, (void*)ret, n_elements * sizeof(T));
+
+    return ret;
+}
+
+template<typename T, s64 N, s64 N2>
+T *add_range(small_array<T, N> *arr, const small_array<T, N2> *other)
+{
+    assert(arr != nullptr);
+    assert(other != nullptr);
+    return add_range(arr, _small_array_data(other), other->size);
+}
+
+template<typename T, s64 N, s64 N2>
+T *add_range(small_array<T, N> *arr, const small_array<T, N2> *other, s64 other_start, s64 count)
+{
+    assert(arr != nullptr);
+    assert(other != nullptr);
+
+    assert(other_start <= other->size);
+    assert(count <= (other->size - other_start));
+    return add_range(arr, _small_array_data(other) + other_start, count);
+}
+
+template<typename T, s64 N>
+T *insert_range(small_array<T, N> *arr, s64 index, const T *elements, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (elements == nullptr || n_elements <= 0 || index < 0)
+        return nullptr;
+
+    T *ret = insert_elements(arr, index, n_elements);
+
+    if (ret == nullptr)
+        return ret;
+
+    ::copy_memory((const void*)elements, (void*)ret, n_elements * sizeof(T));
+
+    return ret;
+}
+
+template<typename T, s64 N, s64 N2>
+T *insert_range(small_array<T, N> *arr, s64 index, const small_array<T, N2> *other)
+{
+    assert(arr != nullptr);
+    assert(other != nullptr);
+
+    return insert_range(arr, index, _small_array_data(other), other->size);
+}
+
+template<typename T, s64 N, s64 N2>
+T *insert_range(small_array<T, N> *arr, s64 index, const small_array<T, N2> *other, s64 other_start, s64 count)
+{
+    assert(arr != nullptr);
+    assert(other != nullptr);
+
+    assert(other_start <= other->size);
+    assert(count <= (other->size - other_start));
+    return insert_range(arr, index, _small_array_data(other) + other_start, count);
+}
+
+template<typename T, s64 N>
+inline T *add_at_start(small_array<T, N> *arr)
+{
+    return insert_elements(arr, 0, 1);
+}
+
+template<typename T, s64 N>
+inline T *add_at_start(small_array<T, N> *arr, T val)
+{
+    T *ret = add_at_start(arr);
+    *ret = val;
+    return ret;
+}
+
+template<typename T, s64 N>
+inline T *add_at_start(small_array<T, N> *arr, const T *val)
+{
+    T *ret = add_at_start(arr);
+    *ret = *val;
+    return ret;
+}
+
+template<typename T, s64 N>
+inline T *add_at_end(small_array<T, N> *arr)
+{
+    return add_elements(arr, 1);
+}
+
+template<typename T, s64 N>
+inline T *add_at_end(small_array<T, N> *arr, T val)
+{
+    T *ret = add_at_end(arr);
+    *ret = val;
+    return ret;
+}
+
+template<typename T, s64 N>
+inline T *add_at_end(small_array<T, N> *arr, const T *val)
+{
+    T *ret = add_at_end(arr);
+    *ret = *val;
+    return ret;
+}
+
+template<bool FreeValues = false, typename T, s64 N>
+void remove_elements(small_array<T, N> *arr, s64 index, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (n_elements <= 0)
+        return;
+
+    if (index < 0 || index >= arr->size)
+        return;
+
+    T *data = _small_array_data(arr);
+
+    if constexpr (FreeValues)
+    {
+        s64 max = Min(index + n_elements, arr->size);
+
+        for (s64 i = index; i < max; ++i)
+            free(data + i);
+    }
+
+    if (index + n_elements >= arr->size)
+    {
+        arr->size = index;
+        return;
+    }
+
+    void *before = reinterpret_cast<void*>(data + index);
+    void *after = reinterpret_cast<void*>(data + index + n_elements);
+
+    s64 num_items_after = arr->size - (index + n_elements);
+    ::move_memory(after, before, num_items_after * sizeof(T));
+
+    arr->size = arr->size - n_elements;
+}
+
+template<bool FreeValues = false, typename T, s64 N>
+inline void remove_from_start(small_array<T, N> *arr)
+{
+    remove_elements<FreeValues>(arr, 0, 1);
+}
+
+template<bool FreeValues = false, typename T, s64 N>
+inline void remove_from_end(small_array<T, N> *arr)
+{
+    remove_elements<FreeValues>(arr, arr->size - 1, 1);
+}
+
+template<typename T, s64 N>
+bool reserve(small_array<T, N> *arr, s64 size)
+{
+    assert(arr != nullptr);
+
+    if (arr->reserved_size >= size)
+        return true;
+
+    return _small_array_reallocate(arr, size);
+}
+
+template<typename T, s64 N>
+bool reserve_exp2(small_array<T, N> *arr, s64 size)
+{
+    return reserve(arr, ceil_exp2(size));
+}
+
+// if size makes array smaller and FreeValues is true, call free() on all
+// removed values before reallocating memory.
+// unlike array, resizing to N or fewer elements keeps N elements reserved
+// inline.
+template<bool FreeValues = false, typename T, s64 N>
+bool resize(small_array<T, N> *arr, s64 size)
+{
+    assert(arr != nullptr);
+
+    if (size < 0)
+        size = 0;
+
+    if constexpr (FreeValues)
+    {
+        T *data = _small_array_data(arr);
+
+        if (arr->size > size)
+        for (s64 i = size; i < arr->size; ++i)
+            free(data + i);
+    }
+
+    if (!_small_array_reallocate(arr, size))
+        return false;
+
+    arr->size = size;
+
+    return true;
+}
+
+template<typename T, s64 N>
+bool shrink_to_fit(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    if (arr->size == arr->reserved_size)
+        return true;
+
+    return _small_array_reallocate(arr, arr->size);
+}
+
+template<typename T, s64 N>
+T *begin(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    return _small_array_data(arr);
+}
+
+// past-the-end pointer
+template<typename T, s64 N>
+T *end(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    return _small_array_data(arr) + arr->size;
+}
+
+template<typename T, s64 N>
+T *at(small_array<T, N> *arr, s64 index)
+{
+    assert(arr != nullptr);
+    assert(index >= 0);
+    assert(index < arr->size);
+
+    return _small_array_data(arr) + index;
+}
+
+template<typename T, s64 N>
+const T *at(const small_array<T, N> *arr, s64 index)
+{
+    assert(arr != nullptr);
+    assert(index >= 0);
+    assert(index < arr->size);
+
+    return _small_array_data(arr) + index;
+}
+
+template<typename T, s64 N>
+void clear(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    arr->size = 0;
+}
+
+template<typename T, s64 N>
+T *array_data(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    return _small_array_data(arr);
+}
+
+template<typename T, s64 N>
+const T *array_data(const small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    return _small_array_data(arr);
+}
+
+template<typename T, s64 N>
+s64 array_size(const small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    return arr->size;
+}
+
+#include "shl/impl/for_array.hpp"
+
+template<typename T, s64 N>
+void free_values(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    for_array(v, arr)
+        free(v);
+}
+
+template<bool FreeValues = false, typename T, s64 N>
+void free(small_array<T, N> *arr)
+{
+    assert(arr != nullptr);
+
+    if constexpr (FreeValues) free_values(arr);
+
+    if (!is_inline(arr) && arr->data != nullptr)
+    {
+        _set_allocator_if_not_set(arr);
+
+        allocator_dealloc_T(arr->allocator, arr->data, T, arr->reserved_size);
+    }
+
+    arr->data = arr->inline_data;
+    arr->size = 0;
+    arr->reserved_size = N;
+}
+
+template<typename T, s64 N>
+T *search(small_array<T, N> *arr, T key, equality_function<T> eq = equals<T>)
+{
+    assert(arr != nullptr);
+
+    for_array(v, arr)
+        if (eq(*v, key))
+            return v;
+
+    return nullptr;
+}
+
+template<typename T, s64 N>
+T *search(small_array<T, N> *arr, const T *key, equality_function_p<T> eq = equals_p<T>)
+{
+    assert(arr != nullptr);
+
+    for_array(v, arr)
+        if (eq(v, key))
+            return v;
+
+    return nullptr;
+}
+
+template<typename T, s64 N>
+s64 index_of(const small_array<T, N> *arr, T key, equality_function<T> eq = equals<T>)
+{
+    assert(arr != nullptr);
+
+    for_array(i, v, arr)
+        if (eq(*v, key))
+            return i;
+
+    return -1;
+}
+
+template<typename T, s64 N>
+s64 index_of(const small_array<T, N> *arr, const T *key, equality_function_p<T> eq = equals_p<T>)
+{
+    assert(arr != nullptr);
+
+    for_array(i, v, arr)
+        if (eq(v, key))
+            return i;
+
+    return -1;
+}
+
+template<typename T, s64 N>
+bool contains(const small_array<T, N> *arr, T key, equality_function<T> eq = equals<T>)
+{
+    return index_of(arr, key, eq) != -1;
+}
+
+template<typename T, s64 N>
+bool contains(const small_array<T, N> *arr, const T *key, equality_function_p<T> eq = equals_p<T>)
+{
+    return index_of(arr, key, eq) != -1;
+}
+
+template<typename T, s64 N>
+hash_t hash(const small_array<T, N> *arr)
+{
+    return hash_data(reinterpret_cast<const void*>(_small_array_data(arr)), arr->size * sizeof(T));
+}
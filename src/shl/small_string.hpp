@@ -0,0 +1,205 @@
+#pragma once
+
+/* small_string.hpp
+
+String which stores up to N - 1 units (plus the null terminator) inline and
+only allocates once it grows beyond that (small string optimization).
+
+    template<typename C, s64 N>
+    struct small_string_base : string_base<C>
+    {
+        allocator backing_allocator;
+        C inline_data[N];
+    }
+
+    typedef small_string_base<c8,  24> small_string;
+    typedef small_string_base<c16, 12> small_u16string;
+    typedef small_string_base<c32, 6>  small_u32string;
+
+A small_string _is_ a string_base<C>, so a pointer to a small_string can be
+passed to every function of shl/string.hpp which takes a string pointer
+(string_append, string_set, string_data, to_const_string, format, ...),
+and the string is always null terminated, just like string.
+
+As long as reserved_size <= N, the units live in inline_data and no memory
+is allocated. Growth goes through the allocator of the string, which for
+small strings is a small allocator that hands out inline_data for requests of
+up to N units and forwards everything else to backing_allocator (the context
+allocator when calling init). Once the string needs more than N units, the
+units are moved to memory allocated with backing_allocator, and from then on
+the small_string grows just like a string.
+
+Example usage:
+
+    small_string key{};
+    init(&key, "apple");        // no allocation
+
+    string_append(&key, "pie"); // still no allocation
+    hash(&key);                 // same hash as a string "applepie"
+
+    free(&key);
+
+Functions:
+
+init(*str)              initializes an empty small_string.
+init(*str, N)           initializes a small_string with N units.
+init(*str, Str)         initializes a small_string with the contents of Str.
+init(*str, Cstr, N)     initializes a small_string with N units of Cstr.
+
+string_data(*str)       returns the data of str, see NOTES.
+is_inline(*str)         returns true if the units of str are stored in
+                        str.inline_data, false otherwise.
+
+All other string functions are used through the string_base<C> interface,
+e.g. free(&str) frees the memory of str (if any), and the small_string can
+be reused afterwards without calling init again.
+
+------
+NOTES:
+
+Unlike string, small_string cannot be copied or moved by value (e.g.
+returned from functions or stored as keys in a hash_table), its copy
+constructor and copy assignment are deleted. When moving (copying the memory
+of) a small_string, the data member and the allocator _are invalidated_ if the
+units are stored inline. string_data(*str) restores
+both, so call string_data(&str) once after moving a small_string, or use
+string for strings that are passed around by value.
+ */
+
+#include "shl/assert.hpp"
+#include "shl/number_types.hpp"
+#include "shl/memory.hpp"
+#include "shl/program_context.hpp"
+#include "shl/string.hpp"
+
+template<typename C, s64 N>
+struct small_string_base : public string_base<C>
+{
+    static_assert(N > 1, "small_string must have at least two inline units, use string otherwise");
+
+    static constexpr s64 inline_size = N;
+
+    ::allocator backing_allocator;
+    C inline_data[N];
+
+    // copies would point into the inline_data of the original
+    small_string_base() = default;
+    small_string_base(const small_string_base &) = delete;
+    small_string_base &operator=(const small_string_base &) = delete;
+};
+
+typedef small_string_base<c8,  24> small_string;
+typedef small_string_base<c16, 12> small_u16string;
+typedef small_string_base<c32, 6>  small_u32string;
+
+template<typename C, s64 N>
+inline bool is_inline(const small_string_base<C, N> *str)
+{
+    assert(str != nullptr);
+
+    return str->reserved_size <= N;
+}
+
+// allocation function of small strings, data is the small_string itself.
+// inline_data is handed out for allocations of up to N units, other
+// allocations are passed to the backing allocator. Heap memory is never
+// shrunk to N units or fewer, instead the units are moved back into
+// inline_data, so is_inline only has to check reserved_size.
+template<typename C, s64 N>
+void *_small_string_alloc(void *data, void *ptr, s64 old_size, s64 new_size)
+{
+    auto *str = (small_string_base<C, N>*)data;
+    void *inline_ptr = (void*)str->inline_data;
+    constexpr s64 inline_bytes = N * (s64)sizeof(C);
+
+    if (ptr == inline_ptr)
+    {
+        if (new_size <= 0)
+            return nullptr;
+
+        if (new_size <= inline_bytes)
+            return inline_ptr;
+
+        // inline -> heap
+        void *n = allocator_alloc(str->backing_allocator, new_size);
+
+        if (n != nullptr)
+            ::copy_memory(inline_ptr, n, Min(old_size, new_size));
+
+        return n;
+    }
+
+    if (new_size > 0 && new_size <= inline_bytes)
+    {
+        // heap -> inline
+        if (ptr != nullptr)
+        {
+            ::copy_memory(ptr, inline_ptr, Min(old_size, new_size));
+            allocator_dealloc(str->backing_allocator, ptr, old_size);
+        }
+
+        return inline_ptr;
+    }
+
+    return allocator_realloc(str->backing_allocator, ptr, old_size, new_size);
+}
+
+template<typename C, s64 N>
+inline C *string_data(small_string_base<C, N> *str)
+{
+    if (str == nullptr)
+        return nullptr;
+
+    str->allocator.data = (void*)str;
+
+    if (str->data != nullptr && is_inline(str))
+        str->data = str->inline_data;
+
+    return str->data;
+}
+
+template<typename C, s64 N>
+void init(small_string_base<C, N> *str)
+{
+    assert(str != nullptr);
+
+    str->inline_data[0] = (C)'\0';
+    str->data = str->inline_data;
+    str->size = 0;
+    str->reserved_size = N;
+    str->backing_allocator = get_context_pointer()->allocator;
+    str->allocator = ::allocator{.alloc = _small_string_alloc<C, N>, .data = (void*)str, .try_expand = nullptr};
+}
+
+template<typename C, s64 N>
+void init(small_string_base<C, N> *str, s64 size)
+{
+    init(str);
+
+    if (size < 0)
+        size = 0;
+
+    string_reserve((string_base<C>*)str, size);
+    str->size = size;
+    str->data[size] = (C)'\0';
+}
+
+template<typename C, s64 N>
+void init(small_string_base<C, N> *str, const_string_base<C> s)
+{
+    init(str, s.size);
+
+    ::copy_memory((const void*)s.c_str, (void*)str->data, s.size * sizeof(C));
+}
+
+template<typename C, s64 N>
+void init(small_string_base<C, N> *str, const C *c, s64 size)
+{
+    init(str, const_string_base<C>{c, size});
+}
+
+template<typename C, s64 N>
+void init(small_string_base<C, N> *str, const C *c)
+{
+    init(str, const_string_base<C>{c, string_length(c)});
+}
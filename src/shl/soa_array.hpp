@@ -0,0 +1,499 @@
+#pragma once
+
+/* soa_array.hpp
+
+Contiguous dynamic structure of arrays. Each field (type) of a soa_array is
+stored in its own contiguous column, so loops that only look at one or two
+fields of every row only touch the memory of those fields.
+
+    template<typename... Ts>
+    struct soa_array
+    {
+        void *columns[sizeof...(Ts)];
+        s64 size;
+        s64 reserved_size;
+        allocator allocator;
+        void *memory;
+    }
+
+All columns are stored in one allocation, and every column starts at an
+address aligned to soa_column_alignment (64) bytes, so columns may be used
+in (SIMD) loops directly.
+
+Example usage:
+
+    // e.g. position x, position y, id
+    soa_array<float, float, u32> arr{};
+    init(&arr);
+
+    add_at_end(&arr, 1.f, 2.f, 10u);
+    add_at_end(&arr, 3.f, 4.f, 11u);
+
+    soa_row<float, float, u32> row = add_at_end(&arr);
+    row.get<0>() = 5.f;
+    row.get<1>() = 6.f;
+    row.get<2>() = 12u;
+
+    // scan one column
+    float *xs = soa_column<0>(&arr);
+
+    for (s64 i = 0; i < arr.size; ++i)
+        xs[i] += 1.f;
+
+    // iterate rows
+    for_soa_array(i, r, &arr)
+        printf("%ld: %f %f %u\n", i, r.get<0>(), r.get<1>(), r.get<2>());
+
+    free(&arr);
+
+Functions:
+
+init(*arr)    Initializes an empty soa_array with no elements and no memory.
+init(*arr, N) Initializes a soa_array with N uninitialized rows.
+
+soa_column<I>(*arr) Returns a pointer to the first element of column I.
+                    The column has arr.size valid elements.
+soa_at<I>(*arr, N)  Returns a pointer to the element of column I in row N.
+
+row_at(*arr, N)     Returns a soa_row proxy for row N.
+                    soa_row contains a pointer to the soa_array and the row
+                    index and provides get<I>() to access the fields of the
+                    row, as well as set(Values...) to set all fields of the
+                    row at once.
+                    A soa_row is invalidated when the soa_array reallocates.
+
+add_at_end(*arr)    Adds one uninitialized row at the end of the soa_array
+                    and returns a soa_row proxy for the new row.
+add_at_end(*arr, Values...) Adds the row Values... at the end of the soa_array
+                            and returns a soa_row proxy for the new row.
+add_at_start(*arr), add_at_start(*arr, Values...)
+                    Same as add_at_end, but at the start.
+
+add_elements(*arr, N)
+    Adds N uninitialized rows at the end of the soa_array and returns the
+    index of the first new row, or -1 if N <= 0 or allocation failed.
+
+insert_elements(*arr, pos, N)
+    Inserts N uninitialized rows at position pos, moving all rows after pos
+    back in every column. Returns pos, or -1 if pos > arr.size,
+    N <= 0 or allocation failed.
+
+remove_elements(*arr, pos, N)
+    Removes N rows starting at pos from every column.
+    Does nothing if pos >= arr.size.
+
+remove_from_start(*arr) Removes the first row.
+remove_from_end(*arr)   Removes the last row.
+
+reserve(*arr, N)    Reserves memory for at least N rows. Cannot shrink.
+resize(*arr, N)     Sets the number of rows to exactly N, reallocating if the
+                    reserved size is not exactly N.
+shrink_to_fit(*arr) Reallocates to only hold arr.size rows.
+
+clear(*arr)         Sets arr.size to 0, keeps the reserved memory.
+array_size(*arr)    Returns arr.size.
+
+free(*arr)          Frees the memory of the soa_array.
+
+for_soa_array(r, *arr)    Iterate the rows of a soa_array, r is a soa_row.
+for_soa_array(i, r, *arr) Iterate the rows of a soa_array, i is the index
+                          of the row and r is a soa_row.
+
+------
+NOTES:
+
+Growing a soa_array always allocates a new block of memory and copies every
+column since the offsets of the columns change, so reserve memory upfront
+if the number of rows is known.
+ */
+
+#include "shl/assert.hpp"
+#include "shl/macros.hpp"
+#include "shl/compare.hpp"
+#include "shl/type_functions.hpp"
+#include "shl/number_types.hpp"
+#include "shl/program_context.hpp"
+#include "shl/memory.hpp"
+#include "shl/math.hpp"
+#include "shl/bits.hpp"
+
+constexpr s64 soa_column_alignment = 64;
+
+template<typename... Ts>
+struct soa_array
+{
+    static_assert(sizeof...(Ts) > 0, "soa_array must have at least one field");
+
+    static constexpr s64 field_count = sizeof...(Ts);
+    static constexpr s64 field_sizes[sizeof...(Ts)] = {(s64)sizeof(Ts)...};
+
+    void *columns[sizeof...(Ts)];
+    s64 size;
+    s64 reserved_size;
+    ::allocator allocator;
+    void *memory; // start of the allocation, columns[0] may be past this
+};
+
+template<typename... Ts>
+struct soa_row
+{
+    soa_array<Ts...> *arr;
+    s64 index;
+
+    template<s64 I>
+    typename nth_type(I, Ts...) &get()
+    {
+        return reinterpret_cast<typename nth_type(I, Ts...)*>(arr->columns[I])[index];
+    }
+
+    template<s64 I>
+    const typename nth_type(I, Ts...) &get() const
+    {
+        return reinterpret_cast<const typename nth_type(I, Ts...)*>(arr->columns[I])[index];
+    }
+
+    void set(const Ts &...values)
+    {
+        s64 i = 0;
+        ((reinterpret_cast<Ts*>(arr->columns[i++])[index] = values), ...);
+    }
+};
+
+template<typename... Ts>
+inline s64 _soa_memory_size(s64 reserved_size)
+{
+    s64 ret = 0;
+
+    for (s64 i = 0; i < soa_array<Ts...>::field_count; ++i)
+        ret = ceil_multiple2(ret, soa_column_alignment) + reserved_size * soa_array<Ts...>::field_sizes[i];
+
+    // space to align the first column
+    return ret + soa_column_alignment - 1;
+}
+
+template<typename... Ts>
+inline void _soa_set_columns(void **columns, void *memory, s64 reserved_size)
+{
+    u64 addr = (u64)memory;
+
+    for (s64 i = 0; i < soa_array<Ts...>::field_count; ++i)
+    {
+        addr = ceil_multiple2(addr, (u64)soa_column_alignment);
+        columns[i] = (void*)addr;
+        addr += reserved_size * soa_array<Ts...>::field_sizes[i];
+    }
+}
+
+// moves all rows into new memory with space for new_reserved_size rows.
+template<typename... Ts>
+bool _soa_reallocate(soa_array<Ts...> *arr, s64 new_reserved_size)
+{
+    _set_allocator_if_not_set(arr);
+
+    void *new_memory = nullptr;
+    void *new_columns[sizeof...(Ts)] = {};
+
+    if (new_reserved_size > 0)
+    {
+        new_memory = allocator_alloc(arr->allocator, _soa_memory_size<Ts...>(new_reserved_size));
+
+        if (new_memory == nullptr)
+            return false;
+
+        _soa_set_columns<Ts...>(new_columns, new_memory, new_reserved_size);
+
+        s64 count = Min(arr->size, new_reserved_size);
+
+        if (arr->memory != nullptr)
+        for (s64 i = 0; i < arr->field_count; ++i)
+            ::copy_memory(arr->columns[i], new_columns[i], count * arr->field_sizes[i]);
+    }
+
+    if (arr->memory != nullptr)
+        allocator_dealloc(arr->allocator, arr->memory, _soa_memory_size<Ts...>(arr->reserved_size));
+
+    arr->memory = new_memory;
+    arr->reserved_size = new_reserved_size;
+
+    for (s64 i = 0; i < arr->field_count; ++i)
+        arr->columns[i] = new_columns[i];
+
+    return true;
+}
+
+template<typename... Ts>
+void init(soa_array<Ts...> *arr)
+{
+    assert(arr != nullptr);
+
+    for (s64 i = 0; i < arr->field_count; ++i)
+        arr->columns[i] = nullptr;
+
+    arr->size = 0;
+    arr->reserved_size = 0;
+    arr->allocator = get_context_pointer()->allocator;
+    arr->memory = nullptr;
+}
+
+template<typename... Ts>
+void init(soa_array<Ts...> *arr, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    init(arr);
+
+    if (n_elements <= 0)
+        return;
+
+    if (_soa_reallocate(arr, n_elements))
+        arr->size = n_elements;
+}
+
+template<s64 I, typename... Ts>
+typename nth_type(I, Ts...) *soa_column(soa_array<Ts...> *arr)
+{
+    assert(arr != nullptr);
+
+    return reinterpret_cast<typename nth_type(I, Ts...)*>(arr->columns[I]);
+}
+
+template<s64 I, typename... Ts>
+const typename nth_type(I, Ts...) *soa_column(const soa_array<Ts...> *arr)
+{
+    assert(arr != nullptr);
+
+    return reinterpret_cast<const typename nth_type(I, Ts...)*>(arr->columns[I]);
+}
+
+template<s64 I, typename... Ts>
+typename nth_type(I, Ts...) *soa_at(soa_array<Ts...> *arr, s64 index)
+{
+    assert(arr != nullptr);
+    assert(index >= 0);
+    assert(index < arr->size);
+
+    return soa_column<I>(arr) + index;
+}
+
+template<s64 I, typename... Ts>
+const typename nth_type(I, Ts...) *soa_at(const soa_array<Ts...> *arr, s64 index)
+{
+    assert(arr != nullptr);
+    assert(index >= 0);
+    assert(index < arr->size);
+
+    return soa_column<I>(arr) + index;
+}
+
+template<typename... Ts>
+soa_row<Ts...> row_at(soa_array<Ts...> *arr, s64 index)
+{
+    assert(arr != nullptr);
+    assert(index >= 0);
+    assert(index < arr->size);
+
+    return soa_row<Ts...>{arr, index};
+}
+
+template<typename... Ts>
+s64 add_elements(soa_array<Ts...> *arr, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (n_elements <= 0)
+        return -1;
+
+    s64 nsize = arr->size + n_elements;
+
+    if (nsize > arr->reserved_size
+     && !_soa_reallocate(arr, ceil_exp2(arr->reserved_size + n_elements)))
+        return -1;
+
+    s64 ret = arr->size;
+    arr->size = nsize;
+
+    return ret;
+}
+
+template<typename... Ts>
+s64 insert_elements(soa_array<Ts...> *arr, s64 index, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (index < 0 || index > arr->size)
+        return -1;
+
+    s64 prev_size = arr->size;
+
+    if (add_elements(arr, n_elements) < 0)
+        return -1;
+
+    for (s64 i = 0; i < arr->field_count; ++i)
+    {
+        s64 field_size = arr->field_sizes[i];
+        char *column = (char*)arr->columns[i];
+
+        ::move_memory(column + index * field_size,
+                      column + (index + n_elements) * field_size,
+                      (prev_size - index) * field_size);
+    }
+
+    return index;
+}
+
+template<typename... Ts>
+inline soa_row<Ts...> add_at_end(soa_array<Ts...> *arr)
+{
+    s64 index = add_elements(arr, 1);
+    assert(index >= 0);
+
+    return soa_row<Ts...>{arr, index};
+}
+
+template<typename... Ts>
+inline soa_row<Ts...> add_at_end(soa_array<Ts...> *arr, const Ts &...values)
+{
+    soa_row<Ts...> ret = add_at_end(arr);
+    ret.set(values...);
+    return ret;
+}
+
+template<typename... Ts>
+inline soa_row<Ts...> add_at_start(soa_array<Ts...> *arr)
+{
+    s64 index = insert_elements(arr, 0, 1);
+    assert(index >= 0);
+
+    return soa_row<Ts...>{arr, index};
+}
+
+template<typename... Ts>
+inline soa_row<Ts...> add_at_start(soa_array<Ts...> *arr, const Ts &...values)
+{
+    soa_row<Ts...> ret = add_at_start(arr);
+    ret.set(values...);
+    return ret;
+}
+
+template<typename... Ts>
+void remove_elements(soa_array<Ts...> *arr, s64 index, s64 n_elements)
+{
+    assert(arr != nullptr);
+
+    if (n_elements <= 0)
+        return;
+
+    if (index < 0 || index >= arr->size)
+        return;
+
+    if (index + n_elements >= arr->size)
+    {
+        arr->size = index;
+        return;
+    }
+
+    s64 num_items_after = arr->size - (index + n_elements);
+
+    for (s64 i = 0; i < arr->field_count; ++i)
+    {
+        s64 field_size = arr->field_sizes[i];
+        char *column = (char*)arr->columns[i];
+
+        ::move_memory(column + (index + n_elements) * field_size,
+                      column + index * field_size,
+                      num_items_after * field_size);
+    }
+
+    arr->size = arr->size - n_elements;
+}
+
+template<typename... Ts>
+inline void remove_from_start(soa_array<Ts...> *arr)
+{
+    remove_elements(arr, 0, 1);
+}
+
+template<typename... Ts>
+inline void remove_from_end(soa_array<Ts...> *arr)
+{
+    remove_elements(arr, arr->size - 1, 1);
+}
+
+template<typename... Ts>
+bool reserve(soa_array<Ts...> *arr, s64 size)
+{
+    assert(arr != nullptr);
+
+    if (arr->reserved_size >= size)
+        return true;
+
+    return _soa_reallocate(arr, size);
+}
+
+template<typename... Ts>
+bool resize(soa_array<Ts...> *arr, s64 size)
+{
+    assert(arr != nullptr);
+
+    if (size < 0)
+        size = 0;
+
+    if (arr->reserved_size != size && !_soa_reallocate(arr, size))
+        return false;
+
+    arr->size = size;
+
+    return true;
+}
+
+template<typename... Ts>
+bool shrink_to_fit(soa_array<Ts...> *arr)
+{
+    assert(arr != nullptr);
+
+    if (arr->size == arr->reserved_size)
+        return true;
+
+    return _soa_reallocate(arr, arr->size);
+}
+
+template<typename... Ts>
+void clear(soa_array<Ts...> *arr)
+{
+    assert(arr != nullptr);
+
+    arr->size = 0;
+}
+
+template<typename... Ts>
+s64 array_size(const soa_array<Ts...> *arr)
+{
+    assert(arr != nullptr);
+
+    return arr->size;
+}
+
+template<typename... Ts>
+void free(soa_array<Ts...> *arr)
+{
+    assert(arr != nullptr);
+
+    _soa_reallocate(arr, 0);
+
+    arr->size = 0;
+}
+
+#define for_soa_array_IV(I_Var, R_Var, ARRAY)\
+    if constexpr (auto R_Var = _soa_first_row(ARRAY); true)\
+    for (s64 I_Var = 0; I_Var < array_size(ARRAY); ++I_Var, ++R_Var.index)
+
+#define for_soa_array_V(R_Var, ARRAY)\
+    for_soa_array_IV(R_Var##_index, R_Var, ARRAY)
+
+#define for_soa_array(...) GET_MACRO2(__VA_ARGS__, for_soa_array_IV, for_soa_array_V)(__VA_ARGS__)
+
+template<typename... Ts>
+inline soa_row<Ts...> _soa_first_row(soa_array<Ts...> *arr)
+{
+    return soa_row<Ts...>{arr, 0};
+}
@@ -8,47 +8,14 @@
 #include "shl/platform.hpp"
 #include "shl/environment.hpp"
 #include "shl/string_encoding.hpp"
+#include "shl/string_search.hpp"
+#include "shl/number_parse.hpp"
+#include "shl/unicode_tables.hpp"
+#include "shl/simd.hpp"
 #include "shl/string.hpp"
 
 #define as_array_ptr(C, str) (array<C>*)(str)
 
-#if GNU
-#define memcmp __builtin_memcmp
-#else
-int memcmp(const void *s1, const void *s2, u64 n)
-{
-    const u8 *p1 = (const u8*)s1;
-    const u8 *p2 = (const u8*)s2;
-
-    while (n-- > 0)
-    {
-        if (*p1++ != *p2++)
-            return p1[-1] < p2[-1] ? -1 : 1;
-    }
-
-    return 0;
-}
-#endif
-
-// https://stackoverflow.com/a/52989329
-static inline void* memmem(const void* haystack, u64 haystack_len,
-    const void* const needle, const u64 needle_len)
-{
-    if (haystack == nullptr) return nullptr; // or assert(haystack != nullptr);
-    if (haystack_len == 0) return nullptr;
-    if (needle == nullptr) return nullptr; // or assert(needle != nullptr);
-    if (needle_len == 0) return nullptr;
-
-    for (const char* h = (const char*)haystack;
-        haystack_len >= needle_len;
-        ++h, --haystack_len) {
-        if (!memcmp(h, needle, needle_len)) {
-            return (void*)h;
-        }
-    }
-    return nullptr;
-}
-
 #if Windows
 template<typename T>
 static inline T *stpncpy(T *dst, const T *src, s64 len)
@@ -297,31 +264,14 @@ void clear(u32string  *str)
 }
 
 // string / char functions
-// TODO: these can probably be optimized, I hear something of a "trie" data structure
-// or something, but as long as we don't run into performance hits, I don't really care.
-bool is_space(u32 codepoint)
+static inline bool _codepoint_has_property(u32 codepoint, u32 property)
 {
-    if (codepoint > 0x00003000u)
-        return false;
-
-    if (codepoint >= 0x00000009u && codepoint <= 0x0000000Du)
-        return true;
-
-    if (codepoint == 0x00000020u) return true;
-    if (codepoint == 0x00000085u) return true;
-    if (codepoint == 0x000000A0u) return true;
-    if (codepoint == 0x00001680u) return true;
-
-    if (codepoint >= 0x00002000u && codepoint <= 0x0000200Au)
-        return true;
-
-    if (codepoint == 0x00002028u) return true;
-    if (codepoint == 0x00002029u) return true;
-    if (codepoint == 0x0000202Fu) return true;
-    if (codepoint == 0x0000205Fu) return true;
-    if (codepoint == 0x00003000u) return true;
+    return (get_unicode_codepoint_info(codepoint)->properties & property) != 0;
+}
 
-    return false;
+bool is_space(u32 codepoint)
+{
+    return _codepoint_has_property(codepoint, UNICODE_PROPERTY_SPACE);
 }
 
 bool is_newline(u32 codepoint)
@@ -341,17 +291,12 @@ bool is_newline(u32 codepoint)
 
 bool is_alpha(u32 codepoint)
 {
-    if (codepoint >= (u32)'A' && codepoint <= (u32)'Z') return true;
-    if (codepoint >= (u32)'a' && codepoint <= (u32)'z') return true;
-    // TODO: all others...
-    return false;
+    return _codepoint_has_property(codepoint, UNICODE_PROPERTY_ALPHA);
 }
 
 bool is_digit(u32 codepoint)
 {
-    if (codepoint >= (u32)'0' && codepoint <= (u32)'9') return true;
-    // TODO: all other numbers.......
-    return false;
+    return _codepoint_has_property(codepoint, UNICODE_PROPERTY_DIGIT);
 }
 
 bool is_bin_digit(u32 codepoint)
@@ -379,23 +324,123 @@ bool is_hex_digit(u32 codepoint)
 
 bool is_alphanum(u32 codepoint)
 {
-    return is_digit(codepoint) || is_alpha(codepoint);
+    return _codepoint_has_property(codepoint, UNICODE_PROPERTY_ALPHA | UNICODE_PROPERTY_DIGIT);
 }
 
 bool is_upper(u32 codepoint)
 {
-    if (codepoint >= (u32)'A' && codepoint <= (u32)'Z') return true;
-    // TODO: all alpha variants...
-    return false;
+    return _codepoint_has_property(codepoint, UNICODE_PROPERTY_UPPER);
 }
 
 bool is_lower(u32 codepoint)
 {
-    if (codepoint >= (u32)'a' && codepoint <= (u32)'z') return true;
-    // TODO: all alpha variants...
-    return false;
+    return _codepoint_has_property(codepoint, UNICODE_PROPERTY_LOWER);
+}
+
+#if Simd != SIMD_NONE
+// all bits of simd_mask set, i.e. every byte matched
+constexpr u64 _simd_full_mask = (simd_mask_bits_per_byte * 16 >= 64) ? max_value(u64) : ((1ull << (simd_mask_bits_per_byte * 16)) - 1);
+
+// bytes of V must be ASCII, i.e. positive as s8
+static inline simd_vec _simd_in_range(simd_vec v, u8 first, u8 last)
+{
+    return simd_and(simd_greater_s8(v, simd_broadcast((u8)(first - 1))),
+                    simd_greater_s8(simd_broadcast((u8)(last + 1)), v));
 }
 
+// loads 16 units at s into *out as bytes if they are all ASCII
+template<typename C>
+static inline bool _simd_load_ascii(const C *s, simd_vec *out)
+{
+    if constexpr (sizeof(C) == 1)
+    {
+        *out = simd_load(s);
+        return simd_is_ascii(*out);
+    }
+    else
+    {
+        u8 buf[16];
+
+        if (!simd_narrow_ascii_u16_u8((const u16*)s, buf))
+            return false;
+
+        *out = simd_load(buf);
+        return true;
+    }
+}
+#endif
+
+// checks 16 ASCII units at a time with SimdProp, anything else one codepoint
+// at a time with CodepointProp.
+template<typename C, typename SimdProp>
+static inline bool _string_is_property(const_string_base<C> str, bool (*codepoint_prop)(u32), [[maybe_unused]] SimdProp simd_prop)
+{
+    if (str.size <= 0)
+        return false;
+
+    const C *s = str.c_str;
+    const C *end = str.c_str + str.size;
+
+    while (s < end)
+    {
+#if Simd != SIMD_NONE
+        if constexpr (sizeof(C) <= 2)
+        {
+            simd_vec v;
+
+            if (end - s >= 16 && _simd_load_ascii(s, &v))
+            {
+                if (simd_mask(simd_prop(v)) != _simd_full_mask)
+                    return false;
+
+                s += 16;
+                continue;
+            }
+        }
+#endif
+
+        // at most 16 units until the next attempt at a vector
+        const C *block_end = (end - s > 16) ? s + 16 : end;
+
+        while (s < block_end)
+        {
+            u32 cp = 0;
+            const C *next = utf_decode(s, &cp);
+
+            if (!codepoint_prop(cp))
+                return false;
+
+            s = (next > s) ? next : s + 1;
+        }
+    }
+
+    return true;
+}
+
+#if Simd != SIMD_NONE
+#define define_string_is_property(CodepointIsProp, SimdExpr)\
+    static inline simd_vec _simd_##CodepointIsProp(simd_vec v) { return SimdExpr; }\
+    bool CodepointIsProp(const_string    str) { return _string_is_property(str, CodepointIsProp, _simd_##CodepointIsProp); }\
+    bool CodepointIsProp(const_u16string str) { return _string_is_property(str, CodepointIsProp, _simd_##CodepointIsProp); }\
+    bool CodepointIsProp(const_u32string str) { return _string_is_property(str, CodepointIsProp, _simd_##CodepointIsProp); }
+#else
+#define define_string_is_property(CodepointIsProp, SimdExpr)\
+    bool CodepointIsProp(const_string    str) { return _string_is_property(str, CodepointIsProp, 0); }\
+    bool CodepointIsProp(const_u16string str) { return _string_is_property(str, CodepointIsProp, 0); }\
+    bool CodepointIsProp(const_u32string str) { return _string_is_property(str, CodepointIsProp, 0); }
+#endif
+
+define_string_is_property(is_space,     simd_or(_simd_in_range(v, '\t', '\r'), simd_equal<u8>(v, simd_broadcast((u8)' '))));
+define_string_is_property(is_newline,   _simd_in_range(v, '\n', '\r'));
+define_string_is_property(is_alpha,     _simd_in_range(simd_or(v, simd_broadcast((u8)0x20)), 'a', 'z'));
+define_string_is_property(is_digit,     _simd_in_range(v, '0', '9'));
+define_string_is_property(is_bin_digit, _simd_in_range(v, '0', '1'));
+define_string_is_property(is_oct_digit, _simd_in_range(v, '0', '7'));
+define_string_is_property(is_hex_digit, simd_or(_simd_in_range(v, '0', '9'), _simd_in_range(simd_or(v, simd_broadcast((u8)0x20)), 'a', 'f')));
+define_string_is_property(is_alphanum,  simd_or(_simd_in_range(v, '0', '9'), _simd_in_range(simd_or(v, simd_broadcast((u8)0x20)), 'a', 'z')));
+define_string_is_property(is_upper,     _simd_in_range(v, 'A', 'Z'));
+define_string_is_property(is_lower,     _simd_in_range(v, 'a', 'z'));
+
 template<typename C>
 static inline bool _string_is_null_or_empty_cs(const_string_base<C> s)
 {
@@ -597,12 +642,15 @@ int utf_codepoint_digit_value(u32 cp)
     }
 
 template<typename C>
-static s64 _string_to_integer(const_string_base<C> s, const_string_base<C> *next, int base, s64 number_min, s64 number_max, error *err)
+static s64 _string_to_integer(const_string_base<C> s, const_string_base<C> *next, int base, s64 number_min, u64 number_max, error *err)
 {
     if (s.size <= 0)
     {
         set_error(err, 22 /* einval */, "No conversion was performed");
-        *next = s;
+
+        if (next != nullptr)
+            *next = s;
+
         return 0;
     }
 
@@ -610,9 +658,7 @@ static s64 _string_to_integer(const_string_base<C> s, const_string_base<C> *next
     bool is_neg = false;
     bool overflow = false;
 
-    s64 n = 0;
-    s64 cutoff = 0;
-    int cutlim = 0;
+    u64 n = 0;
 
     if (base < 0 || base == 1 || base > 36)
     {
@@ -676,51 +722,63 @@ static s64 _string_to_integer(const_string_base<C> s, const_string_base<C> *next
     else if (base == 0)
         base = 10;
 
-    if (number_min != 0)
+    // magnitude limit, e.g. 128 for negative s8
+    u64 limit = number_max;
+
+    if (is_neg && number_min != 0)
+        limit = (u64)(-(number_min + 1)) + 1;
+
+    if (base == 10)
     {
-        cutoff = (is_neg) ? -(number_min / base) : number_max / base;
-        cutlim = (is_neg) ? -(number_min % base) : number_max % base;
+        s64 count = parse_decimal_digits(s.c_str, s.size, limit, &n, &overflow);
+
+        if (count > 0)
+        {
+            s.c_str += count;
+            s.size -= count;
+            end = s;
+        }
     }
     else
     {
-        cutoff = number_max / base;
-        cutlim = number_max % base;
-    }
-
-    while (s.size > 0)
-    {
-        digit = utf_codepoint_digit_value(cp);
+        u64 cutoff = limit / base;
+        u64 cutlim = limit % base;
 
-        if (digit < 0)
+        while (s.size > 0)
         {
-            if (cp >= (u32)'A' && cp <= (u32)'z')
-                digit = (int)((cp - (u32)'A') & (~((u32)'a' ^ (u32)'A'))) + 10;
-            else
+            digit = utf_codepoint_digit_value(cp);
+
+            if (digit < 0)
+            {
+                if (cp >= (u32)'A' && cp <= (u32)'z')
+                    digit = (int)((cp - (u32)'A') & (~((u32)'a' ^ (u32)'A'))) + 10;
+                else
+                    break;
+            }
+
+            if (digit < 0 || digit >= base)
                 break;
-        }
 
-        if (digit < 0 || digit >= base)
-            break;
+            s = utf_advance(s);
+            end = s;
+            _to_number_utf_decode(s, cp, utf_error);
 
-        s = utf_advance(s);
-        end = s;
-        _to_number_utf_decode(s, cp, utf_error);
+            if (overflow)
+            {
+                if (next != nullptr)
+                    continue;
 
-        if (overflow)
-        {
-            if (next != nullptr)
+                break;
+            }
+
+            if (n > cutoff || (n == cutoff && (u64)digit > cutlim))
+            {
+                overflow = 1;
                 continue;
+            }
 
-            break;
+            n = n * base + digit;
         }
-
-        if (n > cutoff || (n == cutoff && digit > cutlim))
-        {
-            overflow = 1;
-            continue;
-        }
-
-        n = n * base + digit;
     }
 
     if (next != nullptr)
@@ -729,16 +787,16 @@ static s64 _string_to_integer(const_string_base<C> s, const_string_base<C> *next
     if (overflow)
     {
         set_error(err, 34 /* erange */, "Parse overflow");
-        return ((is_neg) ? number_min : number_max);
+        return ((is_neg) ? number_min : (s64)number_max);
     }
 
-    return (s64)((is_neg) ? -n : n);
+    return (s64)((is_neg) ? (0 - n) : n);
 }
 
 #define define_string_to_integer_c(NumberType, CharType)\
 NumberType _string_to_##NumberType(const_string_base<CharType> s, const_string_base<CharType> *next, int base, error *err)\
 {\
-    s64 n = _string_to_integer(s, next, base, min_value(NumberType), max_value(NumberType), err);\
+    s64 n = _string_to_integer(s, next, base, min_value(NumberType), (u64)max_value(NumberType), err);\
     return (NumberType)n;\
 }
 
@@ -762,189 +820,180 @@ static double _string_to_decimal(const_string_base<C> s, const_string_base<C> *n
     if (s.size <= 0)
     {
         set_error(err, 22 /* einval */, "No conversion was performed");
-        *next = s;
+
+        if (next != nullptr)
+            *next = s;
+
         return 0.0;
     }
 
-    const_string_base<C> orig = s;
-    const_string_base<C> pexp{};
-    int sign = 0;
-    int exp_sign = 0;
+    double ret = 0.0;
+    bool out_of_range = false;
+    s64 count = parse_decimal_float(s.c_str, s.size, &ret, &out_of_range);
 
-    double fraction = 0;
-    double double_exp = 0;
-    int exp = 0;
-    int frac_exp = 0;
-    int mant_size = 0;
-    int dec_pt = -1;
+    if (out_of_range)
+        set_error(err, 34 /* erange */, "Overflow");
 
-    u32 cp = 0;
-    int utf_error = 0;
-    _to_number_utf_decode(s, cp, utf_error);
+    if (next != nullptr)
+        *next = const_string_base<C>{s.c_str + count, s.size - count};
 
-    if (cp == (u32)'+')
-    {
-        sign = 1;
-        s = utf_advance(s);
-        _to_number_utf_decode(s, cp, utf_error);
-    }
-    else if (cp == (u32)'-')
-    {
-        sign = -1;
-        s = utf_advance(s);
-        _to_number_utf_decode(s, cp, utf_error);
-    }
+    return ret;
+}
 
-    int digit = utf_codepoint_digit_value(cp);
+// finite doubles that round to infinity as float, for which (float)d is
+// undefined. FLT_MAX plus half an ulp rounds up since FLT_MAX is odd.
+static inline bool _float_out_of_range(double d)
+{
+    return (d >= 0x1.ffffffp127 || d <= -0x1.ffffffp127) && d - d == 0;
+}
 
-    pexp = s;
+static inline float _double_to_float(double d)
+{
+    if (_float_out_of_range(d))
+        d = d > 0 ? 1e308 * 10.0 : -1e308 * 10.0;
 
-    while (true)
-    {
-        if (digit == -1)
-        {
-            if ((cp != (u32)'.') || (dec_pt >= 0))
-                break;
+    return (float)d;
+}
 
-            dec_pt = mant_size;
-        }
+#define define_string_to_decimal_c(NumberType, CharType)\
+NumberType _string_to_##NumberType(const_string_base<CharType> s, const_string_base<CharType> *next, error *err)\
+{\
+    double n = _string_to_decimal(s, next, err);\
+\
+    if constexpr (is_same(NumberType, float))\
+    {\
+        if (_float_out_of_range(n))\
+            set_error(err, 34 /* erange */, "Overflow");\
+\
+        return _double_to_float(n);\
+    }\
+    else\
+        return (NumberType)n;\
+}
 
-        mant_size += 1;
-        pexp = utf_advance(pexp);
-        _to_number_utf_decode(pexp, cp, utf_error);
-        digit = utf_codepoint_digit_value(cp);
-    }
+#define define_string_to_decimal(NumberType)\
+    define_string_to_decimal_c(NumberType, c8) \
+    define_string_to_decimal_c(NumberType, c16)\
+    define_string_to_decimal_c(NumberType, c32)\
 
-    if (dec_pt < 0)
-        dec_pt = mant_size;
-    else
-        mant_size -= 1;
+define_string_to_decimal(float);
+define_string_to_decimal(double);
 
-    if (mant_size > 18)
-    {
-        frac_exp = dec_pt - 18;
-        mant_size = 18;
-    }
-    else
-        frac_exp = dec_pt - mant_size;
+template<typename C>
+static inline bool _is_number_field_space(C c, C delim)
+{
+    return c != delim && (c == (C)' ' || c == (C)'\t' || c == (C)'\r' || c == (C)'\n');
+}
 
-    if (mant_size == 0)
-    {
-        fraction = 0.0;
+template<typename C, typename N>
+static s64 _string_to_numbers_cs(const_string_base<C> s, C delim, array<N> *out, error *err)
+{
+    assert(out != nullptr);
 
-        if (next != nullptr)
-            *next = orig;
+    s64 count = 0;
+    s64 i = 0;
 
-        return sign < 0 ? -fraction : fraction;
-    }
-    else
+    while (true)
     {
-        s64 frac1 = 0;
+        while (i < s.size && _is_number_field_space(s.c_str[i], delim))
+            i++;
 
-        _to_number_utf_decode(s, cp, utf_error);
+        if (i >= s.size)
+            break;
+
+        const C *field = s.c_str + i;
+        s64 rest = s.size - i;
+        s64 parsed = 0;
+        bool overflow = false;
+        N value{};
 
-        while (mant_size > 0)
+        if constexpr (is_same(N, float) || is_same(N, double))
         {
-            _to_number_utf_decode(s, cp, utf_error);
+            double d = 0.0;
+            parsed = parse_decimal_float(field, rest, &d, &overflow);
 
-            if (cp == (u32)'.')
+            if constexpr (is_same(N, float))
             {
-                s = utf_advance(s);
-                _to_number_utf_decode(s, cp, utf_error);
+                overflow = overflow || _float_out_of_range(d);
+                value = _double_to_float(d);
             }
+            else
+                value = (N)d;
+        }
+        else
+        {
+            bool is_neg = false;
+            s64 sign = 0;
 
-            digit = utf_codepoint_digit_value(cp);
+            if (field[0] == (C)'+' || (is_signed(N) && field[0] == (C)'-'))
+            {
+                is_neg = field[0] == (C)'-';
+                sign = 1;
+            }
 
-            frac1 = 10 * frac1 + digit;
-            s = utf_advance(s);
-            mant_size -= 1;
-        }
+            u64 limit = (u64)max_value(N);
 
-        fraction = (double)frac1;
-    }
+            if (is_neg)
+                limit += 1;
 
-    s = pexp;
-    _to_number_utf_decode(s, cp, utf_error);
+            u64 n = 0;
+            parsed = parse_decimal_digits(field + sign, rest - sign, limit, &n, &overflow);
 
-    if ((cp == (u32)'E') || (cp == (u32)'e'))
-    {
-        s = utf_advance(s);
-        _to_number_utf_decode(s, cp, utf_error);
+            if (parsed > 0)
+                parsed += sign;
 
-        if (cp == (u32)'-')
-        {
-            exp_sign = -1;
-            s = utf_advance(s);
-            _to_number_utf_decode(s, cp, utf_error);
+            value = (N)(is_neg ? (0 - n) : n);
         }
-        else if (cp == (u32)'+')
+
+        if (parsed == 0)
         {
-            s = utf_advance(s);
-            _to_number_utf_decode(s, cp, utf_error);
-            exp_sign = 1;
+            set_error(err, 22 /* einval */, "No conversion was performed");
+            return -1;
         }
 
-        digit = utf_codepoint_digit_value(cp);
-
-        while (digit != -1)
+        if (overflow)
         {
-            exp = exp * 10 + digit;
-            s = utf_advance(s);
-            _to_number_utf_decode(s, cp, utf_error);
-            digit = utf_codepoint_digit_value(cp);
+            set_error(err, 34 /* erange */, "Parse overflow");
+            return -1;
         }
-    }
-
-    exp = exp_sign < 0 ? (frac_exp - exp) : (frac_exp + exp);
-
-    if (exp < 0)
-    {
-        exp_sign = -1;
-        exp = -exp;
-    }
-    else
-        exp_sign = 1;
 
-    constexpr int max_exponent = 511;
-    constexpr double exp_pow10[] = { 10.0, 100.0, 1.0e4, 1.0e8, 1.0e16, 1.0e32, 1.0e64, 1.0e128, 1.0e256 };
-
-    if (exp > max_exponent)
-    {
-        exp = max_exponent;
-        set_error(err, 34 /* erange */, "Overflow");
-    }
+        add_at_end(out, value);
+        count += 1;
+        i += parsed;
 
-    double_exp = 1.0;
+        while (i < s.size && _is_number_field_space(s.c_str[i], delim))
+            i++;
 
-    for (const double *d = exp_pow10; exp != 0; exp >>= 1, d += 1)
-        if (exp & 01)
-            double_exp *= *d;
+        if (i >= s.size)
+            break;
 
-    if (exp_sign < 0)
-        fraction /= double_exp;
-    else
-        fraction *= double_exp;
+        if (s.c_str[i] != delim)
+        {
+            set_error(err, 22 /* einval */, "Unexpected character");
+            return -1;
+        }
 
-    if (next != nullptr)
-        *next = s;
+        i += 1;
+    }
 
-    return sign < 0 ? -fraction : fraction;
+    return count;
 }
 
-#define define_string_to_decimal_c(NumberType, CharType)\
-NumberType _string_to_##NumberType(const_string_base<CharType> s, const_string_base<CharType> *next, error *err)\
-{\
-    double n = _string_to_decimal(s, next, err);\
-    return (NumberType)n;\
-}
+#define define_string_to_numbers(NumberType)\
+    s64 _string_to_numbers(const_string    s, c8  delim, array<NumberType> *out, error *err) { return _string_to_numbers_cs(s, delim, out, err); }\
+    s64 _string_to_numbers(const_u16string s, c16 delim, array<NumberType> *out, error *err) { return _string_to_numbers_cs(s, delim, out, err); }\
+    s64 _string_to_numbers(const_u32string s, c32 delim, array<NumberType> *out, error *err) { return _string_to_numbers_cs(s, delim, out, err); }
 
-#define define_string_to_decimal(NumberType)\
-    define_string_to_decimal_c(NumberType, c8) \
-    define_string_to_decimal_c(NumberType, c16)\
-    define_string_to_decimal_c(NumberType, c32)\
-
-define_string_to_decimal(float);
-define_string_to_decimal(double);
+define_string_to_numbers(s8);
+define_string_to_numbers(s16);
+define_string_to_numbers(s32);
+define_string_to_numbers(s64);
+define_string_to_numbers(u8);
+define_string_to_numbers(u16);
+define_string_to_numbers(u32);
+define_string_to_numbers(u64);
+define_string_to_numbers(float);
+define_string_to_numbers(double);
 
 // manip
 template<typename C>
@@ -1160,11 +1209,12 @@ static inline s64 _string_index_of_c(const_string_base<C> haystack, C needle, s6
     if (offset >= haystack.size)
         return -1;
 
-    for (s64 i = offset; i < haystack.size; ++i)
-        if (haystack.c_str[i] == needle)
-            return i;
+    s64 idx = search_unit(haystack.c_str + offset, haystack.size - offset, needle);
 
-    return -1;
+    if (idx < 0)
+        return -1;
+
+    return idx + offset;
 }
 
 s64 string_index_of(const_string    haystack, c8              needle, s64 offset)
@@ -1197,34 +1247,12 @@ static inline s64 _string_index_of_s(const_string_base<C> str, const_string_base
     if (needle.size > str.size)
         return -1;
 
-    if constexpr (sizeof(C) == 1)
-    {
-        // char
-        void *begin = (void*)(str.c_str + offset);
-        s64 size = str.size - offset;
-
-        void *f = memmem(begin, size, needle.c_str, needle.size);
-
-        if (f == nullptr)
-            return -1;
-
-        // casting to char ONLY for math
-        s64 diff = (char*)f - (char*)str.c_str;
-        return static_cast<s64>(diff);
-    }
-    else
-    {
-        void *begin = (void*)(str.c_str + offset);
-        s64 size = (str.size - offset) * sizeof(C);
-
-        void *f = memmem(begin, size, needle.c_str, needle.size * sizeof(C));
+    s64 idx = search_units(str.c_str + offset, str.size - offset, needle.c_str, needle.size);
 
-        if (f == nullptr)
-            return -1;
+    if (idx < 0)
+        return -1;
 
-        s64 diff = (char*)f - (char*)str.c_str;
-        return static_cast<s64>(diff / sizeof(C));
-    }
+    return idx + offset;
 }
 
 s64 _string_index_of(const_string    haystack, const_string    needle, s64 offset)
@@ -1251,11 +1279,7 @@ static inline s64 _string_last_index_of_c(const_string_base<C> haystack, C needl
     if (offset == max_value(s64) || offset + 1 >= haystack.size)
         offset = haystack.size - 1;
 
-    for (s64 i = offset; i >= 0; --i)
-        if (haystack.c_str[i] == needle)
-            return i;
-
-    return -1;
+    return search_last_unit(haystack.c_str, offset + 1, needle);
 }
 
 s64 string_last_index_of(const_string    haystack, c8              needle, s64 offset)
@@ -1285,27 +1309,10 @@ static inline s64 _string_last_index_of_s(const_string_base<C> str, const_string
     if (needle.size > str.size)
         return -1;
 
-    if (offset + needle.size > str.size)
+    if (offset > str.size - needle.size)
         offset = str.size - needle.size;
 
-    s64 i = offset;
-    s64 matching_count = 0;
-
-    while (i >= 0)
-    {
-        while (str[i + matching_count] == needle[matching_count])
-        {
-            matching_count += 1;
-
-            if (matching_count == needle.size)
-                return i;
-        }
-        
-        matching_count = 0;
-        i -= 1;
-    }
-
-    return -1;
+    return search_last_units(str.c_str, offset + needle.size, needle.c_str, needle.size);
 }
 
 s64 _string_last_index_of(const_string    haystack, const_string    needle, s64 offset)
@@ -1323,6 +1330,65 @@ s64 _string_last_index_of(const_u32string haystack, const_u32string needle, s64
     return _string_last_index_of_s(haystack, needle, offset);
 }
 
+template<typename C>
+static inline s64 _string_index_of_any_s(const_string_base<C> haystack, const_string_base<C> set, s64 offset)
+{
+    if (offset < 0)
+        return -1;
+
+    if (offset >= haystack.size)
+        return -1;
+
+    s64 idx = search_any_unit(haystack.c_str + offset, haystack.size - offset, set.c_str, set.size);
+
+    if (idx < 0)
+        return -1;
+
+    return idx + offset;
+}
+
+s64 _string_index_of_any(const_string    haystack, const_string    set, s64 offset)
+{
+    return _string_index_of_any_s(haystack, set, offset);
+}
+
+s64 _string_index_of_any(const_u16string haystack, const_u16string set, s64 offset)
+{
+    return _string_index_of_any_s(haystack, set, offset);
+}
+
+s64 _string_index_of_any(const_u32string haystack, const_u32string set, s64 offset)
+{
+    return _string_index_of_any_s(haystack, set, offset);
+}
+
+template<typename C>
+static inline s64 _string_last_index_of_any_s(const_string_base<C> haystack, const_string_base<C> set, s64 offset)
+{
+    if (offset < 0)
+        return -1;
+
+    if (offset >= haystack.size - 1)
+        offset = haystack.size - 1;
+
+    return search_last_any_unit(haystack.c_str, offset + 1, set.c_str, set.size);
+}
+
+s64 _string_last_index_of_any(const_string    haystack, const_string    set, s64 offset)
+{
+    return _string_last_index_of_any_s(haystack, set, offset);
+}
+
+s64 _string_last_index_of_any(const_u16string haystack, const_u16string set, s64 offset)
+{
+    return _string_last_index_of_any_s(haystack, set, offset);
+}
+
+s64 _string_last_index_of_any(const_u32string haystack, const_u32string set, s64 offset)
+{
+    return _string_last_index_of_any_s(haystack, set, offset);
+}
+
 template<typename C>
 static inline bool _string_trim_left(string_base<C> *s)
 {
@@ -1420,50 +1486,107 @@ c32 char_to_upper(c32 c) { return _char_to_upper(c); }
 
 u32 utf_codepoint_to_upper(u32 cp)
 {
-    if (cp >= 'a' && cp <= 'z')
-        return (cp - 'a') + 'A';
-    return cp;
+    return (u32)((s32)cp + get_unicode_codepoint_info(cp)->upper_delta);
 }
 
-void utf_codepoint_to_upper(c8  *codepoint)
+u32 utf_codepoint_to_lower(u32 cp)
 {
-    u32 cp = utf_codepoint_to_upper(utf_decode(codepoint));
-    utf8_encode(cp, codepoint);
+    return (u32)((s32)cp + get_unicode_codepoint_info(cp)->lower_delta);
 }
 
-void utf_codepoint_to_upper(c16 *codepoint)
+// converts the codepoint at s in-place, so mappings that change the encoded
+// length of the codepoint are not applied.
+template<typename C>
+static inline void _utf_codepoint_to_case(C *s, s64 length, u32 (*to_case)(u32))
 {
-    u32 cp = utf_codepoint_to_upper(utf_decode(codepoint));
-    utf16_encode(cp, codepoint);
-}
+    u32 cp = utf_decode(s);
+    u32 mapped = to_case(cp);
 
-void utf_codepoint_to_upper(c32 *codepoint)
-{
-    u32 cp = utf_codepoint_to_upper(utf_decode(codepoint));
-    utf32_encode(cp, codepoint);
-}
+    if (mapped == cp)
+        return;
 
-void utf_to_upper(c8  *s, s64 size)
-{
-    auto cs = const_string_base{s, size};
-    for_utf_string(cp, c, cs)
-        utf8_encode(utf_codepoint_to_upper(cp), (c8*)c.c_str);
+    if constexpr (sizeof(C) == 1)
+    {
+        if (codepoint_utf8_length(mapped) == length)
+            utf8_encode(mapped, s);
+    }
+    else if constexpr (sizeof(C) == 2)
+    {
+        if (codepoint_utf16_length(mapped) == length)
+            utf16_encode(mapped, s);
+    }
+    else
+        *s = (C)mapped;
 }
 
-void utf_to_upper(c16 *s, s64 size)
+#if Simd != SIMD_NONE
+// converts ASCII letters in [first, last] to the other case
+static inline simd_vec _simd_ascii_flip_case(simd_vec v, u8 first, u8 last)
 {
-    auto cs = const_string_base{s, size};
-    for_utf_string(c, cs)
-        utf_codepoint_to_upper((c8*)c.c_str);
+    return simd_xor(v, simd_and(_simd_in_range(v, first, last), simd_broadcast((u8)0x20)));
 }
+#endif
 
-void utf_to_upper(c32 *s, s64 size)
+// converts 16 ASCII units at a time with vectors, anything else one
+// codepoint at a time.
+template<typename C>
+static void _utf_to_case(C *s, s64 size, u32 (*to_case)(u32), [[maybe_unused]] u8 ascii_first, [[maybe_unused]] u8 ascii_last)
 {
-    auto cs = const_string_base{s, size};
-    for_utf_string(c, cs)
-        utf_codepoint_to_upper((c8*)c.c_str);
+    C *end = s + size;
+
+    while (s < end)
+    {
+#if Simd != SIMD_NONE
+        if constexpr (sizeof(C) <= 2)
+        {
+            simd_vec v;
+
+            if (end - s >= 16 && _simd_load_ascii(s, &v))
+            {
+                v = _simd_ascii_flip_case(v, ascii_first, ascii_last);
+
+                if constexpr (sizeof(C) == 1)
+                    simd_store(s, v);
+                else
+                {
+                    u8 buf[16];
+                    simd_store(buf, v);
+                    simd_widen_u8_u16(buf, (u16*)s);
+                }
+
+                s += 16;
+                continue;
+            }
+        }
+#endif
+
+        C *block_end = (end - s > 16) ? s + 16 : end;
+
+        while (s < block_end)
+        {
+            s64 length = utf_codepoint_length(s);
+
+            if (length <= 0)
+                length = 1;
+
+            // truncated codepoint at the end
+            if (length > end - s)
+                return;
+
+            _utf_codepoint_to_case(s, length, to_case);
+            s += length;
+        }
+    }
 }
 
+void utf_codepoint_to_upper(c8  *codepoint) { _utf_codepoint_to_case(codepoint, utf_codepoint_length(codepoint), utf_codepoint_to_upper); }
+void utf_codepoint_to_upper(c16 *codepoint) { _utf_codepoint_to_case(codepoint, utf_codepoint_length(codepoint), utf_codepoint_to_upper); }
+void utf_codepoint_to_upper(c32 *codepoint) { _utf_codepoint_to_case(codepoint, 1, utf_codepoint_to_upper); }
+
+void utf_to_upper(c8  *s, s64 size) { _utf_to_case(s, size, utf_codepoint_to_upper, 'a', 'z'); }
+void utf_to_upper(c16 *s, s64 size) { _utf_to_case(s, size, utf_codepoint_to_upper, 'a', 'z'); }
+void utf_to_upper(c32 *s, s64 size) { _utf_to_case(s, size, utf_codepoint_to_upper, 'a', 'z'); }
+
 void utf_to_upper(string    *s)
 {
     utf_to_upper(s->data, s->size);
@@ -1479,7 +1602,6 @@ void utf_to_upper(u32string *s)
     utf_to_upper(s->data, s->size);
 }
 
-
 template<typename C>
 static inline C _char_to_lower(C c)
 {
@@ -1493,51 +1615,13 @@ c8  char_to_lower(c8  c) { return _char_to_lower(c); }
 c16 char_to_lower(c16 c) { return _char_to_lower(c); }
 c32 char_to_lower(c32 c) { return _char_to_lower(c); }
 
-u32 utf_codepoint_to_lower(u32 cp)
-{
-    if (cp >= 'A' && cp <= 'Z')
-        return (cp - 'A') + 'a';
-    return cp;
-}
+void utf_codepoint_to_lower(c8  *codepoint) { _utf_codepoint_to_case(codepoint, utf_codepoint_length(codepoint), utf_codepoint_to_lower); }
+void utf_codepoint_to_lower(c16 *codepoint) { _utf_codepoint_to_case(codepoint, utf_codepoint_length(codepoint), utf_codepoint_to_lower); }
+void utf_codepoint_to_lower(c32 *codepoint) { _utf_codepoint_to_case(codepoint, 1, utf_codepoint_to_lower); }
 
-void utf_codepoint_to_lower(c8  *codepoint)
-{
-    u32 cp = utf_codepoint_to_lower(utf_decode(codepoint));
-    utf8_encode(cp, codepoint);
-}
-
-void utf_codepoint_to_lower(c16 *codepoint)
-{
-    u32 cp = utf_codepoint_to_lower(utf_decode(codepoint));
-    utf16_encode(cp, codepoint);
-}
-
-void utf_codepoint_to_lower(c32 *codepoint)
-{
-    u32 cp = utf_codepoint_to_lower(utf_decode(codepoint));
-    utf32_encode(cp, codepoint);
-}
-
-void utf_to_lower(c8  *s, s64 size)
-{
-    auto cs = const_string_base{s, size};
-    for_utf_string(cp, c, cs)
-        utf8_encode(utf_codepoint_to_lower(cp), (c8*)c.c_str);
-}
-
-void utf_to_lower(c16 *s, s64 size)
-{
-    auto cs = const_string_base{s, size};
-    for_utf_string(c, cs)
-        utf_codepoint_to_lower((c8*)c.c_str);
-}
-
-void utf_to_lower(c32 *s, s64 size)
-{
-    auto cs = const_string_base{s, size};
-    for_utf_string(c, cs)
-        utf_codepoint_to_lower((c8*)c.c_str);
-}
+void utf_to_lower(c8  *s, s64 size) { _utf_to_case(s, size, utf_codepoint_to_lower, 'A', 'Z'); }
+void utf_to_lower(c16 *s, s64 size) { _utf_to_case(s, size, utf_codepoint_to_lower, 'A', 'Z'); }
+void utf_to_lower(c32 *s, s64 size) { _utf_to_case(s, size, utf_codepoint_to_lower, 'A', 'Z'); }
 
 void utf_to_lower(string    *s)
 {
@@ -1784,116 +1868,299 @@ void _string_replace(u32string *s, const_u32string needle, const_u32string repla
 }
 
 template<typename C>
-static inline void _string_replace_all_s(string_base<C> *s, const_string_base<C> needle, const_string_base<C> replacement, s64 offset)
+static inline s64 _string_count_occurrences(const_string_base<C> s, const_string_base<C> needle, s64 offset)
+{
+    s64 count = 0;
+    s64 idx = string_index_of(s, needle, offset);
+
+    while (idx >= 0)
+    {
+        count++;
+        idx = string_index_of(s, needle, idx + needle.size);
+    }
+
+    return count;
+}
+
+template<typename C>
+static inline s64 _string_replace_all_s(string_base<C> *s, const_string_base<C> needle, const_string_base<C> replacement, s64 offset)
 {
     // TODO: UTF replace
+    assert(s != nullptr);
+
     if (needle.size == 0)
-        return;
+        return 0;
 
-    s64 idx = string_index_of(s, needle, offset);
+    const_string_base<C> str = to_const_string(s);
+    s64 idx = string_index_of(str, needle, offset);
 
-    while (idx >= 0)
+    if (idx < 0)
+        return 0;
+
+    s64 count = 0;
+
+    if (replacement.size <= needle.size)
     {
-        if (needle.size > replacement.size)
+        // the result is never longer than the input, so matches can be
+        // compacted forward in place: the write position never overtakes
+        // the read position.
+        s64 read = idx;
+        s64 write = idx;
+
+        while (idx >= 0)
         {
-            s64 size_diff = needle.size - replacement.size;
-            s64 remaining_size = string_length(s) - idx - needle.size;
+            s64 n = idx - read;
+
+            if (n > 0 && write != read)
+                move_memory(s->data + read, s->data + write, sizeof(C) * n);
 
-            s->size -= size_diff;
+            write += n;
+            copy_memory(replacement.c_str, s->data + write, sizeof(C) * replacement.size);
+            write += replacement.size;
+            read = idx + needle.size;
+            count++;
 
-            move_memory(s->data + idx + needle.size, s->data + idx + replacement.size, sizeof(C) * remaining_size);
-            s->data[s->size] = '\0';
+            idx = string_index_of(str, needle, read);
         }
-        else if (needle.size < replacement.size)
-        {
-            s64 size_diff = replacement.size - needle.size;
-            s64 remaining_size = string_length(s) - idx - needle.size;
 
-            string_reserve(s, string_length(s) + size_diff);
-            s->size += size_diff;
+        s64 n = s->size - read;
 
-            move_memory(s->data + idx + needle.size, s->data + idx + replacement.size, sizeof(C) * remaining_size);
-            s->data[s->size] = '\0';
-        }
+        if (n > 0 && write != read)
+            move_memory(s->data + read, s->data + write, sizeof(C) * n);
+
+        s->size = write + n;
+        s->data[s->size] = '\0';
+
+        return count;
+    }
+
+    // the result grows: count the matches, reserve once, move the tail
+    // (everything after the first match) to the end of the new buffer
+    // and rebuild the string in a single forward pass reading from the
+    // moved tail. The write position stays behind the read position
+    // because each remaining match is still ahead of it.
+    count = _string_count_occurrences(str, needle, idx);
+
+    s64 diff = (replacement.size - needle.size) * count;
+    s64 new_size = s->size + diff;
+
+    string_reserve(s, new_size);
+
+    move_memory(s->data + idx, s->data + idx + diff, sizeof(C) * (s->size - idx));
+
+    const_string_base<C> tail{s->data + idx + diff, s->size - idx};
+    s64 read = 0;
+    s64 write = idx;
+    s64 tidx = 0; // the tail starts with the first match
 
-        string_copy(replacement, s, max_value(s64), idx);
+    while (tidx >= 0)
+    {
+        s64 n = tidx - read;
+
+        if (n > 0)
+            move_memory(tail.c_str + read, s->data + write, sizeof(C) * n);
 
-        idx = string_index_of(s, needle, idx + 1);
+        write += n;
+        copy_memory(replacement.c_str, s->data + write, sizeof(C) * replacement.size);
+        write += replacement.size;
+        read = tidx + needle.size;
+
+        tidx = string_index_of(tail, needle, read);
     }
+
+    // remaining tail is already in its final position
+    s->size = new_size;
+    s->data[s->size] = '\0';
+
+    return count;
 }
 
-void _string_replace_all(string  *s, const_string  needle, const_string  replacement, s64 offset)
+s64 _string_replace_all(string  *s, const_string  needle, const_string  replacement, s64 offset)
 {
-    _string_replace_all_s(s, needle, replacement, offset);
+    return _string_replace_all_s(s, needle, replacement, offset);
 }
 
-void _string_replace_all(u16string *s, const_u16string needle, const_u16string replacement, s64 offset)
+s64 _string_replace_all(u16string *s, const_u16string needle, const_u16string replacement, s64 offset)
 {
-    _string_replace_all_s(s, needle, replacement, offset);
+    return _string_replace_all_s(s, needle, replacement, offset);
 }
 
-void _string_replace_all(u32string *s, const_u32string needle, const_u32string replacement, s64 offset)
+s64 _string_replace_all(u32string *s, const_u32string needle, const_u32string replacement, s64 offset)
 {
-    _string_replace_all_s(s, needle, replacement, offset);
+    return _string_replace_all_s(s, needle, replacement, offset);
 }
 
 template<typename C>
-static inline s64 _split_s(const_string_base<C> s, const_string_base<C> delim, array<const_string_base<C>> *out)
+static inline s64 _string_replace_all_out_s(const_string_base<C> s, const_string_base<C> needle, const_string_base<C> replacement, string_base<C> *out, s64 offset)
 {
-    // TODO: UTF split
-    if (delim.size == 0)
-        return 0;
+    // TODO: UTF replace
+    assert(out != nullptr);
+    assert(s.c_str == nullptr || s.c_str != out->data);
 
-    s64 split_count = 0;
-    out->size = 0;
+    s64 count = 0;
 
-    s64 begin = 0;
-    s64 end = string_index_of(s, delim);
-    s64 diff = 0;
+    if (needle.size > 0)
+        count = _string_count_occurrences(s, needle, offset);
 
-    const_string_base<C> to_add;
+    s64 new_size = s.size + (replacement.size - needle.size) * count;
 
-    while (end >= 0)
+    string_reserve(out, new_size);
+
+    if (count == 0)
     {
-        split_count++;
-        diff = end - begin;
+        if (s.size > 0)
+            copy_memory(s.c_str, out->data, sizeof(C) * s.size);
 
-        if (diff <= 0)
-        {
-            to_add.c_str = string_literal(C, "");
-            to_add.size = 0;
-        }
-        else
-        {
-            to_add.c_str = s.c_str + begin;
-            to_add.size = end - begin;
-        }
+        out->size = s.size;
+        out->data[out->size] = '\0';
+        return 0;
+    }
 
-        add_at_end(out, to_add);
+    s64 read = 0;
+    s64 write = 0;
+    s64 idx = string_index_of(s, needle, offset);
 
-        begin = end + delim.size;
-        end = string_index_of(s, delim, end + delim.size);
+    while (idx >= 0)
+    {
+        s64 n = idx - read;
+        copy_memory(s.c_str + read, out->data + write, sizeof(C) * n);
+        write += n;
+        copy_memory(replacement.c_str, out->data + write, sizeof(C) * replacement.size);
+        write += replacement.size;
+        read = idx + needle.size;
+
+        idx = string_index_of(s, needle, read);
     }
 
-    end = s.size;
-    diff = end - begin;
+    copy_memory(s.c_str + read, out->data + write, sizeof(C) * (s.size - read));
+
+    out->size = new_size;
+    out->data[out->size] = '\0';
+
+    return count;
+}
+
+s64 _string_replace_all(const_string    s, const_string    needle, const_string    replacement, string    *out, s64 offset)
+{
+    return _string_replace_all_out_s(s, needle, replacement, out, offset);
+}
+
+s64 _string_replace_all(const_u16string s, const_u16string needle, const_u16string replacement, u16string *out, s64 offset)
+{
+    return _string_replace_all_out_s(s, needle, replacement, out, offset);
+}
+
+s64 _string_replace_all(const_u32string s, const_u32string needle, const_u32string replacement, u32string *out, s64 offset)
+{
+    return _string_replace_all_out_s(s, needle, replacement, out, offset);
+}
+
+template<typename C>
+static inline bool _string_split_next_s(const_string_base<C> *rest, const_string_base<C> delim, const_string_base<C> *piece)
+{
+    assert(rest != nullptr);
+    assert(piece != nullptr);
+
+    if (rest->c_str == nullptr)
+        return false;
 
-    if (diff <= 0)
+    s64 idx = -1;
+
+    if (delim.size > 0)
+        idx = search_units(rest->c_str, rest->size, delim.c_str, delim.size);
+
+    if (idx < 0)
     {
-        to_add.c_str = string_literal(C, "");
-        to_add.size = 0;
+        *piece = *rest;
+        rest->c_str = nullptr;
+        rest->size = 0;
+        return true;
     }
-    else
+
+    piece->c_str = rest->c_str;
+    piece->size = idx;
+    rest->c_str += idx + delim.size;
+    rest->size  -= idx + delim.size;
+
+    return true;
+}
+
+template<typename C>
+static inline bool _string_split_next_c(const_string_base<C> *rest, C delim, const_string_base<C> *piece)
+{
+    assert(rest != nullptr);
+    assert(piece != nullptr);
+
+    if (rest->c_str == nullptr)
+        return false;
+
+    s64 idx = search_unit(rest->c_str, rest->size, delim);
+
+    if (idx < 0)
     {
-        to_add.c_str = s.c_str + begin;
-        to_add.size = end - begin;
+        *piece = *rest;
+        rest->c_str = nullptr;
+        rest->size = 0;
+        return true;
     }
 
-    add_at_end(out, to_add);
+    piece->c_str = rest->c_str;
+    piece->size = idx;
+    rest->c_str += idx + 1;
+    rest->size  -= idx + 1;
+
+    return true;
+}
+
+bool _string_split_next(const_string    *rest, const_string    delim, const_string    *piece)
+{
+    return _string_split_next_s(rest, delim, piece);
+}
+
+bool _string_split_next(const_u16string *rest, const_u16string delim, const_u16string *piece)
+{
+    return _string_split_next_s(rest, delim, piece);
+}
 
-    return split_count;
+bool _string_split_next(const_u32string *rest, const_u32string delim, const_u32string *piece)
+{
+    return _string_split_next_s(rest, delim, piece);
+}
+
+bool string_split_next(const_string    *rest, c8  delim, const_string    *piece)
+{
+    return _string_split_next_c(rest, delim, piece);
 }
 
+bool string_split_next(const_u16string *rest, c16 delim, const_u16string *piece)
+{
+    return _string_split_next_c(rest, delim, piece);
+}
+
+bool string_split_next(const_u32string *rest, c32 delim, const_u32string *piece)
+{
+    return _string_split_next_c(rest, delim, piece);
+}
+
+template<typename C>
+static inline s64 _split_s(const_string_base<C> s, const_string_base<C> delim, array<const_string_base<C>> *out)
+{
+    // TODO: UTF split
+    if (delim.size == 0)
+        return 0;
+
+    out->size = 0;
+
+    if (s.c_str == nullptr)
+        s.c_str = string_literal(C, "");
+
+    const_string_base<C> piece;
+
+    while (_string_split_next_s(&s, delim, &piece))
+        add_at_end(out, piece);
+
+    return out->size - 1;
+}
 
 s64 _string_split(const_string    s, const_string    delim, array<const_string>    *out)
 {
@@ -131,6 +131,11 @@ is_lower(u32 cp)
 is_lower(const_string str)
     Returns true if str only contains lower case alphabetical codepoint.
 
+    Codepoint properties are looked up in the Unicode tables of
+    shl/unicode_tables.hpp. The string versions check 16 units at a time
+    using vector instructions as long as the units are ASCII, and fall back
+    to codepoint lookups for non-ASCII text.
+
 string_length(...)
     Returns the number of units, not codepoints, not including null at the end,
     of the given parameter. Accepts most strings as parameter.
@@ -195,6 +200,19 @@ string_to_float(Str s, const_string *next = nullptr, error *err = nullptr)
 
 string_to_double(...) same as string_to_float
 
+    Decimal integers are parsed 8 digits at a time and floating point numbers
+    are rounded correctly using the Eisel-Lemire algorithm, see
+    shl/number_parse.hpp.
+
+string_to_numbers(Str s, C delim, array<N> *out, error *err = nullptr)
+    Parses the delim-separated decimal numbers in s (e.g. a CSV column or
+    a line of numbers) and adds them to the end of out. N may be any integer
+    type, float or double. Spaces, tabs and newlines (except delim) around
+    numbers are skipped and a trailing delim is allowed.
+    Returns the number of numbers added, or -1 if a field is empty, is not
+    a number or does not fit into N, and sets err accordingly. Numbers
+    before the invalid field remain in out.
+
 string_set(string *dest, Str src)
     Copies src into dest, discarding anything in dest before setting.
     NOTE: string_set may also convert between UTF types, e.g.:
@@ -228,6 +246,20 @@ string_last_index_of(haystack, needle[, offset])
     optionally ending at offset (moving towards the beginning),
     within the string haystack, or -1 if needle was not found.
 
+string_index_of_any(Str haystack, Str set[, offset])
+    Returns the unit index of the first unit in haystack that is any of the
+    units in set, optionally starting at offset, or -1 if there is none.
+    e.g. string_index_of_any(line, "\",\n") returns the index of the first
+    quote, comma or newline in line.
+
+string_last_index_of_any(Str haystack, Str set[, offset])
+    Returns the unit index of the last unit in haystack that is any of the
+    units in set, optionally ending at offset, or -1 if there is none.
+
+    The index_of functions use the vectorized search kernels of
+    shl/string_search.hpp and always return indices of units, including for
+    UTF-16 and UTF-32 strings.
+
 contains(Str haystack, Str needle)
     Returns true if haystack contains needle, false if not.
 
@@ -256,10 +288,13 @@ utf_codepoint_to_upper(c32 cp)
 
 utf_codepoint_to_upper(c8* / c16* / c32* )
     Changes the given UTF-8/16/32 codepoint from lower case to upper case.
-    Only a single codepoint is affected.
+    Only a single codepoint is affected. Since the codepoint is changed
+    in-place, mappings whose upper case codepoint has a different encoded
+    length (e.g. U+0131 in UTF-8) are not applied.
 
 utf_to_upper(string *s)
-    Converts the entire string s to upper case.
+    Converts the entire string s to upper case, using simple (single
+    codepoint) case mappings. ASCII text is converted 16 units at a time.
 
 utf_codepoint_to_lower(c32 cp)
     Returns the lower case UTF codepoint of cp, or cp if cp is already
@@ -267,7 +302,7 @@ utf_codepoint_to_lower(c32 cp)
 
 utf_codepoint_to_lower(c8* / c16* / c32* )
     Changes the given UTF-8/16/32 codepoint from upper case to lower case.
-    Only a single codepoint is affected.
+    Only a single codepoint is affected, see utf_codepoint_to_upper.
 
 utf_to_lower(string *s)
     Converts the entire string s to lower case.
@@ -298,12 +333,45 @@ string_replace(string *str, Str needle, Str replacement[, s64 offset])
 
 string_replace_all(string *str, Str needle, Str replacement[, s64 offset])
     Replaces the all occurrences of needle with replacement [starting at offset] in
-    str.
+    str and returns the number of replacements.
+    Matches do not overlap and text inserted by a replacement is never matched
+    again. Runs in a single pass over str and reallocates at most once.
+
+string_replace_all(Str src, Str needle, Str replacement, string *out[, s64 offset])
+    Same as above, but writes the result into out instead of modifying src,
+    discarding anything in out before. out must not be src.
 
 string_split(Str s, Str delim, array<const_string> *out)
     Splits Str by delimiter delim and stores slices (const_string, pointing into str)
     in the array out. Resets the size of out.
 
+string_split_next(const_string *rest, Str delim, const_string *piece)
+string_split_next(const_string *rest, c8 delim, const_string *piece)
+    Sets piece to the part of rest up to the first occurrence of delim
+    and advances rest past the delimiter. Returns false once all pieces have
+    been returned. Pieces are slices of the original string and nothing is
+    allocated, so this can be used to read only the first few fields of a
+    string. Yields the same pieces as string_split, i.e. N delimiters yield
+    N+1 pieces, some of which may be empty. An empty delim yields rest
+    as a single piece.
+    Example:
+
+        const_string rest = "a,b,,c"_cs;
+        const_string field;
+
+        while (string_split_next(&rest, ',', &field))
+            ... // "a", "b", "", "c"
+
+for_string_split([I, ]Piece, Str, Delim)
+    Iterates the pieces of Str split by Delim using string_split_next,
+    optionally with the index I of the piece. Example:
+
+        for_string_split(i, field, line, '\t')
+        {
+            if (i == 2) break;
+            ...
+        }
+
 string_join(Str* strings, s64 n, Str delim, string *out)
     Joins strings together, separated by delim, and writes the output to out.
     strings is a pointer to N strings (const char**, const_string*, string*, etc.).
@@ -520,37 +588,34 @@ inline const_string_base<C> utf_advance(const_string_base<C> str)
 // character/codepoint functions
 bool is_space(u32 codepoint);
 
-#define define_string_is_property(CodepointIsProp)\
-    template<typename C>\
-    bool CodepointIsProp(const_string_base<C> str)\
-    {\
-        if (str.size <= 0) return false;\
-        for_utf_string(cp, _, str) if (!CodepointIsProp(cp)) return false;\
-        return true;\
-    }
+// these check 16 units at a time while the string is ASCII
+#define declare_string_is_property(CodepointIsProp)\
+    bool CodepointIsProp(const_string    str);\
+    bool CodepointIsProp(const_u16string str);\
+    bool CodepointIsProp(const_u32string str);
 
-define_string_is_property(is_space);
+declare_string_is_property(is_space);
 
 bool is_newline(u32 codepoint);
-define_string_is_property(is_newline);
+declare_string_is_property(is_newline);
 
 bool is_alpha(u32 codepoint);
-define_string_is_property(is_alpha);
+declare_string_is_property(is_alpha);
 bool is_digit(u32 codepoint);
-define_string_is_property(is_digit);
+declare_string_is_property(is_digit);
 bool is_bin_digit(u32 codepoint);
-define_string_is_property(is_bin_digit);
+declare_string_is_property(is_bin_digit);
 bool is_oct_digit(u32 codepoint);
-define_string_is_property(is_oct_digit);
+declare_string_is_property(is_oct_digit);
 bool is_hex_digit(u32 codepoint);
-define_string_is_property(is_hex_digit);
+declare_string_is_property(is_hex_digit);
 bool is_alphanum(u32 codepoint);
-define_string_is_property(is_alphanum);
+declare_string_is_property(is_alphanum);
 
 bool is_upper(u32 codepoint);
-define_string_is_property(is_upper);
+declare_string_is_property(is_upper);
 bool is_lower(u32 codepoint);
-define_string_is_property(is_lower);
+declare_string_is_property(is_lower);
 
 // string functions
 
@@ -745,6 +810,29 @@ declare_string_to_integer(u64);
 declare_string_to_decimal(float);
 declare_string_to_decimal(double);
 
+#define declare_string_to_numbers(NumberType)\
+    s64 _string_to_numbers(const_string    s, c8  delim, array<NumberType> *out, error *err);\
+    s64 _string_to_numbers(const_u16string s, c16 delim, array<NumberType> *out, error *err);\
+    s64 _string_to_numbers(const_u32string s, c32 delim, array<NumberType> *out, error *err);
+
+declare_string_to_numbers(s8);
+declare_string_to_numbers(s16);
+declare_string_to_numbers(s32);
+declare_string_to_numbers(s64);
+declare_string_to_numbers(u8);
+declare_string_to_numbers(u16);
+declare_string_to_numbers(u32);
+declare_string_to_numbers(u64);
+declare_string_to_numbers(float);
+declare_string_to_numbers(double);
+
+template<typename T, typename N>
+auto string_to_numbers(T s, typename decltype(to_const_string(s))::value_type delim, array<N> *out, error *err = nullptr)
+    -> decltype(_string_to_numbers(to_const_string(s), delim, out, err))
+{
+    return _string_to_numbers(to_const_string(s), delim, out, err);
+}
+
 // string manipulation
 
 // sets dst to src, discarding all previous data in dst.
@@ -922,6 +1010,28 @@ auto string_last_index_of(T haystack, c32 needle, s64 offset)
     return _string_last_index_of(to_const_string(haystack), needle, offset);
 }
 
+s64 _string_index_of_any(const_string    haystack, const_string    set, s64 offset);
+s64 _string_index_of_any(const_u16string haystack, const_u16string set, s64 offset);
+s64 _string_index_of_any(const_u32string haystack, const_u32string set, s64 offset);
+
+template<typename T1, typename T2>
+auto string_index_of_any(T1 haystack, T2 set, s64 offset = 0)
+    -> decltype(_string_index_of_any(to_const_string(haystack), to_const_string(set), offset))
+{
+    return _string_index_of_any(to_const_string(haystack), to_const_string(set), offset);
+}
+
+s64 _string_last_index_of_any(const_string    haystack, const_string    set, s64 offset);
+s64 _string_last_index_of_any(const_u16string haystack, const_u16string set, s64 offset);
+s64 _string_last_index_of_any(const_u32string haystack, const_u32string set, s64 offset);
+
+template<typename T1, typename T2>
+auto string_last_index_of_any(T1 haystack, T2 set, s64 offset = max_value(s64))
+    -> decltype(_string_last_index_of_any(to_const_string(haystack), to_const_string(set), offset))
+{
+    return _string_last_index_of_any(to_const_string(haystack), to_const_string(set), offset);
+}
+
 template<typename T1, typename T2>
 auto contains(T1 haystack, T2 needle)
     -> decltype(string_index_of(to_const_string(haystack), needle) != -1)
@@ -956,6 +1066,7 @@ void utf_to_upper(u32string *s);
 c8  char_to_lower(c8  c);
 c16 char_to_lower(c16 c);
 c32 char_to_lower(c32 c);
+u32  utf_codepoint_to_lower(u32  codepoint);
 void utf_codepoint_to_lower(c8  *codepoint);
 void utf_codepoint_to_lower(c16 *codepoint);
 void utf_codepoint_to_lower(c32 *codepoint);
@@ -1030,15 +1141,26 @@ auto string_replace(string_base<C> *s, TNeedle needle, TReplacement replacement,
     _string_replace(s, to_const_string(needle), to_const_string(replacement), offset);
 }
 
-void _string_replace_all(string    *s, const_string    needle, const_string    replacement, s64 offset);
-void _string_replace_all(u16string *s, const_u16string needle, const_u16string replacement, s64 offset);
-void _string_replace_all(u32string *s, const_u32string needle, const_u32string replacement, s64 offset);
+s64 _string_replace_all(string    *s, const_string    needle, const_string    replacement, s64 offset);
+s64 _string_replace_all(u16string *s, const_u16string needle, const_u16string replacement, s64 offset);
+s64 _string_replace_all(u32string *s, const_u32string needle, const_u32string replacement, s64 offset);
 
 template<typename C, typename TNeedle, typename TReplacement>
 auto string_replace_all(string_base<C> *s, TNeedle needle, TReplacement replacement, s64 offset = 0)
     -> decltype(_string_replace_all(s, to_const_string(needle), to_const_string(replacement), offset))
 {
-    _string_replace_all(s, to_const_string(needle), to_const_string(replacement), offset);
+    return _string_replace_all(s, to_const_string(needle), to_const_string(replacement), offset);
+}
+
+s64 _string_replace_all(const_string    s, const_string    needle, const_string    replacement, string    *out, s64 offset);
+s64 _string_replace_all(const_u16string s, const_u16string needle, const_u16string replacement, u16string *out, s64 offset);
+s64 _string_replace_all(const_u32string s, const_u32string needle, const_u32string replacement, u32string *out, s64 offset);
+
+template<typename C, typename TStr, typename TNeedle, typename TReplacement>
+auto string_replace_all(TStr s, TNeedle needle, TReplacement replacement, string_base<C> *out, s64 offset = 0)
+    -> decltype(_string_replace_all(to_const_string(s), to_const_string(needle), to_const_string(replacement), out, offset))
+{
+    return _string_replace_all(to_const_string(s), to_const_string(needle), to_const_string(replacement), out, offset);
 }
 
 s64 _string_split(const_string    s, const_string    delim, array<const_string>    *out);
@@ -1059,6 +1181,32 @@ auto string_split(T s, C delim, array<const_string_base<C>> *out)
     return _string_split(to_const_string(s), delim, out);
 }
 
+bool _string_split_next(const_string    *rest, const_string    delim, const_string    *piece);
+bool _string_split_next(const_u16string *rest, const_u16string delim, const_u16string *piece);
+bool _string_split_next(const_u32string *rest, const_u32string delim, const_u32string *piece);
+bool string_split_next(const_string    *rest, c8  delim, const_string    *piece);
+bool string_split_next(const_u16string *rest, c16 delim, const_u16string *piece);
+bool string_split_next(const_u32string *rest, c32 delim, const_u32string *piece);
+
+template<typename C, typename TDelim>
+auto string_split_next(const_string_base<C> *rest, TDelim delim, const_string_base<C> *piece)
+    -> decltype(_string_split_next(rest, to_const_string(delim), piece))
+{
+    return _string_split_next(rest, to_const_string(delim), piece);
+}
+
+#define for_string_split_IP(I_Var, P_Var, STRING, DELIM)\
+    if constexpr (auto P_Var##_rest = to_const_string(STRING); true)\
+    if constexpr (decltype(P_Var##_rest) P_Var{}; true)\
+    for (s64 I_Var = 0; string_split_next(&P_Var##_rest, DELIM, &P_Var); ++I_Var)
+
+#define for_string_split_P(P_Var, STRING, DELIM)\
+    if constexpr (auto P_Var##_rest = to_const_string(STRING); true)\
+    if constexpr (decltype(P_Var##_rest) P_Var{}; true)\
+    while (string_split_next(&P_Var##_rest, DELIM, &P_Var))
+
+#define for_string_split(...) GET_MACRO3(__VA_ARGS__, for_string_split_IP, for_string_split_P)(__VA_ARGS__)
+
 void _string_join(const c8     **strings, s64 count, const_string delim, string *out);
 void _string_join(const_string  *strings, s64 count, const_string delim, string *out);
 void _string_join(const string  *strings, s64 count, const_string delim, string *out);
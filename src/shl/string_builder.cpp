@@ -0,0 +1,211 @@
+
+#include "shl/assert.hpp"
+#include "shl/memory.hpp"
+#include "shl/compare.hpp"
+#include "shl/program_context.hpp"
+#include "shl/string_builder.hpp"
+
+void init(string_builder *sb)
+{
+    init(sb, string_builder_min_chunk_size);
+}
+
+void init(string_builder *sb, s64 first_chunk_size)
+{
+    assert(sb != nullptr);
+
+    sb->allocator = get_context_pointer()->allocator;
+    sb->current = 0;
+    sb->size = 0;
+
+    with_allocator(sb->allocator)
+    {
+        init(&sb->chunks);
+        init(&sb->scratch);
+    }
+
+    if (first_chunk_size > 0)
+    {
+        string_builder_chunk *chunk = add_at_end(&sb->chunks);
+        chunk->data = (c8*)allocator_alloc(sb->allocator, first_chunk_size);
+        chunk->size = 0;
+        chunk->capacity = first_chunk_size;
+    }
+}
+
+void free(string_builder *sb)
+{
+    assert(sb != nullptr);
+
+    for_array(chunk, &sb->chunks)
+        allocator_dealloc(sb->allocator, chunk->data, chunk->capacity);
+
+    free(&sb->chunks);
+    free(&sb->scratch);
+    sb->current = 0;
+    sb->size = 0;
+}
+
+void clear(string_builder *sb)
+{
+    assert(sb != nullptr);
+
+    for_array(chunk, &sb->chunks)
+        chunk->size = 0;
+
+    sb->current = 0;
+    sb->size = 0;
+}
+
+c8 *_string_builder_reserve(string_builder *sb, s64 min_size, s64 *out_available)
+{
+    assert(sb != nullptr);
+    assert(out_available != nullptr);
+
+    // skips full (or, after clear, too small) chunks that are already allocated
+    while (sb->current < sb->chunks.size)
+    {
+        string_builder_chunk *chunk = sb->chunks.data + sb->current;
+
+        if (chunk->capacity - chunk->size >= min_size)
+        {
+            *out_available = chunk->capacity - chunk->size;
+            return chunk->data + chunk->size;
+        }
+
+        if (sb->current + 1 >= sb->chunks.size)
+            break;
+
+        sb->current += 1;
+    }
+
+    s64 capacity = string_builder_min_chunk_size;
+
+    if (sb->chunks.size > 0)
+        capacity = Min(sb->chunks.data[sb->chunks.size - 1].capacity * 2, (s64)string_builder_max_chunk_size);
+
+    capacity = Max(capacity, min_size);
+
+    string_builder_chunk *chunk = add_at_end(&sb->chunks);
+    chunk->data = (c8*)allocator_alloc(sb->allocator, capacity);
+    chunk->size = 0;
+    chunk->capacity = capacity;
+    sb->current = sb->chunks.size - 1;
+
+    *out_available = capacity;
+    return chunk->data;
+}
+
+void _string_builder_commit(string_builder *sb, s64 size)
+{
+    assert(sb != nullptr);
+    assert(sb->current < sb->chunks.size);
+
+    string_builder_chunk *chunk = sb->chunks.data + sb->current;
+
+    assert(chunk->size + size <= chunk->capacity);
+
+    chunk->size += size;
+    sb->size += size;
+}
+
+s64 _string_builder_append(string_builder *sb, const_string str)
+{
+    assert(sb != nullptr);
+
+    s64 copied = 0;
+
+    // fills the current chunk, then continues in the next one
+    while (copied < str.size)
+    {
+        s64 available = 0;
+        c8 *buf = _string_builder_reserve(sb, 1, &available);
+        s64 n = Min(available, str.size - copied);
+
+        copy_memory(str.c_str + copied, buf, n);
+        _string_builder_commit(sb, n);
+        copied += n;
+    }
+
+    return copied;
+}
+
+s64 string_builder_append(string_builder *sb, c8 c)
+{
+    return _string_builder_append(sb, const_string{&c, 1});
+}
+
+void string_builder_to_string(const string_builder *sb, string *out)
+{
+    assert(sb != nullptr);
+    assert(out != nullptr);
+
+    string_reserve(out, sb->size);
+
+    s64 offset = 0;
+
+    for_string_builder_chunks(span, sb)
+    {
+        copy_memory(span.c_str, out->data + offset, span.size);
+        offset += span.size;
+    }
+
+    out->size = sb->size;
+    out->data[out->size] = '\0';
+}
+
+string string_builder_to_string(const string_builder *sb)
+{
+    string ret{};
+    init(&ret);
+    string_builder_to_string(sb, &ret);
+    return ret;
+}
+
+s64 string_builder_write(const string_builder *sb, io_handle h, error *err)
+{
+    assert(sb != nullptr);
+
+    array<io_write_buffer> buffers{};
+    init(&buffers);
+    reserve(&buffers, sb->chunks.size);
+
+    for_string_builder_chunks(span, sb)
+        add_at_end(&buffers, io_write_buffer{.data = span.c_str, .size = span.size});
+
+    s64 total = 0;
+    s64 first = 0;
+
+    while (first < buffers.size)
+    {
+        s64 written = io_write_gather(h, buffers.data + first, buffers.size - first, err);
+
+        if (written < 0)
+        {
+            total = -1;
+            break;
+        }
+
+        if (written == 0)
+            break;
+
+        total += written;
+
+        // skips the fully written buffers and the written part of the next one
+        while (first < buffers.size && written >= buffers.data[first].size)
+        {
+            written -= buffers.data[first].size;
+            first += 1;
+        }
+
+        if (first < buffers.size)
+        {
+            buffers.data[first].data = (const c8*)buffers.data[first].data + written;
+            buffers.data[first].size -= written;
+        }
+    }
+
+    free(&buffers);
+
+    return total;
+}
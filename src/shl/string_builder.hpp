@@ -0,0 +1,159 @@
+#pragma once
+
+/* string_builder.hpp
+
+Collects many pieces of text (strings and formatted values) and produces
+one contiguous string with a single allocation, or writes all pieces to an
+io_handle with a single gather write, without making the text contiguous.
+
+Pieces are copied into chunks of memory owned by the builder. A new chunk
+is only allocated when the current one is full, and every new chunk is twice
+as large as the previous one (up to string_builder_max_chunk_size), so
+appending never moves text that was already appended, and the number of
+chunks stays small. Formatting writes directly into the current chunk if the
+result fits, otherwise the result is formatted into a scratch string of the
+builder first.
+
+    struct string_builder
+    {
+        array<string_builder_chunk> chunks;
+        s64 current;        // index of the chunk being appended to
+        s64 size;           // total bytes in all chunks
+        string scratch;
+        allocator allocator;
+    }
+
+Example usage:
+
+    string_builder sb{};
+    init(&sb);
+
+    string_builder_append(&sb, "HTTP/1.1 200 OK\r\n");
+    string_builder_format(&sb, "Content-Length: %\r\n\r\n", body.size);
+    string_builder_append(&sb, body);
+
+    string_builder_write(&sb, socket);      // single writev
+    // or
+    string s = string_builder_to_string(&sb); // single allocation
+
+    free(&s);
+    free(&sb);
+
+Functions:
+
+init(*sb)               initializes an empty builder.
+init(*sb, ChunkSize)    initializes an empty builder whose first chunk holds
+                        ChunkSize bytes (default string_builder_min_chunk_size).
+free(*sb)               frees all chunks and the scratch string.
+clear(*sb)              empties the builder, keeping all chunks for reuse.
+
+string_builder_append(*sb, Str)     appends Str (anything to_const_string
+                                    accepts) or a single c8.
+string_builder_format(*sb, Fmt, ...) appends the formatted string, see
+                                    format in shl/format.hpp.
+    Both return the number of bytes appended.
+
+string_builder_to_string(*sb)       returns a new string with all pieces.
+string_builder_to_string(*sb, *out) sets out to all pieces, reserving out
+                                    only once.
+string_builder_write(*sb, Handle[, *err])
+    writes all pieces to Handle using io_write_gather, retrying partial writes
+    until everything is written. Returns the number of bytes written, or -1
+    on error.
+
+for_string_builder_chunks(Span, *sb)
+    iterates the non-empty chunks of sb in order, Span is a const_string
+    of the bytes of the chunk.
+ */
+
+#include "shl/number_types.hpp"
+#include "shl/array.hpp"
+#include "shl/string.hpp"
+#include "shl/format.hpp"
+#include "shl/io.hpp"
+#include "shl/error.hpp"
+
+#ifndef string_builder_min_chunk_size
+#define string_builder_min_chunk_size 1024
+#endif
+
+#ifndef string_builder_max_chunk_size
+#define string_builder_max_chunk_size 65536
+#endif
+
+struct string_builder_chunk
+{
+    c8 *data;
+    s64 size;
+    s64 capacity;
+};
+
+struct string_builder
+{
+    array<string_builder_chunk> chunks;
+    s64 current;
+    s64 size;
+    string scratch;
+    ::allocator allocator;
+};
+
+void init(string_builder *sb);
+void init(string_builder *sb, s64 first_chunk_size);
+void free(string_builder *sb);
+void clear(string_builder *sb);
+
+// returns a pointer to at least min_size free bytes at the end of the
+// builder, *out_available receives the number of free bytes.
+c8 *_string_builder_reserve(string_builder *sb, s64 min_size, s64 *out_available);
+// marks size bytes of the pointer returned by _string_builder_reserve as used.
+void _string_builder_commit(string_builder *sb, s64 size);
+
+s64 _string_builder_append(string_builder *sb, const_string str);
+s64 string_builder_append(string_builder *sb, c8 c);
+
+template<typename T>
+auto string_builder_append(string_builder *sb, T str)
+    -> decltype(_string_builder_append(sb, to_const_string(str)))
+{
+    return _string_builder_append(sb, to_const_string(str));
+}
+
+template<typename... Ts>
+s64 string_builder_format(string_builder *sb, const_string fmt, Ts &&...args)
+{
+    assert(sb != nullptr);
+
+    s64 available = 0;
+    c8 *buf = _string_builder_reserve(sb, 1, &available);
+    s64 written = format(buf, available, fmt, forward<Ts>(args)...);
+
+    // the buffer is filled completely if the result did not fit
+    if (written >= 0 && written < available)
+    {
+        _string_builder_commit(sb, written);
+        return written;
+    }
+
+    written = format(&sb->scratch, fmt, forward<Ts>(args)...);
+
+    if (written < 0)
+        return -1;
+
+    return _string_builder_append(sb, const_string{sb->scratch.data, written});
+}
+
+template<typename... Ts>
+s64 string_builder_format(string_builder *sb, const c8 *fmt, Ts &&...args)
+{
+    return string_builder_format(sb, to_const_string(fmt), forward<Ts>(args)...);
+}
+
+void string_builder_to_string(const string_builder *sb, string *out);
+string string_builder_to_string(const string_builder *sb);
+
+s64 string_builder_write(const string_builder *sb, io_handle h, error *err = nullptr);
+
+#define for_string_builder_chunks(S_Var, SB)\
+    for_array(S_Var##_chunk, &(SB)->chunks)\
+    if (S_Var##_chunk->size > 0)\
+    if constexpr (const_string S_Var{S_Var##_chunk->data, S_Var##_chunk->size}; true)
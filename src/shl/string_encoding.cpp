@@ -1,8 +1,26 @@
 
 #include "shl/memory.hpp" // copy_memory
 #include "shl/compare.hpp" // Min
+#include "shl/bits.hpp" // popcnt64
+#include "shl/simd.hpp"
 #include "shl/string_encoding.hpp"
 
+#if Simd != SIMD_NONE
+// The ASCII fast paths of the functions that stop at a null character only
+// use aligned 16 (or 32) byte blocks so that they never read across a page
+// boundary past the end of the string.
+static inline bool _is_aligned(const void *p, u64 alignment)
+{
+    return ((u64)p & (alignment - 1)) == 0;
+}
+
+// true if the 16 bytes in v are all ASCII and none are zero
+static inline bool _is_ascii_block(simd_vec v)
+{
+    return simd_is_ascii(v) && simd_mask(simd_equal<u8>(v, simd_broadcast((u8)0))) == 0;
+}
+#endif
+
 static constexpr char _utf8_lengths[] = {
     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
     0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 3, 3, 4, 0
@@ -120,6 +138,19 @@ static inline s64 _utf8_decode_string(const c8 *u8str, const c8 **end, s64 u8str
 
     while (err == 0 && (s - u8str < u8str_size) && *s != '\0' && i < out_length)
     {
+#if Simd != SIMD_NONE
+        if (_is_aligned(s, 16)
+         && u8str_size - (s - u8str) >= 16
+         && out_length - i >= 16
+         && _is_ascii_block(simd_load(s)))
+        {
+            simd_widen_u8_u32(s, out + i);
+            s += 16;
+            i += 16;
+            continue;
+        }
+#endif
+
         s = utf8_decode(s, out + i, &err);
         i += 1;
     }
@@ -445,6 +476,19 @@ s64 utf8_to_utf16(const c8 *u8str, s64 u8str_size,  c16  *out, s64 out_size)
         if (u16_index >= out_size)
             break;
 
+#if Simd != SIMD_NONE
+        if (_is_aligned(s, 16)
+         && u8str_size - (s64)(s - u8str) >= 16
+         && out_size - u16_index >= 16
+         && _is_ascii_block(simd_load(s)))
+        {
+            simd_widen_u8_u16(s, (u16*)(out + u16_index));
+            s += 16;
+            u16_index += 16;
+            continue;
+        }
+#endif
+
         cp_len = utf_codepoint_length(s);
         s = utf8_decode_safe(s, &cp, &err);
 
@@ -496,6 +540,25 @@ s64 utf16_to_utf8(const c16 *u16str, s64 u16str_size, char *out, s64 out_size)
         if (u8_index >= out_size)
             break;
 
+#if Simd != SIMD_NONE
+        // 32 byte aligned so both 16 byte loads are on the same page
+        if (_is_aligned(s, 32)
+         && u16str_size - (s64)(s - u16str) >= 16
+         && out_size - u8_index >= 16)
+        {
+            simd_vec zero = simd_broadcast((u16)0);
+            simd_vec zeroes = simd_or(simd_equal<c16>(simd_load(s), zero),
+                                      simd_equal<c16>(simd_load(s + 8), zero));
+
+            if (simd_mask(zeroes) == 0 && simd_narrow_ascii_u16_u8((const u16*)s, out + u8_index))
+            {
+                s += 16;
+                u8_index += 16;
+                continue;
+            }
+        }
+#endif
+
         s = utf16_decode(s, &cp, &err);
 
         if (err != 0)
@@ -606,6 +669,28 @@ s64 utf16_bytes_required_from_utf8(const c8 *u8str, s64 u8str_size)
 
     while (u8str_size > 0 && *u8str != '\0')
     {
+#if Simd != SIMD_NONE
+        if (u8str_size >= 16 && _is_aligned(u8str, 16))
+        {
+            simd_vec v = simd_load(u8str);
+
+            if (simd_mask(simd_equal<u8>(v, simd_broadcast((u8)0))) == 0)
+            {
+                // every byte that is not a continuation byte (0x80 - 0xbf)
+                // starts a codepoint, and bytes >= 0xf0 start a codepoint
+                // that needs a surrogate pair.
+                u64 starts = simd_mask(simd_greater_s8(v, simd_broadcast((u8)0xbf)));
+                u64 fours  = simd_mask(simd_greater_s8(v, simd_broadcast((u8)0xef)))
+                           & simd_mask(simd_greater_s8(simd_broadcast((u8)0), v));
+
+                sz += (s64)((popcnt64(starts) + popcnt64(fours)) / simd_mask_bits_per_byte);
+                u8str += 16;
+                u8str_size -= 16;
+                continue;
+            }
+        }
+#endif
+
         if ((u8)(*u8str) - 0x80u >= 0x40u) sz += 1;
         if ((u8)(*u8str) >= 0xf0u)         sz += 1;
 
@@ -623,19 +708,26 @@ s64 utf16_bytes_required_from_utf32(const c32 *u32str, s64 u32str_size)
 
 s64 utf32_bytes_required_from_utf8(const c8 *u8str, s64 u8str_size)
 {
+    // every byte that is not a continuation byte (0x80 - 0xbf) starts a codepoint
     s64 sz = 0;
-    const c8 *start = u8str;
-    const c8 *s = start;
-    int len = 0;
+    s64 i = 0;
+    const u8 *s = (const u8*)u8str;
 
-    while ((s64)(s - start) < u8str_size)
+#if Simd != SIMD_NONE
+    simd_vec continuation_max = simd_broadcast((u8)0xbf);
+
+    for (; i + 16 <= u8str_size; i += 16)
     {
-        len = _utf8_lengths[((u8)s[0]) >> 3];
-        s = s + len + !len;
-        sz += sizeof(c32);
+        u64 starts = simd_mask(simd_greater_s8(simd_load(s + i), continuation_max));
+        sz += (s64)(popcnt64(starts) / simd_mask_bits_per_byte);
     }
+#endif
 
-    return sz;
+    for (; i < u8str_size; ++i)
+        if ((s[i] & 0xc0) != 0x80)
+            sz += 1;
+
+    return sz * sizeof(c32);
 }
 
 s64 utf32_bytes_required_from_utf16(const c16 *u16str, s64 u16str_size)
@@ -645,6 +737,23 @@ s64 utf32_bytes_required_from_utf16(const c16 *u16str, s64 u16str_size)
 
     while (u16str_size > 0)
     {
+#if Simd != SIMD_NONE
+        if (u16str_size >= 8)
+        {
+            simd_vec v = simd_load(u16str);
+            simd_vec surrogates = simd_equal<u16>(simd_and(v, simd_broadcast((u16)UTF16_SURROGATE_MASK)),
+                                                  simd_broadcast((u16)UTF16_SURROGATE_HIGH));
+
+            if (simd_mask(surrogates) == 0)
+            {
+                sz += 8 * sizeof(c32);
+                u16str += 8;
+                u16str_size -= 8;
+                continue;
+            }
+        }
+#endif
+
         high = *(const u16*)u16str;
         sz += sizeof(c32);
 
@@ -663,6 +772,129 @@ s64 utf32_bytes_required_from_utf16(const c16 *u16str, s64 u16str_size)
     return sz;
 }
 
+// returns the length of the valid UTF-8 sequence at s, or 0 if the sequence
+// is invalid, overlong, a surrogate, above UNICODE_MAX or truncated.
+static inline s64 _utf8_valid_sequence_length(const u8 *s, s64 size)
+{
+    u8 c = s[0];
+
+    if (c < 0x80)
+        return 1;
+
+    if (c < 0xc2) // continuation byte or overlong 2 byte sequence
+        return 0;
+
+    if (c < 0xe0)
+    {
+        if (size < 2 || (s[1] & 0xc0) != 0x80)
+            return 0;
+
+        return 2;
+    }
+
+    u8 min = 0x80;
+    u8 max = 0xbf;
+
+    if (c < 0xf0)
+    {
+        if      (c == 0xe0) min = 0xa0; // overlong
+        else if (c == 0xed) max = 0x9f; // surrogates
+
+        if (size < 3 || s[1] < min || s[1] > max || (s[2] & 0xc0) != 0x80)
+            return 0;
+
+        return 3;
+    }
+
+    if (c < 0xf5)
+    {
+        if      (c == 0xf0) min = 0x90; // overlong
+        else if (c == 0xf4) max = 0x8f; // > UNICODE_MAX
+
+        if (size < 4 || s[1] < min || s[1] > max || (s[2] & 0xc0) != 0x80 || (s[3] & 0xc0) != 0x80)
+            return 0;
+
+        return 4;
+    }
+
+    return 0;
+}
+
+bool utf8_is_valid(const c8 *u8str, s64 u8str_size)
+{
+    const u8 *s = (const u8*)u8str;
+    s64 i = 0;
+    s64 block_end = 0;
+
+    while (i < u8str_size)
+    {
+#if Simd != SIMD_NONE
+        if (i >= block_end && i + 16 <= u8str_size)
+        {
+            if (simd_is_ascii(simd_load(s + i)))
+            {
+                i += 16;
+                continue;
+            }
+
+            // validate the non-ASCII block one sequence at a time
+            block_end = i + 16;
+        }
+#endif
+
+        s64 len = _utf8_valid_sequence_length(s + i, u8str_size - i);
+
+        if (len == 0)
+            return false;
+
+        i += len;
+    }
+
+    return true;
+}
+
+bool utf16_is_valid(const c16 *u16str, s64 u16str_size)
+{
+    s64 i = 0;
+
+    while (i < u16str_size)
+    {
+#if Simd != SIMD_NONE
+        if (i + 8 <= u16str_size)
+        {
+            simd_vec v = simd_load(u16str + i);
+            simd_vec surrogates = simd_equal<u16>(simd_and(v, simd_broadcast((u16)UTF16_SURROGATE_MASK)),
+                                                  simd_broadcast((u16)UTF16_SURROGATE_HIGH));
+
+            if (simd_mask(surrogates) == 0)
+            {
+                i += 8;
+                continue;
+            }
+        }
+#endif
+
+        u16 c = (u16)u16str[i];
+
+        if ((c & UTF16_SURROGATE_MASK) != UTF16_SURROGATE_HIGH)
+        {
+            i += 1;
+            continue;
+        }
+
+        // must be a high surrogate followed by a low surrogate
+        if ((c & UTF16_SURROGATE_HIGH_LOW_MASK) != UTF16_SURROGATE_HIGH)
+            return false;
+
+        if (i + 1 >= u16str_size || (((u16)u16str[i + 1]) & UTF16_SURROGATE_HIGH_LOW_MASK) != UTF16_SURROGATE_LOW)
+            return false;
+
+        i += 2;
+    }
+
+    return true;
+}
+
 s64 utf8_bytes_required_from_codepoints(const u32 *cps, s64 cp_count)
 {
     s64 sz = 0;
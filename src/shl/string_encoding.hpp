@@ -90,6 +90,24 @@ utf<A>_to_utf<B>(A_string, A_size, B_out_string, B_out_size)
 utf<A>_units_required_from_utf<B>(B_string, B_size)
     Returns the number of units a UTF-A string would require when converting
     the entire UTF-B string B_string to UTF-A.
+    utf32_units_required_from_utf8 is also the number of codepoints in a UTF-8
+    string, it counts every byte that is not a continuation byte.
+
+utf8_is_valid(u8str, u8str_size)
+    Returns whether the u8str_size bytes of u8str are valid UTF-8, i.e. contain
+    no invalid, overlong or truncated sequences, no surrogates and no
+    codepoints above UNICODE_MAX. Null characters are valid.
+
+utf16_is_valid(u16str, u16str_size)
+    Returns whether u16str is valid UTF-16, i.e. all surrogates are correctly
+    paired.
+
+Vectorization:
+    On architectures with SIMD support (see shl/simd.hpp), validation, the
+    units_required functions and the conversions from UTF-8 to UTF-16/32 and
+    from UTF-16 to UTF-8 process 16 units per step while the input is ASCII
+    (or has no surrogates for UTF-16) and fall back to decoding one codepoint
+    at a time otherwise.
 
 utf<A>_bytes_required_from_utf<B>(B_string, B_size)
     Returns the number of _bytes_ a UTF-A string would require when converting
@@ -233,6 +251,9 @@ s64 utf16_bytes_required_from_utf32(const c32 *u32str, s64 u32str_size);
 s64 utf32_bytes_required_from_utf8 (const c8  *u8str,  s64 u8str_size);
 s64 utf32_bytes_required_from_utf16(const c16 *u16str, s64 u16str_size);
 
+bool utf8_is_valid (const c8  *u8str,  s64 u8str_size);
+bool utf16_is_valid(const c16 *u16str, s64 u16str_size);
+
 // length (bytes) of a single unicode codepoint if it were encoded as utf8/utf16
 static inline s32 codepoint_utf8_length (u32 cp)
 {
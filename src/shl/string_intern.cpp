@@ -0,0 +1,297 @@
+
+#include "shl/assert.hpp"
+#include "shl/memory.hpp"
+#include "shl/bits.hpp"
+#include "shl/hash_table.hpp"
+#include "shl/program_context.hpp"
+#include "shl/string_intern.hpp"
+
+#define _first_chunk_size ((u64)1 << string_intern_first_chunk_shift)
+
+static inline u64 _make_slot(hash_t hsh, u32 id)
+{
+    return ((u64)hsh << 32) | ((u64)id + 1);
+}
+
+static inline u32 _slot_id(u64 slot)
+{
+    return (u32)(slot & 0xffffffffu) - 1;
+}
+
+static inline hash_t _slot_hash(u64 slot)
+{
+    return (hash_t)(slot >> 32);
+}
+
+static inline string_intern_entry *_entry_of(string_intern_entry *const *chunks, u32 id)
+{
+    // chunk k holds ids [first * (2^k - 1), first * (2^(k+1) - 1)[
+    u64 n = (u64)id + _first_chunk_size;
+    u64 k = (63 - clz64(n)) - string_intern_first_chunk_shift;
+    string_intern_entry *chunk = __atomic_load_n(chunks + k, __ATOMIC_ACQUIRE);
+
+    return chunk + (n - (_first_chunk_size << k));
+}
+
+static _string_intern_table *_alloc_table(::allocator a, u64 slot_count)
+{
+    _string_intern_table *table = allocator_alloc_T(a, _string_intern_table);
+    table->slots = allocator_alloc_T(a, u64, slot_count);
+    table->slot_count = slot_count;
+    fill_memory(table->slots, 0, sizeof(u64) * slot_count);
+
+    return table;
+}
+
+static void _free_table(::allocator a, _string_intern_table *table)
+{
+    allocator_dealloc_T(a, table->slots, u64, table->slot_count);
+    allocator_dealloc_T(a, table, _string_intern_table);
+}
+
+void init(string_intern *si)
+{
+    init(si, 0);
+}
+
+void init(string_intern *si, s64 expected_count)
+{
+    assert(si != nullptr);
+    assert(expected_count >= 0);
+
+    s64 slot_count = ceil_exp2((s64)(((expected_count + 2) * 100) / TABLE_SIZE_FACTOR));
+
+    if (slot_count < MIN_TABLE_SIZE)
+        slot_count = MIN_TABLE_SIZE;
+
+    si->allocator = get_context_pointer()->allocator;
+    si->table = _alloc_table(si->allocator, (u64)slot_count);
+    si->count = 0;
+    si->lock = 0;
+
+    for (s64 i = 0; i < string_intern_max_chunks; ++i)
+        si->chunks[i] = nullptr;
+
+    with_allocator(si->allocator)
+    {
+        init(&si->blocks);
+        init(&si->retired_tables);
+    }
+}
+
+void free(string_intern *si)
+{
+    assert(si != nullptr);
+
+    for_array(block, &si->blocks)
+        allocator_dealloc(si->allocator, block->data, block->size);
+
+    for (s64 i = 0; i < string_intern_max_chunks; ++i)
+    {
+        string_intern_entry *chunk = si->chunks[i];
+
+        if (chunk != nullptr)
+            allocator_dealloc_T(si->allocator, chunk, string_intern_entry, _first_chunk_size << i);
+
+        si->chunks[i] = nullptr;
+    }
+
+    for_array(table, &si->retired_tables)
+        _free_table(si->allocator, *table);
+
+    if (si->table != nullptr)
+        _free_table(si->allocator, si->table);
+
+    free(&si->blocks);
+    free(&si->retired_tables);
+    si->table = nullptr;
+    si->count = 0;
+}
+
+// probes the same way hash_table does
+static bool _table_find(const _string_intern_table *table, string_intern_entry *const *chunks, const_string str, hash_t hsh, u32 *out_id, u64 *out_index)
+{
+    u64 mask = table->slot_count - 1;
+    u64 index = hsh & mask;
+    u64 inc = 1;
+
+    while (true)
+    {
+        u64 slot = __atomic_load_n(table->slots + index, __ATOMIC_ACQUIRE);
+
+        if (slot == 0)
+            break;
+
+        if (_slot_hash(slot) == hsh)
+        {
+            u32 id = _slot_id(slot);
+            string_intern_entry *entry = _entry_of(chunks, id);
+
+            if (entry->size == str.size && string_compare(const_string{entry->data, entry->size}, str) == 0)
+            {
+                *out_id = id;
+                return true;
+            }
+        }
+
+        index = (index + inc) & mask;
+        inc++;
+    }
+
+    if (out_index != nullptr)
+        *out_index = index;
+
+    return false;
+}
+
+static void _lock(string_intern *si)
+{
+    while (__atomic_exchange_n(&si->lock, 1, __ATOMIC_ACQUIRE) != 0)
+        while (__atomic_load_n(&si->lock, __ATOMIC_RELAXED) != 0)
+            ;
+}
+
+static void _unlock(string_intern *si)
+{
+    __atomic_store_n(&si->lock, 0, __ATOMIC_RELEASE);
+}
+
+static const c8 *_copy_string(string_intern *si, const_string str)
+{
+    s64 size = str.size + 1;
+    string_intern_block *block = nullptr;
+
+    if (si->blocks.size > 0)
+        block = si->blocks.data + (si->blocks.size - 1);
+
+    if (block == nullptr || block->size - block->used < size)
+    {
+        s64 block_size = size > string_intern_block_size ? size : string_intern_block_size;
+
+        block = add_at_end(&si->blocks);
+        block->data = (c8*)allocator_alloc(si->allocator, block_size);
+        block->size = block_size;
+        block->used = 0;
+    }
+
+    c8 *ret = block->data + block->used;
+    copy_memory(str.c_str, ret, str.size);
+    ret[str.size] = '\0';
+    block->used += size;
+
+    return ret;
+}
+
+// inserts all entries into a new table of twice the size, called with the lock held.
+static void _grow_table(string_intern *si)
+{
+    _string_intern_table *old_table = si->table;
+    _string_intern_table *table = _alloc_table(si->allocator, old_table->slot_count * 2);
+    u64 mask = table->slot_count - 1;
+
+    for (u32 id = 0; id < si->count; ++id)
+    {
+        hash_t hsh = _entry_of(si->chunks, id)->hash;
+        u64 index = hsh & mask;
+        u64 inc = 1;
+
+        while (table->slots[index] != 0)
+        {
+            index = (index + inc) & mask;
+            inc++;
+        }
+
+        table->slots[index] = _make_slot(hsh, id);
+    }
+
+    // readers may still be probing the old table
+    with_allocator(si->allocator)
+        add_at_end(&si->retired_tables, old_table);
+
+    __atomic_store_n(&si->table, table, __ATOMIC_RELEASE);
+}
+
+u32 _string_intern_add(string_intern *si, const_string str, const_string *out)
+{
+    assert(si != nullptr);
+    assert(si->table != nullptr);
+
+    hash_t hsh = hash(str);
+    u32 id = 0;
+
+    _string_intern_table *table = __atomic_load_n(&si->table, __ATOMIC_ACQUIRE);
+
+    if (!_table_find(table, si->chunks, str, hsh, &id, nullptr))
+    {
+        _lock(si);
+
+        u64 index = 0;
+
+        // another thread may have added str in the meantime
+        if (!_table_find(si->table, si->chunks, str, hsh, &id, &index))
+        {
+            id = si->count;
+            assert(id < max_value(u32));
+
+            u64 n = (u64)id + _first_chunk_size;
+            u64 k = (63 - clz64(n)) - string_intern_first_chunk_shift;
+
+            assert(k < string_intern_max_chunks);
+
+            if (si->chunks[k] == nullptr)
+            {
+                string_intern_entry *chunk = allocator_alloc_T(si->allocator, string_intern_entry, _first_chunk_size << k);
+                __atomic_store_n(si->chunks + k, chunk, __ATOMIC_RELEASE);
+            }
+
+            string_intern_entry *entry = _entry_of(si->chunks, id);
+            entry->data = _copy_string(si, str);
+            entry->size = str.size;
+            entry->hash = hsh;
+
+            // the entry is complete before the count and the slot make it visible
+            __atomic_store_n(&si->count, id + 1, __ATOMIC_RELEASE);
+            __atomic_store_n(si->table->slots + index, _make_slot(hsh, id), __ATOMIC_RELEASE);
+
+            if ((u64)si->count * 100 >= si->table->slot_count * TABLE_SIZE_FACTOR)
+                _grow_table(si);
+        }
+
+        _unlock(si);
+    }
+
+    if (out != nullptr)
+        *out = string_intern_get(si, id);
+
+    return id;
+}
+
+bool _string_intern_find(const string_intern *si, const_string str, u32 *out_id)
+{
+    assert(si != nullptr);
+    assert(out_id != nullptr);
+
+    const _string_intern_table *table = __atomic_load_n(&si->table, __ATOMIC_ACQUIRE);
+
+    if (table == nullptr)
+        return false;
+
+    return _table_find(table, si->chunks, str, hash(str), out_id, nullptr);
+}
+
+const_string string_intern_get(const string_intern *si, u32 id)
+{
+    assert(si != nullptr);
+    assert(id < __atomic_load_n(&si->count, __ATOMIC_ACQUIRE));
+
+    const string_intern_entry *entry = _entry_of(si->chunks, id);
+
+    return const_string{entry->data, entry->size};
+}
+
+s64 string_intern_count(const string_intern *si)
+{
+    assert(si != nullptr);
+
+    return (s64)__atomic_load_n(&si->count, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+/* string_intern.hpp
+
+String interning: stores every distinct string only once and identifies it
+by a stable u32 id, so that equal strings can be compared by their ids.
+
+The bytes of interned strings are copied into large blocks that are never
+moved or freed until the string_intern is freed, so the const_string views
+returned by the functions below stay valid for the lifetime of the
+string_intern. Every interned string is null terminated.
+
+The ids are indices into a table of entries (pointer, size and hash of
+every interned string). The entries are stored in chunks whose size doubles
+with every chunk, so entries never move either.
+
+Ids are found through an open addressing hash table, using the same probing
+and load factor as hash_table (see shl/hash_table.hpp). When the table has
+to grow, a new table is built and published atomically; the old table is
+kept until the string_intern is freed, since other threads may still be
+reading it.
+
+Concurrency: string_intern_find, string_intern_get and string_intern_count
+do not lock and may be called from any number of threads, also while
+another thread adds strings. string_intern_add first looks up the string
+without locking and only takes a (spin) lock to insert new strings, so
+adding strings that already exist is lock-free as well.
+
+Example:
+
+    string_intern si{};
+    init(&si);
+
+    u32 a = string_intern_add(&si, "hello");
+    u32 b = string_intern_add(&si, "hello"_cs);
+    // a == b
+
+    const_string s = string_intern_get(&si, a); // "hello"
+
+    free(&si);
+
+Functions:
+
+init(*si)       initializes an empty string_intern using the allocator of
+                the current program context.
+init(*si, N)    same, but reserves the hash table for N strings.
+free(*si)       frees all interned strings, entries and tables.
+
+string_intern_add(*si, Str[, *out])
+    Interns Str, copying it if it was not interned before, and returns its
+    id. If out is not nullptr, sets *out to the interned string.
+
+string_intern_find(*si, Str, *out_id)
+    Returns true and sets *out_id to the id of Str if Str is interned,
+    otherwise returns false. Never inserts.
+
+string_intern_get(*si, Id)
+    Returns the interned string of Id. Id must have been returned by
+    string_intern_add on si.
+
+string_intern_count(*si)
+    Returns the number of interned strings.
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/array.hpp"
+#include "shl/hash.hpp"
+#include "shl/string.hpp"
+#include "shl/allocator.hpp"
+
+#ifndef string_intern_block_size
+#define string_intern_block_size 65536
+#endif
+
+#define string_intern_first_chunk_shift 10
+#define string_intern_max_chunks 23
+
+struct string_intern_entry
+{
+    const c8 *data;
+    s64 size;
+    hash_t hash;
+};
+
+struct string_intern_block
+{
+    c8 *data;
+    s64 size;
+    s64 used;
+};
+
+// slots contain the hash in the upper and id + 1 in the lower 32 bits,
+// or 0 if unused.
+struct _string_intern_table
+{
+    u64 *slots;
+    u64 slot_count;
+};
+
+struct string_intern
+{
+    _string_intern_table *table;
+    string_intern_entry *chunks[string_intern_max_chunks];
+    u32 count;
+    s32 lock;
+
+    array<string_intern_block> blocks;
+    array<_string_intern_table*> retired_tables;
+    ::allocator allocator;
+};
+
+void init(string_intern *si);
+void init(string_intern *si, s64 expected_count);
+void free(string_intern *si);
+
+u32 _string_intern_add(string_intern *si, const_string str, const_string *out);
+bool _string_intern_find(const string_intern *si, const_string str, u32 *out_id);
+
+template<typename T>
+auto string_intern_add(string_intern *si, T str, const_string *out = nullptr)
+    -> decltype(_string_intern_add(si, to_const_string(str), out))
+{
+    return _string_intern_add(si, to_const_string(str), out);
+}
+
+template<typename T>
+auto string_intern_find(const string_intern *si, T str, u32 *out_id)
+    -> decltype(_string_intern_find(si, to_const_string(str), out_id))
+{
+    return _string_intern_find(si, to_const_string(str), out_id);
+}
+
+const_string string_intern_get(const string_intern *si, u32 id);
+s64 string_intern_count(const string_intern *si);
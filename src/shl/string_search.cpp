@@ -0,0 +1,331 @@
+
+#include "shl/simd.hpp"
+#include "shl/bits.hpp"
+#include "shl/string_search.hpp"
+
+#if Simd != SIMD_NONE
+// number of units in a vector
+template<typename C>
+constexpr s64 _search_vec_units = 16 / sizeof(C);
+
+template<typename C>
+constexpr u64 _search_mask_bits_per_unit = simd_mask_bits_per_byte * sizeof(C);
+
+// the comparison mask has _search_mask_bits_per_unit bits set for every
+// matching unit, this keeps only the lowest bit of each unit so that
+// bits can be iterated one unit at a time.
+template<typename C>
+constexpr u64 _search_unit_bits()
+{
+    u64 ret = 0;
+
+    for (s64 i = 0; i < _search_vec_units<C>; ++i)
+        ret |= 1ull << (i * _search_mask_bits_per_unit<C>);
+
+    return ret;
+}
+
+template<typename C>
+static inline u64 _search_unit_mask(simd_vec v)
+{
+    return simd_mask(v) & _search_unit_bits<C>();
+}
+
+template<typename C>
+static inline s64 _search_first_index(u64 mask)
+{
+    return (s64)(ctz64(mask) / _search_mask_bits_per_unit<C>);
+}
+
+template<typename C>
+static inline s64 _search_last_index(u64 mask)
+{
+    return (s64)((63 - clz64(mask)) / _search_mask_bits_per_unit<C>);
+}
+#endif
+
+template<typename C>
+static inline bool _search_units_equal(const C *a, const C *b, s64 n)
+{
+    for (s64 i = 0; i < n; ++i)
+        if (a[i] != b[i])
+            return false;
+
+    return true;
+}
+
+template<typename C>
+static inline bool _search_is_in_set(C c, const C *set, s64 set_size)
+{
+    for (s64 i = 0; i < set_size; ++i)
+        if (c == set[i])
+            return true;
+
+    return false;
+}
+
+template<typename C>
+static inline s64 _search_unit(const C *data, s64 size, C unit)
+{
+    s64 i = 0;
+
+#if Simd != SIMD_NONE
+    constexpr s64 N = _search_vec_units<C>;
+    simd_vec u = simd_broadcast(unit);
+
+    for (; i + N <= size; i += N)
+    {
+        u64 mask = _search_unit_mask<C>(simd_equal<C>(simd_load(data + i), u));
+
+        if (mask != 0)
+            return i + _search_first_index<C>(mask);
+    }
+#endif
+
+    for (; i < size; ++i)
+        if (data[i] == unit)
+            return i;
+
+    return -1;
+}
+
+template<typename C>
+static inline s64 _search_last_unit(const C *data, s64 size, C unit)
+{
+    s64 i = size;
+
+#if Simd != SIMD_NONE
+    constexpr s64 N = _search_vec_units<C>;
+    simd_vec u = simd_broadcast(unit);
+
+    for (; i >= N; i -= N)
+    {
+        u64 mask = _search_unit_mask<C>(simd_equal<C>(simd_load(data + i - N), u));
+
+        if (mask != 0)
+            return i - N + _search_last_index<C>(mask);
+    }
+#endif
+
+    while (i > 0)
+    {
+        --i;
+
+        if (data[i] == unit)
+            return i;
+    }
+
+    return -1;
+}
+
+template<typename C>
+static inline s64 _search_any_unit(const C *data, s64 size, const C *set, s64 set_size)
+{
+    if (set_size <= 0)
+        return -1;
+
+    if (set_size == 1)
+        return _search_unit(data, size, set[0]);
+
+    s64 i = 0;
+
+#if Simd != SIMD_NONE
+    if (set_size <= search_max_vector_set_size)
+    {
+        constexpr s64 N = _search_vec_units<C>;
+        simd_vec units[search_max_vector_set_size];
+
+        for (s64 s = 0; s < set_size; ++s)
+            units[s] = simd_broadcast(set[s]);
+
+        for (; i + N <= size; i += N)
+        {
+            simd_vec block = simd_load(data + i);
+            simd_vec eq = simd_equal<C>(block, units[0]);
+
+            for (s64 s = 1; s < set_size; ++s)
+                eq = simd_or(eq, simd_equal<C>(block, units[s]));
+
+            u64 mask = _search_unit_mask<C>(eq);
+
+            if (mask != 0)
+                return i + _search_first_index<C>(mask);
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+        if (_search_is_in_set(data[i], set, set_size))
+            return i;
+
+    return -1;
+}
+
+template<typename C>
+static inline s64 _search_last_any_unit(const C *data, s64 size, const C *set, s64 set_size)
+{
+    if (set_size <= 0)
+        return -1;
+
+    if (set_size == 1)
+        return _search_last_unit(data, size, set[0]);
+
+    s64 i = size;
+
+#if Simd != SIMD_NONE
+    if (set_size <= search_max_vector_set_size)
+    {
+        constexpr s64 N = _search_vec_units<C>;
+        simd_vec units[search_max_vector_set_size];
+
+        for (s64 s = 0; s < set_size; ++s)
+            units[s] = simd_broadcast(set[s]);
+
+        for (; i >= N; i -= N)
+        {
+            simd_vec block = simd_load(data + i - N);
+            simd_vec eq = simd_equal<C>(block, units[0]);
+
+            for (s64 s = 1; s < set_size; ++s)
+                eq = simd_or(eq, simd_equal<C>(block, units[s]));
+
+            u64 mask = _search_unit_mask<C>(eq);
+
+            if (mask != 0)
+                return i - N + _search_last_index<C>(mask);
+        }
+    }
+#endif
+
+    while (i > 0)
+    {
+        --i;
+
+        if (_search_is_in_set(data[i], set, set_size))
+            return i;
+    }
+
+    return -1;
+}
+
+template<typename C>
+static inline s64 _search_units(const C *data, s64 size, const C *needle, s64 needle_size)
+{
+    if (needle_size <= 0)
+        return 0;
+
+    if (needle_size > size)
+        return -1;
+
+    if (needle_size == 1)
+        return _search_unit(data, size, needle[0]);
+
+    // last possible start of a match
+    const s64 last = size - needle_size;
+    s64 i = 0;
+
+#if Simd != SIMD_NONE
+    constexpr s64 N = _search_vec_units<C>;
+    simd_vec first_unit = simd_broadcast(needle[0]);
+    simd_vec last_unit  = simd_broadcast(needle[needle_size - 1]);
+
+    // checks N starting positions at once
+    for (; i + N - 1 <= last; i += N)
+    {
+        simd_vec eq_first = simd_equal<C>(simd_load(data + i), first_unit);
+        simd_vec eq_last  = simd_equal<C>(simd_load(data + i + needle_size - 1), last_unit);
+        u64 mask = _search_unit_mask<C>(simd_and(eq_first, eq_last));
+
+        while (mask != 0)
+        {
+            s64 pos = i + _search_first_index<C>(mask);
+
+            if (_search_units_equal(data + pos + 1, needle + 1, needle_size - 2))
+                return pos;
+
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i <= last; ++i)
+        if (data[i] == needle[0] && _search_units_equal(data + i + 1, needle + 1, needle_size - 1))
+            return i;
+
+    return -1;
+}
+
+template<typename C>
+static inline s64 _search_last_units(const C *data, s64 size, const C *needle, s64 needle_size)
+{
+    if (needle_size <= 0)
+        return size;
+
+    if (needle_size > size)
+        return -1;
+
+    if (needle_size == 1)
+        return _search_last_unit(data, size, needle[0]);
+
+    // i is one past the last start position that has not been checked yet
+    s64 i = size - needle_size + 1;
+
+#if Simd != SIMD_NONE
+    constexpr s64 N = _search_vec_units<C>;
+    simd_vec first_unit = simd_broadcast(needle[0]);
+    simd_vec last_unit  = simd_broadcast(needle[needle_size - 1]);
+
+    for (; i >= N; i -= N)
+    {
+        s64 start = i - N;
+        simd_vec eq_first = simd_equal<C>(simd_load(data + start), first_unit);
+        simd_vec eq_last  = simd_equal<C>(simd_load(data + start + needle_size - 1), last_unit);
+        u64 mask = _search_unit_mask<C>(simd_and(eq_first, eq_last));
+
+        while (mask != 0)
+        {
+            u64 bit = 63 - clz64(mask);
+            s64 pos = start + (s64)(bit / _search_mask_bits_per_unit<C>);
+
+            if (_search_units_equal(data + pos + 1, needle + 1, needle_size - 2))
+                return pos;
+
+            mask &= ~(1ull << bit);
+        }
+    }
+#endif
+
+    while (i > 0)
+    {
+        --i;
+
+        if (data[i] == needle[0] && _search_units_equal(data + i + 1, needle + 1, needle_size - 1))
+            return i;
+    }
+
+    return -1;
+}
+
+s64 search_unit(const c8  *data, s64 size, c8  unit) { return _search_unit(data, size, unit); }
+s64 search_unit(const c16 *data, s64 size, c16 unit) { return _search_unit(data, size, unit); }
+s64 search_unit(const c32 *data, s64 size, c32 unit) { return _search_unit(data, size, unit); }
+
+s64 search_last_unit(const c8  *data, s64 size, c8  unit) { return _search_last_unit(data, size, unit); }
+s64 search_last_unit(const c16 *data, s64 size, c16 unit) { return _search_last_unit(data, size, unit); }
+s64 search_last_unit(const c32 *data, s64 size, c32 unit) { return _search_last_unit(data, size, unit); }
+
+s64 search_any_unit(const c8  *data, s64 size, const c8  *set, s64 set_size) { return _search_any_unit(data, size, set, set_size); }
+s64 search_any_unit(const c16 *data, s64 size, const c16 *set, s64 set_size) { return _search_any_unit(data, size, set, set_size); }
+s64 search_any_unit(const c32 *data, s64 size, const c32 *set, s64 set_size) { return _search_any_unit(data, size, set, set_size); }
+
+s64 search_last_any_unit(const c8  *data, s64 size, const c8  *set, s64 set_size) { return _search_last_any_unit(data, size, set, set_size); }
+s64 search_last_any_unit(const c16 *data, s64 size, const c16 *set, s64 set_size) { return _search_last_any_unit(data, size, set, set_size); }
+s64 search_last_any_unit(const c32 *data, s64 size, const c32 *set, s64 set_size) { return _search_last_any_unit(data, size, set, set_size); }
+
+s64 search_units(const c8  *data, s64 size, const c8  *needle, s64 needle_size) { return _search_units(data, size, needle, needle_size); }
+s64 search_units(const c16 *data, s64 size, const c16 *needle, s64 needle_size) { return _search_units(data, size, needle, needle_size); }
+s64 search_units(const c32 *data, s64 size, const c32 *needle, s64 needle_size) { return _search_units(data, size, needle, needle_size); }
+
+s64 search_last_units(const c8  *data, s64 size, const c8  *needle, s64 needle_size) { return _search_last_units(data, size, needle, needle_size); }
+s64 search_last_units(const c16 *data, s64 size, const c16 *needle, s64 needle_size) { return _search_last_units(data, size, needle, needle_size); }
+s64 search_last_units(const c32 *data, s64 size, const c32 *needle, s64 needle_size) { return _search_last_units(data, size, needle, needle_size); }
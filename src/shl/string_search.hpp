@@ -0,0 +1,75 @@
+#pragma once
+
+/* string_search.hpp
+
+Search kernels on code units, used by string_index_of, string_last_index_of,
+string_index_of_any and others in shl/string.hpp.
+All functions work on units (c8, c16 or c32), not bytes or codepoints, so
+matches always start at a unit boundary for all unit widths.
+
+On x86_64 the kernels use SSE2 and on aarch64 they use NEON, both of which
+are always available on these architectures. 16 bytes are compared at a time,
+the remaining units are compared one by one. Other architectures only use
+the scalar loops.
+
+Functions:
+
+search_unit(const C *data, s64 size, C unit)
+    Returns the index of the first unit in data[0, size[ that is equal to unit,
+    or -1 if there is none.
+
+search_last_unit(const C *data, s64 size, C unit)
+    Returns the index of the last unit in data[0, size[ that is equal to unit,
+    or -1 if there is none.
+
+search_any_unit(const C *data, s64 size, const C *set, s64 set_size)
+    Returns the index of the first unit in data[0, size[ that is equal to any
+    of the units in set, or -1 if there is none.
+    e.g. search_any_unit(line, size, "\",\n", 3) finds the next quote, comma
+    or newline.
+    Sets of more than search_max_vector_set_size units are searched without
+    vectorization.
+
+search_last_any_unit(const C *data, s64 size, const C *set, s64 set_size)
+    Same as search_any_unit, but returns the index of the last unit.
+
+search_units(const C *data, s64 size, const C *needle, s64 needle_size)
+    Returns the index of the first occurrence of needle in data[0, size[,
+    or -1 if there is none. Returns 0 if needle_size is 0.
+    Candidates are found by comparing the first and last unit of needle
+    against a block of positions at once, only candidates are compared
+    fully.
+
+search_last_units(const C *data, s64 size, const C *needle, s64 needle_size)
+    Same as search_units, but returns the index of the last occurrence of
+    needle in data, or size if needle_size is 0.
+*/
+
+#include "shl/number_types.hpp"
+#include "shl/char_types.hpp"
+
+#define search_max_vector_set_size 16
+
+s64 search_unit(const c8  *data, s64 size, c8  unit);
+s64 search_unit(const c16 *data, s64 size, c16 unit);
+s64 search_unit(const c32 *data, s64 size, c32 unit);
+
+s64 search_last_unit(const c8  *data, s64 size, c8  unit);
+s64 search_last_unit(const c16 *data, s64 size, c16 unit);
+s64 search_last_unit(const c32 *data, s64 size, c32 unit);
+
+s64 search_any_unit(const c8  *data, s64 size, const c8  *set, s64 set_size);
+s64 search_any_unit(const c16 *data, s64 size, const c16 *set, s64 set_size);
+s64 search_any_unit(const c32 *data, s64 size, const c32 *set, s64 set_size);
+
+s64 search_last_any_unit(const c8  *data, s64 size, const c8  *set, s64 set_size);
+s64 search_last_any_unit(const c16 *data, s64 size, const c16 *set, s64 set_size);
+s64 search_last_any_unit(const c32 *data, s64 size, const c32 *set, s64 set_size);
+
+s64 search_units(const c8  *data, s64 size, const c8  *needle, s64 needle_size);
+s64 search_units(const c16 *data, s64 size, const c16 *needle, s64 needle_size);
+s64 search_units(const c32 *data, s64 size, const c32 *needle, s64 needle_size);
+
+s64 search_last_units(const c8  *data, s64 size, const c8  *needle, s64 needle_size);
+s64 search_last_units(const c16 *data, s64 size, const c16 *needle, s64 needle_size);
+s64 search_last_units(const c32 *data, s64 size, const c32 *needle, s64 needle_size);
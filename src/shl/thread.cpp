@@ -75,6 +75,106 @@ static inline s32 _get_thread_status(HANDLE h)
 #include "shl/impl/linux/thread.hpp"
 #include "shl/impl/linux/exit.hpp"
 
+#include "shl/impl/linux/memory.hpp"
+
+/* get_thread_data_slot finds the slots of the calling thread by the address
+of a local variable, since thread_local storage is shared with the creating
+thread.
+Thread stacks created by thread_create are aligned to _STACK_GRANULE and span
+whole granules, so no other mapping shares a granule with them.
+_stack_slot_table maps the granules of every started thread stack to the
+slots of its thread, so a lookup is two loads. The granules of a stack are
+written by thread_start before the thread exists and by the thread itself
+when it stops, so a thread always sees its own entry. Leaves are allocated
+when first needed and never freed. */
+#define _STACK_GRANULE_SHIFT    16
+#define _STACK_GRANULE          ((s64)1 << _STACK_GRANULE_SHIFT)
+#define _STACK_LEAF_BITS        20
+#define _STACK_LEAF_SIZE        (((s64)1 << _STACK_LEAF_BITS) * (s64)sizeof(thread_data_slot*))
+#define _STACK_TOP_BITS         (48 - _STACK_GRANULE_SHIFT - _STACK_LEAF_BITS)
+
+static thread_data_slot **_stack_slot_table[1 << _STACK_TOP_BITS]{};
+
+static thread_data_slot **_get_stack_slot_leaf(thread_data_slot ***top, error *err)
+{
+    thread_data_slot **leaf = __atomic_load_n(top, __ATOMIC_ACQUIRE);
+
+    if (leaf != nullptr)
+        return leaf;
+
+    void *mem = mmap(nullptr, _STACK_LEAF_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE);
+
+    if (MMAP_IS_ERROR(mem))
+    {
+        set_error_by_code(err, -(sys_int)mem);
+        return nullptr;
+    }
+
+    if (!__atomic_compare_exchange_n(top, &leaf, (thread_data_slot**)mem, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        // another thread published a leaf first
+        munmap(mem, _STACK_LEAF_SIZE);
+        return leaf;
+    }
+
+    return (thread_data_slot**)mem;
+}
+
+// clearing (slots == nullptr) never fails.
+static bool _set_stack_slots(void *stack, s64 size, thread_data_slot *slots, error *err)
+{
+    u64 first = (u64)stack >> _STACK_GRANULE_SHIFT;
+    u64 last  = ((u64)stack + size - 1) >> _STACK_GRANULE_SHIFT;
+
+    if ((last >> _STACK_LEAF_BITS) >= (1 << _STACK_TOP_BITS))
+    {
+        set_error(err, 14 /* efault */, "thread stack address out of range");
+        return false;
+    }
+
+    for (u64 granule = first; granule <= last; ++granule)
+    {
+        thread_data_slot ***top = _stack_slot_table + (granule >> _STACK_LEAF_BITS);
+        thread_data_slot **leaf = nullptr;
+
+        if (slots == nullptr)
+            leaf = __atomic_load_n(top, __ATOMIC_ACQUIRE);
+        else
+            leaf = _get_stack_slot_leaf(top, err);
+
+        if (leaf == nullptr)
+        {
+            if (slots == nullptr)
+                continue;
+
+            _set_stack_slots(stack, size, nullptr, nullptr);
+            return false;
+        }
+
+        __atomic_store_n(leaf + (granule & ((1 << _STACK_LEAF_BITS) - 1)), slots, __ATOMIC_RELAXED);
+    }
+
+    return true;
+}
+
+// aligns the stack to _STACK_GRANULE by trimming a larger mapping.
+static void *_thread_stack_create_aligned(s64 size, error *err)
+{
+    char *mem = (char*)thread_stack_create(size + _STACK_GRANULE, err);
+
+    if (mem == nullptr)
+        return nullptr;
+
+    char *stack = (char*)ceil_multiple2((u64)mem, (u64)_STACK_GRANULE);
+
+    if (stack > mem)
+        munmap(mem, stack - mem);
+
+    munmap(stack + size, (mem + _STACK_GRANULE) - stack);
+
+    return (void*)stack;
+}
+
 static void _clone_entry(thread_stack_head *head)
 {
     // this is within the new thread
@@ -88,6 +188,14 @@ static void _clone_entry(thread_stack_head *head)
 
     __atomic_store_n(&head->state, THREAD_STATE_RUNNING, __ATOMIC_SEQ_CST);
     head->user_function_result = head->user_function(head->user_function_argument);
+
+    thread_data_slot *slots = (thread_data_slot*)head->data_slots;
+
+    for (s32 i = 0; i < THREAD_DATA_SLOT_COUNT; ++i)
+        if (slots[i].cleanup != nullptr)
+            slots[i].cleanup(slots[i].data);
+
+    _set_stack_slots((void*)head->clone_args.stack, head->original_stack_size, nullptr, nullptr);
     __atomic_store_n(&head->state, THREAD_STATE_STOPPED, __ATOMIC_SEQ_CST);
 
     futex_wake(&head->join_futex);
@@ -214,7 +322,8 @@ bool thread_create(thread *t, thread_function func, void *argument, program_cont
         if (storage_size <= 0)
             storage_size = THREAD_STACKSIZE_STORAGE_DEFAULT;
 
-        stack = thread_stack_create(stack_size, err);
+        stack_size = ceil_multiple2(stack_size, _STACK_GRANULE);
+        stack = _thread_stack_create_aligned(stack_size, err);
 
         if (stack == nullptr)
             return false;
@@ -227,6 +336,8 @@ bool thread_create(thread *t, thread_function func, void *argument, program_cont
 
         if (stack_size > 0)
         {
+            stack_size = ceil_multiple2(stack_size, _STACK_GRANULE);
+
             // check if new stack size larger different than before,
             // then reallocate if it is.
             if (stack_size > head->original_stack_size)
@@ -234,7 +345,7 @@ bool thread_create(thread *t, thread_function func, void *argument, program_cont
                 if (!thread_stack_destroy(stack, head->original_stack_size, err))
                     return false;
 
-                stack = thread_stack_create(stack_size, err);
+                stack = _thread_stack_create_aligned(stack_size, err);
 
                 if (stack == nullptr)
                     return false;
@@ -280,6 +391,14 @@ bool thread_create(thread *t, thread_function func, void *argument, program_cont
     nctx->thread_storage_allocator = storage_alloc;
     t->starting_context = nctx;
 
+    head->data_slots = allocator_alloc_T(storage_alloc, thread_data_slot, THREAD_DATA_SLOT_COUNT);
+
+    if (head->data_slots == nullptr)
+    {
+        set_error(err, 12 /* enomem */, "thread storage too small for data slots");
+        return false;
+    }
+
     return true;
 #else
     return false;
@@ -386,9 +505,24 @@ bool thread_start(thread *t, error *err)
 
     assert(!linux_thread_is_running(head));
 
+    void *stack = (void*)head->clone_args.stack;
+    thread_data_slot *slots = (thread_data_slot*)head->data_slots;
+    assert(slots != nullptr);
+
+    fill_memory(slots, 0, sizeof(thread_data_slot) * THREAD_DATA_SLOT_COUNT);
+
+    if (!_set_stack_slots(stack, head->original_stack_size, slots, err))
+        return false;
+
     sys_int ok = linux_thread_start(head, err);
 
-    return ok > 0;
+    if (ok <= 0)
+    {
+        _set_stack_slots(stack, head->original_stack_size, nullptr, nullptr);
+        return false;
+    }
+
+    return true;
 #else
     return false;
 #endif
@@ -553,3 +687,28 @@ void thread_storage(thread *t, void **out_data, s64 *out_size)
     return;
 #endif
 }
+
+thread_data_slot *get_thread_data_slot(s32 index)
+{
+    assert(index >= 0 && index < THREAD_DATA_SLOT_COUNT);
+
+#if Linux
+    char local;
+    u64 granule = (u64)&local >> _STACK_GRANULE_SHIFT;
+
+    if ((granule >> _STACK_LEAF_BITS) >= (1 << _STACK_TOP_BITS))
+        return nullptr;
+
+    thread_data_slot **leaf = __atomic_load_n(_stack_slot_table + (granule >> _STACK_LEAF_BITS), __ATOMIC_ACQUIRE);
+
+    if (leaf == nullptr)
+        return nullptr;
+
+    thread_data_slot *slots = __atomic_load_n(leaf + (granule & ((1 << _STACK_LEAF_BITS) - 1)), __ATOMIC_RELAXED);
+
+    if (slots != nullptr)
+        return slots + index;
+#endif
+
+    return nullptr;
+}
@@ -96,14 +96,15 @@ thread_create(*thread, Func, *Arg, *Context, Stack_size, Storage_size[, *error])
     thread. The context is copied into thread storage.
 
     Stacksize is the requested size of the thread stack, rounded up to the
-    nearest pagesize.
+    nearest pagesize (64 KiB on Linux, where stacks are 64 KiB aligned).
 
     Storagesize is the requested size for extra memory which may be accessed
     by the thread as long as the thread is running, and by other threads
     as long as the target thread is stopped (or ready) and not destroyed.
     At the head of the extra storage is an arena, directly after which is
-    the copied program_context. Use arena->start to find the first free
-    address within the storage size, if necessary.
+    the copied program_context (and on Linux, the data slots of the thread).
+    Use arena->start to find the first free address within the storage size,
+    if necessary.
     
     Returns whether or not the function succeeded.
 
@@ -154,6 +155,22 @@ thread_storage(*thread, *out_data, *out_size)
     An arena object is located at the start of the storage, with the first
     member being a pointer to the first free space within the storage.
 
+
+get_thread_data_slot(Index)
+    Returns the data slot Index (below THREAD_DATA_SLOT_COUNT) of the calling
+    thread if it was started with thread_start, or nullptr otherwise, e.g.
+    in the main thread or in a pthread.
+    On Linux, threads started with thread_start share the thread_local
+    storage of the thread that created them and never run thread_local
+    destructors, so data that must be owned by one thread (e.g. the tformat
+    buffers) is kept in a slot instead. A slot is empty when the thread
+    starts; when the thread function returns, cleanup(data) is called for
+    every slot with a cleanup function.
+    The lookup is constant time: thread_start registers the stack of the
+    thread, and fails if it cannot.
+    Returns nullptr on Windows as well, where threads have their own
+    thread_local storage.
+
 */
 
 #include "shl/error.hpp"
@@ -162,6 +179,18 @@ thread_storage(*thread, *out_data, *out_size)
 
 typedef void *(*thread_function)(void *arg);
 
+// slots used by shl, see get_thread_data_slot
+#define THREAD_DATA_SLOT_TFORMAT        0
+#define THREAD_DATA_SLOT_PRINT_BUFFER   1
+#define THREAD_DATA_SLOT_LOG            2
+#define THREAD_DATA_SLOT_COUNT          4
+
+struct thread_data_slot
+{
+    void *data;
+    void (*cleanup)(void *data);
+};
+
 struct thread
 {
     s32 thread_id;
@@ -185,3 +214,5 @@ bool thread_stop(thread *t, timespan *wait_timeout = nullptr, error *err = nullp
 // make sure thread is stopped and not destroyed for these
 void *thread_result(thread *t);
 void thread_storage(thread *t, void **out_data, s64 *out_size);
+
+thread_data_slot *get_thread_data_slot(s32 index);
@@ -22,6 +22,8 @@ is_signed(T)        is true if T is a signed number type.
 if_type(Cond, TrueType, FalseType)
     Evaluates to TrueType at compile time if Cond is true, FalseType otherwise.
 
+nth_type(N, Ts...)  gets the Nth (starting at 0) type of the types Ts.
+
 forward<T>(x)       "forwards" x.
 
 
@@ -65,6 +67,14 @@ struct _if_type<false, T, F> { using type = F; };
 
 #define if_type(Condition, TrueType, FalseType) _if_type<Condition, TrueType, FalseType>::type
 
+template<long long N, typename T, typename... Ts>
+struct _nth_type { using type = typename _nth_type<N - 1, Ts...>::type; };
+
+template<typename T, typename... Ts>
+struct _nth_type<0, T, Ts...> { using type = T; };
+
+#define nth_type(N, ...) _nth_type<N, __VA_ARGS__>::type
+
 template<typename T>
 inline T&& forward(typename remove_reference(T)& t)
 {
@@ -0,0 +1,65 @@
+#pragma once
+
+/* unicode_tables.hpp
+
+Unicode character properties and simple case mappings, used by is_alpha,
+is_upper, utf_codepoint_to_upper and others in shl/string.hpp.
+
+Every codepoint maps to one unicode_codepoint_info record. Since only a few
+hundred different records exist, the records are stored once and looked up
+through a two-stage table:
+
+    _unicode_stage1[cp >> 7]        index of the block of 128 codepoints of cp
+    _unicode_stage2[block * 128 + (cp & 127)]
+                                    index of the record of cp
+
+Identical blocks (e.g. unassigned or CJK ideographs) are stored only once,
+which keeps all tables at about 28KB. Codepoints at or above
+_unicode_table_limit have no properties.
+
+The tables in unicode_tables.cpp are generated by
+tools/generate_unicode_tables.py, do not edit them by hand.
+
+Properties:
+UNICODE_PROPERTY_ALPHA  letters (general category L*)
+UNICODE_PROPERTY_DIGIT  decimal digits (general category Nd)
+UNICODE_PROPERTY_SPACE  whitespace (White_Space)
+UNICODE_PROPERTY_UPPER  upper case (Uppercase)
+UNICODE_PROPERTY_LOWER  lower case (Lowercase)
+
+Case mappings are stored as the difference to the upper or lower case
+codepoint, 0 if the codepoint has no simple (single codepoint) mapping.
+
+Functions:
+get_unicode_codepoint_info(u32 cp)
+    Returns a pointer to the (static) record of cp.
+*/
+
+#include "shl/number_types.hpp"
+
+#define UNICODE_PROPERTY_ALPHA 0x01u
+#define UNICODE_PROPERTY_DIGIT 0x02u
+#define UNICODE_PROPERTY_SPACE 0x04u
+#define UNICODE_PROPERTY_UPPER 0x08u
+#define UNICODE_PROPERTY_LOWER 0x10u
+
+struct unicode_codepoint_info
+{
+    u32 properties;
+    s32 upper_delta;
+    s32 lower_delta;
+};
+
+extern const u32 _unicode_table_limit;
+extern const unicode_codepoint_info _unicode_codepoint_infos[];
+extern const u8 _unicode_stage1[];
+extern const u8 _unicode_stage2[];
+
+inline const unicode_codepoint_info *get_unicode_codepoint_info(u32 cp)
+{
+    if (cp >= _unicode_table_limit)
+        return _unicode_codepoint_infos;
+
+    u32 block = _unicode_stage1[cp >> 7];
+    return _unicode_codepoint_infos + _unicode_stage2[(block << 7) | (cp & 127)];
+}
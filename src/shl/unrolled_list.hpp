@@ -0,0 +1,620 @@
+#pragma once
+
+/* unrolled_list.hpp
+
+Unrolled linked list. Like linked_list (see shl/linked_list.hpp), but each node
+stores up to K elements contiguously instead of one, which reduces the number
+of allocations and pointer dereferences when iterating or searching the list
+by up to a factor of K.
+
+    template<typename T, s64 K>
+    struct unrolled_list_node
+    {
+        unrolled_list_node *next;
+        unrolled_list_node *previous;
+        s64 count;
+        T values[K];
+    }
+
+Nodes are never empty. Inserting into a full node splits the node in half,
+removing elements merges a node with a neighboring node if both fit into one
+node.
+Unlike linked_list, elements may move within and between nodes when
+inserting or removing elements, so pointers to elements are invalidated by
+insertions and removals.
+
+K defaults to the number of elements that fit into ~256 bytes per node.
+
+Example, writing 0..4 to an unrolled list:
+
+    unrolled_list<int> list{};
+    init(&list);
+
+    for (int i = 0; i < 5; ++i)
+        add_at_end(&list, i);
+
+    for_unrolled_list(i, v, &list)
+        printf("%ld: %d\n", i, *v);
+
+    free(&list);
+
+Functions:
+
+init(*list)    initializes an empty list.
+init(*list, N) initializes a list with N uninitialized elements.
+
+add_at_start(*list), add_at_start(*list, V)
+    adds a new element at the start of the list and returns a pointer to it.
+add_at_end(*list), add_at_end(*list, V)
+    adds a new element at the end of the list and returns a pointer to it.
+
+add_elements(*list, N) adds N uninitialized elements at the end of the list
+                       and returns a pointer to the first new element.
+
+insert_elements(*list, pos, N) inserts N uninitialized elements at position
+                               pos. if pos > list.size, does nothing and
+                               returns nullptr. otherwise returns a pointer to
+                               the first inserted element.
+
+remove_elements(*list, pos, N) removes N elements starting at position pos.
+                               does nothing if pos >= list.size.
+remove_from_start(*list) removes the first element.
+remove_from_end(*list)   removes the last element.
+
+at(*list, N) returns a pointer to the Nth element in the list. walks from
+             the nearer end, skipping at most list.size / 2 elements, which
+             is about list.size / K nodes when nodes are at least half full
+             (as after a split). nodes left small by removals make the walk
+             longer, up to list.size / 2 nodes.
+
+clear(*list) identical to free<false>(*list).
+
+free_values(*list) calls free(*v) on each element in the list.
+free(*list)        frees all nodes. if template parameter FreeValues is true,
+                   calls free() on every element.
+
+search(*list, *key, eq), index_of(*list, *key, eq), contains(*list, *key, eq)
+    same as for linked_list.
+
+hash(*list) returns the default hash of the _memory_ of the _elements_
+            stored in the list.
+
+supports index operator: list[0] == *at(&list, 0).
+
+for_unrolled_list(v, *list)    iterate a list. v will be a pointer to an
+                               element in the list.
+for_unrolled_list(i, v, *list) iterate a list. i will be the index of an
+                               element and v will be a pointer to an element.
+ */
+
+#include "shl/assert.hpp"
+#include "shl/compare.hpp"
+#include "shl/macros.hpp"
+#include "shl/type_functions.hpp"
+#include "shl/number_types.hpp"
+#include "shl/program_context.hpp"
+#include "shl/memory.hpp"
+#include "shl/hash.hpp"
+
+template<typename T>
+constexpr s64 unrolled_list_default_count()
+{
+    constexpr s64 header = 3 * sizeof(void*);
+    constexpr s64 count = (256 - header) / (s64)sizeof(T);
+
+    return count < 4 ? 4 : count;
+}
+
+template<typename T, s64 K>
+struct unrolled_list_node
+{
+    typedef T value_type;
+
+    unrolled_list_node<T, K> *next;
+    unrolled_list_node<T, K> *previous;
+    s64 count;
+
+    T values[K];
+};
+
+template<typename T, s64 K = unrolled_list_default_count<T>()>
+struct unrolled_list
+{
+    static_assert(K > 1, "unrolled_list must store more than 1 element per node, use linked_list otherwise");
+
+    typedef T value_type;
+    typedef unrolled_list_node<T, K> node_type;
+    static constexpr s64 node_capacity = K;
+
+    unrolled_list_node<T, K> *first;
+    unrolled_list_node<T, K> *last;
+    s64 size;
+
+    ::allocator allocator;
+
+    T &operator[](s64 index) { return *at(this, index); }
+};
+
+template<typename T, s64 K>
+void init(unrolled_list<T, K> *list)
+{
+    assert(list != nullptr);
+
+    list->first = nullptr;
+    list->last = nullptr;
+    list->size = 0;
+    list->allocator = get_context_pointer()->allocator;
+}
+
+template<typename T, s64 K>
+void init(unrolled_list<T, K> *list, s64 n_elements)
+{
+    assert(list != nullptr);
+
+    init(list);
+
+    if (n_elements <= 0)
+        return;
+
+    add_elements(list, n_elements);
+}
+
+// returns the node containing the element at index and sets *offset to the
+// index of the element within the node.
+template<typename T, s64 K>
+unrolled_list_node<T, K> *_unrolled_list_find(const unrolled_list<T, K> *list, s64 index, s64 *offset)
+{
+    if (index < 0 || index >= list->size)
+        return nullptr;
+
+    unrolled_list_node<T, K> *n = nullptr;
+
+    if (index < list->size / 2)
+    {
+        n = list->first;
+
+        while (index >= n->count)
+        {
+            index -= n->count;
+            n = n->next;
+        }
+    }
+    else
+    {
+        // index from the back
+        index = list->size - 1 - index;
+        n = list->last;
+
+        while (index >= n->count)
+        {
+            index -= n->count;
+            n = n->previous;
+        }
+
+        index = n->count - 1 - index;
+    }
+
+    *offset = index;
+    return n;
+}
+
+// inserts a new, empty node after node 'after', or at the start if after
+// is nullptr.
+template<typename T, s64 K>
+unrolled_list_node<T, K> *_unrolled_list_add_node(unrolled_list<T, K> *list, unrolled_list_node<T, K> *after)
+{
+    _set_allocator_if_not_set(list);
+
+    auto *n = (unrolled_list_node<T, K>*)allocator_alloc(list->allocator, sizeof(unrolled_list_node<T, K>));
+
+    if (n == nullptr)
+        return nullptr;
+
+    n->count = 0;
+    n->previous = after;
+    n->next = after != nullptr ? after->next : list->first;
+
+    if (n->next != nullptr)
+        n->next->previous = n;
+    else
+        list->last = n;
+
+    if (after != nullptr)
+        after->next = n;
+    else
+        list->first = n;
+
+    return n;
+}
+
+template<typename T, s64 K>
+void _unrolled_list_remove_node(unrolled_list<T, K> *list, unrolled_list_node<T, K> *n)
+{
+    if (n->previous != nullptr)
+        n->previous->next = n->next;
+    else
+        list->first = n->next;
+
+    if (n->next != nullptr)
+        n->next->previous = n->previous;
+    else
+        list->last = n->previous;
+
+    _set_allocator_if_not_set(list);
+    allocator_dealloc(list->allocator, n, sizeof(unrolled_list_node<T, K>));
+}
+
+template<typename T, s64 K>
+T *add_elements(unrolled_list<T, K> *list, s64 n_elements)
+{
+    assert(list != nullptr);
+
+    if (n_elements <= 0)
+        return nullptr;
+
+    T *ret = nullptr;
+
+    while (n_elements > 0)
+    {
+        unrolled_list_node<T, K> *n = list->last;
+
+        if (n == nullptr || n->count >= K)
+        {
+            n = _unrolled_list_add_node(list, list->last);
+
+            if (n == nullptr)
+                return nullptr;
+        }
+
+        s64 count = Min(n_elements, K - n->count);
+
+        if (ret == nullptr)
+            ret = n->values + n->count;
+
+        n->count += count;
+        list->size += count;
+        n_elements -= count;
+    }
+
+    return ret;
+}
+
+template<typename T, s64 K>
+T *_unrolled_list_insert_element(unrolled_list<T, K> *list, s64 index)
+{
+    if (index == list->size)
+        return add_elements(list, 1);
+
+    s64 offset = 0;
+    unrolled_list_node<T, K> *n = _unrolled_list_find(list, index, &offset);
+
+    if (n->count >= K)
+    {
+        // split node in half
+        unrolled_list_node<T, K> *split = _unrolled_list_add_node(list, n);
+
+        if (split == nullptr)
+            return nullptr;
+
+        s64 half = K / 2;
+        split->count = K - half;
+        ::copy_memory((const void*)(n->values + half), (void*)split->values, split->count * sizeof(T));
+        n->count = half;
+
+        if (offset > half)
+        {
+            offset -= half;
+            n = split;
+        }
+    }
+
+    ::move_memory((const void*)(n->values + offset), (void*)(n->values + offset + 1), (n->count - offset) * sizeof(T));
+    n->count += 1;
+    list->size += 1;
+
+    return n->values + offset;
+}
+
+template<typename T, s64 K>
+T *insert_elements(unrolled_list<T, K> *list, s64 index, s64 n_elements)
+{
+    assert(list != nullptr);
+
+    if (n_elements <= 0)
+        return nullptr;
+
+    if (index < 0 || index > list->size)
+        return nullptr;
+
+    if (index == list->size)
+        return add_elements(list, n_elements);
+
+    for (s64 i = 0; i < n_elements; ++i)
+        if (_unrolled_list_insert_element(list, index) == nullptr)
+            return nullptr;
+
+    return at(list, index);
+}
+
+template<typename T, s64 K>
+inline T *add_at_start(unrolled_list<T, K> *list)
+{
+    return insert_elements(list, 0, 1);
+}
+
+template<typename T, s64 K>
+inline T *add_at_start(unrolled_list<T, K> *list, T val)
+{
+    T *ret = add_at_start(list);
+    *ret = val;
+    return ret;
+}
+
+template<typename T, s64 K>
+inline T *add_at_start(unrolled_list<T, K> *list, const T *val)
+{
+    T *ret = add_at_start(list);
+    *ret = *val;
+    return ret;
+}
+
+template<typename T, s64 K>
+inline T *add_at_end(unrolled_list<T, K> *list)
+{
+    return add_elements(list, 1);
+}
+
+template<typename T, s64 K>
+inline T *add_at_end(unrolled_list<T, K> *list, T val)
+{
+    T *ret = add_at_end(list);
+    *ret = val;
+    return ret;
+}
+
+template<typename T, s64 K>
+inline T *add_at_end(unrolled_list<T, K> *list, const T *val)
+{
+    T *ret = add_at_end(list);
+    *ret = *val;
+    return ret;
+}
+
+// merges n with its next or previous node if they fit into one node.
+template<typename T, s64 K>
+void _unrolled_list_merge(unrolled_list<T, K> *list, unrolled_list_node<T, K> *n)
+{
+    unrolled_list_node<T, K> *into = n;
+    unrolled_list_node<T, K> *from = n->next;
+
+    if (from == nullptr || into->count + from->count > K)
+    {
+        into = n->previous;
+        from = n;
+    }
+
+    if (into == nullptr || into->count + from->count > K)
+        return;
+
+    ::copy_memory((const void*)from->values, (void*)(into->values + into->count), from->count * sizeof(T));
+    into->count += from->count;
+    _unrolled_list_remove_node(list, from);
+}
+
+template<bool FreeValues = false, typename T, s64 K>
+void remove_elements(unrolled_list<T, K> *list, s64 index, s64 n_elements)
+{
+    assert(list != nullptr);
+
+    if (n_elements <= 0)
+        return;
+
+    if (index < 0 || index >= list->size)
+        return;
+
+    s64 offset = 0;
+    unrolled_list_node<T, K> *n = _unrolled_list_find(list, index, &offset);
+
+    while (n_elements > 0 && n != nullptr)
+    {
+        s64 count = Min(n_elements, n->count - offset);
+
+        if constexpr (FreeValues)
+        for (s64 i = offset; i < offset + count; ++i)
+            free(n->values + i);
+
+        ::move_memory((const void*)(n->values + offset + count), (void*)(n->values + offset), (n->count - offset - count) * sizeof(T));
+        n->count -= count;
+        list->size -= count;
+        n_elements -= count;
+
+        unrolled_list_node<T, K> *next = n->next;
+
+        if (n->count == 0)
+            _unrolled_list_remove_node(list, n);
+        else if (n_elements == 0)
+        {
+            _unrolled_list_merge(list, n);
+            break;
+        }
+
+        n = next;
+        offset = 0;
+    }
+}
+
+template<bool FreeValues = false, typename T, s64 K>
+inline void remove_from_start(unrolled_list<T, K> *list)
+{
+    remove_elements<FreeValues>(list, 0, 1);
+}
+
+template<bool FreeValues = false, typename T, s64 K>
+inline void remove_from_end(unrolled_list<T, K> *list)
+{
+    remove_elements<FreeValues>(list, list->size - 1, 1);
+}
+
+template<typename T, s64 K>
+T *at(unrolled_list<T, K> *list, s64 index)
+{
+    assert(list != nullptr);
+
+    s64 offset = 0;
+    unrolled_list_node<T, K> *n = _unrolled_list_find(list, index, &offset);
+
+    if (n == nullptr)
+        return nullptr;
+
+    return n->values + offset;
+}
+
+template<typename T, s64 K>
+const T *at(const unrolled_list<T, K> *list, s64 index)
+{
+    assert(list != nullptr);
+
+    s64 offset = 0;
+    unrolled_list_node<T, K> *n = _unrolled_list_find(list, index, &offset);
+
+    if (n == nullptr)
+        return nullptr;
+
+    return n->values + offset;
+}
+
+// advances *node and *offset to the next element and returns a pointer
+// to it, or nullptr if there is no next element.
+template<typename T, s64 K>
+inline T *_unrolled_list_next(unrolled_list_node<T, K> **node, s64 *offset)
+{
+    *offset += 1;
+
+    if (*offset < (*node)->count)
+        return (*node)->values + *offset;
+
+    *node = (*node)->next;
+    *offset = 0;
+
+    return *node != nullptr ? (*node)->values : nullptr;
+}
+
+#define for_unrolled_list_IV(I_Var, V_Var, LIST)\
+    if constexpr (auto *I_Var##V_Var##_node = (LIST)->first; true)\
+    if constexpr (s64 I_Var##V_Var##_offset = 0; true)\
+    if constexpr (auto *V_Var = I_Var##V_Var##_node != nullptr ? I_Var##V_Var##_node->values : nullptr; true)\
+    for (s64 I_Var = 0; V_Var != nullptr; ++I_Var, V_Var = _unrolled_list_next(&I_Var##V_Var##_node, &I_Var##V_Var##_offset))
+
+#define for_unrolled_list_V(V_Var, LIST)\
+    for_unrolled_list_IV(V_Var##_index, V_Var, LIST)
+
+#define for_unrolled_list(...) GET_MACRO2(__VA_ARGS__, for_unrolled_list_IV, for_unrolled_list_V)(__VA_ARGS__)
+
+template<typename T, s64 K>
+void free_values(unrolled_list<T, K> *list)
+{
+    assert(list != nullptr);
+
+    for_unrolled_list(v, list)
+        free(v);
+}
+
+template<bool FreeValues = false, typename T, s64 K>
+void free(unrolled_list<T, K> *list)
+{
+    assert(list != nullptr);
+
+    if constexpr (FreeValues) free_values(list);
+
+    _set_allocator_if_not_set(list);
+
+    unrolled_list_node<T, K> *n = list->first;
+
+    while (n != nullptr)
+    {
+        unrolled_list_node<T, K> *next = n->next;
+        allocator_dealloc(list->allocator, n, sizeof(unrolled_list_node<T, K>));
+        n = next;
+    }
+
+    list->first = nullptr;
+    list->last = nullptr;
+    list->size = 0;
+}
+
+template<typename T, s64 K>
+void clear(unrolled_list<T, K> *list)
+{
+    free<false>(list);
+}
+
+template<typename T, s64 K>
+T *search(unrolled_list<T, K> *list, T key, equality_function<T> eq = equals<T>)
+{
+    assert(list != nullptr);
+
+    for_unrolled_list(v, list)
+        if (eq(*v, key))
+            return v;
+
+    return nullptr;
+}
+
+template<typename T, s64 K>
+T *search(unrolled_list<T, K> *list, const T *key, equality_function_p<T> eq = equals_p<T>)
+{
+    assert(list != nullptr);
+
+    for_unrolled_list(v, list)
+        if (eq(v, key))
+            return v;
+
+    return nullptr;
+}
+
+template<typename T, s64 K>
+s64 index_of(const unrolled_list<T, K> *list, T key, equality_function<T> eq = equals<T>)
+{
+    assert(list != nullptr);
+
+    for_unrolled_list(i, v, list)
+        if (eq(*v, key))
+            return i;
+
+    return -1;
+}
+
+template<typename T, s64 K>
+s64 index_of(const unrolled_list<T, K> *list, const T *key, equality_function_p<T> eq = equals_p<T>)
+{
+    assert(list != nullptr);
+
+    for_unrolled_list(i, v, list)
+        if (eq(v, key))
+            return i;
+
+    return -1;
+}
+
+template<typename T, s64 K>
+bool contains(const unrolled_list<T, K> *list, T key, equality_function<T> eq = equals<T>)
+{
+    return index_of(list, key, eq) != -1;
+}
+
+template<typename T, s64 K>
+bool contains(const unrolled_list<T, K> *list, const T *key, equality_function_p<T> eq = equals_p<T>)
+{
+    return index_of(list, key, eq) != -1;
+}
+
+template<typename T, s64 K>
+hash_t hash(const unrolled_list<T, K> *list)
+{
+    hash_t ret = 0;
+
+    for_unrolled_list(v, list)
+        ret = hash_data(reinterpret_cast<const void*>(v), sizeof(T), ret);
+
+    return ret;
+}
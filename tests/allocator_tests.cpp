@@ -2,6 +2,8 @@
 #include <t1/t1.hpp>
 
 #include "shl/allocator.hpp"
+#include "shl/allocator_page.hpp"
+#include "shl/memory.hpp"
 
 define_test(default_allocator_allocates_and_deallocates_memory)
 {
@@ -50,4 +52,43 @@ define_test(default_allocator_allocates_and_deallocates_memory3)
     assert_equal(x, nullptr);
 }
 
+define_test(default_allocator_does_not_expand_in_place)
+{
+    allocator a = default_allocator;
+
+    int *x = allocator_alloc_T(a, int);
+
+    assert_equal(allocator_try_expand_T(a, x, int, 1, 2), false);
+
+    allocator_dealloc_T(a, x, int);
+}
+
+define_test(page_allocator_allocates_pages)
+{
+    allocator a = page_allocator;
+    s64 pagesize = get_system_pagesize();
+
+    char *x = (char*)allocator_alloc(a, 10);
+
+    assert_not_equal(x, nullptr);
+    assert_equal((u64)x % pagesize, 0);
+
+    // whole page is usable
+    fill_memory(x, 'a', pagesize);
+
+    // same page count, stays in place
+    assert_equal(allocator_try_expand(a, x, 10, pagesize), true);
+
+    x = (char*)allocator_realloc(a, x, pagesize, pagesize * 16);
+
+    assert_not_equal(x, nullptr);
+    assert_equal(x[0], 'a');
+    assert_equal(x[pagesize - 1], 'a');
+    x[pagesize * 16 - 1] = 'b';
+
+    x = (char*)allocator_dealloc(a, x, pagesize * 16);
+
+    assert_equal(x, nullptr);
+}
+
 define_default_test_main()
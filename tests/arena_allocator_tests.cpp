@@ -128,4 +128,34 @@ define_test(free_only_frees_last_alloc)
     free(&_a);
 }
 
+define_test(try_expand_expands_last_alloc)
+{
+    arena _a;
+
+    init(&_a, 128);
+
+    {
+        arena a = _a;
+        allocator alloc = arena_allocator(&a);
+
+        s64 *x = allocator_alloc_T(alloc, s64);
+        s64 *y = allocator_alloc_T(alloc, s64);
+
+        assert_equal(arena_remaining_size(a), 112);
+
+        // x is not the last entry
+        assert_equal(allocator_try_expand(alloc, x, sizeof(s64), 32), false);
+        assert_equal(arena_remaining_size(a), 112);
+
+        assert_equal(allocator_try_expand(alloc, y, sizeof(s64), 32), true);
+        assert_equal(arena_remaining_size(a), 88);
+
+        // not enough space
+        assert_equal(allocator_try_expand(alloc, y, 32, 256), false);
+        assert_equal(arena_remaining_size(a), 88);
+    }
+
+    free(&_a);
+}
+
 define_default_test_main()
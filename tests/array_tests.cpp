@@ -2,6 +2,8 @@
 #include <t1/t1.hpp>
 
 #include "shl/array.hpp"
+#include "shl/allocator_arena.hpp"
+#include "shl/allocator_page.hpp"
 
 define_test(init_initializes_array)
 {
@@ -1173,4 +1175,88 @@ define_test(zero_init_zero_initializes_array)
     free(&arr);
 }
 
+struct growth_1_5 { int x; };
+struct growth_page { int x; };
+
+template<> constexpr array_growth array_growth_policy<growth_1_5> = array_growth::Factor1_5;
+template<> constexpr array_growth array_growth_policy<growth_page> = array_growth::Page;
+
+define_test(add_elements_uses_growth_policy)
+{
+    array<growth_1_5> arr{};
+
+    add_elements(&arr, 4);
+    assert_equal(arr.reserved_size, 4);
+
+    add_elements(&arr, 1);
+    assert_equal(arr.reserved_size, 6);
+
+    add_elements(&arr, 2);
+    assert_equal(arr.reserved_size, 9);
+
+    add_elements(&arr, 10);
+    assert_equal(arr.reserved_size, 17);
+
+    free(&arr);
+
+    array<growth_page> arr2{};
+    s64 per_page = get_system_pagesize() / (s64)sizeof(growth_page);
+
+    add_elements(&arr2, 1);
+    assert_equal(arr2.reserved_size, per_page);
+
+    add_elements(&arr2, per_page);
+    assert_equal(arr2.reserved_size, per_page * 2);
+    assert_equal(arr2.size, per_page + 1);
+
+    free(&arr2);
+}
+
+define_test(add_elements_expands_in_place)
+{
+    arena _a;
+    init(&_a, 4096);
+    arena a = _a;
+
+    array<int> arr{};
+
+    with_allocator(arena_allocator(&a))
+        init(&arr);
+
+    add_elements(&arr, 4);
+    int *data = arr.data;
+    assert_equal(arr.reserved_size, 4);
+    assert_equal(arena_remaining_size(a), 4096 - 4 * (s64)sizeof(int));
+
+    add_elements(&arr, 20);
+    assert_equal(arr.data, data);
+    assert_equal(arr.reserved_size, 32);
+    assert_equal(arena_remaining_size(a), 4096 - 32 * (s64)sizeof(int));
+
+    reserve(&arr, 100);
+    assert_equal(arr.data, data);
+    assert_equal(arr.reserved_size, 100);
+
+    free(&_a);
+}
+
+define_test(page_allocator_grows_large_arrays)
+{
+    array<u64> arr{};
+    s64 count = 4 * get_system_pagesize();
+
+    with_allocator(page_allocator)
+        init(&arr);
+
+    for (s64 i = 0; i < count; ++i)
+        add_at_end(&arr, (u64)i);
+
+    assert_equal(arr.size, count);
+
+    for (s64 i = 0; i < count; ++i)
+        assert_equal(arr[i], (u64)i);
+
+    free(&arr);
+}
+
 define_default_test_main();
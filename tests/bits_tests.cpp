@@ -141,4 +141,28 @@ define_test(is_pow2_checks_if_number_is_pow2)
     assert_equal(is_pow2(8), true);
 }
 
+define_test(popcnt64_counts_bits)
+{
+    assert_equal(popcnt64(0), 0);
+    assert_equal(popcnt64(1), 1);
+    assert_equal(popcnt64(0xff00ff00ff00ff00), 32);
+    assert_equal(popcnt64(0xffffffffffffffff), 64);
+}
+
+define_test(clz64_counts_leading_zeroes)
+{
+    assert_equal(clz64(0), 64);
+    assert_equal(clz64(1), 63);
+    assert_equal(clz64(0x100000000), 31);
+    assert_equal(clz64(0x8000000000000000), 0);
+}
+
+define_test(ctz64_counts_trailing_zeroes)
+{
+    assert_equal(ctz64(0), 64);
+    assert_equal(ctz64(1), 0);
+    assert_equal(ctz64(0x100000000), 32);
+    assert_equal(ctz64(0x8000000000000000), 63);
+}
+
 define_default_test_main();
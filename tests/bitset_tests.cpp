@@ -0,0 +1,210 @@
+#include <t1/t1.hpp>
+
+#include "shl/bitset.hpp"
+
+define_test(set_bit_sets_bit)
+{
+    bitset<100> bits{};
+
+    assert_equal(bits.word_count, 2);
+    assert_equal(is_bit_set(&bits, 5), false);
+
+    set_bit(&bits, 5);
+    set_bit(&bits, 64);
+    set_bit(&bits, 99);
+
+    assert_equal(is_bit_set(&bits, 5), true);
+    assert_equal(is_bit_set(&bits, 64), true);
+    assert_equal(is_bit_set(&bits, 99), true);
+    assert_equal(bits.words[0], 1ull << 5);
+    assert_equal(bits.words[1], (1ull << 0) | (1ull << 35));
+
+    unset_bit(&bits, 64);
+    toggle_bit(&bits, 5);
+    toggle_bit(&bits, 6);
+
+    assert_equal(is_bit_set(&bits, 5), false);
+    assert_equal(is_bit_set(&bits, 6), true);
+    assert_equal(is_bit_set(&bits, 64), false);
+    assert_equal(count_set_bits(&bits), 2);
+}
+
+define_test(fill_bits_fills_bits)
+{
+    bitset<100> bits{};
+
+    fill_bits(&bits, true);
+
+    assert_equal(count_set_bits(&bits), 100);
+    // unused bits stay 0
+    assert_equal(bits.words[1], (1ull << 36) - 1);
+
+    bits_not(&bits);
+
+    assert_equal(count_set_bits(&bits), 0);
+}
+
+define_test(bit_rank_counts_bits_before_index)
+{
+    bitset<200> bits{};
+
+    set_bit(&bits, 0);
+    set_bit(&bits, 10);
+    set_bit(&bits, 63);
+    set_bit(&bits, 64);
+    set_bit(&bits, 150);
+
+    assert_equal(bit_rank(&bits, 0), 0);
+    assert_equal(bit_rank(&bits, 1), 1);
+    assert_equal(bit_rank(&bits, 11), 2);
+    assert_equal(bit_rank(&bits, 64), 3);
+    assert_equal(bit_rank(&bits, 65), 4);
+    assert_equal(bit_rank(&bits, 200), 5);
+}
+
+define_test(bit_select_finds_kth_set_bit)
+{
+    bitset<200> bits{};
+
+    set_bit(&bits, 3);
+    set_bit(&bits, 10);
+    set_bit(&bits, 64);
+    set_bit(&bits, 199);
+
+    assert_equal(bit_select(&bits, 0), 3);
+    assert_equal(bit_select(&bits, 1), 10);
+    assert_equal(bit_select(&bits, 2), 64);
+    assert_equal(bit_select(&bits, 3), 199);
+    assert_equal(bit_select(&bits, 4), -1);
+
+    for (s64 k = 0; k < 4; ++k)
+        assert_equal(bit_rank(&bits, bit_select(&bits, k)), k);
+}
+
+define_test(for_each_set_bit_iterates_set_bits)
+{
+    bitset<300> bits{};
+    s64 expected[] = {0, 1, 63, 64, 128, 255, 299};
+
+    for (s64 i : expected)
+        set_bit(&bits, i);
+
+    s64 count = 0;
+
+    for_each_set_bit(i, &bits)
+    {
+        assert_equal(i, expected[count]);
+        count++;
+    }
+
+    assert_equal(count, 7);
+    assert_equal(next_set_bit(&bits, 2), 63);
+    assert_equal(next_set_bit(&bits, 300), -1);
+}
+
+define_test(set_operations_combine_bitsets)
+{
+    bitset<130> a{};
+    bitset<130> b{};
+
+    set_bit(&a, 1);
+    set_bit(&a, 65);
+    set_bit(&a, 129);
+    set_bit(&b, 65);
+    set_bit(&b, 100);
+
+    bitset<130> c = a;
+    bits_and(&c, &b);
+    assert_equal(count_set_bits(&c), 1);
+    assert_equal(is_bit_set(&c, 65), true);
+
+    c = a;
+    bits_or(&c, &b);
+    assert_equal(count_set_bits(&c), 4);
+
+    c = a;
+    bits_xor(&c, &b);
+    assert_equal(count_set_bits(&c), 3);
+    assert_equal(is_bit_set(&c, 65), false);
+
+    c = a;
+    bits_andnot(&c, &b);
+    assert_equal(count_set_bits(&c), 2);
+    assert_equal(is_bit_set(&c, 1), true);
+    assert_equal(is_bit_set(&c, 129), true);
+}
+
+define_test(bit_array_init_initializes_bit_array)
+{
+    bit_array arr;
+
+    init(&arr);
+
+    assert_equal(arr.size, 0);
+    assert_equal(arr.words.size, 0);
+    assert_equal(count_set_bits(&arr), 0);
+    assert_equal(next_set_bit(&arr, 0), -1);
+
+    free(&arr);
+
+    init(&arr, 1000);
+
+    assert_equal(arr.size, 1000);
+    assert_equal(arr.words.size, 16);
+    assert_equal(count_set_bits(&arr), 0);
+
+    free(&arr);
+}
+
+define_test(bit_array_resize_keeps_bits)
+{
+    bit_array arr{};
+    init(&arr, 70);
+
+    fill_bits(&arr, true);
+    assert_equal(count_set_bits(&arr), 70);
+
+    resize(&arr, 200);
+
+    assert_equal(arr.size, 200);
+    assert_equal(count_set_bits(&arr), 70);
+    assert_equal(is_bit_set(&arr, 69), true);
+    assert_equal(is_bit_set(&arr, 70), false);
+
+    resize(&arr, 10);
+
+    assert_equal(count_set_bits(&arr), 10);
+
+    resize(&arr, 100);
+
+    assert_equal(count_set_bits(&arr), 10);
+
+    free(&arr);
+}
+
+define_test(bit_array_set_operations_combine_bit_arrays)
+{
+    bit_array a{};
+    bit_array b{};
+    init(&a, 1000);
+    init(&b, 1000);
+
+    for (s64 i = 0; i < 1000; i += 2)
+        set_bit(&a, i);
+
+    for (s64 i = 0; i < 1000; i += 3)
+        set_bit(&b, i);
+
+    bits_and(&a, &b);
+
+    // multiples of 6
+    assert_equal(count_set_bits(&a), 167);
+
+    for_each_set_bit(i, &a)
+        assert_equal(i % 6, 0);
+
+    free(&a);
+    free(&b);
+}
+
+define_default_test_main();
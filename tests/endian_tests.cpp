@@ -17,4 +17,17 @@ define_test(endianness_test)
     assert_equal(values[3], 0x78);
 }
 
+define_test(byte_swap_reverses_bytes)
+{
+    assert_equal(byte_swap((u32)0x12345678u), (u32)0x78563412u);
+    assert_equal(byte_swap((u64)0x0123456789abcdefull), (u64)0xefcdab8967452301ull);
+    static_assert(byte_swap(byte_swap((u64)0x1122334455667788ull)) == 0x1122334455667788ull);
+
+    u64 big_endian_value = force_big_endian((u64)0x0102030405060708ull);
+    u8 *values = (u8*)&big_endian_value;
+
+    for (s64 i = 0; i < 8; ++i)
+        assert_equal(values[i], (u8)(i + 1));
+}
+
 define_default_test_main();
@@ -0,0 +1,384 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <t1/t1.hpp>
+
+#include "shl/format.hpp"
+#include "shl/print.hpp"
+#include "shl/pipe.hpp"
+#include "shl/time.hpp"
+
+/* not correctness tests: these print the time per call and throughput of
+format, to_string, tformat and put next to snprintf (and write) doing the
+same work, to catch regressions in the formatter.
+Every benchmark first checks that both produce the same text.
+
+The benchmarks only run if FORMAT_BENCHMARK_COUNT is set to the number of
+calls per case (e.g. 1000000), otherwise only the checks run.
+If FORMAT_BENCHMARK_MAX_RATIO is set as well, a case fails if it takes more
+than that many times as long as snprintf, e.g. FORMAT_BENCHMARK_MAX_RATIO=1.5 */
+
+static s64 _benchmark_count()
+{
+    if (const char *env = getenv("FORMAT_BENCHMARK_COUNT"); env != nullptr)
+        return string_to_s64(to_const_string(env));
+
+    return 0;
+}
+
+static double _benchmark_max_ratio()
+{
+    if (const char *env = getenv("FORMAT_BENCHMARK_MAX_RATIO"); env != nullptr)
+        return string_to_double(to_const_string(env));
+
+    return 0.0;
+}
+
+struct _benchmark
+{
+    timespan start;
+    s64 calls;
+    s64 bytes;
+};
+
+static void _benchmark_start(_benchmark *b)
+{
+    b->calls = 0;
+    b->bytes = 0;
+    get_time(&b->start);
+}
+
+static double _benchmark_stop(_benchmark *b, const_string name)
+{
+    timespan end;
+    get_time(&end);
+    double secs = get_seconds_difference(&b->start, &end);
+
+    if (b->calls > 0)
+        tprint("  %-28s %#8.1f ns/call %#9.1f MiB/s\n", name, secs * 1e9 / b->calls, b->bytes / secs / (1 << 20));
+
+    return secs;
+}
+
+static void _benchmark_compare(double secs, double baseline_secs)
+{
+    if (_benchmark_count() <= 0)
+        return;
+
+    tprint("  %-28s %#8.2fx\n", "speedup over snprintf", baseline_secs / secs);
+
+    if (double max_ratio = _benchmark_max_ratio(); max_ratio > 0)
+        assert_less_or_equal(secs, baseline_secs * max_ratio);
+}
+
+define_test(format_integers_with_padding)
+{
+    const s64 count = _benchmark_count();
+    c8 buf[64];
+    c8 cbuf[64];
+    _benchmark b;
+
+    s64 n = format(buf, 64, "%08x|%-10|%+6"_cs, 0xbeefu, -1234, 56);
+    assert_equal(n, (s64)snprintf(cbuf, 64, "%08x|%-10d|%+6d", 0xbeefu, -1234, 56));
+    assert_equal((const_string{buf, n}), (const_string{cbuf, n}));
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += format(buf, 64, "%08x|%-10|%+6"_cs, (u32)i * 2654435761u, i - count / 2, i & 0xffff);
+        b.calls++;
+    }
+
+    double secs = _benchmark_stop(&b, "format integers"_cs);
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += snprintf(cbuf, 64, "%08x|%-10lld|%+6lld", (u32)i * 2654435761u, (long long)(i - count / 2), (long long)(i & 0xffff));
+        b.calls++;
+    }
+
+    _benchmark_compare(secs, _benchmark_stop(&b, "snprintf integers"_cs));
+}
+
+define_test(format_floats_with_precision)
+{
+    const s64 count = _benchmark_count();
+    c8 buf[64];
+    c8 cbuf[64];
+    _benchmark b;
+
+    // # keeps trailing zeroes like printf
+    s64 n = format(buf, 64, "%#12.3f|%#.6f"_cs, -1234.5678, 0.1);
+    assert_equal(n, (s64)snprintf(cbuf, 64, "%12.3f|%.6f", -1234.5678, 0.1));
+    assert_equal((const_string{buf, n}), (const_string{cbuf, n}));
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        double x = (double)(i - count / 2) * 0.37;
+        b.bytes += format(buf, 64, "%#12.3f|%#.6f"_cs, x, x / 7.0);
+        b.calls++;
+    }
+
+    double secs = _benchmark_stop(&b, "format floats"_cs);
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        double x = (double)(i - count / 2) * 0.37;
+        b.bytes += snprintf(cbuf, 64, "%12.3f|%.6f", x, x / 7.0);
+        b.calls++;
+    }
+
+    _benchmark_compare(secs, _benchmark_stop(&b, "snprintf floats"_cs));
+
+    // shortest round trip, no printf equivalent
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        double x = (double)(i - count / 2) * 0.37;
+        b.bytes += to_string(buf, 64, x);
+        b.calls++;
+    }
+
+    _benchmark_stop(&b, "to_string double"_cs);
+}
+
+define_test(format_strings_with_padding)
+{
+    const s64 count = _benchmark_count();
+    const c8 *words[] = {"a", "format", "benchmark", "with some spaces", "x"};
+    c8 buf[128];
+    c8 cbuf[128];
+    _benchmark b;
+
+    s64 n = format(buf, 128, "[%-12s|%12s|%s]"_cs, words[1], words[2], words[3]);
+    assert_equal(n, (s64)snprintf(cbuf, 128, "[%-12s|%12s|%s]", words[1], words[2], words[3]));
+    assert_equal((const_string{buf, n}), (const_string{cbuf, n}));
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += format(buf, 128, "[%-12s|%12s|%s]"_cs, words[i % 5], words[(i + 1) % 5], words[(i + 3) % 5]);
+        b.calls++;
+    }
+
+    double secs = _benchmark_stop(&b, "format strings"_cs);
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += snprintf(cbuf, 128, "[%-12s|%12s|%s]", words[i % 5], words[(i + 1) % 5], words[(i + 3) % 5]);
+        b.calls++;
+    }
+
+    _benchmark_compare(secs, _benchmark_stop(&b, "snprintf strings"_cs));
+}
+
+define_test(format_mixed_log_lines)
+{
+    const s64 count = _benchmark_count();
+    c8 cbuf[256];
+    string str{};
+    _benchmark b;
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        const_string s = tformat("% [%5s] request % took %#.3fms (% bytes)\n"_cs, i, "INFO", "/index.html", i * 0.001, i & 4095);
+        b.bytes += s.size;
+        b.calls++;
+    }
+
+    double secs = _benchmark_stop(&b, "tformat log line"_cs);
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += format(&str, "% [%5s] request % took %#.3fms (% bytes)\n"_cs, i, "INFO", "/index.html", i * 0.001, i & 4095);
+        b.calls++;
+    }
+
+    _benchmark_stop(&b, "format string log line"_cs);
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += format_size("% [%5s] request % took %#.3fms (% bytes)\n"_cs, i, "INFO", "/index.html", i * 0.001, i & 4095);
+        b.calls++;
+    }
+
+    _benchmark_stop(&b, "format_size log line"_cs);
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += snprintf(cbuf, 256, "%lld [%5s] request %s took %.3fms (%lld bytes)\n", (long long)i, "INFO", "/index.html", i * 0.001, (long long)(i & 4095));
+        b.calls++;
+    }
+
+    _benchmark_compare(secs, _benchmark_stop(&b, "snprintf log line"_cs));
+
+    free(&str);
+}
+
+struct _tformat_benchmark_args
+{
+    s64 count;
+    s64 bytes;
+    bool use_snprintf;
+};
+
+static void *_tformat_benchmark_thread(void *arg)
+{
+    _tformat_benchmark_args *args = (_tformat_benchmark_args*)arg;
+    c8 cbuf[128];
+
+    for (s64 i = 0; i < args->count; ++i)
+    {
+        if (args->use_snprintf)
+            args->bytes += snprintf(cbuf, 128, "thread %p value %lld %.3f\n", (void*)args, (long long)i, i * 0.5);
+        else
+            args->bytes += tformat("thread % value % %#.3f\n"_cs, (void*)args, i, i * 0.5).size;
+    }
+
+    return nullptr;
+}
+
+static double _run_tformat_threads(s64 thread_count, s64 count, bool use_snprintf, const_string name)
+{
+    pthread_t threads[8];
+    _tformat_benchmark_args args[8]{};
+    _benchmark b;
+
+    assert(thread_count <= 8);
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        args[i].count = count;
+        args[i].use_snprintf = use_snprintf;
+        assert_equal(pthread_create(threads + i, nullptr, _tformat_benchmark_thread, args + i), 0);
+    }
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        pthread_join(threads[i], nullptr);
+        b.bytes += args[i].bytes;
+        b.calls += args[i].count;
+    }
+
+    // ns/call is wall time divided by calls of all threads
+    return _benchmark_stop(&b, name);
+}
+
+define_test(tformat_in_multiple_threads)
+{
+    const s64 count = _benchmark_count();
+    const s64 thread_count = 4;
+
+    double secs = _run_tformat_threads(thread_count, count, false, "tformat 4 threads"_cs);
+    _benchmark_compare(secs, _run_tformat_threads(thread_count, count, true, "snprintf 4 threads"_cs));
+}
+
+static void _benchmark_put(io_handle h, s64 count, const c8 *target)
+{
+    const_string line = "a line of 64 bytes written to the handle with put, padded ....\n"_cs;
+    c8 cbuf[128];
+    _benchmark b;
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += put(h, line);
+        b.calls++;
+    }
+
+    _benchmark_stop(&b, tformat("put %"_cs, target));
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += tprint(h, "% % %#.2f\n"_cs, i, target, i * 0.25);
+        b.calls++;
+    }
+
+    double tprint_secs = _benchmark_stop(&b, tformat("tprint %"_cs, target));
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        b.bytes += format_to_io(h, "% % %#.2f\n"_cs, i, target, i * 0.25);
+        b.calls++;
+    }
+
+    _benchmark_stop(&b, tformat("format_to_io %"_cs, target));
+
+    _benchmark_start(&b);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        int n = snprintf(cbuf, 128, "%lld %s %.2f\n", (long long)i, target, i * 0.25);
+        b.bytes += ::write(h, cbuf, n);
+        b.calls++;
+    }
+
+    _benchmark_compare(tprint_secs, _benchmark_stop(&b, tformat("snprintf+write %"_cs, target)));
+}
+
+define_test(put_to_dev_null)
+{
+    error err{};
+    io_handle h = io_open("/dev/null", open_mode::Write, &err);
+    assert_equal(err.error_code, 0);
+
+    _benchmark_put(h, _benchmark_count() / 4, "/dev/null");
+
+    io_close(h);
+}
+
+static void *_drain_pipe(void *arg)
+{
+    io_handle h = *(io_handle*)arg;
+    c8 buf[65536];
+
+    while (io_read(h, buf, 65536) > 0)
+        ;
+
+    return nullptr;
+}
+
+define_test(put_to_pipe)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    pthread_t reader;
+    assert_equal(pthread_create(&reader, nullptr, _drain_pipe, &p.read), 0);
+
+    _benchmark_put(p.write, _benchmark_count() / 4, "pipe");
+
+    io_close(p.write);
+    pthread_join(reader, nullptr);
+    io_close(p.read);
+}
+
+define_default_test_main();
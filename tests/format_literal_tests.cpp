@@ -0,0 +1,90 @@
+
+#include <t1/t1.hpp>
+
+#include "shl/format.hpp"
+
+#define assert_equal_str(Str1, Str2) assert_equal(to_const_string(Str1), to_const_string(Str2))
+
+// compares the compile-time format against the runtime format
+#define assert_same_format(Fmt, ...)\
+    assert_equal_str(tformat(Fmt##_fmt, __VA_ARGS__), tformat(Fmt, __VA_ARGS__))
+
+define_test(format_literal_counts_placeholders)
+{
+    static_assert(format_literal_placeholder_count(""_fmt) == 0);
+    static_assert(format_literal_placeholder_count("abc"_fmt) == 0);
+    static_assert(format_literal_placeholder_count("% %"_fmt) == 2);
+    static_assert(format_literal_placeholder_count("\\% %5.2f%"_fmt) == 2);
+    static_assert(format_literal_placeholder_count(fmt_literal<u"%x">{}) == 1);
+
+    assert_equal(format_literal_placeholder_count("%%%"_fmt), 3);
+}
+
+define_test(format_literal_formats_like_format)
+{
+    assert_equal_str(tformat("abc"_fmt), "abc");
+    assert_equal_str(tformat(""_fmt), "");
+    assert_equal_str(tformat("hello %!"_fmt, "world"), "hello world!");
+    assert_equal_str(tformat("%"_fmt, 123), "123");
+
+    assert_same_format("% %", "hello", "world");
+    assert_same_format("[%] %: %", 1, 'c', true);
+    assert_same_format("%5|%-5|%05", 12, 34, 56);
+    assert_same_format("%+d %+d", 5, -5);
+    assert_same_format("%x %X %#x %#X %#x", 255, 255, 255, 255, 0);
+    assert_same_format("%b %#b %o %#o", 5, 5, 8, 8);
+    assert_same_format("%f %.2f %#.2f %8.3f", 1.5, 2.0, 2.0, 3.14159);
+    assert_same_format("%.3 % %s", 1.23456, 7u, "s");
+    assert_same_format("%.12f|%.10f", 0.1, 2.5);
+    assert_same_format("%6s|%-6s|", "abc", "def");
+    assert_same_format("% %", (s64)-123456789012345, max_value(u64));
+    assert_same_format("%p", (const void*)0x1234);
+    assert_same_format("%", 0.1f);
+}
+
+define_test(format_literal_resolves_escapes)
+{
+    assert_equal_str(tformat(R"(abc\def)"_fmt), R"(abc\def)");
+    assert_equal_str(tformat(R"(abc\\def)"_fmt), R"(abc\\def)");
+    assert_equal_str(tformat(R"(abc\%def)"_fmt), R"(abc%def)");
+    assert_equal_str(tformat(R"(abc\\\%def)"_fmt), R"(abc\\%def)");
+    assert_equal_str(tformat(R"(abc\\% def)"_fmt, 123), R"(abc\\123 def)");
+    assert_equal_str(tformat(R"(/* \% */)"_fmt), R"(/* % */)");
+    assert_equal_str(tformat(R"(end\)"_fmt), R"(end\)");
+}
+
+define_test(format_literal_formats_to_buffer_and_string)
+{
+    c8 buf[10] = {0};
+
+    assert_equal(format(buf, 10, "% %"_fmt, 123, 45.6), 8);
+    assert_equal_str(const_string(buf, 8), "123 45.6");
+
+    // truncates like format
+    fill_memory(buf, 0, 10);
+    assert_equal(format(buf, 5, "abc %"_fmt, 123), 5);
+    assert_equal_str(const_string(buf, 5), "abc 1");
+
+    assert_equal(format(buf, 3, "abcdef%"_fmt, 1), 3);
+    assert_equal(format(buf, 10, 500000, "% %"_fmt, 123, 45.6), 0);
+
+    string str{};
+    init(&str);
+
+    assert_equal(format(&str, "hello %"_fmt, "world"), 11);
+    assert_equal_str(str, "hello world");
+    assert_equal(str.data[str.size], '\0');
+
+    assert_equal(format(&str, 6, "% and more"_fmt, "there"), 14);
+    assert_equal_str(str, "hello there and more");
+
+    free(&str);
+
+    u16string s16 = new_format(u"% %"_fmt, u"abc", 16);
+    assert_equal(s16, u"abc 16"_cs);
+    free(&s16);
+
+    assert_equal(tformat(U"%-4|"_fmt, 32), U"32  |"_cs);
+}
+
+define_default_test_main();
@@ -1,6 +1,12 @@
 
+#include <pthread.h>
+
 #include <t1/t1.hpp>
 #include "shl/format.hpp"
+#include "shl/print.hpp"
+#include "shl/pipe.hpp"
+#include "shl/thread.hpp"
+#include "shl/time.hpp"
 #include "shl/compiler.hpp"
 
 #if GNU
@@ -405,6 +411,94 @@ define_test(to_string_converts_integer_to_c_string)
     assert_equal_str(buf, "     0x000");
 }
 
+define_test(to_string_converts_integer_limits)
+{
+    string str;
+    init(&str);
+
+    format_options<char> opt = default_format_options<char>;
+    integer_format_options iopt = default_integer_options;
+
+    assert_to_string(str, "18446744073709551615"_cs, 20, max_value(u64));
+    assert_to_string(str, "9223372036854775808"_cs, 19, (u64)1 << 63);
+    assert_to_string(str, "-9223372036854775808"_cs, 20, min_value(s64));
+    assert_to_string(str, "9223372036854775807"_cs, 19, max_value(s64));
+    assert_to_string(str, "4294967295"_cs, 10, max_value(u32));
+    assert_to_string(str, "-128"_cs, 4, min_value(s8));
+
+    iopt.base = 16;
+    assert_to_string(str, "ffffffffffffffff"_cs, 16, max_value(u64), 0, opt, iopt);
+    iopt.caps_letters = true;
+    assert_to_string(str, "8000000000000000"_cs, 16, (u64)1 << 63, 0, opt, iopt);
+    assert_to_string(str, "-1A"_cs, 3, (s64)-26, 0, opt, iopt);
+
+    iopt.base = 2;
+    assert_to_string(str, "1000000000000000000000000000000000000000000000000000000000000001"_cs, 64, ((u64)1 << 63) | 1, 0, opt, iopt);
+
+    iopt.base = 8;
+    assert_to_string(str, "1777777777777777777777"_cs, 22, max_value(u64), 0, opt, iopt);
+
+    free(&str);
+}
+
+define_test(to_string_writes_integer_batch)
+{
+    c8 buf[32];
+    u64 values[] = {1, 22, 0, 18446744073709551615ull};
+    s64 svalues[] = {-1, 0, min_value(s64)};
+
+    assert_equal(to_string(buf, 32, values, 4, ", "_cs), 30);
+    assert_equal(const_string(buf, 30), "1, 22, 0, 18446744073709551615"_cs);
+
+    assert_equal(to_string(buf, 32, svalues, 3, ","_cs), 25);
+    assert_equal(const_string(buf, 25), "-1,0,-9223372036854775808"_cs);
+
+    // truncates
+    assert_equal(to_string(buf, 10, values, 4, ", "_cs), 10);
+    assert_equal(const_string(buf, 10), "1, 22, 0, "_cs);
+
+    assert_equal(to_string(buf, 32, values, 0, ","_cs), 0);
+
+    array<u64> arr{};
+    init(&arr);
+
+    for (u64 i = 0; i < 1000; ++i)
+        add_at_end(&arr, i * 1000003);
+
+    string str;
+    init(&str);
+    string_append(&str, "x="_cs);
+
+    s64 written = to_string(&str, &arr, ";"_cs, 2);
+    assert_equal(string_length(&str), written + 2);
+    assert_equal(str.data[str.size], '\0');
+    assert_equal(str.reserved_size >= str.size, true);
+
+    s64 pos = 2;
+
+    for (u64 i = 0; i < 1000; ++i)
+    {
+        s64 n = to_string(buf, 32, i * 1000003);
+        assert_equal(const_string(str.data + pos, n), const_string(buf, n));
+        pos += n + 1;
+    }
+
+    assert_equal(pos - 1, str.size);
+
+    array<s64> sarr{};
+    init(&sarr);
+    add_at_end(&sarr, (s64)-5);
+    add_at_end(&sarr, (s64)7);
+
+    clear(&str);
+    assert_equal(to_string(&str, &sarr, " "_cs), 4);
+    assert_equal_str(str, "-5 7"_cs);
+
+    free(&sarr);
+    free(&arr);
+    free(&str);
+}
+
 define_test(to_string_converts_pointer_to_string)
 {
     string str;
@@ -802,6 +896,12 @@ define_test(format_only_escapes_percent_backslashes)
     assert_equal_str(tformat(R"(abc\\% def)", 123),   R"(abc\\123 def)");
     assert_equal_str(tformat(R"(abc\\\\% def)", 123), R"(abc\\\\123 def)");
 
+    // escaped pairs at the end of the buffer don't write past it
+    c8 small[5] = "zzzz";
+    format(small, 3, R"(ab\\c)");
+    assert_equal(small[3], 'z');
+    format(small, 3, R"(ab\\%)", 1);
+    assert_equal(small[3], 'z');
 }
 
 define_test(format_padding_pads_string)
@@ -830,4 +930,178 @@ define_test(format_alt_formats_hex)
     assert_equal_str(tformat("%#x", U32_MAX), "0xffffffff");
 }
 
+define_test(set_tformat_buffer_size_grows_buffer)
+{
+    s64 old_size = get_tformat_buffer_size();
+
+    set_tformat_buffer_size(old_size * 4);
+    assert_greater_or_equal(get_tformat_buffer_size(), old_size * 4);
+    assert_equal(tformat("% %"_cs, "abc", 1), "abc 1"_cs);
+
+    // never shrinks below the minimum
+    set_tformat_buffer_size(1);
+    assert_greater_or_equal(get_tformat_buffer_size(), old_size * 4);
+    assert_equal(tformat("%"_cs, 2), "2"_cs);
+}
+
+struct _tformat_thread_args
+{
+    s64 id;
+    bool ok;
+    const c8 *buffer_data;
+};
+
+static void *_tformat_thread(void *arg)
+{
+    _tformat_thread_args *args = (_tformat_thread_args*)arg;
+    args->ok = true;
+
+    const_string first = tformat("thread %"_cs, args->id);
+    args->buffer_data = first.c_str;
+
+    for (s64 i = 0; i < 100000 && args->ok; ++i)
+    {
+        const_string s = tformat("thread % %"_cs, args->id, i);
+        const_string expected = tformat("thread % %"_cs, args->id, i);
+
+        if (s != expected || s.c_str[s.size] != '\0')
+            args->ok = false;
+    }
+
+    return nullptr;
+}
+
+define_test(tformat_uses_one_buffer_per_thread)
+{
+    const s64 thread_count = 4;
+    pthread_t threads[thread_count];
+    _tformat_thread_args args[thread_count]{};
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        args[i].id = i;
+        assert_equal(pthread_create(threads + i, nullptr, _tformat_thread, args + i), 0);
+    }
+
+    for (s64 i = 0; i < thread_count; ++i)
+        pthread_join(threads[i], nullptr);
+
+    const c8 *main_data = tformat("main"_cs).c_str;
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        assert_equal(args[i].ok, true);
+        assert_not_equal(args[i].buffer_data, main_data);
+    }
+}
+
+define_test(tformat_uses_one_buffer_per_shl_thread)
+{
+    const s64 thread_count = 4;
+    thread threads[thread_count]{};
+    _tformat_thread_args args[thread_count]{};
+
+    // shl threads share the thread_local storage of this thread
+    const_string main_str = tformat("main % %"_cs, 1, 2);
+    program_context *ctx = get_context_pointer();
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        args[i].id = i;
+        assert_equal(thread_create(threads + i, _tformat_thread, args + i), true);
+        assert_equal(thread_start(threads + i), true);
+
+        // starting threads set the context pointer of this thread
+        while (!thread_is_running(threads + i) && !thread_is_stopped(threads + i))
+            ;
+
+        set_context_pointer(ctx);
+    }
+
+    for (s64 i = 0; i < thread_count; ++i)
+        assert_equal(thread_stop(threads + i), true);
+
+    // thread_stop returns slightly before the threads stop using their stack
+    sleep_ms(20);
+
+    for (s64 i = 0; i < thread_count; ++i)
+        assert_equal(thread_destroy(threads + i), true);
+
+    assert_equal(main_str, "main 1 2"_cs);
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        assert_equal(args[i].ok, true);
+        assert_not_equal(args[i].buffer_data, main_str.c_str);
+
+        for (s64 j = 0; j < i; ++j)
+            assert_not_equal(args[i].buffer_data, args[j].buffer_data);
+    }
+}
+
+define_test(format_size_returns_formatted_size)
+{
+    assert_equal(format_size("abc"_cs), 3);
+    assert_equal(format_size(""_cs), 0);
+    assert_equal(format_size("% %"_cs, "hello", 12345), 11);
+    assert_equal(format_size("%08x|%-6s|%.3f"_cs, 0xff, "ab", 1.5), 8 + 1 + 6 + 1 + 3);
+    assert_equal(format_size(u"% \\%"_cs, u"wide"), 6);
+
+    // values larger than the chunk buffer
+    string big{};
+    string_reserve(&big, 3 * FORMAT_CHUNK_BUFFER_SIZE);
+    fill_memory(big.data, 'x', 3 * FORMAT_CHUNK_BUFFER_SIZE);
+    big.size = 3 * FORMAT_CHUNK_BUFFER_SIZE;
+    big.data[big.size] = '\0';
+
+    assert_equal(format_size("[%][%]"_cs, big, 1), big.size + 5);
+
+    // same size as format
+    string str{};
+    s64 size = format_size("% % % %"_cs, 1.25, -7, "abc", big);
+    string_reserve(&str, size);
+    assert_equal(format(str.data, size, "% % % %"_cs, 1.25, -7, "abc", big), size);
+
+    // too few arguments
+    assert_equal(format_size("% %"_cs, 1), -1);
+
+    free(&str);
+    free(&big);
+}
+
+static const_string _read_pipe(pipe_t *p, c8 *buf, s64 size)
+{
+    s64 n = io_read(p->read, buf, size);
+    return const_string{buf, n < 0 ? 0 : n};
+}
+
+define_test(format_to_io_writes_in_chunks)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+    c8 buf[512];
+
+    assert_equal(format_to_io(p.write, "hello % %\n"_cs, "world", 42), 15);
+    assert_equal(_read_pipe(&p, buf, 512), "hello world 42\n"_cs);
+
+    // small buffers flush in the middle of text, escapes and values
+    const_string expected = R"(abcdef \\ % 12345678 0x1f |  pad|left  )"_cs;
+
+    for (s64 size = 2; size < 12; ++size)
+    {
+        c8 chunk[12];
+        assert_equal(format_to_io(p.write, chunk, size, R"(abcdef \\ \% % %#x |%5s|%-6s)"_cs, 12345678, 0x1f, "pad", "left"), expected.size);
+        assert_equal(_read_pipe(&p, buf, 512), expected);
+    }
+
+    // larger than the buffer
+    c8 chunk[4];
+    assert_equal(format_to_io(p.write, chunk, 4, "[%]"_cs, "0123456789"), 12);
+    assert_equal(_read_pipe(&p, buf, 512), "[0123456789]"_cs);
+
+    assert_equal(format_to_io(p.write, "% %"_cs, 1), -1);
+
+    free(&p);
+}
+
 define_default_test_main();
@@ -0,0 +1,397 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <t1/t1.hpp>
+
+#include "shl/json.hpp"
+#include "shl/time.hpp"
+#include "shl/print.hpp"
+#include "_test_file_util.hpp"
+
+define_test(json_writer_writes_objects_and_arrays)
+{
+    string out{};
+    json_writer w{};
+    init(&w, &out);
+
+    json_begin_object(&w);
+    json_key(&w, "name");
+    json_value(&w, "shl");
+    json_key(&w, "tags"_cs);
+    json_begin_array(&w);
+    json_value(&w, 1);
+    json_value(&w, 2.5);
+    json_value(&w, -3.0f);
+    json_value(&w, nullptr);
+    json_value(&w, true);
+    json_begin_object(&w);
+    json_end_object(&w);
+    json_begin_array(&w);
+    json_end_array(&w);
+    json_end_array(&w);
+    json_key(&w, "n");
+    json_value(&w, min_value(s64));
+    json_key(&w, "u");
+    json_value(&w, max_value(u64));
+    json_end_object(&w);
+
+    assert_equal(json_flush(&w), true);
+    assert_equal(out, R"({"name":"shl","tags":[1,2.5,-3,null,true,{},[]],"n":-9223372036854775808,"u":18446744073709551615})" "\n"_cs);
+
+    free(&w);
+    free(&out);
+}
+
+define_test(json_writer_writes_non_finite_floats_as_null)
+{
+    string out{};
+    json_writer w{};
+    init(&w, &out);
+
+    double inf = 1e308 * 10.0;
+
+    json_begin_array(&w);
+    json_value(&w, inf);
+    json_value(&w, -inf);
+    json_value(&w, inf - inf);
+    json_value(&w, (float)-inf);
+    json_value(&w, -0.0);
+    json_value(&w, -0.5f);
+    json_end_array(&w);
+    free(&w);
+
+    assert_equal(out, "[null,null,null,null,0,-0.5]\n"_cs);
+    free(&out);
+}
+
+define_test(json_writer_writes_top_level_values_on_separate_lines)
+{
+    string out{};
+    json_writer w{};
+    init(&w, &out);
+
+    json_value(&w, 1);
+    json_begin_object(&w);
+    json_key(&w, "a");
+    json_value(&w, false);
+    json_end_object(&w);
+    json_value(&w, "x");
+    free(&w);
+
+    assert_equal(out, "1\n{\"a\":false}\n\"x\"\n"_cs);
+    free(&out);
+}
+
+define_test(json_writer_escapes_strings)
+{
+    string out{};
+    json_writer w{};
+    init(&w, &out);
+
+    json_value(&w, "a\"b\\c\nd\te\x01" "f/g");
+    // long enough for the vector search, special characters at different offsets
+    json_value(&w, "0123456789abcdef0123456789\"abcdef\x1f" "0123456789abcdef");
+    json_value(&w, "h\xc3\xa9llo \xf0\x9f\x98\x80");
+    json_value(&w, 1.0 / 0.0);
+    free(&w);
+
+    assert_equal(out, R"("a\"b\\c\nd\te\u0001f/g")" "\n"
+                      R"("0123456789abcdef0123456789\"abcdef\u001f0123456789abcdef")" "\n"
+                      "\"h\xc3\xa9llo \xf0\x9f\x98\x80\"\n"
+                      "null\n"_cs);
+    free(&out);
+}
+
+define_test(json_writer_writes_to_memory_stream)
+{
+    memory_stream mem{};
+    init(&mem, 8);
+    json_writer w{};
+    init(&w, &mem);
+
+    json_value(&w, "abc");
+    assert_equal(json_flush(&w), true);
+    assert_equal((const_string{mem.data, tell(&mem)}), "\"abc\"\n"_cs);
+
+    // does not fit
+    error err{};
+    json_value(&w, "abc");
+    assert_equal(json_flush(&w, &err), false);
+    assert_equal(err.error_code, 5);
+
+    free(&w);
+    free(&mem);
+}
+
+static void _assert_token(json_reader *r, json_token token, const_string text)
+{
+    assert_equal(json_next(r), true);
+    assert_equal(r->token, token);
+    assert_equal(r->text, text);
+}
+
+define_test(json_reader_reads_tokens)
+{
+    json_reader r{};
+    const_string data = R"( {"a": [1, -2.5e+3, "x", true, false, null, {}, []], "b" : {"c": 0}} )"_cs;
+    init(&r, data);
+
+    _assert_token(&r, json_token::object_begin, "{"_cs);
+    _assert_token(&r, json_token::key, "a"_cs);
+    _assert_token(&r, json_token::array_begin, "["_cs);
+    _assert_token(&r, json_token::number, "1"_cs);
+    _assert_token(&r, json_token::number, "-2.5e+3"_cs);
+    _assert_token(&r, json_token::string, "x"_cs);
+    _assert_token(&r, json_token::boolean, "true"_cs);
+    assert_equal(r.boolean, true);
+    _assert_token(&r, json_token::boolean, "false"_cs);
+    assert_equal(r.boolean, false);
+    _assert_token(&r, json_token::null, "null"_cs);
+    _assert_token(&r, json_token::object_begin, "{"_cs);
+    _assert_token(&r, json_token::object_end, "}"_cs);
+    _assert_token(&r, json_token::array_begin, "["_cs);
+    _assert_token(&r, json_token::array_end, "]"_cs);
+    _assert_token(&r, json_token::array_end, "]"_cs);
+    _assert_token(&r, json_token::key, "b"_cs);
+    _assert_token(&r, json_token::object_begin, "{"_cs);
+    _assert_token(&r, json_token::key, "c"_cs);
+    _assert_token(&r, json_token::number, "0"_cs);
+    _assert_token(&r, json_token::object_end, "}"_cs);
+    _assert_token(&r, json_token::object_end, "}"_cs);
+
+    assert_equal(json_next(&r), false);
+    assert_equal(r.token, json_token::end);
+
+    // text points into the data
+    init(&r, data);
+    json_next(&r);
+    json_next(&r);
+    assert_equal(r.text.c_str, data.c_str + 3);
+}
+
+define_test(json_reader_reads_newline_delimited_values)
+{
+    json_reader r{};
+    init(&r, "{\"id\":1}\n{\"id\":2}\n3\n"_cs);
+
+    s64 values = 0;
+
+    while (json_next(&r))
+        if (r.depth == 0)
+            values++;
+
+    assert_equal(r.token, json_token::end);
+    assert_equal(values, 3);
+}
+
+define_test(json_reader_reports_errors)
+{
+    const_string invalid[] = {
+        "{"_cs, "[1,]"_cs, "{\"a\" 1}"_cs, "{1:2}"_cs, "[1 2]"_cs, "[1}"_cs,
+        "01"_cs, "1."_cs, "-"_cs, "1e"_cs, "tru"_cs, "nul"_cs, "\"abc"_cs,
+        "\"a\nb\""_cs, "\"\\x\""_cs, "\"\\u12g4\""_cs, "]"_cs, "truex"_cs, "1x"_cs
+    };
+
+    for (const_string s : invalid)
+    {
+        json_reader r{};
+        init(&r, s);
+
+        while (json_next(&r))
+            ;
+
+        if (r.token != json_token::error)
+            tprint("  % was accepted\n", s);
+
+        assert_equal(r.token, json_token::error);
+        assert_not_equal(r.error_message, (const c8*)nullptr);
+    }
+
+    json_reader r{};
+    init(&r, "[1, x]"_cs);
+    json_next(&r);
+    json_next(&r);
+    assert_equal(json_next(&r), false);
+    assert_equal(r.error_position, 4);
+    // stays in the error state
+    assert_equal(json_next(&r), false);
+}
+
+define_test(json_skip_skips_containers)
+{
+    json_reader r{};
+    init(&r, R"({"skip": {"a": [1, {"b": []}]}, "keep": 2})"_cs);
+
+    _assert_token(&r, json_token::object_begin, "{"_cs);
+    _assert_token(&r, json_token::key, "skip"_cs);
+    _assert_token(&r, json_token::object_begin, "{"_cs);
+    assert_equal(json_skip(&r), true);
+    assert_equal(r.token, json_token::object_end);
+    _assert_token(&r, json_token::key, "keep"_cs);
+    _assert_token(&r, json_token::number, "2"_cs);
+}
+
+define_test(json_unescape_decodes_escape_sequences)
+{
+    json_reader r{};
+    init(&r, R"("a\"b\\c\/d\n\t\u00e9\ud83d\ude00")"_cs);
+
+    assert_equal(json_next(&r), true);
+    assert_equal(r.escaped, true);
+
+    string s{};
+    assert_equal(json_unescape(r.text, &s), true);
+    assert_equal(s, "a\"b\\c/d\n\t\xc3\xa9\xf0\x9f\x98\x80"_cs);
+
+    // lone surrogate
+    assert_equal(json_unescape(R"(\udc00)"_cs, &s), false);
+
+    free(&s);
+}
+
+define_test(json_writer_output_is_read_back)
+{
+    string out{};
+    json_writer w{};
+    init(&w, &out);
+
+    const c8 *text = "line\n\"quoted\" \x02";
+    json_begin_array(&w);
+    json_value(&w, text);
+    json_value(&w, 0.1);
+    json_value(&w, -123456789);
+    json_end_array(&w);
+    free(&w);
+
+    json_reader r{};
+    init(&r, to_const_string(&out));
+    string s{};
+
+    _assert_token(&r, json_token::array_begin, "["_cs);
+    assert_equal(json_next(&r), true);
+    assert_equal(json_unescape(r.text, &s), true);
+    assert_equal(s, to_const_string(text));
+    assert_equal(json_next(&r), true);
+    assert_equal(string_to_double(r.text), 0.1);
+    assert_equal(json_next(&r), true);
+    assert_equal(string_to_s64(r.text), (s64)-123456789);
+    _assert_token(&r, json_token::array_end, "]"_cs);
+
+    free(&s);
+    free(&out);
+}
+
+define_test(json_newline_delimited_file_throughput)
+{
+    // not a correctness test, prints the throughput of writing and reading
+    // a newline-delimited JSON file of JSON_BENCHMARK_SIZE bytes, e.g.
+    // JSON_BENCHMARK_SIZE=1073741824 for 1 GiB. Skipped if it is not set.
+    const char *env = getenv("JSON_BENCHMARK_SIZE");
+
+    if (env == nullptr)
+        return;
+
+    s64 target_size = string_to_s64(to_const_string(env));
+
+    sys_string path = get_filepath(SYS_CHAR("json_benchmark.ndjson"));
+    file_stream fs{};
+    assert_equal(init(&fs, path.data, open_mode::Write | open_mode::WriteTrunc), true);
+
+    timespan start;
+    timespan end;
+    get_time(&start);
+
+    json_writer w{};
+    init(&w, &fs);
+    s64 records = 0;
+    s64 written = 0;
+
+    while (written < target_size)
+    {
+        json_begin_object(&w);
+        json_key(&w, "id");
+        json_value(&w, records);
+        json_key(&w, "name");
+        json_value(&w, "user name with \"quotes\"");
+        json_key(&w, "score");
+        json_value(&w, records * 0.25);
+        json_key(&w, "active");
+        json_value(&w, (records & 1) == 0);
+        json_key(&w, "tags");
+        json_begin_array(&w);
+        json_value(&w, "alpha");
+        json_value(&w, "beta");
+        json_value(&w, records % 1000);
+        json_end_array(&w);
+        json_end_object(&w);
+
+        records++;
+
+        if ((records & 1023) == 0)
+            written = tell(&fs) + w.size;
+    }
+
+    assert_equal(json_flush(&w), true);
+    free(&w);
+    get_time(&end);
+    double write_secs = get_seconds_difference(&start, &end);
+    s64 file_size = tell(&fs);
+    free(&fs);
+
+    assert_equal(init(&fs, path.data, open_mode::Read), true);
+
+    // reads blocks and parses the complete lines of each block
+    const s64 block_size = 16 << 20;
+    c8 *block = (c8*)::malloc(block_size);
+    s64 carry = 0;
+    s64 values = 0;
+    s64 tokens = 0;
+    bool ok = true;
+
+    get_time(&start);
+
+    while (true)
+    {
+        s64 n = read(&fs, block + carry, block_size - carry);
+        s64 size = carry + (n > 0 ? n : 0);
+
+        if (size == 0)
+            break;
+
+        s64 last_line_end = n > 0 ? string_last_index_of(const_string{block, size}, '\n') + 1 : size;
+
+        json_reader r{};
+        init(&r, const_string{block, last_line_end});
+
+        while (json_next(&r))
+        {
+            tokens++;
+
+            if (r.depth == 0)
+                values++;
+        }
+
+        ok = ok && r.token == json_token::end;
+        carry = size - last_line_end;
+        copy_memory(block + last_line_end, block, carry);
+
+        if (n <= 0)
+            break;
+    }
+
+    get_time(&end);
+    double read_secs = get_seconds_difference(&start, &end);
+
+    ::free(block);
+    free(&fs);
+    ::remove(path.data);
+    free(&path);
+
+    assert_equal(ok, true);
+    assert_equal(values, records);
+
+    tprint("  % MiB, % records: write % MiB/s, read % MiB/s (% tokens)\n",
+           file_size >> 20, records, file_size / write_secs / (1 << 20), file_size / read_secs / (1 << 20), tokens);
+}
+
+define_default_test_main();
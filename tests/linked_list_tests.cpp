@@ -2,6 +2,7 @@
 #include <t1/t1.hpp>
 
 #include "shl/linked_list.hpp"
+#include "shl/allocator_pool.hpp"
 
 template<typename T>
 void assert_list_integrity(const linked_list<T> *list)
@@ -1507,4 +1508,35 @@ define_test(add_at_start_adds_element_at_start)
     free(&lst);
 }
 
+define_test(linked_list_allocates_nodes_from_pool)
+{
+    pool p;
+    init(&p, sizeof(list_node<int>), 64);
+
+    linked_list<int> list{};
+
+    with_allocator(pool_allocator(&p))
+        init(&list);
+
+    for (int i = 0; i < 100; ++i)
+        add_at_end(&list, i);
+
+    assert_list_integrity(&list);
+
+    // consecutive nodes are next to each other in the pool
+    assert_equal((char*)list.first->next, (char*)list.first + p.element_size);
+
+    for_list(i, v, &list)
+        assert_equal(*v, (int)i);
+
+    remove_elements(&list, 10, 20);
+    add_at_end(&list, 100);
+
+    assert_equal(list.size, 81);
+    assert_list_integrity(&list);
+
+    free(&list);
+    free(&p);
+}
+
 define_default_test_main();
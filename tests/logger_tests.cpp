@@ -0,0 +1,327 @@
+
+#include <t1/t1.hpp>
+#include <pthread.h>
+
+#include "shl/logger.hpp"
+#include "shl/pipe.hpp"
+#include "shl/string.hpp"
+
+static const_string _read_pipe(pipe_t *p, c8 *buf, s64 size)
+{
+    s64 available = io_size(p->read);
+
+    if (available <= 0)
+        return const_string{buf, 0};
+
+    if (available > size)
+        available = size;
+
+    return const_string{buf, io_read(p->read, buf, available)};
+}
+
+// removes the timestamps at the start of every line
+static const_string _strip_times(const_string s, c8 *out)
+{
+    s64 size = 0;
+    s64 i = 0;
+
+    while (i < s.size)
+    {
+        while (i < s.size && s[i] != ' ')
+            ++i;
+
+        ++i;
+
+        while (i < s.size && s[i] != '\n')
+            out[size++] = s[i++];
+
+        if (i < s.size)
+            out[size++] = s[i++];
+    }
+
+    return const_string{out, size};
+}
+
+static const_string _read_log(pipe_t *p, c8 *buf, c8 *out, s64 size)
+{
+    return _strip_times(_read_pipe(p, buf, size), out);
+}
+
+define_test(log_message_writes_messages_at_or_above_level)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    logger lg{};
+    assert_equal(init(&lg, p.write, log_level::info), true);
+    c8 buf[256];
+    c8 out[256];
+
+    log_message(&lg, log_level::debug, "not logged"_fmt);
+    log_message(&lg, log_level::info, "hello %"_fmt, "world");
+    log_message(&lg, log_level::error, "% + % = %"_fmt, 1, 2.5f, 3.5);
+    log_flush(&lg);
+
+    assert_equal(_read_log(&p, buf, out, 256), "INFO  hello world\nERROR 1 + 2.5 = 3.5\n"_cs);
+
+    set_log_level(&lg, log_level::trace);
+    log_message(&lg, log_level::trace, "%"_fmt, 'c');
+    set_log_level(&lg, log_level::off);
+    log_message(&lg, log_level::fatal, "not logged"_fmt);
+    log_flush(&lg);
+
+    assert_equal(_read_log(&p, buf, out, 256), "TRACE c\n"_cs);
+
+    free(&lg);
+    free(&p);
+}
+
+define_test(log_message_line_starts_with_time)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    logger lg{};
+    init(&lg, p.write);
+    c8 buf[256];
+
+    timespan t{};
+    get_time(&t);
+    log_message(&lg, log_level::warning, "x"_fmt);
+    free(&lg);
+
+    const_string line = _read_pipe(&p, buf, 256);
+    s64 dot = string_index_of(line, '.');
+
+    assert_greater(dot, 0);
+    assert_equal(string_to_u64(const_string{line.c_str, dot}) - (u64)t.seconds <= 1, true);
+    // microseconds are padded to 6 digits
+    assert_equal(line[dot + 7], ' ');
+    assert_equal((const_string{line.c_str + dot + 8, line.size - dot - 8}), "WARN  x\n"_cs);
+
+    free(&p);
+}
+
+define_test(log_message_copies_strings)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    logger lg{};
+    init(&lg, p.write, log_level::trace);
+    c8 buf[256];
+    c8 out[256];
+
+    c8 text[] = "abc";
+    string s = "hello"_s;
+    const c8 *null_string = nullptr;
+
+    log_message(&lg, log_level::info, "% % % % % %"_fmt, text, &s, to_const_string(&s), s, u"wide"_cs, null_string);
+
+    // changing the strings after logging does not change the message
+    text[0] = 'x';
+    s[0] = 'j';
+    free(&s);
+    log_flush(&lg);
+
+    assert_equal(_read_log(&p, buf, out, 256), "INFO  abc hello hello hello wide \n"_cs);
+
+    free(&lg);
+    free(&p);
+}
+
+struct _log_thread_args
+{
+    logger *lg;
+    s64 thread;
+};
+
+#define log_thread_count 4
+#define log_thread_messages 200
+
+static void *_log_thread(void *_arg)
+{
+    _log_thread_args *arg = (_log_thread_args*)_arg;
+
+    for (s64 i = 0; i < log_thread_messages; ++i)
+        log_message(arg->lg, log_level::info, "% %"_fmt, arg->thread, i);
+
+    return nullptr;
+}
+
+// checks that every thread logged all of its messages in order
+static void _assert_thread_log(pipe_t *p)
+{
+    static c8 buf[65536];
+    static c8 out[65536];
+    const_string log = _read_log(p, buf, out, 65536);
+
+    s64 next[log_thread_count]{};
+    s64 lines = 0;
+    s64 i = 0;
+
+    while (i < log.size)
+    {
+        s64 end = string_index_of(log, '\n', i);
+        assert_greater(end, i);
+
+        const_string line{log.c_str + i, end - i};
+        assert_equal(string_index_of(line, "INFO  "_cs), 0);
+
+        const_string next_num{};
+        s64 thread = string_to_s64(const_string{line.c_str + 6, line.size - 6}, &next_num);
+        s64 message = string_to_s64(const_string{next_num.c_str + 1, next_num.size - 1});
+
+        assert_equal(message, next[thread]);
+        next[thread]++;
+        lines++;
+        i = end + 1;
+    }
+
+    assert_equal(lines, log_thread_count * log_thread_messages);
+}
+
+define_test(log_message_from_multiple_threads_keeps_order_per_thread)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    logger lg{};
+    init(&lg, p.write);
+
+    pthread_t threads[log_thread_count];
+    _log_thread_args args[log_thread_count];
+
+    for (s64 i = 0; i < log_thread_count; ++i)
+    {
+        args[i] = _log_thread_args{&lg, i};
+        assert_equal(pthread_create(threads + i, nullptr, _log_thread, args + i), 0);
+    }
+
+    for (s64 i = 0; i < log_thread_count; ++i)
+        pthread_join(threads[i], nullptr);
+
+    // the rings of the exited threads are drained before they are freed
+    log_flush(&lg);
+    _assert_thread_log(&p);
+
+    free(&lg);
+    free(&p);
+}
+
+define_test(log_message_from_shl_threads_uses_ring_per_thread)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    logger lg{};
+    init(&lg, p.write);
+
+    // shl threads share the thread_local storage of this thread
+    log_message(&lg, log_level::info, "% %"_fmt, log_thread_count, 0);
+    log_flush(&lg);
+    c8 buf[256];
+    c8 out[256];
+    assert_equal(_read_log(&p, buf, out, 256), "INFO  4 0\n"_cs);
+
+    program_context *ctx = get_context_pointer();
+    thread threads[log_thread_count]{};
+    _log_thread_args args[log_thread_count];
+
+    for (s64 i = 0; i < log_thread_count; ++i)
+    {
+        args[i] = _log_thread_args{&lg, i};
+        assert_equal(thread_create(threads + i, _log_thread, args + i), true);
+        assert_equal(thread_start(threads + i), true);
+
+        // starting threads set the context pointer of this thread
+        while (!thread_is_running(threads + i) && !thread_is_stopped(threads + i))
+            ;
+
+        set_context_pointer(ctx);
+    }
+
+    for (s64 i = 0; i < log_thread_count; ++i)
+        assert_equal(thread_stop(threads + i), true);
+
+    // thread_stop returns slightly before the threads stop using their stack
+    sleep_ms(20);
+
+    for (s64 i = 0; i < log_thread_count; ++i)
+        assert_equal(thread_destroy(threads + i), true);
+
+    // the rings of the stopped threads were closed and are drained before
+    // they are freed
+    log_flush(&lg);
+    _assert_thread_log(&p);
+
+    free(&lg);
+    free(&p);
+}
+
+define_test(log_message_counts_dropped_messages)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    logger lg{};
+    init(&lg, p.write, log_level::info, 256);
+    // the background thread only wakes on flush
+    lg.flush_interval.seconds = 60;
+    log_flush(&lg);
+    c8 buf[1024];
+    c8 out[1024];
+
+    // records are 32 bytes of header plus 8 bytes per argument
+    for (s64 i = 0; i < 10; ++i)
+        log_message(&lg, log_level::info, "%"_fmt, i);
+
+    log_flush(&lg);
+
+    assert_equal(_read_log(&p, buf, out, 1024), "INFO  0\nINFO  1\nINFO  2\nINFO  3\nINFO  4\nINFO  5\nWARN  logger dropped 4 messages\n"_cs);
+
+    free(&lg);
+    free(&p);
+}
+
+define_test(log_functions_use_logger_of_program_context)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    // nothing happens without a logger
+    assert_equal(get_context_pointer()->logger, (logger*)nullptr);
+    log_error("not logged"_fmt);
+
+    logger lg{};
+    init(&lg, p.write, log_level::debug);
+    c8 buf[256];
+    c8 out[256];
+
+    get_context_pointer()->logger = &lg;
+
+    log_trace("%"_fmt, 0);
+    log_debug("%"_fmt, 1);
+    log_info("%"_fmt, 2);
+    log_warning("%"_fmt, 3);
+    log_error("%"_fmt, 4);
+    log_fatal("%"_fmt, 5);
+    log_message(log_level::info, "%"_fmt, 6);
+    log_flush(&lg);
+
+    assert_equal(_read_log(&p, buf, out, 256), "DEBUG 1\nINFO  2\nWARN  3\nERROR 4\nFATAL 5\nINFO  6\n"_cs);
+
+    get_context_pointer()->logger = nullptr;
+    free(&lg);
+    free(&p);
+}
+
+define_test(log_level_name_returns_name)
+{
+    assert_equal(log_level_name(log_level::trace), "TRACE"_cs);
+    assert_equal(log_level_name(log_level::info), "INFO"_cs);
+    assert_equal(log_level_name(log_level::warning), "WARNING"_cs);
+    assert_equal(log_level_name(log_level::off), "OFF"_cs);
+}
+
+define_default_test_main();
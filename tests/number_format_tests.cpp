@@ -0,0 +1,436 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include <t1/t1.hpp>
+
+#include "shl/number_format.hpp"
+#include "shl/bits.hpp"
+#include "shl/random.hpp"
+#include "shl/time.hpp"
+#include "shl/print.hpp"
+#include "shl/format.hpp"
+
+#define assert_equal_str(Str1, Str2) assert_equal(to_const_string(Str1), to_const_string(Str2))
+
+static c8 _buf[FLOAT_DECIMAL_BUFFER_SIZE + 1];
+
+static const_string _shortest(double x) { return const_string{_buf, write_float_shortest(_buf, x)}; }
+static const_string _shortest(float x)  { return const_string{_buf, write_float_shortest(_buf, x)}; }
+static const_string _fixed(double x, s32 p, bool trim = false)      { return const_string{_buf, write_float_fixed(_buf, x, p, trim)}; }
+static const_string _scientific(double x, s32 p, bool trim = false) { return const_string{_buf, write_float_scientific(_buf, x, p, trim)}; }
+
+static double _random_double(pcg64 *gen)
+{
+    double x = 0;
+
+    do
+    {
+        u64 bits = next_random_int(gen);
+        memcpy(&x, &bits, sizeof(x));
+    } while (x != x || x - x != 0); // nan or inf
+
+    return x;
+}
+
+static float _random_float(pcg64 *gen)
+{
+    float x = 0;
+
+    do
+    {
+        u32 bits = (u32)next_random_int(gen);
+        memcpy(&x, &bits, sizeof(x));
+    } while (x != x || x - x != 0);
+
+    return x;
+}
+
+define_test(integer_digit_count_counts_digits)
+{
+    assert_equal(integer_digit_count(0, 10), 1);
+    assert_equal(integer_digit_count(9, 10), 1);
+    assert_equal(integer_digit_count(10, 10), 2);
+    assert_equal(integer_digit_count(99999, 10), 5);
+    assert_equal(integer_digit_count(100000, 10), 6);
+    assert_equal(integer_digit_count(9999999999999999999ull, 10), 19);
+    assert_equal(integer_digit_count(10000000000000000000ull, 10), 20);
+    assert_equal(integer_digit_count(max_value(u64), 10), 20);
+
+    assert_equal(integer_digit_count(0, 16), 1);
+    assert_equal(integer_digit_count(0xf, 16), 1);
+    assert_equal(integer_digit_count(0x10, 16), 2);
+    assert_equal(integer_digit_count(max_value(u64), 16), 16);
+    assert_equal(integer_digit_count(7, 8), 1);
+    assert_equal(integer_digit_count(8, 8), 2);
+    assert_equal(integer_digit_count(max_value(u64), 8), 22);
+    assert_equal(integer_digit_count(0, 2), 1);
+    assert_equal(integer_digit_count(max_value(u64), 2), 64);
+    assert_equal(integer_digit_count(5, 3), -1);
+
+    for (u64 p = 1, n = 1; n <= 19; p *= 10, ++n)
+    {
+        assert_equal(integer_digit_count(p, 10), (s32)n);
+        assert_equal(integer_digit_count(p - 1, 10), p == 1 ? 1 : (s32)n - 1);
+    }
+}
+
+define_test(write_integer_matches_printf)
+{
+    pcg64 gen{};
+    init(&gen, 45, 1);
+    c8 buf[INTEGER_DIGITS_BUFFER_SIZE];
+    char expected[80];
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        // all digit counts
+        u64 x = next_random_int(&gen) >> next_bounded_int(&gen, 0, 63);
+        int n = 0;
+
+        n = snprintf(expected, 80, "%llu", (unsigned long long)x);
+        assert_equal(const_string(buf, write_integer_decimal(buf, x)), const_string(expected, n));
+
+        n = snprintf(expected, 80, "%llx", (unsigned long long)x);
+        assert_equal(const_string(buf, write_integer_hex(buf, x)), const_string(expected, n));
+
+        n = snprintf(expected, 80, "%llX", (unsigned long long)x);
+        assert_equal(const_string(buf, write_integer_hex(buf, x, true)), const_string(expected, n));
+
+        n = snprintf(expected, 80, "%llo", (unsigned long long)x);
+        assert_equal(const_string(buf, write_integer_octal(buf, x)), const_string(expected, n));
+
+        n = 0;
+
+        for (int bit = 63 - (int)clz64(x | 1); bit >= 0; --bit)
+            expected[n++] = (char)('0' + ((x >> bit) & 1));
+
+        assert_equal(const_string(buf, write_integer_binary(buf, x)), const_string(expected, n));
+    }
+}
+
+define_test(float_to_shortest_decimal_finds_shortest_digits)
+{
+    u64 digits = 0;
+    s32 exponent = 0;
+
+    float_to_shortest_decimal(0.0, &digits, &exponent);
+    assert_equal(digits, 0);
+    assert_equal(exponent, 0);
+
+    float_to_shortest_decimal(1.0, &digits, &exponent);
+    assert_equal(digits, 1);
+    assert_equal(exponent, 0);
+
+    float_to_shortest_decimal(0.3, &digits, &exponent);
+    assert_equal(digits, 3);
+    assert_equal(exponent, -1);
+
+    float_to_shortest_decimal(1500.0, &digits, &exponent);
+    assert_equal(digits, 15);
+    assert_equal(exponent, 2);
+
+    float_to_shortest_decimal(-123.456, &digits, &exponent);
+    assert_equal(digits, 123456);
+    assert_equal(exponent, -3);
+
+    float_to_shortest_decimal(5e-324, &digits, &exponent);
+    assert_equal(digits, 5);
+    assert_equal(exponent, -324);
+
+    float_to_shortest_decimal(1.7976931348623157e308, &digits, &exponent);
+    assert_equal(digits, 17976931348623157);
+    assert_equal(exponent, 292);
+
+    float_to_shortest_decimal(0.1f, &digits, &exponent);
+    assert_equal(digits, 1);
+    assert_equal(exponent, -1);
+
+    float_to_shortest_decimal(16777216.0f, &digits, &exponent);
+    assert_equal(digits, 16777216);
+    assert_equal(exponent, 0);
+}
+
+define_test(write_float_shortest_writes_shortest_text)
+{
+    assert_equal_str(_shortest(0.0), "0");
+    assert_equal_str(_shortest(-0.0), "0");
+    assert_equal_str(_shortest(1.0), "1");
+    assert_equal_str(_shortest(0.1), "0.1");
+    assert_equal_str(_shortest(0.1 + 0.2), "0.30000000000000004");
+    assert_equal_str(_shortest(-123.456), "123.456");
+    assert_equal_str(_shortest(1e21), "1e+21");
+    assert_equal_str(_shortest(1e20), "100000000000000000000");
+    assert_equal_str(_shortest(123e18), "123000000000000000000");
+    assert_equal_str(_shortest(0.000001), "0.000001");
+    assert_equal_str(_shortest(1.5e-7), "1.5e-7");
+    assert_equal_str(_shortest(5e-324), "5e-324");
+    assert_equal_str(_shortest(1.7976931348623157e308), "1.7976931348623157e+308");
+    assert_equal_str(_shortest(0.1f), "0.1");
+    assert_equal_str(_shortest(3.4028235e38f), "3.4028235e+38");
+    assert_equal_str(_shortest(1e-45f), "1e-45");
+    assert_equal_str(_shortest(__builtin_inf()), "inf");
+    assert_equal_str(_shortest(__builtin_nan("")), "nan");
+}
+
+define_test(write_float_fixed_rounds_exactly)
+{
+    assert_equal_str(_fixed(0.0, 6), "0.000000");
+    assert_equal_str(_fixed(0.0, 6, true), "0");
+    assert_equal_str(_fixed(1.5, 0), "2");
+    assert_equal_str(_fixed(2.5, 0), "2");
+    assert_equal_str(_fixed(0.5, 0), "0");
+    assert_equal_str(_fixed(0.125, 2), "0.12");
+    assert_equal_str(_fixed(0.375, 2), "0.38");
+    assert_equal_str(_fixed(0.1, 19), "0.1000000000000000056");
+    assert_equal_str(_fixed(9.9999999, 6), "10.000000");
+    assert_equal_str(_fixed(123.456, 3), "123.456");
+    assert_equal_str(_fixed(123.456, 6, true), "123.456");
+    assert_equal_str(_fixed(1e-10, 6), "0.000000");
+    assert_equal_str(_fixed(18446744073709549568.0, 1), "18446744073709549568.0");
+    assert_equal_str(_fixed(1e22, 2), "10000000000000000000000.00");
+    assert_equal_str(_fixed(1e22, 2, true), "10000000000000000000000");
+
+    // same as printf
+    pcg64 gen{};
+    init(&gen, 44, 1);
+    c8 expected[512];
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        double x = ldexp((double)next_random_int(&gen), -(int)next_bounded_int(&gen, 0, 70));
+        s32 precision = (s32)next_bounded_int(&gen, 0, 19);
+
+        int n = snprintf(expected, 512, "%.*f", precision, x);
+
+        assert_equal(_fixed(x, precision), const_string(expected, n));
+    }
+}
+
+define_test(write_float_scientific_writes_exponent)
+{
+    assert_equal_str(_scientific(0.0, 6), "0.000000e+00");
+    assert_equal_str(_scientific(0.0, 6, true), "0e+00");
+    assert_equal_str(_scientific(123.456, 6), "1.234560e+02");
+    assert_equal_str(_scientific(123.456, 6, true), "1.23456e+02");
+    assert_equal_str(_scientific(123.456, 2), "1.23e+02");
+    assert_equal_str(_scientific(123.456, 0), "1e+02");
+    assert_equal_str(_scientific(9.99, 1), "1.0e+01");
+    assert_equal_str(_scientific(1.25, 1), "1.2e+00");
+    assert_equal_str(_scientific(1.35, 1), "1.4e+00");
+    assert_equal_str(_scientific(0.001, 3), "1.000e-03");
+    // the exact value, 4.94065...e-324
+    assert_equal_str(_scientific(5e-324, 2), "4.94e-324");
+    assert_equal_str(_scientific(0.1, 19), "1.0000000000000000555e-01");
+    assert_equal_str(_scientific(1e100, 1), "1.0e+100");
+    assert_equal_str(_scientific(1e23, 2), "1.00e+23");
+    assert_equal_str(_scientific(1.7976931348623157e308, 19), "1.7976931348623157081e+308");
+    assert_equal_str(_scientific(2.5f, 3), "2.500e+00");
+
+    // same as printf
+    pcg64 gen{};
+    init(&gen, 45, 1);
+    c8 expected[512];
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        double x = _random_double(&gen);
+
+        if (x < 0)
+            x = -x;
+
+        s32 precision = (s32)next_bounded_int(&gen, 0, FLOAT_DECIMAL_MAX_PRECISION);
+
+        int n = snprintf(expected, 512, "%.*e", precision, x);
+
+        assert_equal(_scientific(x, precision), const_string(expected, n));
+    }
+}
+
+define_test(write_float_shortest_round_trips)
+{
+    pcg64 gen{};
+    init(&gen, 4044, 3);
+    char expected[64];
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        double x = _random_double(&gen);
+        const_string s = _shortest(x);
+        _buf[s.size] = '\0';
+
+        double parsed = strtod(_buf, nullptr);
+        assert_equal(parsed, x < 0 ? -x : x);
+
+        // the shortest digit count for which printf round-trips
+        u64 digits = 0;
+        s32 exponent = 0;
+        float_to_shortest_decimal(x, &digits, &exponent);
+
+        int p = 1;
+
+        for (; p < 17; ++p)
+        {
+            snprintf(expected, 64, "%.*e", p - 1, x);
+
+            if (strtod(expected, nullptr) == x)
+                break;
+        }
+
+        char actual[64];
+        snprintf(actual, 64, "%llu", (unsigned long long)digits);
+        assert_equal((int)strlen(actual), p);
+    }
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        float x = _random_float(&gen);
+        const_string s = _shortest(x);
+        _buf[s.size] = '\0';
+
+        float parsed = strtof(_buf, nullptr);
+        assert_equal(parsed, x < 0 ? -x : x);
+
+        u64 digits = 0;
+        s32 exponent = 0;
+        float_to_shortest_decimal(x, &digits, &exponent);
+
+        int p = 1;
+
+        for (; p < 9; ++p)
+        {
+            snprintf(expected, 64, "%.*e", p - 1, (double)x);
+
+            if (strtof(expected, nullptr) == x)
+                break;
+        }
+
+        char actual[64];
+        snprintf(actual, 64, "%llu", (unsigned long long)digits);
+        assert_equal((int)strlen(actual), p);
+    }
+}
+
+define_test(to_string_uses_float_format_mode)
+{
+    float_format_options fopt = default_float_options;
+    format_options<c8> opt = default_format_options<c8>;
+    c8 buf[64];
+
+    assert_equal_str(tformat("%", 0.1 + 0.2), "0.3");
+
+    fopt.mode = float_format_mode::shortest;
+    assert_equal_str(const_string(buf, to_string(buf, 64, 0.1 + 0.2, 0, opt, fopt)), "0.30000000000000004");
+    assert_equal_str(const_string(buf, to_string(buf, 64, -1e300, 0, opt, fopt)), "-1e+300");
+    assert_equal_str(const_string(buf, to_string(buf, 64, -0.0, 0, opt, fopt)), "-0");
+
+    fopt.mode = float_format_mode::scientific;
+    fopt.ignore_trailing_zeroes = false;
+    opt.precision = 3;
+    opt.pad_length = 12;
+    assert_equal_str(const_string(buf, to_string(buf, 64, -1234.5, 0, opt, fopt)), "  -1.234e+03");
+
+    string str{};
+    init(&str);
+    opt.sign = '+';
+    to_string(&str, 1234.5f, 0, opt, fopt);
+    assert_equal_str(str, "  +1.234e+03");
+    free(&str);
+}
+
+define_test(float_formatting_throughput)
+{
+    // not a correctness test, prints the throughput of formatting doubles
+    const int count = 1000000;
+    double *values = (double*)::malloc(count * sizeof(double));
+    pcg64 gen{};
+    init(&gen, 123, 1);
+
+    for (int i = 0; i < count; ++i)
+        values[i] = next_bounded_decimal(&gen, -1e6, 1e6);
+
+    c8 buf[64];
+    s64 total = 0;
+    timespan start;
+    timespan end;
+
+    get_time(&start);
+
+    for (int i = 0; i < count; ++i)
+        total += write_float_shortest(buf, values[i]);
+
+    get_time(&end);
+    double shortest_secs = get_seconds_difference(&start, &end);
+
+    get_time(&start);
+
+    for (int i = 0; i < count; ++i)
+        total += to_string(buf, 64, values[i]);
+
+    get_time(&end);
+    double to_string_secs = get_seconds_difference(&start, &end);
+
+    get_time(&start);
+
+    for (int i = 0; i < count; ++i)
+        total += snprintf(buf, 64, "%.17g", values[i]);
+
+    get_time(&end);
+    double snprintf_secs = get_seconds_difference(&start, &end);
+
+    tprint("  shortest: % M/s, to_string: % M/s, snprintf .17g: % M/s (% chars)\n",
+           count / shortest_secs / 1e6, count / to_string_secs / 1e6, count / snprintf_secs / 1e6, total);
+
+    ::free(values);
+}
+
+define_test(integer_formatting_throughput)
+{
+    // not a correctness test, prints the throughput of formatting integers
+    const int count = 1000000;
+    u64 *values = (u64*)::malloc(count * sizeof(u64));
+    pcg64 gen{};
+    init(&gen, 123, 1);
+
+    for (int i = 0; i < count; ++i)
+        values[i] = next_random_int(&gen) >> next_bounded_int(&gen, 0, 63);
+
+    c8 *out = (c8*)::malloc(count * 21);
+    fill_memory(out, 0, count * 21);
+    timespan start;
+    timespan end;
+
+    get_time(&start);
+
+    s64 total = to_string(out, count * 21, values, count, ","_cs);
+
+    get_time(&end);
+    double batch_secs = get_seconds_difference(&start, &end);
+
+    c8 buf[32];
+    get_time(&start);
+
+    for (int i = 0; i < count; ++i)
+        total += to_string(buf, 32, values[i]);
+
+    get_time(&end);
+    double to_string_secs = get_seconds_difference(&start, &end);
+
+    get_time(&start);
+
+    for (int i = 0; i < count; ++i)
+        total += snprintf(buf, 32, "%llu", (unsigned long long)values[i]);
+
+    get_time(&end);
+    double snprintf_secs = get_seconds_difference(&start, &end);
+
+    tprint("  batch: % M/s, to_string: % M/s, snprintf: % M/s (% chars)\n",
+           count / batch_secs / 1e6, count / to_string_secs / 1e6, count / snprintf_secs / 1e6, total);
+
+    ::free(out);
+    ::free(values);
+}
+
+define_default_test_main();
@@ -0,0 +1,282 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <t1/t1.hpp>
+
+#include "shl/number_parse.hpp"
+#include "shl/string.hpp"
+#include "shl/random.hpp"
+
+static s64 _parse_digits(const c8 *s, u64 limit, u64 *out, bool *overflow)
+{
+    return parse_decimal_digits(s, (s64)strlen(s), limit, out, overflow);
+}
+
+define_test(parse_decimal_digits_parses_digits)
+{
+    u64 n = 0;
+    bool overflow = false;
+
+    assert_equal(_parse_digits("", max_value(u64), &n, &overflow), 0);
+    assert_equal(_parse_digits("abc", max_value(u64), &n, &overflow), 0);
+    assert_equal(_parse_digits("7", max_value(u64), &n, &overflow), 1);
+    assert_equal(n, 7u);
+
+    // every length around the 8 digit blocks
+    const c8 *digits = "12345678901234567890";
+    u64 expected = 0;
+
+    for (s64 len = 1; len <= 19; ++len)
+    {
+        expected = expected * 10 + (u64)(digits[len - 1] - '0');
+        assert_equal(parse_decimal_digits(digits, len, max_value(u64), &n, &overflow), len);
+        assert_equal(n, expected);
+        assert_equal(overflow, false);
+    }
+
+    assert_equal(_parse_digits("12345678x9", max_value(u64), &n, &overflow), 8);
+    assert_equal(n, 12345678u);
+    assert_equal(_parse_digits("1234567812345678 1", max_value(u64), &n, &overflow), 16);
+    assert_equal(n, 1234567812345678u);
+    assert_equal(_parse_digits("00000000000000000000042", max_value(u64), &n, &overflow), 23);
+    assert_equal(n, 42u);
+
+    // digits in other unit types
+    assert_equal(parse_decimal_digits(u"123456789", 9, max_value(u64), &n, &overflow), 9);
+    assert_equal(n, 123456789u);
+    assert_equal(parse_decimal_digits(U"987654321", 9, max_value(u64), &n, &overflow), 9);
+    assert_equal(n, 987654321u);
+    assert_equal(overflow, false);
+}
+
+define_test(parse_decimal_digits_detects_overflow)
+{
+    u64 n = 0;
+    bool overflow = false;
+
+    assert_equal(_parse_digits("18446744073709551615", max_value(u64), &n, &overflow), 20);
+    assert_equal(n, max_value(u64));
+    assert_equal(overflow, false);
+
+    assert_equal(_parse_digits("18446744073709551616", max_value(u64), &n, &overflow), 20);
+    assert_equal(overflow, true);
+
+    // consumes all digits even after an overflow
+    overflow = false;
+    assert_equal(_parse_digits("123456789012345678901234567890abc", max_value(u64), &n, &overflow), 30);
+    assert_equal(overflow, true);
+
+    overflow = false;
+    assert_equal(_parse_digits("255", 255, &n, &overflow), 3);
+    assert_equal(n, 255u);
+    assert_equal(overflow, false);
+    assert_equal(_parse_digits("256", 255, &n, &overflow), 3);
+    assert_equal(overflow, true);
+
+    overflow = false;
+    assert_equal(_parse_digits("99999999", 99999998, &n, &overflow), 8);
+    assert_equal(overflow, true);
+}
+
+define_test(string_to_u64_parses_full_range)
+{
+    error err{};
+    const_string next{};
+
+    assert_equal(string_to_u64("18446744073709551615", &next, 10, &err), max_value(u64));
+    assert_equal(err.error_code, 0);
+    assert_equal(next.size, 0);
+
+    assert_equal(string_to_u64("18446744073709551616", &next, 10, &err), max_value(u64));
+    assert_equal(err.error_code, 34);
+
+    err = error{};
+    assert_equal(string_to_u64("0xffffffffffffffff", nullptr, 0, &err), max_value(u64));
+    assert_equal(err.error_code, 0);
+
+    assert_equal(string_to_s64("-9223372036854775808", nullptr, 10, &err), min_value(s64));
+    assert_equal(string_to_s64("9223372036854775807", nullptr, 10, &err), max_value(s64));
+    assert_equal(err.error_code, 0);
+
+    assert_equal(string_to_s64("-9223372036854775809", nullptr, 10, &err), min_value(s64));
+    assert_equal(err.error_code, 34);
+
+    err = error{};
+    assert_equal(string_to_s8("-128", nullptr, 10, &err), min_value(s8));
+    assert_equal(string_to_u8("255", nullptr, 10, &err), max_value(u8));
+    assert_equal(err.error_code, 0);
+
+    assert_equal(string_to_s32("  12", &next, 10, &err), 0);
+    assert_equal(next.size, 4);
+}
+
+static void _assert_same_as_strtod(const c8 *s)
+{
+    double expected = strtod(s, nullptr);
+    double actual = string_to_double(s);
+
+    if (memcmp(&expected, &actual, sizeof(double)) != 0)
+        printf("mismatch for %s: %.17g != %.17g\n", s, actual, expected);
+
+    assert_equal(memcmp(&expected, &actual, sizeof(double)), 0);
+}
+
+define_test(string_to_double_rounds_correctly)
+{
+    const c8 *numbers[] = {
+        "0", "-0", "1", "-1", "0.1", "0.2", "0.3", "3.14159265358979323846",
+        "1e22", "1e23", "9007199254740993", "9007199254740992",
+        "7.2057594037927933e+16", "2.2250738585072013e-308",
+        "2.2250738585072011e-308", "4.9406564584124654e-324",
+        "2.4703282292062327e-324", "2.4703282292062328e-324",
+        "1.7976931348623157e308", "1.7976931348623158e308",
+        "1e-400", "123456789012345678901234567890", "0.000000000000000000000000123",
+        "179769313486231570814527423731704356798070567525844996598917476803157260780028538760589558632766878171540458953514382464234321326889464182768467546703537516986049910576551282076245490090389328944075868508455133942304583236903222948165808559332123348274797826204144723168738177180919299881250404026184124858368",
+        "2.22507385850720113605740979670913197593481954635164564e-308",
+        "0.500000000000000166533453693773481063544750213623046875",
+        "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124",
+        "1.00000000000000011102230246251565404236316680908203126",
+        "4.35e-5", "1e-5", "65613616e-46", "2e-323", "1448997445238699",
+        "+12.5e+2", "12.5E-2", ".5", "5.", "0000001.00000",
+    };
+
+    for (const c8 *s : numbers)
+        _assert_same_as_strtod(s);
+}
+
+define_test(string_to_double_matches_strtod_on_random_numbers)
+{
+    pcg64 gen{};
+    init(&gen, 1234, 5678);
+    c8 buf[64];
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        u64 bits = next_random_int(&gen);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+
+        if (d - d != 0.0)
+            continue;
+
+        snprintf(buf, sizeof(buf), "%.*g", 1 + (int)(bits % 17), d);
+        _assert_same_as_strtod(buf);
+
+        snprintf(buf, sizeof(buf), "%.17g", d);
+        _assert_same_as_strtod(buf);
+    }
+}
+
+define_test(string_to_double_sets_next_and_error)
+{
+    error err{};
+    const_string next{};
+
+    assert_equal(string_to_double("1.5e", &next, &err), 1.5);
+    assert_equal(next, "e"_cs);
+
+    assert_equal(string_to_double("2.5e+x", &next, &err), 2.5);
+    assert_equal(next, "e+x"_cs);
+
+    assert_equal(string_to_double("-.25;", &next, &err), -0.25);
+    assert_equal(next, ";"_cs);
+
+    assert_equal(string_to_double("abc", &next, &err), 0.0);
+    assert_equal(next, "abc"_cs);
+
+    assert_equal(string_to_double(u"6.25", nullptr, &err), 6.25);
+    assert_equal(string_to_double(U"6.25", nullptr, &err), 6.25);
+    assert_equal(string_to_float("0.5", nullptr, &err), 0.5f);
+    assert_equal(err.error_code, 0);
+
+    double inf = string_to_double("1e309", nullptr, &err);
+    assert_equal(err.error_code, 34);
+    assert_greater(inf, max_value(double));
+
+    // finite as double, but not as float
+    err = error{};
+    float finf = string_to_float("-1e39", nullptr, &err);
+    assert_equal(err.error_code, 34);
+    assert_less(finf, -max_value(float));
+
+    err = error{};
+    assert_equal(string_to_float("3.4028235e38", nullptr, &err), max_value(float));
+    assert_equal(err.error_code, 0);
+}
+
+define_test(string_to_numbers_parses_columns)
+{
+    error err{};
+    array<s32> ints{};
+    init(&ints);
+
+    assert_equal(string_to_numbers("1,-2, 3 ,4000000,", ',', &ints, &err), 4);
+    assert_equal(ints.size, 4);
+    assert_equal(ints[0], 1);
+    assert_equal(ints[1], -2);
+    assert_equal(ints[2], 3);
+    assert_equal(ints[3], 4000000);
+
+    assert_equal(string_to_numbers(u"5\n6\n", u'\n', &ints, &err), 2);
+    assert_equal(ints.size, 6);
+    assert_equal(ints[5], 6);
+
+    assert_equal(string_to_numbers("", ',', &ints, &err), 0);
+    assert_equal(err.error_code, 0);
+
+    assert_equal(string_to_numbers("1,,2", ',', &ints, &err), -1);
+    assert_equal(err.error_code, 22);
+    assert_equal(ints.size, 7);
+
+    err = error{};
+    assert_equal(string_to_numbers("1;2", ',', &ints, &err), -1);
+    assert_equal(err.error_code, 22);
+
+    err = error{};
+    assert_equal(string_to_numbers("3000000000", ',', &ints, &err), -1);
+    assert_equal(err.error_code, 34);
+
+    free(&ints);
+
+    array<float> floats{};
+    init(&floats);
+
+    err = error{};
+    assert_equal(string_to_numbers("1.5,3.4e38", ',', &floats, &err), 2);
+    assert_equal(err.error_code, 0);
+
+    assert_equal(string_to_numbers("1.5,3.5e38", ',', &floats, &err), -1);
+    assert_equal(err.error_code, 34);
+
+    free(&floats);
+
+    array<u8> bytes{};
+    init(&bytes);
+
+    err = error{};
+    assert_equal(string_to_numbers("0 255 128", ' ', &bytes, &err), 3);
+    assert_equal(bytes[1], (u8)255);
+    assert_equal(err.error_code, 0);
+
+    assert_equal(string_to_numbers("-1", ' ', &bytes, &err), -1);
+    assert_equal(err.error_code, 22);
+
+    free(&bytes);
+
+    array<double> doubles{};
+    init(&doubles);
+
+    err = error{};
+    assert_equal(string_to_numbers("0.1\t1e3\t-2.5", '\t', &doubles, &err), 3);
+    assert_equal(doubles[0], 0.1);
+    assert_equal(doubles[1], 1000.0);
+    assert_equal(doubles[2], -2.5);
+    assert_equal(err.error_code, 0);
+
+    free(&doubles);
+}
+
+define_default_test_main();
@@ -0,0 +1,99 @@
+#include <t1/t1.hpp>
+
+#include "shl/allocator_pool.hpp"
+
+define_test(pool_init_initializes_pool)
+{
+    pool p;
+
+    init(&p, 12, 16);
+
+    assert_equal(p.element_size, 16);
+    assert_equal(p.elements_per_block, 16);
+    assert_equal(p.alignment, 8);
+    assert_equal(p.free_list, nullptr);
+    assert_equal(p.blocks, nullptr);
+
+    free(&p);
+}
+
+define_test(pool_allocates_contiguous_elements)
+{
+    pool p;
+    init(&p, sizeof(s64), 4);
+
+    allocator a = pool_allocator(&p);
+
+    s64 *x = allocator_alloc_T(a, s64);
+    s64 *y = allocator_alloc_T(a, s64);
+    s64 *z = allocator_alloc_T(a, s64);
+
+    assert_not_equal(p.blocks, nullptr);
+    assert_equal(y, x + 1);
+    assert_equal(z, y + 1);
+
+    // reuses deallocated elements
+    allocator_dealloc_T(a, y, s64);
+    s64 *w = allocator_alloc_T(a, s64);
+
+    assert_equal(w, y);
+
+    // new block when out of elements
+    s64 *v = allocator_alloc_T(a, s64);
+    s64 *u = allocator_alloc_T(a, s64);
+
+    assert_not_equal(v, nullptr);
+    assert_not_equal(u, nullptr);
+    assert_not_equal(*(void**)p.blocks, nullptr);
+
+    free(&p);
+
+    assert_equal(p.blocks, nullptr);
+}
+
+define_test(pool_aligns_elements_to_alignment)
+{
+    pool p;
+    init(&p, 24, 3, 64);
+
+    assert_equal(p.element_size, 64);
+    assert_equal(p.alignment, 64);
+
+    allocator a = pool_allocator(&p);
+
+    // 5 elements span two blocks
+    for (s64 i = 0; i < 5; ++i)
+    {
+        void *x = allocator_alloc(a, 24);
+
+        assert_not_equal(x, nullptr);
+        assert_equal((u64)x % 64, 0u);
+    }
+
+    free(&p);
+}
+
+define_test(pool_passes_large_allocations_to_backing_allocator)
+{
+    pool p;
+    init(&p, sizeof(s64), 4);
+
+    allocator a = pool_allocator(&p);
+
+    s64 *x = allocator_alloc_T(a, s64, 100);
+
+    assert_not_equal(x, nullptr);
+    assert_equal(p.blocks, nullptr);
+
+    x[99] = 5;
+    x = allocator_realloc_T(a, x, s64, 100, 1);
+
+    assert_not_equal(x, nullptr);
+    assert_not_equal(p.blocks, nullptr);
+
+    allocator_dealloc_T(a, x, s64);
+
+    free(&p);
+}
+
+define_default_test_main()
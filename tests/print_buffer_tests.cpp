@@ -0,0 +1,234 @@
+
+#include <t1/t1.hpp>
+
+#include "shl/print.hpp"
+#include "shl/pipe.hpp"
+#include "shl/thread.hpp"
+#include "shl/time.hpp"
+
+static const_string _read_pipe(pipe_t *p, c8 *buf, s64 size)
+{
+    s64 available = io_size(p->read);
+
+    if (available <= 0)
+        return const_string{buf, 0};
+
+    if (available > size)
+        available = size;
+
+    return const_string{buf, io_read(p->read, buf, available)};
+}
+
+define_test(print_buffer_flushes_complete_lines_on_newline)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    print_buffer pb{};
+    init(&pb, p.write);
+    c8 buf[256];
+
+    assert_equal(put(&pb, "hello"), 5);
+    assert_equal(io_size(p.read), 0);
+
+    // writes the complete line, keeps the incomplete one
+    assert_equal(put(&pb, " world\nabc"), 10);
+    assert_equal(_read_pipe(&p, buf, 256), "hello world\n"_cs);
+    assert_equal(pb.size, 3);
+
+    assert_equal(tprint(&pb, "%\n%\nx", 1, 2), 5);
+    assert_equal(_read_pipe(&p, buf, 256), "abc1\n2\n"_cs);
+
+    put(&pb, 'y');
+    assert_equal(flush(&pb), true);
+    assert_equal(_read_pipe(&p, buf, 256), "xy"_cs);
+    assert_equal(pb.size, 0);
+
+    free(&pb);
+    free(&p);
+}
+
+define_test(print_buffer_flushes_on_size)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    print_buffer pb{};
+    init(&pb, p.write, print_flush_mode::on_size, 64);
+    pb.flush_size = 8;
+    c8 buf[256];
+
+    put(&pb, "1234\n");
+    assert_equal(io_size(p.read), 0);
+    put(&pb, "567");
+    assert_equal(_read_pipe(&p, buf, 256), "1234\n567"_cs);
+
+    // writes larger than the buffer are written together with the buffer
+    put(&pb, "ab");
+    c8 large[100];
+    fill_memory(large, 'z', 100);
+
+    assert_equal(put(&pb, const_string{large, 100}), 100);
+    assert_equal(pb.size, 0);
+    assert_equal(io_size(p.read), 102);
+    assert_equal(_read_pipe(&p, buf, 2), "ab"_cs);
+    assert_equal(_read_pipe(&p, buf, 256), (const_string{large, 100}));
+
+    free(&pb);
+    free(&p);
+}
+
+define_test(print_buffer_manual_only_flushes_when_full)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    print_buffer pb{};
+    init(&pb, p.write, print_flush_mode::manual, 16);
+    c8 buf[256];
+
+    put(&pb, "line 1\n");
+    put(&pb, "line 2\n");
+    assert_equal(io_size(p.read), 0);
+
+    // does not fit anymore
+    put(&pb, "line 3\n");
+    assert_equal(_read_pipe(&p, buf, 256), "line 1\nline 2\n"_cs);
+    assert_equal(pb.size, 7);
+
+    // free flushes
+    free(&pb);
+    assert_equal(_read_pipe(&p, buf, 256), "line 3\n"_cs);
+
+    free(&p);
+}
+
+define_test(put_and_tprint_use_thread_print_buffer_when_buffered)
+{
+    pipe_t p{};
+    assert_equal(init(&p), true);
+    c8 buf[256];
+
+    print_buffer *pb = get_stdout_print_buffer();
+    assert_equal(pb, get_print_buffer(stdout_handle()));
+    assert_equal(get_stderr_print_buffer(), get_print_buffer(stderr_handle()));
+    assert_equal(get_print_buffer(p.write), (print_buffer*)nullptr);
+
+    // redirect the stdout buffer of this thread to the pipe
+    io_handle old_handle = pb->handle;
+    pb->handle = p.write;
+    pb->mode = print_flush_mode::manual;
+
+    assert_equal(is_print_buffered(), false);
+    set_print_buffered(true);
+    assert_equal(is_print_buffered(), true);
+
+    put("a");
+    put('b');
+    tprint("%\n", 12);
+    tprint(u"%", u"c");
+    assert_equal(pb->size, 6);
+    assert_equal(io_size(p.read), 0);
+
+    // disabling flushes
+    set_print_buffered(false);
+    assert_equal(_read_pipe(&p, buf, 256), "ab12\nc"_cs);
+
+    pb->handle = old_handle;
+    pb->mode = print_flush_mode::on_newline;
+
+    free(&p);
+}
+
+struct _print_thread_args
+{
+    print_buffer *shared;
+    print_buffer *own;
+};
+
+static void *_print_thread(void *arg)
+{
+    _print_thread_args *args = (_print_thread_args*)arg;
+    args->own = get_stdout_print_buffer();
+
+    for (s64 i = 0; i < 1000; ++i)
+        put(args->shared, "abcdefg\n");
+
+    return nullptr;
+}
+
+struct _drain_pipe_args
+{
+    io_handle h;
+    string out;
+};
+
+static void *_drain_pipe(void *arg)
+{
+    _drain_pipe_args *args = (_drain_pipe_args*)arg;
+    c8 buf[4096];
+    s64 n = 0;
+
+    while ((n = io_read(args->h, buf, 4096)) > 0)
+        string_append(&args->out, const_string{buf, n});
+
+    return nullptr;
+}
+
+define_test(print_buffer_may_be_shared_by_threads)
+{
+    const s64 thread_count = 4;
+    pipe_t p{};
+    assert_equal(init(&p), true);
+
+    _drain_pipe_args drain{.h = p.read, .out = {}};
+    thread reader{};
+    program_context *ctx = get_context_pointer();
+    assert_equal(thread_create(&reader, _drain_pipe, &drain), true);
+    assert_equal(thread_start(&reader), true);
+
+    print_buffer pb{};
+    init(&pb, p.write, print_flush_mode::on_size, 64);
+
+    thread threads[thread_count]{};
+    _print_thread_args args[thread_count]{};
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        args[i].shared = &pb;
+        assert_equal(thread_create(threads + i, _print_thread, args + i), true);
+        assert_equal(thread_start(threads + i), true);
+    }
+
+    // starting threads set the context pointer of this thread
+    for (s64 i = 0; i < thread_count; ++i)
+        thread_stop(threads + i);
+
+    set_context_pointer(ctx);
+
+    free(&pb);
+    io_close(p.write);
+    thread_stop(&reader);
+    set_context_pointer(ctx);
+
+    assert_equal(drain.out.size, thread_count * 1000 * 8);
+
+    for (s64 i = 0; i < drain.out.size; i += 8)
+        assert_equal((const_string{drain.out.data + i, 8}), "abcdefg\n"_cs);
+
+    // shl threads do not share the stdout buffer of this thread
+    for (s64 i = 0; i < thread_count; ++i)
+        assert_not_equal(args[i].own, get_stdout_print_buffer());
+
+    // thread_stop returns slightly before the threads stop using their stack
+    sleep_ms(20);
+
+    for (s64 i = 0; i < thread_count; ++i)
+        thread_destroy(threads + i);
+
+    thread_destroy(&reader);
+    io_close(p.read);
+    free(&drain.out);
+}
+
+define_default_test_main();
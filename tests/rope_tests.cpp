@@ -0,0 +1,328 @@
+
+#include <t1/t1.hpp>
+
+#include "shl/rope.hpp"
+#include "shl/array.hpp"
+#include "shl/random.hpp"
+
+static bool rope_equals(const rope *r, const_string s)
+{
+    if (r->size != s.size)
+        return false;
+
+    s64 i = 0;
+
+    for_rope_chunks(span, r)
+    {
+        if (string_compare(span, to_const_string(s.c_str + i, span.size)) != 0)
+            return false;
+
+        i += span.size;
+    }
+
+    return i == s.size;
+}
+
+define_test(init_initializes_rope)
+{
+    rope r;
+    init(&r);
+
+    assert_equal(r.root, nullptr);
+    assert_equal(r.size, 0);
+
+    free(&r);
+
+    init(&r, "hello world");
+
+    assert_equal(r.size, 11);
+    assert_equal(rope_equals(&r, "hello world"_cs), true);
+
+    free(&r);
+
+    assert_equal(r.root, nullptr);
+    assert_equal(r.size, 0);
+}
+
+define_test(rope_insert_inserts_string)
+{
+    rope r;
+    init(&r, "hello world");
+
+    rope_insert(&r, 5, ",");
+    assert_equal(rope_equals(&r, "hello, world"_cs), true);
+
+    rope_prepend(&r, ">> ");
+    assert_equal(rope_equals(&r, ">> hello, world"_cs), true);
+
+    rope_append(&r, "!");
+    assert_equal(rope_equals(&r, ">> hello, world!"_cs), true);
+
+    // position is clamped
+    rope_insert(&r, 1000, "?");
+    assert_equal(rope_equals(&r, ">> hello, world!?"_cs), true);
+
+    free(&r);
+}
+
+define_test(rope_insert_inserts_large_string)
+{
+    string big{};
+    init(&big, 5000);
+
+    for (int i = 0; i < 5000; ++i)
+        big.data[i] = (c8)('a' + (i % 26));
+
+    rope r;
+    init(&r, "[]");
+
+    rope_insert(&r, 1, to_const_string(&big));
+
+    assert_equal(r.size, 5002);
+    assert_equal(rope_at(&r, 0), '[');
+    assert_equal(rope_at(&r, 1), 'a');
+    assert_equal(rope_at(&r, 27), 'a');
+    assert_equal(rope_at(&r, 5000), big.data[4999]);
+    assert_equal(rope_at(&r, 5001), ']');
+
+    s64 chunks = 0;
+
+    for_rope_chunks(span, &r)
+    {
+        assert_less_or_equal(span.size, rope_chunk_size);
+        chunks++;
+    }
+
+    assert_greater(chunks, 5000 / rope_chunk_size);
+
+    free(&r);
+    free(&big);
+}
+
+define_test(rope_remove_removes_units)
+{
+    rope r;
+    init(&r, "hello, world");
+
+    rope_remove(&r, 5, 1);
+    assert_equal(rope_equals(&r, "hello world"_cs), true);
+
+    rope_remove(&r, 0, 6);
+    assert_equal(rope_equals(&r, "world"_cs), true);
+
+    rope_remove(&r, 3, 100);
+    assert_equal(rope_equals(&r, "wor"_cs), true);
+
+    rope_remove(&r, 0, 3);
+    assert_equal(r.size, 0);
+    assert_equal(r.root, nullptr);
+
+    free(&r);
+}
+
+define_test(rope_split_and_concat)
+{
+    rope r;
+    rope tail;
+    init(&r, "hello world");
+    init(&tail);
+
+    rope_split(&r, 5, &tail);
+
+    assert_equal(rope_equals(&r, "hello"_cs), true);
+    assert_equal(rope_equals(&tail, " world"_cs), true);
+
+    rope_insert(&tail, 0, " big");
+    rope_concat(&r, &tail);
+
+    assert_equal(rope_equals(&r, "hello big world"_cs), true);
+    assert_equal(tail.size, 0);
+    assert_equal(tail.root, nullptr);
+
+    free(&r);
+    free(&tail);
+}
+
+define_test(rope_substring_copies_units)
+{
+    rope r;
+    init(&r, "the quick brown fox");
+
+    string s{};
+    init(&s);
+
+    rope_substring(&r, 4, 5, &s);
+    assert_equal(string_compare(&s, "quick"), 0);
+    assert_equal(s.data[5], '\0');
+
+    rope_substring(&r, 16, 100, &s);
+    assert_equal(string_compare(&s, "fox"), 0);
+
+    rope_to_string(&r, &s);
+    assert_equal(string_compare(&s, "the quick brown fox"), 0);
+
+    free(&s);
+
+    s = rope_to_string(&r);
+    assert_equal(string_compare(&s, "the quick brown fox"), 0);
+
+    free(&s);
+    free(&r);
+}
+
+define_test(rope_matches_string_after_random_edits)
+{
+    rope r;
+    array<c8> s{};
+    init(&r);
+    init(&s);
+
+    seed_rng(1234);
+
+    c8 text[1200];
+
+    for (s64 i = 0; i < (s64)sizeof(text); ++i)
+        text[i] = (c8)('a' + (i % 26));
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        s64 pos = (s64)next_bounded_int(s.size + 1);
+
+        if (next_bounded_int(3) != 0)
+        {
+            s64 len = (s64)next_bounded_int(i % 10 == 0 ? 1200 : 16) + 1;
+            const_string ins = to_const_string(text + next_bounded_int(26), Min(len, (s64)sizeof(text) - 26));
+
+            rope_insert(&r, pos, ins);
+            insert_range(&s, pos, ins.c_str, ins.size);
+        }
+        else
+        {
+            s64 len = (s64)next_bounded_int(i % 10 == 0 ? 1500 : 20);
+
+            rope_remove(&r, pos, len);
+            remove_elements(&s, pos, Min(len, s.size - pos));
+        }
+
+        assert_equal(r.size, s.size);
+    }
+
+    assert_equal(rope_equals(&r, to_const_string(s.data, s.size)), true);
+
+    for (s64 i = 0; i < s.size; i += 97)
+        assert_equal(rope_at(&r, i), s.data[i]);
+
+    free(&s);
+    free(&r);
+}
+
+static s64 _rope_chunk_count(const rope *r)
+{
+    s64 count = 0;
+
+    for_rope_chunks(span, r)
+        count += 1;
+
+    return count;
+}
+
+define_test(zero_initialized_rope_seeds_priorities)
+{
+    rope r{};
+    c8 text[rope_chunk_size * 8];
+    fill_memory(text, 'a', sizeof(text));
+
+    assert_equal(rope_insert(&r, 0, to_const_string(text, sizeof(text))), true);
+    assert_not_equal(r.seed, 0ull);
+    assert_not_equal(r.root->priority, r.root->left != nullptr ? r.root->left->priority : r.root->right->priority);
+
+    rope out{};
+    assert_equal(rope_split(&r, rope_chunk_size * 4 + 10, &out), true);
+    assert_not_equal(out.seed, 0ull);
+    assert_not_equal(out.seed, r.seed);
+    assert_equal(out.size, rope_chunk_size * 4 - 10);
+
+    free(&out);
+    free(&r);
+}
+
+define_test(rope_merges_small_chunks)
+{
+    rope r;
+    c8 text[rope_chunk_size * 4];
+    fill_memory(text, 'a', sizeof(text));
+    init(&r, to_const_string(text, sizeof(text)));
+    assert_equal(_rope_chunk_count(&r), 4);
+
+    // leaves 10 units of the first and 10 of the second chunk
+    assert_equal(rope_remove(&r, 10, rope_chunk_size * 2 - 20), true);
+    assert_equal(r.size, rope_chunk_size * 2 + 20);
+    assert_equal(_rope_chunk_count(&r), 3);
+
+    // shrinking a chunk inside merges it with its neighbour
+    assert_equal(rope_remove(&r, 20, rope_chunk_size - 10), true);
+    assert_equal(_rope_chunk_count(&r), 2);
+
+    // the 5 units after the split do not fit into the next chunk
+    rope out{};
+    assert_equal(rope_split(&r, 25, &out), true);
+    assert_equal(_rope_chunk_count(&r), 1);
+    assert_equal(_rope_chunk_count(&out), 2);
+    assert_equal(r.size + out.size, rope_chunk_size + 30);
+
+    // splitting inside the last chunk merges its front with the previous one
+    assert_equal(rope_split(&out, 10, &r), true);
+    assert_equal(_rope_chunk_count(&out), 1);
+    assert_equal(out.size, 10);
+    assert_equal(r.size, rope_chunk_size - 5);
+
+    free(&out);
+    free(&r);
+}
+
+static void *_failing_alloc(void *, void *, s64, s64)
+{
+    return nullptr;
+}
+
+define_test(rope_is_unchanged_if_allocation_fails)
+{
+    rope r;
+    init(&r, "hello world");
+
+    allocator old = r.allocator;
+    r.allocator = allocator{.alloc = _failing_alloc, .data = nullptr, .try_expand = nullptr};
+
+    c8 text[rope_chunk_size * 2];
+    fill_memory(text, 'a', sizeof(text));
+
+    // fits into the chunk, no allocation
+    assert_equal(rope_insert(&r, 5, ","), true);
+    assert_equal(rope_insert(&r, 3, to_const_string(text, sizeof(text))), false);
+    assert_equal(rope_equals(&r, "hello, world"_cs), true);
+
+    rope out{};
+    assert_equal(rope_split(&r, 3, &out), false);
+    assert_equal(rope_equals(&r, "hello, world"_cs), true);
+
+    r.allocator = old;
+    free(&r);
+}
+
+define_test(u32rope_works)
+{
+    u32rope r;
+    init(&r, U"hello");
+
+    rope_append(&r, U" world");
+    rope_remove(&r, 0, 1);
+    rope_insert(&r, 0, U"J");
+
+    u32string s = rope_to_string(&r);
+    assert_equal(string_compare(&s, U"Jello world"), 0);
+
+    free(&s);
+    free(&r);
+}
+
+define_default_test_main();
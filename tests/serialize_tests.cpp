@@ -0,0 +1,358 @@
+
+#include <t1/t1.hpp>
+
+#include "shl/serialize.hpp"
+
+define_test(varint_writes_and_reads_leb128)
+{
+    u8 buf[VARINT_MAX_SIZE];
+    u64 x = 0;
+
+    assert_equal(write_varint(buf, 0), 1);
+    assert_equal(buf[0], 0);
+
+    assert_equal(write_varint(buf, 127), 1);
+    assert_equal(buf[0], 0x7f);
+
+    assert_equal(write_varint(buf, 300), 2);
+    assert_equal(buf[0], 0xac);
+    assert_equal(buf[1], 0x02);
+    assert_equal(read_varint(buf, 2, &x), 2);
+    assert_equal(x, 300u);
+
+    assert_equal(write_varint(buf, max_value(u64)), VARINT_MAX_SIZE);
+    assert_equal(read_varint(buf, VARINT_MAX_SIZE, &x), VARINT_MAX_SIZE);
+    assert_equal(x, max_value(u64));
+
+    // truncated
+    assert_equal(read_varint(buf, 5, &x), 0);
+
+    // more than 64 bits
+    buf[VARINT_MAX_SIZE - 1] = 0x02;
+    assert_equal(read_varint(buf, VARINT_MAX_SIZE, &x), 0);
+}
+
+define_test(zigzag_maps_small_negative_numbers_to_small_numbers)
+{
+    static_assert(zigzag_encode(0) == 0);
+    static_assert(zigzag_encode(-1) == 1);
+    static_assert(zigzag_encode(1) == 2);
+    static_assert(zigzag_encode(-2) == 3);
+    static_assert(zigzag_encode(max_value(s64)) == max_value(u64) - 1);
+    static_assert(zigzag_encode(min_value(s64)) == max_value(u64));
+
+    static_assert(zigzag_decode(zigzag_encode(-12345)) == -12345);
+    static_assert(zigzag_decode(zigzag_encode(min_value(s64))) == min_value(s64));
+}
+
+define_test(serialize_writes_numbers_little_endian)
+{
+    memory_stream mem{};
+    init(&mem, 64);
+
+    u32 a = 0x11223344;
+    s16 b = -2;
+    bool c = true;
+    double d = 1.5;
+
+    assert_equal(serialize(&mem, &a), true);
+    assert_equal(serialize(&mem, &b), true);
+    assert_equal(serialize(&mem, &c), true);
+    assert_equal(serialize(&mem, &d), true);
+    assert_equal(tell(&mem), 4 + 2 + 1 + 8);
+
+    u8 *data = (u8*)mem.data;
+    assert_equal(data[0], 0x44);
+    assert_equal(data[3], 0x11);
+    assert_equal(data[4], 0xfe);
+    assert_equal(data[5], 0xff);
+    assert_equal(data[6], 1);
+
+    seek_from_start(&mem, 0);
+
+    u32 a2 = 0;
+    s16 b2 = 0;
+    bool c2 = false;
+    double d2 = 0;
+
+    assert_equal(deserialize(&mem, &a2), true);
+    assert_equal(deserialize(&mem, &b2), true);
+    assert_equal(deserialize(&mem, &c2), true);
+    assert_equal(deserialize(&mem, &d2), true);
+
+    assert_equal(a2, a);
+    assert_equal(b2, b);
+    assert_equal(c2, c);
+    assert_equal(d2, d);
+
+    free(&mem);
+}
+
+define_test(serialize_writes_varint_and_zigzag_integers)
+{
+    memory_stream mem{};
+    init(&mem, 64);
+
+    serialize_options varint{.integers = integer_encoding::varint};
+    serialize_options zigzag{.integers = integer_encoding::zigzag};
+
+    u64 small = 5;
+    s32 negative = -1;
+
+    assert_equal(serialize(&mem, &small, varint), true);
+    assert_equal(tell(&mem), 1);
+
+    // sign extended to 64 bits
+    assert_equal(serialize(&mem, &negative, varint), true);
+    assert_equal(tell(&mem), 1 + 10);
+
+    assert_equal(serialize(&mem, &negative, zigzag), true);
+    assert_equal(tell(&mem), 1 + 10 + 1);
+    assert_equal(((u8*)mem.data)[11], 1);
+
+    seek_from_start(&mem, 0);
+
+    u64 small2 = 0;
+    s32 negative2 = 0;
+    s32 negative3 = 0;
+
+    assert_equal(deserialize(&mem, &small2, varint), true);
+    assert_equal(deserialize(&mem, &negative2, varint), true);
+    assert_equal(deserialize(&mem, &negative3, zigzag), true);
+
+    assert_equal(small2, small);
+    assert_equal(negative2, negative);
+    assert_equal(negative3, negative);
+
+    free(&mem);
+}
+
+define_test(serialize_writes_strings)
+{
+    memory_stream mem{};
+    init(&mem, 256);
+
+    string s = "world"_s;
+    const_u16string u = u"wide"_cs;
+
+    assert_equal(serialize(&mem, "hello"), true);
+    assert_equal(serialize(&mem, &s), true);
+    assert_equal(serialize(&mem, ""_cs), true);
+    assert_equal(serialize(&mem, u), true);
+
+    assert_equal(tell(&mem), 6 + 6 + 1 + 9);
+    assert_equal(mem.data[0], 5);
+    assert_equal((const_string{mem.data + 1, 5}), "hello"_cs);
+
+    seek_from_start(&mem, 0);
+
+    string s1{};
+    string s2{};
+    string s3{};
+    u16string u2{};
+
+    assert_equal(deserialize(&mem, &s1), true);
+    assert_equal(deserialize(&mem, &s2), true);
+    assert_equal(deserialize(&mem, &s3), true);
+    assert_equal(deserialize(&mem, &u2), true);
+
+    assert_equal(s1, "hello"_cs);
+    assert_equal(s1.data[s1.size], '\0');
+    assert_equal(s2, "world"_cs);
+    assert_equal(s3, ""_cs);
+    assert_equal(u2, u"wide"_cs);
+
+    free(&s);
+    free(&s1);
+    free(&s2);
+    free(&s3);
+    free(&u2);
+    free(&mem);
+}
+
+define_test(serialize_writes_arrays)
+{
+    memory_stream mem{};
+    init(&mem, 4096);
+
+    array<s32> numbers{};
+    init(&numbers, 100);
+
+    for (s64 i = 0; i < numbers.size; ++i)
+        numbers[i] = (s32)(i * i - 50);
+
+    array<string> strings{};
+    init(&strings, 3);
+    strings[0] = "a"_s;
+    strings[1] = "bc"_s;
+    strings[2] = "def"_s;
+
+    assert_equal(serialize(&mem, &numbers), true);
+    assert_equal(tell(&mem), 1 + 100 * 4);
+
+    serialize_options zigzag{.integers = integer_encoding::zigzag};
+    assert_equal(serialize(&mem, &numbers, zigzag), true);
+    assert_equal(serialize(&mem, &strings), true);
+
+    seek_from_start(&mem, 0);
+
+    array<s32> numbers2{};
+    array<s32> numbers3{};
+    array<string> strings2{};
+
+    assert_equal(deserialize(&mem, &numbers2), true);
+    assert_equal(deserialize(&mem, &numbers3, zigzag), true);
+    assert_equal(deserialize(&mem, &strings2), true);
+
+    assert_equal(numbers2.size, numbers.size);
+    assert_equal(numbers3.size, numbers.size);
+
+    for (s64 i = 0; i < numbers.size; ++i)
+    {
+        assert_equal(numbers2[i], numbers[i]);
+        assert_equal(numbers3[i], numbers[i]);
+    }
+
+    assert_equal(strings2.size, 3);
+    assert_equal(strings2[0], "a"_cs);
+    assert_equal(strings2[1], "bc"_cs);
+    assert_equal(strings2[2], "def"_cs);
+
+    free<true>(&strings);
+    free<true>(&strings2);
+    free(&numbers);
+    free(&numbers2);
+    free(&numbers3);
+    free(&mem);
+}
+
+define_test(serialize_writes_sets_and_hash_tables)
+{
+    memory_stream mem{};
+    init(&mem, 4096);
+
+    set<u16> st{};
+    init(&st);
+    insert_element(&st, (u16)30);
+    insert_element(&st, (u16)10);
+    insert_element(&st, (u16)20);
+
+    hash_table<u32, string> table{};
+    init(&table);
+    table[1] = "one"_s;
+    table[2] = "two"_s;
+    table[300] = "three hundred"_s;
+
+    serialize_options varint{.integers = integer_encoding::varint};
+    assert_equal(serialize(&mem, &st, varint), true);
+    assert_equal(tell(&mem), 4);
+    assert_equal(serialize(&mem, &table, varint), true);
+
+    seek_from_start(&mem, 0);
+
+    set<u16> st2{};
+    hash_table<u32, string> table2{};
+
+    assert_equal(deserialize(&mem, &st2, varint), true);
+    assert_equal(deserialize(&mem, &table2, varint), true);
+
+    assert_equal(st2.size, 3);
+    assert_equal(st2[0], 10);
+    assert_equal(st2[1], 20);
+    assert_equal(st2[2], 30);
+
+    assert_equal(table2.size, 3);
+    assert_equal(table2[1u], "one"_cs);
+    assert_equal(table2[2u], "two"_cs);
+    assert_equal(table2[300u], "three hundred"_cs);
+
+    free(&st);
+    free(&st2);
+    free<false, true>(&table);
+    free<false, true>(&table2);
+    free(&mem);
+}
+
+struct _serialize_vec2
+{
+    float x;
+    float y;
+};
+
+template<typename Stream>
+bool serialize(Stream *s, const _serialize_vec2 *v, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return serialize(s, &v->x, opt, err) && serialize(s, &v->y, opt, err);
+}
+
+template<typename Stream>
+bool deserialize(Stream *s, _serialize_vec2 *v, serialize_options opt = default_serialize_options, error *err = nullptr)
+{
+    return deserialize(s, &v->x, opt, err) && deserialize(s, &v->y, opt, err);
+}
+
+define_test(serialize_uses_overloads_of_custom_types)
+{
+    memory_stream mem{};
+    init(&mem, 256);
+
+    array<_serialize_vec2> arr{};
+    init(&arr, 2);
+    arr[0] = _serialize_vec2{1.f, 2.f};
+    arr[1] = _serialize_vec2{-3.f, 0.5f};
+
+    assert_equal(serialize(&mem, &arr), true);
+    assert_equal(tell(&mem), 1 + 2 * 8);
+
+    seek_from_start(&mem, 0);
+
+    array<_serialize_vec2> arr2{};
+    assert_equal(deserialize(&mem, &arr2), true);
+
+    assert_equal(arr2.size, 2);
+    assert_equal(arr2[0].x, 1.f);
+    assert_equal(arr2[0].y, 2.f);
+    assert_equal(arr2[1].x, -3.f);
+    assert_equal(arr2[1].y, 0.5f);
+
+    free(&arr);
+    free(&arr2);
+    free(&mem);
+}
+
+define_test(serialize_fails_on_full_stream_and_deserialize_on_end_of_data)
+{
+    memory_stream mem{};
+    init(&mem, 8);
+    error err{};
+
+    u64 x = 1;
+    assert_equal(serialize(&mem, &x, default_serialize_options, &err), true);
+    assert_equal(serialize(&mem, &x, default_serialize_options, &err), false);
+    assert_equal(err.error_code, 28);
+
+    // a size larger than the rest of the data is rejected before allocating
+    seek_from_start(&mem, 0);
+    u8 huge[] = {0xff, 0xff, 0xff, 0xff, 0x0f};
+    write(&mem, huge, 5);
+    seek_from_start(&mem, 0);
+
+    string s{};
+    err = error{};
+    assert_equal(deserialize(&mem, &s, default_serialize_options, &err), false);
+    assert_equal(err.error_code, 61);
+    assert_equal(s.data, (c8*)nullptr);
+
+    // truncated varint
+    mem.size = 2;
+    seek_from_start(&mem, 0);
+    u64 y = 0;
+    err = error{};
+    assert_equal(deserialize(&mem, &y, serialize_options{.integers = integer_encoding::varint}, &err), false);
+    assert_equal(err.error_code, 61);
+
+    mem.size = 8;
+    free(&mem);
+}
+
+define_default_test_main();
@@ -0,0 +1,294 @@
+#include <t1/t1.hpp>
+
+#include "shl/small_array.hpp"
+
+define_test(init_initializes_small_array)
+{
+    small_array<int, 4> arr;
+
+    init(&arr);
+
+    assert_equal(arr.data, arr.inline_data);
+    assert_equal(arr.size, 0);
+    assert_equal(arr.reserved_size, 4);
+    assert_equal(is_inline(&arr), true);
+
+    free(&arr);
+}
+
+define_test(init_initializes_small_array2)
+{
+    small_array<int, 4> arr;
+
+    init(&arr, 3);
+
+    assert_equal(arr.data, arr.inline_data);
+    assert_equal(arr.size, 3);
+    assert_equal(arr.reserved_size, 4);
+
+    free(&arr);
+
+    init(&arr, 10);
+
+    assert_not_equal(arr.data, arr.inline_data);
+    assert_equal(arr.size, 10);
+    assert_equal(arr.reserved_size, 10);
+    assert_equal(is_inline(&arr), false);
+
+    free(&arr);
+
+    assert_equal(arr.data, arr.inline_data);
+    assert_equal(arr.size, 0);
+    assert_equal(arr.reserved_size, 4);
+}
+
+define_test(add_at_end_adds_inline_until_full)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        add_at_end(&arr, i);
+        assert_equal(is_inline(&arr), true);
+    }
+
+    assert_equal(arr.size, 4);
+    assert_equal(arr.data, arr.inline_data);
+
+    add_at_end(&arr, 4);
+
+    assert_equal(is_inline(&arr), false);
+    assert_not_equal(arr.data, arr.inline_data);
+    assert_equal(arr.size, 5);
+    assert_equal(arr.reserved_size, 8);
+
+    for (int i = 0; i < 5; ++i)
+        assert_equal(arr[i], i);
+
+    free(&arr);
+}
+
+define_test(add_at_start_adds_at_start)
+{
+    small_array<int, 2> arr;
+    init(&arr);
+
+    add_at_start(&arr, 1);
+    add_at_start(&arr, 2);
+    add_at_start(&arr, 3);
+
+    assert_equal(arr.size, 3);
+    assert_equal(arr[0], 3);
+    assert_equal(arr[1], 2);
+    assert_equal(arr[2], 1);
+
+    free(&arr);
+}
+
+define_test(insert_elements_inserts_elements)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    add_at_end(&arr, 1);
+    add_at_end(&arr, 4);
+
+    int *n = insert_elements(&arr, 1, 2);
+    n[0] = 2;
+    n[1] = 3;
+
+    assert_equal(arr.size, 4);
+    assert_equal(is_inline(&arr), true);
+
+    for (int i = 0; i < 4; ++i)
+        assert_equal(arr[i], i + 1);
+
+    assert_equal(insert_elements(&arr, 5, 1), nullptr);
+
+    n = insert_elements(&arr, 0, 1);
+    *n = 0;
+
+    assert_equal(arr.size, 5);
+    assert_equal(is_inline(&arr), false);
+
+    for (int i = 0; i < 5; ++i)
+        assert_equal(arr[i], i);
+
+    free(&arr);
+}
+
+define_test(add_range_adds_range)
+{
+    small_array<int, 4> arr;
+    small_array<int, 2> arr2;
+    init(&arr);
+    init(&arr2);
+
+    int vals[] = {1, 2, 3};
+    add_range(&arr, vals, 3);
+    add_range(&arr2, vals, 3);
+
+    assert_equal(arr.size, 3);
+    assert_equal(arr2.size, 3);
+    assert_equal(is_inline(&arr), true);
+    assert_equal(is_inline(&arr2), false);
+
+    add_range(&arr, &arr2);
+
+    assert_equal(arr.size, 6);
+
+    for (int i = 0; i < 6; ++i)
+        assert_equal(arr[i], (i % 3) + 1);
+
+    free(&arr);
+    free(&arr2);
+}
+
+define_test(remove_elements_removes_elements)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    for (int i = 0; i < 6; ++i)
+        add_at_end(&arr, i);
+
+    remove_elements(&arr, 1, 2);
+
+    assert_equal(arr.size, 4);
+    assert_equal(arr[0], 0);
+    assert_equal(arr[1], 3);
+    assert_equal(arr[2], 4);
+    assert_equal(arr[3], 5);
+
+    remove_from_start(&arr);
+    remove_from_end(&arr);
+
+    assert_equal(arr.size, 2);
+    assert_equal(arr[0], 3);
+    assert_equal(arr[1], 4);
+
+    free(&arr);
+}
+
+define_test(reserve_reserves_memory)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    reserve(&arr, 2);
+
+    assert_equal(arr.reserved_size, 4);
+    assert_equal(is_inline(&arr), true);
+
+    add_at_end(&arr, 1);
+    reserve(&arr, 10);
+
+    assert_equal(arr.reserved_size, 10);
+    assert_equal(is_inline(&arr), false);
+    assert_equal(arr[0], 1);
+
+    free(&arr);
+}
+
+define_test(resize_and_shrink_to_fit_move_elements_back_inline)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    for (int i = 0; i < 10; ++i)
+        add_at_end(&arr, i);
+
+    assert_equal(is_inline(&arr), false);
+
+    resize(&arr, 3);
+
+    assert_equal(is_inline(&arr), true);
+    assert_equal(arr.data, arr.inline_data);
+    assert_equal(arr.size, 3);
+    assert_equal(arr.reserved_size, 4);
+
+    for (int i = 0; i < 3; ++i)
+        assert_equal(arr[i], i);
+
+    for (int i = 3; i < 10; ++i)
+        add_at_end(&arr, i);
+
+    remove_elements(&arr, 2, 8);
+
+    assert_equal(is_inline(&arr), false);
+    assert_equal(arr.size, 2);
+
+    shrink_to_fit(&arr);
+
+    assert_equal(is_inline(&arr), true);
+    assert_equal(arr.reserved_size, 4);
+    assert_equal(arr[0], 0);
+    assert_equal(arr[1], 1);
+
+    free(&arr);
+}
+
+define_test(for_array_iterates_small_array)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    for (int i = 0; i < 8; ++i)
+        add_at_end(&arr, i);
+
+    int sum = 0;
+    s64 count = 0;
+
+    for_array(i, v, &arr)
+    {
+        assert_equal(*v, (int)i);
+        sum += *v;
+        count++;
+    }
+
+    assert_equal(count, 8);
+    assert_equal(sum, 28);
+
+    free(&arr);
+}
+
+define_test(moved_small_array_keeps_inline_elements)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    add_at_end(&arr, 1);
+    add_at_end(&arr, 2);
+
+    small_array<int, 4> moved = arr;
+
+    assert_equal(array_data(&moved), moved.inline_data);
+    assert_equal(moved[0], 1);
+    assert_equal(moved[1], 2);
+
+    add_at_end(&moved, 3);
+
+    assert_equal(*at(&moved, 2), 3);
+
+    free(&moved);
+}
+
+define_test(search_finds_elements)
+{
+    small_array<int, 4> arr;
+    init(&arr);
+
+    for (int i = 0; i < 6; ++i)
+        add_at_end(&arr, i * 2);
+
+    assert_equal(index_of(&arr, 4), 2);
+    assert_equal(index_of(&arr, 5), -1);
+    assert_equal(contains(&arr, 10), true);
+    assert_equal(*search(&arr, 8), 8);
+    assert_equal(search(&arr, 9), nullptr);
+
+    free(&arr);
+}
+
+define_default_test_main();
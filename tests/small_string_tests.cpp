@@ -0,0 +1,192 @@
+
+#include <t1/t1.hpp>
+
+#include "shl/small_string.hpp"
+#include "shl/allocator_arena.hpp"
+
+// copies would point into the inline data of the original
+static_assert(!__is_constructible(small_string, const small_string&));
+static_assert(!__is_assignable(small_string&, const small_string&));
+static_assert(!__is_constructible(small_u32string, small_u32string&&));
+
+define_test(init_initializes_small_string)
+{
+    small_string str;
+
+    init(&str);
+
+    assert_equal(str.data, str.inline_data);
+    assert_equal(str.size, 0);
+    assert_equal(str.reserved_size, 24);
+    assert_equal(str.data[0], '\0');
+    assert_equal(is_inline(&str), true);
+
+    free(&str);
+}
+
+define_test(init_initializes_small_string2)
+{
+    small_string str;
+
+    init(&str, "hello");
+
+    assert_equal(str.data, str.inline_data);
+    assert_equal(str.size, 5);
+    assert_equal(string_compare(&str, "hello"), 0);
+    assert_equal(str.data[5], '\0');
+
+    free(&str);
+
+    // 23 units + null terminator still fit inline
+    init(&str, "abcdefghijklmnopqrstuvw");
+
+    assert_equal(is_inline(&str), true);
+    assert_equal(str.size, 23);
+    assert_equal(str.data[23], '\0');
+
+    free(&str);
+
+    init(&str, "abcdefghijklmnopqrstuvwx");
+
+    assert_equal(is_inline(&str), false);
+    assert_not_equal(str.data, str.inline_data);
+    assert_equal(str.size, 24);
+    assert_equal(string_compare(&str, "abcdefghijklmnopqrstuvwx"), 0);
+    assert_equal(str.data[24], '\0');
+
+    free(&str);
+
+    assert_equal(str.data, nullptr);
+    assert_equal(str.size, 0);
+}
+
+define_test(small_string_grows_from_inline_to_heap)
+{
+    small_string str;
+    init(&str, "apple");
+
+    string_append(&str, "pie");
+
+    assert_equal(is_inline(&str), true);
+    assert_equal(string_compare(&str, "applepie"), 0);
+
+    string_append(&str, " with a lot of whipped cream");
+
+    assert_equal(is_inline(&str), false);
+    assert_equal(string_compare(&str, "applepie with a lot of whipped cream"), 0);
+    assert_equal(str.data[str.size], '\0');
+
+    string_append(&str, " and a cherry on top");
+
+    assert_equal(string_compare(&str, "applepie with a lot of whipped cream and a cherry on top"), 0);
+
+    free(&str);
+}
+
+define_test(small_string_works_with_string_functions)
+{
+    small_string str;
+    init(&str, "  hello world  ");
+
+    string_trim(&str);
+    assert_equal(string_compare(&str, "hello world"), 0);
+
+    string_replace_all(&str, "o", "0");
+    assert_equal(string_compare(&str, "hell0 w0rld"), 0);
+
+    assert_equal(string_index_of(&str, "w"), 6);
+    assert_equal(to_const_string(&str).size, 11);
+    assert_equal(string_data(&str), str.inline_data);
+
+    string s = "hell0 w0rld"_s;
+    assert_equal(hash(&str), hash(&s));
+    free(&s);
+
+    clear(&str);
+    assert_equal(str.size, 0);
+    assert_equal(str.data[0], '\0');
+    assert_equal(is_inline(&str), true);
+
+    free(&str);
+}
+
+define_test(small_string_does_not_allocate_when_inline)
+{
+    arena a{};
+    init(&a, 64);
+    s64 remaining = arena_remaining_size(a);
+
+    small_string str;
+
+    with_allocator(arena_allocator(&a))
+        init(&str, "key");
+
+    string_set(&str, "another key");
+    string_append(&str, "!");
+
+    assert_equal(is_inline(&str), true);
+    assert_equal(arena_remaining_size(a), remaining);
+
+    free(&str);
+    free(&a);
+}
+
+define_test(small_string_free_allows_reuse)
+{
+    small_string str;
+    init(&str, "this string does not fit in the inline data");
+
+    assert_equal(is_inline(&str), false);
+
+    free(&str);
+
+    string_set(&str, "short");
+
+    assert_equal(is_inline(&str), true);
+    assert_equal(string_compare(&str, "short"), 0);
+
+    free(&str);
+}
+
+define_test(string_data_restores_moved_small_string)
+{
+    small_string a;
+    init(&a, "moved");
+
+    small_string b;
+    copy_memory(&a, &b, sizeof(small_string));
+
+    assert_equal(b.data, a.inline_data);
+    assert_equal(string_data(&b), b.inline_data);
+
+    string_append(&b, " string");
+
+    assert_equal(string_compare(&b, "moved string"), 0);
+    assert_equal(string_compare(&a, "moved"), 0);
+
+    free(&b);
+}
+
+define_test(small_u16string_and_small_u32string)
+{
+    small_u16string s16;
+    small_u32string s32;
+
+    init(&s16, u"hello");
+    init(&s32, U"hello");
+
+    assert_equal(is_inline(&s16), true);
+    assert_equal(is_inline(&s32), true);
+
+    string_append(&s32, U"!");
+    assert_equal(is_inline(&s32), false);
+    assert_equal(string_compare(&s32, U"hello!"), 0);
+
+    string_set(&s16, U"world");
+    assert_equal(string_compare(&s16, u"world"), 0);
+
+    free(&s16);
+    free(&s32);
+}
+
+define_default_test_main();
@@ -0,0 +1,189 @@
+#include <t1/t1.hpp>
+
+#include "shl/soa_array.hpp"
+
+define_test(init_initializes_soa_array)
+{
+    soa_array<float, u8, s64> arr;
+
+    init(&arr);
+
+    assert_equal(arr.memory, nullptr);
+    assert_equal(arr.columns[0], nullptr);
+    assert_equal(arr.columns[1], nullptr);
+    assert_equal(arr.columns[2], nullptr);
+    assert_equal(arr.size, 0);
+    assert_equal(arr.reserved_size, 0);
+
+    free(&arr);
+}
+
+define_test(init_initializes_soa_array2)
+{
+    soa_array<float, u8, s64> arr;
+
+    init(&arr, 10);
+
+    assert_not_equal(arr.memory, nullptr);
+    assert_equal(arr.size, 10);
+    assert_equal(arr.reserved_size, 10);
+
+    for (s64 i = 0; i < arr.field_count; ++i)
+        assert_equal((u64)arr.columns[i] % soa_column_alignment, 0);
+
+    // columns don't overlap
+    assert_greater_or_equal((char*)arr.columns[1], (char*)(soa_column<0>(&arr) + 10));
+    assert_greater_or_equal((char*)arr.columns[2], (char*)(soa_column<1>(&arr) + 10));
+
+    free(&arr);
+
+    assert_equal(arr.memory, nullptr);
+    assert_equal(arr.size, 0);
+    assert_equal(arr.reserved_size, 0);
+}
+
+define_test(add_at_end_adds_rows)
+{
+    soa_array<int, char> arr{};
+    init(&arr);
+
+    for (int i = 0; i < 20; ++i)
+        add_at_end(&arr, i, (char)('a' + i));
+
+    assert_equal(arr.size, 20);
+    assert_equal(arr.reserved_size, 32);
+
+    int *ints = soa_column<0>(&arr);
+    char *chars = soa_column<1>(&arr);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        assert_equal(ints[i], i);
+        assert_equal(chars[i], (char)('a' + i));
+        assert_equal(*soa_at<0>(&arr, i), i);
+        assert_equal(row_at(&arr, i).get<1>(), (char)('a' + i));
+    }
+
+    soa_row<int, char> row = add_at_end(&arr);
+    row.get<0>() = 100;
+    row.get<1>() = 'z';
+
+    assert_equal(arr.size, 21);
+    assert_equal(*soa_at<0>(&arr, 20), 100);
+    assert_equal(*soa_at<1>(&arr, 20), 'z');
+
+    free(&arr);
+}
+
+define_test(insert_elements_inserts_rows)
+{
+    soa_array<int, double> arr{};
+    init(&arr);
+
+    add_at_end(&arr, 1, 1.0);
+    add_at_end(&arr, 4, 4.0);
+
+    s64 index = insert_elements(&arr, 1, 2);
+
+    assert_equal(index, 1);
+    row_at(&arr, 1).set(2, 2.0);
+    row_at(&arr, 2).set(3, 3.0);
+
+    add_at_start(&arr, 0, 0.0);
+
+    assert_equal(arr.size, 5);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        assert_equal(*soa_at<0>(&arr, i), i);
+        assert_equal(*soa_at<1>(&arr, i), (double)i);
+    }
+
+    assert_equal(insert_elements(&arr, 6, 1), -1);
+
+    free(&arr);
+}
+
+define_test(remove_elements_removes_rows)
+{
+    soa_array<int, s16> arr{};
+    init(&arr);
+
+    for (int i = 0; i < 6; ++i)
+        add_at_end(&arr, i, (s16)(i * 10));
+
+    remove_elements(&arr, 1, 2);
+
+    assert_equal(arr.size, 4);
+    assert_equal(*soa_at<0>(&arr, 0), 0);
+    assert_equal(*soa_at<0>(&arr, 1), 3);
+    assert_equal(*soa_at<1>(&arr, 1), 30);
+    assert_equal(*soa_at<0>(&arr, 3), 5);
+    assert_equal(*soa_at<1>(&arr, 3), 50);
+
+    remove_from_start(&arr);
+    remove_from_end(&arr);
+
+    assert_equal(arr.size, 2);
+    assert_equal(*soa_at<0>(&arr, 0), 3);
+    assert_equal(*soa_at<0>(&arr, 1), 4);
+
+    free(&arr);
+}
+
+define_test(reserve_and_resize_keep_rows)
+{
+    soa_array<int, char> arr{};
+    init(&arr);
+
+    for (int i = 0; i < 5; ++i)
+        add_at_end(&arr, i, (char)i);
+
+    reserve(&arr, 100);
+
+    assert_equal(arr.reserved_size, 100);
+    assert_equal(arr.size, 5);
+
+    for (int i = 0; i < 5; ++i)
+        assert_equal(*soa_at<0>(&arr, i), i);
+
+    resize(&arr, 3);
+
+    assert_equal(arr.reserved_size, 3);
+    assert_equal(arr.size, 3);
+
+    for (int i = 0; i < 3; ++i)
+        assert_equal(*soa_at<1>(&arr, i), (char)i);
+
+    free(&arr);
+}
+
+define_test(for_soa_array_iterates_rows)
+{
+    soa_array<int, int> arr{};
+    init(&arr);
+
+    for (int i = 0; i < 10; ++i)
+        add_at_end(&arr, i, i * 2);
+
+    s64 count = 0;
+
+    for_soa_array(i, row, &arr)
+    {
+        assert_equal(row.get<0>(), (int)i);
+        assert_equal(row.get<1>(), (int)i * 2);
+        count++;
+    }
+
+    assert_equal(count, 10);
+
+    for_soa_array(row, &arr)
+        row.get<1>() = 0;
+
+    for (s64 i = 0; i < arr.size; ++i)
+        assert_equal(soa_column<1>(&arr)[i], 0);
+
+    free(&arr);
+}
+
+define_default_test_main();
@@ -0,0 +1,156 @@
+
+#include <t1/t1.hpp>
+
+#include "shl/string_builder.hpp"
+#include "shl/pipe.hpp"
+
+define_test(init_initializes_string_builder)
+{
+    string_builder sb;
+    init(&sb);
+
+    assert_equal(sb.size, 0);
+    assert_equal(sb.chunks.size, 1);
+    assert_equal(sb.chunks.data[0].capacity, string_builder_min_chunk_size);
+
+    free(&sb);
+
+    assert_equal(sb.chunks.size, 0);
+}
+
+define_test(string_builder_append_appends_pieces)
+{
+    string_builder sb;
+    init(&sb);
+
+    string s = "world"_s;
+
+    assert_equal(string_builder_append(&sb, "hello"), 5);
+    assert_equal(string_builder_append(&sb, ' '), 1);
+    assert_equal(string_builder_append(&sb, &s), 5);
+    assert_equal(string_builder_append(&sb, "!"_cs), 1);
+
+    assert_equal(sb.size, 12);
+
+    string out = string_builder_to_string(&sb);
+    assert_equal(string_compare(&out, "hello world!"), 0);
+    assert_equal(out.data[12], '\0');
+
+    free(&out);
+    free(&s);
+    free(&sb);
+}
+
+define_test(string_builder_append_spans_chunks)
+{
+    string_builder sb;
+    init(&sb, 8);
+
+    for (int i = 0; i < 100; ++i)
+        string_builder_append(&sb, "0123456789");
+
+    assert_equal(sb.size, 1000);
+    assert_greater(sb.chunks.size, 1);
+
+    // chunks are filled completely before the next one is used
+    s64 chunks = 0;
+    s64 total = 0;
+
+    for_string_builder_chunks(span, &sb)
+    {
+        if (total + span.size < sb.size)
+            assert_equal(span.size, sb.chunks.data[chunks].capacity);
+
+        total += span.size;
+        chunks++;
+    }
+
+    assert_equal(total, 1000);
+
+    string out{};
+    init(&out);
+    string_builder_to_string(&sb, &out);
+
+    assert_equal(out.size, 1000);
+
+    for (s64 i = 0; i < out.size; ++i)
+        assert_equal(out.data[i], (c8)('0' + (i % 10)));
+
+    free(&out);
+    free(&sb);
+}
+
+define_test(string_builder_format_formats_pieces)
+{
+    string_builder sb;
+    init(&sb, 16);
+
+    string_builder_format(&sb, "a=% b=%", 1, "two");
+    assert_equal(sb.size, 9);
+
+    // does not fit into the rest of the first chunk
+    string_builder_format(&sb, ", long value: %", "this is a longer piece of text");
+
+    string out = string_builder_to_string(&sb);
+    assert_equal(string_compare(&out, "a=1 b=two, long value: this is a longer piece of text"), 0);
+
+    free(&out);
+    free(&sb);
+}
+
+define_test(string_builder_clear_reuses_chunks)
+{
+    string_builder sb;
+    init(&sb, 8);
+
+    for (int i = 0; i < 10; ++i)
+        string_builder_append(&sb, "abcdefgh");
+
+    s64 chunk_count = sb.chunks.size;
+
+    clear(&sb);
+    assert_equal(sb.size, 0);
+
+    for (int i = 0; i < 10; ++i)
+        string_builder_append(&sb, "abcdefgh");
+
+    assert_equal(sb.chunks.size, chunk_count);
+    assert_equal(sb.size, 80);
+
+    string out = string_builder_to_string(&sb);
+    assert_equal(out.size, 80);
+    assert_equal(string_begins_with(&out, "abcdefghabcdefgh"), true);
+
+    free(&out);
+    free(&sb);
+}
+
+define_test(string_builder_write_writes_all_chunks)
+{
+    string_builder sb;
+    init(&sb, 8);
+
+    for (int i = 0; i < 50; ++i)
+        string_builder_format(&sb, "line %\n", i);
+
+    pipe_t p{};
+    error err{};
+    assert_equal(init(&p, &err), true);
+
+    s64 written = string_builder_write(&sb, p.write, &err);
+    assert_equal(written, sb.size);
+
+    string expected = string_builder_to_string(&sb);
+    string actual{};
+    init(&actual, sb.size);
+
+    assert_equal(io_read(p.read, actual.data, actual.size, &err), sb.size);
+    assert_equal(string_compare(&actual, &expected), 0);
+
+    free(&actual);
+    free(&expected);
+    free(&p);
+    free(&sb);
+}
+
+define_default_test_main();
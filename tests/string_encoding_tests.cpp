@@ -308,6 +308,133 @@ define_test(utf16_to_utf8_encodes_utf16_string_to_utf8)
     assert_equal(memcmp(conv, u8"hello 彁 Привет", 22), 0);
 }
 
+define_test(utf8_is_valid_returns_true_for_valid_utf8)
+{
+    assert_equal(utf8_is_valid(u8"", 0), true);
+    assert_equal(utf8_is_valid(u8"hello world", 11), true);
+    assert_equal(utf8_is_valid(u8"hello 彁 Привет 🍌", 27), true);
+    assert_equal(utf8_is_valid("a\0b", 3), true);
+    assert_equal(utf8_is_valid("\xf4\x8f\xbf\xbf", 4), true);  // U+10FFFF
+    assert_equal(utf8_is_valid("\xed\x9f\xbf", 3), true);      // U+D7FF
+    assert_equal(utf8_is_valid("\xee\x80\x80", 3), true);      // U+E000
+}
+
+define_test(utf8_is_valid_returns_false_for_invalid_utf8)
+{
+    assert_equal(utf8_is_valid("\x80", 1), false);              // lone continuation byte
+    assert_equal(utf8_is_valid("\xc0\xaf", 2), false);          // overlong
+    assert_equal(utf8_is_valid("\xe0\x80\xaf", 3), false);      // overlong
+    assert_equal(utf8_is_valid("\xf0\x80\x80\xaf", 4), false);  // overlong
+    assert_equal(utf8_is_valid("\xed\xa0\x80", 3), false);      // surrogate
+    assert_equal(utf8_is_valid("\xf4\x90\x80\x80", 4), false);  // > U+10FFFF
+    assert_equal(utf8_is_valid("\xf5\x80\x80\x80", 4), false);
+    assert_equal(utf8_is_valid("\xe5\xbd", 2), false);          // truncated
+    assert_equal(utf8_is_valid("\xe5\x41\x81", 3), false);      // bad continuation
+}
+
+define_test(utf8_is_valid_validates_long_strings)
+{
+    c8 buf[100];
+
+    for (int i = 0; i < 100; ++i)
+        buf[i] = 'a' + (i % 26);
+
+    assert_equal(utf8_is_valid(buf, 100), true);
+
+    // invalid bytes at every position, including after ASCII blocks
+    for (int i = 0; i < 100; ++i)
+    {
+        c8 prev = buf[i];
+        buf[i] = (c8)0xff;
+        assert_equal(utf8_is_valid(buf, 100), false);
+        assert_equal(utf8_is_valid(buf, i), true);
+        buf[i] = prev;
+    }
+
+    // multibyte sequence crossing a 16 byte block
+    buf[15] = (c8)0xe5;
+    buf[16] = (c8)0xbd;
+    buf[17] = (c8)0x81;
+    assert_equal(utf8_is_valid(buf, 100), true);
+    assert_equal(utf8_is_valid(buf, 17), false);
+}
+
+define_test(utf16_is_valid_validates_surrogates)
+{
+    assert_equal(utf16_is_valid(u"", 0), true);
+    assert_equal(utf16_is_valid(u"hello 彁 Привет 🍌 and some more text", 34), true);
+
+    const c16 lone_high[] = {'a', 'b', 0xd83c, 'c', 'd', 'e', 'f', 'g', 'h', 'i'};
+    const c16 lone_low[]  = {'a', 'b', 0xdf4c, 'c', 'd', 'e', 'f', 'g', 'h', 'i'};
+    const c16 truncated[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 0xd83c};
+
+    assert_equal(utf16_is_valid(lone_high, 10), false);
+    assert_equal(utf16_is_valid(lone_low, 10), false);
+    assert_equal(utf16_is_valid(truncated, 10), false);
+    assert_equal(utf16_is_valid(truncated, 9), true);
+}
+
+define_test(utf8_to_utf16_and_back_converts_long_mixed_strings)
+{
+    // mostly ASCII with some multibyte codepoints, long enough to use the
+    // vectorized paths.
+    const c8 *input = u8"The quick brown fox jumps over the lazy dog. "
+                      u8"今日は, привет! 🍌 The quick brown fox jumps over the lazy dog. "
+                      u8"The quick brown fox jumps over the lazy dog.";
+    const s64 input_size = 164;
+
+    assert_equal(utf8_is_valid(input, input_size), true);
+
+    s64 cps = utf32_units_required_from_utf8(input, input_size);
+    assert_equal(cps, 149);
+
+    s64 u16_units = utf16_units_required_from_utf8(input, input_size);
+    assert_equal(u16_units, 150);
+
+    alignas(32) c16 u16buf[200] = {0};
+    s64 written = utf8_to_utf16(input, input_size, u16buf, 200);
+
+    assert_equal(written, 150);
+    assert_equal(u16buf[0], u'T');
+    assert_equal(u16buf[45], (c16)0x4eca);  // 今
+    assert_equal(u16buf[149], u'.');
+    assert_equal(utf16_is_valid(u16buf, written), true);
+    assert_equal(utf32_units_required_from_utf16(u16buf, written), 149);
+
+    c8 u8buf[200] = {0};
+    s64 written8 = utf16_to_utf8(u16buf, written, u8buf, 200);
+
+    assert_equal(written8, input_size);
+    assert_equal(memcmp(u8buf, input, input_size), 0);
+
+    alignas(16) c32 u32buf[200] = {0};
+    s64 written32 = utf8_to_utf32(input, input_size, u32buf, 200);
+
+    assert_equal(written32, 149);
+    assert_equal(u32buf[0], U'T');
+    assert_equal(u32buf[45], U'今');
+    assert_equal(u32buf[58], (c32)0x1f34c);  // 🍌
+    assert_equal(u32buf[148], U'.');
+}
+
+define_test(utf8_to_utf16_stops_at_null_and_out_size)
+{
+    alignas(16) c8 input[48];
+
+    for (int i = 0; i < 48; ++i)
+        input[i] = 'x';
+
+    input[40] = '\0';
+
+    c16 out[64] = {0};
+
+    assert_equal(utf8_to_utf16(input, 48, out, 64), 40);
+    assert_equal(out[39], u'x');
+    assert_equal(out[40], 0);
+    assert_equal(utf8_to_utf16(input, 48, out, 20), 20);
+    assert_equal(utf16_units_required_from_utf8(input, 48), 40);
+}
+
 /*
 define_test(utf16_bytes_required_from_utf8_returns_numbers_of_utf16_bytes_required_to_store_utf8_string)
 {
@@ -0,0 +1,222 @@
+
+#include <stdio.h>
+
+#include <t1/t1.hpp>
+
+#include "shl/string_intern.hpp"
+#include "shl/thread.hpp"
+
+define_test(string_intern_add_returns_same_id_for_equal_strings)
+{
+    string_intern si{};
+    init(&si);
+
+    string s = "hello"_s;
+
+    u32 a = string_intern_add(&si, "hello");
+    u32 b = string_intern_add(&si, "world"_cs);
+    u32 c = string_intern_add(&si, &s);
+    u32 d = string_intern_add(&si, "");
+
+    assert_equal(a, 0u);
+    assert_equal(b, 1u);
+    assert_equal(c, a);
+    assert_equal(d, 2u);
+    assert_equal(string_intern_count(&si), 3);
+
+    assert_equal(string_intern_get(&si, a), "hello"_cs);
+    assert_equal(string_intern_get(&si, b), "world"_cs);
+    assert_equal(string_intern_get(&si, d), ""_cs);
+
+    // interned strings do not point to the original
+    const_string out{};
+    string_intern_add(&si, &s, &out);
+    assert_equal(out, "hello"_cs);
+    assert_not_equal(out.c_str, (const c8*)s.data);
+    assert_equal(out.c_str[out.size], '\0');
+
+    free(&s);
+    free(&si);
+}
+
+define_test(string_intern_find_does_not_insert)
+{
+    string_intern si{};
+    init(&si);
+
+    u32 id = 1234;
+
+    assert_equal(string_intern_find(&si, "abc", &id), false);
+    assert_equal(id, 1234u);
+    assert_equal(string_intern_count(&si), 0);
+
+    u32 abc = string_intern_add(&si, "abc");
+
+    assert_equal(string_intern_find(&si, "abc"_cs, &id), true);
+    assert_equal(id, abc);
+    assert_equal(string_intern_find(&si, "ab", &id), false);
+    assert_equal(string_intern_find(&si, "abcd", &id), false);
+
+    free(&si);
+}
+
+define_test(string_intern_views_stay_valid_while_growing)
+{
+    string_intern si{};
+    init(&si);
+
+    const s64 n = 20000;
+    c8 buf[64];
+    array<const_string> views{};
+    init(&views);
+
+    for (s64 i = 0; i < n; ++i)
+    {
+        int len = snprintf(buf, sizeof(buf), "string number %lld", (long long)i);
+
+        const_string out{};
+        u32 id = string_intern_add(&si, const_string{buf, len}, &out);
+
+        assert_equal(id, (u32)i);
+        add_at_end(&views, out);
+    }
+
+    assert_equal(string_intern_count(&si), n);
+
+    // the tables and entry chunks grew many times, but views and ids persist
+    for (s64 i = 0; i < n; ++i)
+    {
+        int len = snprintf(buf, sizeof(buf), "string number %lld", (long long)i);
+        const_string expected{buf, len};
+        u32 id = 0;
+
+        assert_equal(views[i], expected);
+        assert_equal(string_intern_get(&si, (u32)i).c_str, views[i].c_str);
+        assert_equal(string_intern_find(&si, expected, &id), true);
+        assert_equal(id, (u32)i);
+        assert_equal(string_intern_add(&si, expected), (u32)i);
+    }
+
+    assert_equal(string_intern_count(&si), n);
+
+    // larger than a block
+    string big{};
+    init(&big, string_intern_block_size * 2);
+    fill_memory(big.data, 'x', big.size);
+
+    u32 big_id = string_intern_add(&si, &big);
+    assert_equal(string_intern_get(&si, big_id).size, big.size);
+    assert_equal(string_intern_add(&si, &big), big_id);
+
+    free(&big);
+    free(&views);
+    free(&si);
+}
+
+struct _intern_thread_args
+{
+    string_intern *si;
+    s64 count;
+    s64 found;
+    bool ok;
+};
+
+// threads of shl/thread.hpp do not set up libc thread state, so the
+// threads below neither allocate nor use snprintf.
+static s64 _format_key(c8 *buf, s64 num)
+{
+    c8 digits[24];
+    s64 n = 0;
+
+    do
+    {
+        digits[n++] = (c8)('0' + num % 10);
+        num /= 10;
+    }
+    while (num > 0);
+
+    buf[0] = 'k';
+    buf[1] = '-';
+
+    for (s64 i = 0; i < n; ++i)
+        buf[2 + i] = digits[n - 1 - i];
+
+    return 2 + n;
+}
+
+static void *_intern_reader_thread(void *arg)
+{
+    _intern_thread_args *args = (_intern_thread_args*)arg;
+    c8 buf[32];
+
+    args->ok = true;
+    args->found = 0;
+
+    // looks up all keys until all of them were added by the main thread
+    while (args->found < args->count)
+    {
+        args->found = 0;
+
+        for (s64 i = 0; i < args->count; ++i)
+        {
+            const_string s{buf, _format_key(buf, i)};
+            u32 id = 0;
+
+            if (!string_intern_find(args->si, s, &id))
+                continue;
+
+            args->found += 1;
+
+            if (string_intern_get(args->si, id) != s)
+                args->ok = false;
+        }
+    }
+
+    return nullptr;
+}
+
+define_test(string_intern_find_is_lock_free_while_adding)
+{
+    string_intern si{};
+    init(&si);
+
+    const s64 thread_count = 4;
+    const s64 count = 50000;
+    thread threads[thread_count]{};
+    _intern_thread_args args[thread_count]{};
+    c8 buf[32];
+
+    for (s64 i = 0; i < count / 2; ++i)
+        string_intern_add(&si, const_string{buf, _format_key(buf, i)});
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        args[i] = _intern_thread_args{.si = &si, .count = count, .found = 0, .ok = false};
+        assert_equal(thread_create(threads + i, _intern_reader_thread, args + i), true);
+        thread_start(threads + i);
+    }
+
+    // grows the table several times while the threads are reading
+    for (s64 i = count / 2; i < count; ++i)
+        string_intern_add(&si, const_string{buf, _format_key(buf, i)});
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        thread_stop(threads + i);
+        assert_equal(args[i].ok, true);
+        assert_equal(args[i].found, count);
+    }
+
+    // thread_stop returns when the thread function returned, which is
+    // slightly before the thread exits and stops using its stack.
+    sleep_ms(20);
+
+    for (s64 i = 0; i < thread_count; ++i)
+        thread_destroy(threads + i);
+
+    assert_equal(string_intern_count(&si), count);
+
+    free(&si);
+}
+
+define_default_test_main();
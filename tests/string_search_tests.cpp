@@ -0,0 +1,183 @@
+#include <t1/t1.hpp>
+
+#include "shl/string_search.hpp"
+
+template<typename C>
+static s64 naive_search(const C *data, s64 size, const C *needle, s64 needle_size)
+{
+    for (s64 i = 0; i + needle_size <= size; ++i)
+    {
+        s64 j = 0;
+
+        while (j < needle_size && data[i + j] == needle[j])
+            ++j;
+
+        if (j == needle_size)
+            return i;
+    }
+
+    return -1;
+}
+
+template<typename C>
+static s64 naive_search_last(const C *data, s64 size, const C *needle, s64 needle_size)
+{
+    for (s64 i = size - needle_size; i >= 0; --i)
+    {
+        s64 j = 0;
+
+        while (j < needle_size && data[i + j] == needle[j])
+            ++j;
+
+        if (j == needle_size)
+            return i;
+    }
+
+    return -1;
+}
+
+// fills data with a pattern of 'a's and 'b's, so that there are many
+// partial matches of needles made of 'a's and 'b's.
+template<typename C>
+static void fill_pattern(C *data, s64 size)
+{
+    for (s64 i = 0; i < size; ++i)
+        data[i] = (i % 7 == 3 || i % 5 == 1) ? (C)'b' : (C)'a';
+}
+
+template<typename C>
+static void check_search_units()
+{
+    C data[100];
+    fill_pattern(data, 100);
+
+    const C needles[][4] = {
+        {'b', 'a', 'b', 0},
+        {'a', 'b', 'a', 'a'},
+        {'b', 'b', 0, 0},
+        {'a', 'a', 'a', 'b'},
+    };
+    const s64 needle_sizes[] = {3, 4, 2, 4};
+
+    for (s64 size = 0; size <= 100; ++size)
+    for (s64 n = 0; n < 4; ++n)
+    {
+        assert_equal(search_units(data, size, needles[n], needle_sizes[n]),
+                     naive_search(data, size, needles[n], needle_sizes[n]));
+        assert_equal(search_last_units(data, size, needles[n], needle_sizes[n]),
+                     naive_search_last(data, size, needles[n], needle_sizes[n]));
+    }
+}
+
+template<typename C>
+static void check_search_unit()
+{
+    C data[80];
+    const C set[] = {(C)'y', (C)'x'};
+
+    for (s64 i = 0; i < 80; ++i)
+        data[i] = (C)'a';
+
+    for (s64 pos = 0; pos < 80; ++pos)
+    {
+        data[pos] = (C)'x';
+
+        for (s64 size = 0; size <= 80; ++size)
+        {
+            s64 expected = pos < size ? pos : -1;
+            assert_equal(search_unit(data, size, (C)'x'), expected);
+            assert_equal(search_last_unit(data, size, (C)'x'), expected);
+            assert_equal(search_any_unit(data, size, set, 2), expected);
+            assert_equal(search_last_any_unit(data, size, set, 2), expected);
+        }
+
+        data[pos] = (C)'a';
+    }
+}
+
+define_test(search_unit_finds_unit)
+{
+    check_search_unit<c8>();
+    check_search_unit<c16>();
+    check_search_unit<c32>();
+}
+
+define_test(search_unit_returns_first_and_last_unit)
+{
+    const c8 *data = "a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p,q";
+
+    assert_equal(search_unit(data, 33, ','), 1);
+    assert_equal(search_last_unit(data, 33, ','), 31);
+    assert_equal(search_unit(data, 33, '?'), -1);
+    assert_equal(search_last_unit(data, 33, '?'), -1);
+    assert_equal(search_unit(data, 0, 'a'), -1);
+    assert_equal(search_last_unit(data, 0, 'a'), -1);
+}
+
+define_test(search_any_unit_finds_any_unit_in_set)
+{
+    const c8 *data = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaa\"aaaaaaaaaa,aaaaaaaaaaaaaa\naaaaaa";
+    s64 size = 63;
+
+    assert_equal(search_any_unit(data, size, "\",\n", 3), 29);
+    assert_equal(search_any_unit(data + 30, size - 30, "\",\n", 3), 10);
+    assert_equal(search_any_unit(data + 41, size - 41, "\",\n", 3), 14);
+    assert_equal(search_any_unit(data, size, "xyz", 3), -1);
+    assert_equal(search_any_unit(data, size, "", 0), -1);
+
+    assert_equal(search_last_any_unit(data, size, "\",\n", 3), 55);
+    assert_equal(search_last_any_unit(data, 55, "\",\n", 3), 40);
+    assert_equal(search_last_any_unit(data, 40, "\",\n", 3), 29);
+    assert_equal(search_last_any_unit(data, 29, "\",\n", 3), -1);
+
+    // larger sets than search_max_vector_set_size
+    const c8 *set = "ABCDEFGHIJKLMNOPQRSTUVWXYZ\n";
+    assert_equal(search_any_unit(data, size, set, 27), 55);
+    assert_equal(search_last_any_unit(data, size, set, 27), 55);
+
+    const c16 *data16 = u"hello world, hello \"world\"";
+    assert_equal(search_any_unit(data16, 26, u"\",", 2), 11);
+    assert_equal(search_last_any_unit(data16, 26, u"\",", 2), 25);
+
+    const c32 *data32 = U"hello world, hello \"world\"";
+    assert_equal(search_any_unit(data32, 26, U"\",", 2), 11);
+    assert_equal(search_last_any_unit(data32, 26, U"\",", 2), 25);
+}
+
+define_test(search_units_finds_substrings)
+{
+    check_search_units<c8>();
+    check_search_units<c16>();
+    check_search_units<c32>();
+}
+
+define_test(search_units_handles_edge_cases)
+{
+    const c8 *data = "hello world hello world";
+
+    assert_equal(search_units(data, 23, "", 0), 0);
+    assert_equal(search_last_units(data, 23, "", 0), 23);
+    assert_equal(search_units(data, 5, "hello world", 11), -1);
+    assert_equal(search_units(data, 23, "world", 5), 6);
+    assert_equal(search_last_units(data, 23, "world", 5), 18);
+    assert_equal(search_last_units(data, 22, "world", 5), 6);
+    assert_equal(search_units(data, 23, "hello world hello world", 23), 0);
+}
+
+define_test(search_units_does_not_return_misaligned_matches)
+{
+    const c16 data16[] = {0x4100, 0x0042, 0x4100, 0x0042, 0x4100, 0x0042, 0x4100, 0x0042,
+                          0x4100, 0x0042, 0x4100, 0x0042, 0x4100, 0x0042, 0x4100, 0x0042};
+    const c16 needle16[] = {0x4241, 0x0000};
+
+    assert_equal(search_units(data16, 16, needle16, 1), -1);
+    assert_equal(search_last_units(data16, 16, needle16, 1), -1);
+
+    const c32 data32[] = {0x41000000, 0x00000042, 0x41000000, 0x00000042, 0x41000000, 0x00000042};
+    const c32 needle32[] = {0x00424100};
+
+    assert_equal(search_units(data32, 6, needle32, 1), -1);
+    assert_equal(search_last_unit(data32, 6, needle32[0]), -1);
+}
+
+define_default_test_main();
@@ -426,28 +426,115 @@ define_test(is_upper_returns_true_if_codepoint_is_uppercase_alphabetical)
 {
     assert_equal(is_upper((u32)'A'), true);
     assert_equal(is_upper((u32)'Z'), true);
-    // TODO: more...
+    assert_equal(is_upper(0x00C4u), true); // Ä
+    assert_equal(is_upper(0x0416u), true); // Ж
+    assert_equal(is_upper(0x1E900u), true); // adlam capital alif
 }
 
 define_test(is_upper_returns_false_if_codepoint_is_not_uppercase_alphabetical)
 {
     assert_equal(is_upper((u32)'0'), false);
     assert_equal(is_upper((u32)'a'), false);
-    // TODO: more...
+    assert_equal(is_upper(0x00E4u), false); // ä
+    assert_equal(is_upper(0x65E5u), false); // 日
 }
 
 define_test(is_lower_returns_true_if_codepoint_is_lowercase_alphabetical)
 {
     assert_equal(is_lower((u32)'a'), true);
     assert_equal(is_lower((u32)'z'), true);
-    // TODO: more...
+    assert_equal(is_lower(0x00DFu), true); // ß
+    assert_equal(is_lower(0x0436u), true); // ж
 }
 
 define_test(is_lower_returns_false_if_codepoint_is_not_lowercase_alphabetical)
 {
     assert_equal(is_lower((u32)'0'), false);
     assert_equal(is_lower((u32)'A'), false);
-    // TODO: more...
+    assert_equal(is_lower(0x0416u), false); // Ж
+    assert_equal(is_lower(0x65E5u), false); // 日
+}
+
+define_test(codepoint_properties_include_unicode_codepoints)
+{
+    assert_equal(is_alpha(0x00E4u), true);  // ä
+    assert_equal(is_alpha(0x65E5u), true);  // 日
+    assert_equal(is_alpha(0x0660u), false); // arabic-indic digit zero
+    assert_equal(is_alpha(0x10FFFFu), false);
+    assert_equal(is_alpha(0xFFFFFFFFu), false);
+    assert_equal(is_digit(0x0660u), true);
+    assert_equal(is_digit(0xFF19u), true);  // fullwidth 9
+    assert_equal(is_digit(0x00B2u), false); // superscript 2 is not a decimal digit
+    assert_equal(is_alphanum(0x0660u), true);
+    assert_equal(is_alphanum(0x2603u), false); // snowman
+}
+
+define_test(string_is_property_checks_long_strings)
+{
+    // long enough for the vectorized ASCII path, with unicode in the middle
+    assert_equal(is_alpha(u8"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"_cs), true);
+    assert_equal(is_alpha(u8"abcdefghijklmnopqrstuvwxyzäöüABCDEFGHIJKLMNOPQRSTUVWXYZ"_cs), true);
+    assert_equal(is_alpha( u"abcdefghijklmnopqrstuvwxyzäöüABCDEFGHIJKLMNOPQRSTUVWXYZ"_cs), true);
+    assert_equal(is_alpha( U"abcdefghijklmnopqrstuvwxyzäöüABCDEFGHIJKLMNOPQRSTUVWXYZ"_cs), true);
+    assert_equal(is_alpha(u8"abcdefghijklmnopqrstuvwxyz@ABCDEFGHIJKLMNOPQRSTUVWXYZ"_cs), false);
+    assert_equal(is_alpha(u8"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXY["_cs), false);
+    assert_equal(is_alpha( u"abcdefghijklmnop`rstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"_cs), false);
+    assert_equal(is_alpha(u8"abcdefghijklmnopqrstuvwxyzäöü☃ABCDEFGHIJKLMNOPQRSTUVWXYZ"_cs), false);
+
+    assert_equal(is_digit(u8"01234567890123456789012345678901234567890123456789"_cs), true);
+    assert_equal(is_digit(u8"0123456789012345678901234567890123/567890123456789"_cs), false);
+    assert_equal(is_digit(u8"0123456789012345:"_cs), false);
+
+    assert_equal(is_space(u8"  \t\t\n\n\r\r\v\v\f\f              "_cs), true);
+    assert_equal(is_space(u8"  \t\t\n\n\r\r\v\v\f\f        \x1f     "_cs), false);
+
+    assert_equal(is_hex_digit(u8"0123456789abcdefABCDEF0123456789abcdefABCDEF"_cs), true);
+    assert_equal(is_hex_digit(u8"0123456789abcdefABCDEF0123456789abcdefgABCDEF"_cs), false);
+
+    assert_equal(is_alphanum(u8"abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJ"_cs), true);
+    assert_equal(is_upper(u8"ABCDEFGHIJKLMNOPQRSTUVWXYZÄÖÜ"_cs), true);
+    assert_equal(is_upper(u8"ABCDEFGHIJKLMNOPQRSTUVWXYZäÖÜ"_cs), false);
+    assert_equal(is_lower(u8"abcdefghijklmnopqrstuvwxyzäöüß"_cs), true);
+    assert_equal(is_lower(u8"abcdefghijklmnopqrstuvwxyZ"_cs), false);
+}
+
+define_test(utf_to_upper_converts_string_to_upper_case)
+{
+    string s = "hello world, this is a long string. ÄäÖöÜü жЖ ǆ ßſ ı!"_s;
+    utf_to_upper(&s);
+
+    // ß has no simple upper case mapping, ſ and ı map to ASCII
+    // letters of a different UTF-8 length and remain unchanged.
+    assert_equal(s, "HELLO WORLD, THIS IS A LONG STRING. ÄÄÖÖÜÜ ЖЖ Ǆ ßſ ı!"_cs);
+
+    utf_to_lower(&s);
+    assert_equal(s, "hello world, this is a long string. ääööüü жж ǆ ßſ ı!"_cs);
+
+    u16string s16 = u"abcdefghijklmnopqrstuvwxyz äöü ſ"_s;
+    utf_to_upper(&s16);
+    assert_equal(s16, u"ABCDEFGHIJKLMNOPQRSTUVWXYZ ÄÖÜ S"_cs);
+
+    u32string s32 = U"ABCDEFGHIJKLMNOPQRSTUVWXYZ ÄÖÜ 𞤀"_s;
+    utf_to_lower(&s32);
+    assert_equal(s32, U"abcdefghijklmnopqrstuvwxyz äöü 𞤢"_cs);
+
+    free(&s);
+    free(&s16);
+    free(&s32);
+}
+
+define_test(utf_codepoint_to_upper_converts_codepoint)
+{
+    assert_equal(utf_codepoint_to_upper((u32)'a'), (u32)'A');
+    assert_equal(utf_codepoint_to_upper((u32)'A'), (u32)'A');
+    assert_equal(utf_codepoint_to_upper(0x00E4u), 0x00C4u); // ä
+    assert_equal(utf_codepoint_to_upper(0x00DFu), 0x00DFu); // ß
+    assert_equal(utf_codepoint_to_lower(0x0416u), 0x0436u); // Ж
+    assert_equal(utf_codepoint_to_lower((u32)'1'), (u32)'1');
+
+    c8 buf[] = u8"ä";
+    utf_codepoint_to_upper(buf);
+    assert_equal((const_string{buf, 2}), u8"Ä"_cs);
 }
 
 define_test(string_length_returns_unit_length_of_string)
@@ -1151,6 +1238,46 @@ define_test(string_index_of_returns_index_of_first_needle_occurence_in_haystack_
     assert_equal(string_index_of(u8"hello 今日は 今日は"_cs, u8"今日は"_cs, 7), 16); // in units, not utf codepoints
 }
 
+define_test(string_index_of_does_not_return_misaligned_matches)
+{
+    // the bytes of u"\u4100\u0042" contain the bytes of u"\u4241" at an odd
+    // byte offset, which is not a match in units.
+    assert_equal(string_index_of(u"\u4100\u0042"_cs, u"\u4241"_cs), -1);
+    assert_equal(string_last_index_of(u"\u4100\u0042"_cs, u"\u4241"_cs), -1);
+    assert_equal(string_index_of(u"\u4100\u0042\u4241"_cs, u"\u4241"_cs), 2);
+}
+
+define_test(string_index_of_any_returns_index_of_first_unit_in_set)
+{
+    const_string line = "name,\"value\"\nnext"_cs;
+
+    assert_equal(string_index_of_any(line, "\",\n"_cs), 4);
+    assert_equal(string_index_of_any(line, "\",\n"_cs, 5), 5);
+    assert_equal(string_index_of_any(line, "\",\n"_cs, 6), 11);
+    assert_equal(string_index_of_any(line, "\n"_cs), 12);
+    assert_equal(string_index_of_any(line, "?!"_cs), -1);
+    assert_equal(string_index_of_any(line, ""_cs), -1);
+    assert_equal(string_index_of_any(line, ","_cs, -1), -1);
+    assert_equal(string_index_of_any(line, ","_cs, 100), -1);
+
+    assert_equal(string_index_of_any(u"hello, world"_cs, u" ,"_cs), 5);
+    assert_equal(string_index_of_any(U"hello, world"_cs, U"wd"_cs), 7);
+}
+
+define_test(string_last_index_of_any_returns_index_of_last_unit_in_set)
+{
+    const_string line = "name,\"value\"\nnext"_cs;
+
+    assert_equal(string_last_index_of_any(line, "\",\n"_cs), 12);
+    assert_equal(string_last_index_of_any(line, "\",\n"_cs, 11), 11);
+    assert_equal(string_last_index_of_any(line, "\",\n"_cs, 10), 5);
+    assert_equal(string_last_index_of_any(line, ","_cs, 3), -1);
+    assert_equal(string_last_index_of_any(line, "?!"_cs), -1);
+
+    assert_equal(string_last_index_of_any(u"hello, world"_cs, u" ,"_cs), 6);
+    assert_equal(string_last_index_of_any(U"hello, world"_cs, U"lo"_cs), 10);
+}
+
 define_test(string_last_index_of_returns_negative_one_on_negative_offset)
 {
     assert_equal(string_last_index_of("hello"_cs, "hell"_cs, -1), -1);
@@ -1698,6 +1825,83 @@ define_test(string_replace_all_replaces_all_occurrences_of_string_starting_at_of
     free(&str);
 }
 
+define_test(string_replace_all_replaces_with_larger_replacement)
+{
+    string str = "a.b.c.d"_s;
+
+    s64 count = string_replace_all(&str, "."_cs, "<->"_cs);
+
+    assert_equal(count, 3);
+    assert_equal(str, "a<->b<->c<->d"_cs);
+    assert_equal(string_length(&str), 13);
+    assert_equal(str[string_length(&str)], '\0');
+
+    free(&str);
+}
+
+define_test(string_replace_all_does_not_match_inside_replacement)
+{
+    string str = "aaa"_s;
+
+    s64 count = string_replace_all(&str, "a"_cs, "aa"_cs);
+
+    assert_equal(count, 3);
+    assert_equal(str, "aaaaaa"_cs);
+
+    count = string_replace_all(&str, "aa"_cs, "a"_cs);
+
+    assert_equal(count, 3);
+    assert_equal(str, "aaa"_cs);
+
+    free(&str);
+}
+
+define_test(string_replace_all_replaces_many_occurrences)
+{
+    string str{};
+    string expected{};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        string_append(&str, "<x>"_cs);
+        string_append(&expected, "&lt;x&gt;"_cs);
+    }
+
+    s64 count = string_replace_all(&str, "<"_cs, "&lt;"_cs);
+    count += string_replace_all(&str, ">"_cs, "&gt;"_cs);
+
+    assert_equal(count, 2000);
+    assert_equal(str, to_const_string(expected));
+    assert_equal(str[string_length(&str)], '\0');
+
+    free(&str);
+    free(&expected);
+}
+
+define_test(string_replace_all_writes_to_output_string)
+{
+    const_string src = "hello hello hello world"_cs;
+    string out = "previous contents"_s;
+
+    s64 count = string_replace_all(src, "hello"_cs, "good morning"_cs, &out);
+
+    assert_equal(count, 3);
+    assert_equal(out, "good morning good morning good morning world"_cs);
+    assert_equal(out[string_length(&out)], '\0');
+
+    count = string_replace_all(src, "hello"_cs, "bye"_cs, &out, 1);
+
+    assert_equal(count, 2);
+    assert_equal(out, "hello bye bye world"_cs);
+
+    count = string_replace_all(src, "xyz"_cs, "bye"_cs, &out);
+
+    assert_equal(count, 0);
+    assert_equal(out, src);
+
+    free(&out);
+}
+
 define_test(string_split_splits_by_string)
 {
     const_string str = "hello ABC world"_cs;
@@ -1751,6 +1955,92 @@ define_test(string_split_splits_by_string2)
     free(&splits);
 }
 
+define_test(string_split_next_returns_pieces_one_by_one)
+{
+    const_string rest = "a,b,,c"_cs;
+    const_string piece{};
+
+    assert_equal(string_split_next(&rest, ',', &piece), true);
+    assert_equal(piece, "a"_cs);
+    assert_equal(rest, "b,,c"_cs);
+    assert_equal(string_split_next(&rest, ',', &piece), true);
+    assert_equal(piece, "b"_cs);
+    assert_equal(string_split_next(&rest, ',', &piece), true);
+    assert_equal(piece, ""_cs);
+    assert_equal(string_split_next(&rest, ',', &piece), true);
+    assert_equal(piece, "c"_cs);
+    assert_equal(string_split_next(&rest, ',', &piece), false);
+    assert_equal(string_split_next(&rest, ',', &piece), false);
+
+    rest = "hello ABC world ABC "_cs;
+
+    assert_equal(string_split_next(&rest, " ABC "_cs, &piece), true);
+    assert_equal(piece, "hello"_cs);
+    assert_equal(string_split_next(&rest, " ABC ", &piece), true);
+    assert_equal(piece, "world"_cs);
+    assert_equal(string_split_next(&rest, " ABC ", &piece), true);
+    assert_equal(piece, ""_cs);
+    assert_equal(string_split_next(&rest, " ABC ", &piece), false);
+
+    const_u16string rest16 = u"x\ty"_cs;
+    const_u16string piece16{};
+
+    assert_equal(string_split_next(&rest16, u'\t', &piece16), true);
+    assert_equal(piece16, u"x"_cs);
+    assert_equal(string_split_next(&rest16, u"\t"_cs, &piece16), true);
+    assert_equal(piece16, u"y"_cs);
+    assert_equal(string_split_next(&rest16, u'\t', &piece16), false);
+}
+
+define_test(for_string_split_iterates_pieces)
+{
+    const_string line = "id\tname\tvalue\t\tcomment"_cs;
+    const_string expected[] = {"id"_cs, "name"_cs, "value"_cs, ""_cs, "comment"_cs};
+    s64 count = 0;
+
+    for_string_split(i, field, line, '\t')
+    {
+        assert_equal(i, count);
+        assert_equal(field, expected[i]);
+        count++;
+    }
+
+    assert_equal(count, 5);
+
+    count = 0;
+
+    for_string_split(field, "hello ABC world"_cs, " ABC "_cs)
+    {
+        assert_equal(field.size, 5);
+        count++;
+    }
+
+    assert_equal(count, 2);
+
+    // stops early without touching the rest
+    count = 0;
+
+    for_string_split(i, field, line, '\t')
+    {
+        if (i == 2)
+            break;
+
+        count++;
+    }
+
+    assert_equal(count, 2);
+
+    // yields the same pieces as string_split
+    array<const_string> splits{};
+    init(&splits);
+    string_split(line, "\t"_cs, &splits);
+
+    for_string_split(i, field, line, "\t"_cs)
+        assert_equal(field, splits[i]);
+
+    free(&splits);
+}
+
 define_test(string_join_joins_strings_by_string_delim)
 {
     const_string str = "a,b,c,d"_cs;
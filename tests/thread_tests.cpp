@@ -52,6 +52,85 @@ define_test(thread_create_recreates_destroyed_thread)
     thread_destroy(&t, &err);
 }
 
+struct _slot_thread_args
+{
+    s32 *release;
+    thread_data_slot *slot;
+};
+
+static s32 _slot_cleanups = 0;
+
+static void _slot_cleanup(void *)
+{
+    __atomic_add_fetch(&_slot_cleanups, 1, __ATOMIC_SEQ_CST);
+}
+
+void *slot_thread_func(void *_arg)
+{
+    _slot_thread_args *arg = (_slot_thread_args*)_arg;
+
+    arg->slot = get_thread_data_slot(0);
+
+    if (arg->slot != nullptr)
+    {
+        arg->slot->data = _arg;
+        arg->slot->cleanup = _slot_cleanup;
+    }
+
+    while (__atomic_load_n(arg->release, __ATOMIC_SEQ_CST) == 0)
+        sleep_ms(1);
+
+    return nullptr;
+}
+
+define_test(threads_have_their_own_data_slots)
+{
+    // more threads than there used to be slot entries
+    const s64 thread_count = 300;
+    static thread threads[thread_count]{};
+    static _slot_thread_args args[thread_count]{};
+    s32 release = 0;
+    _slot_cleanups = 0;
+
+    assert_equal(get_thread_data_slot(0), nullptr);
+
+    program_context *ctx = get_context_pointer();
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        args[i].release = &release;
+        assert_equal(thread_create(threads + i, slot_thread_func, args + i, nullptr, 256 * 1024, 4096), true);
+        assert_equal(thread_start(threads + i), true);
+
+        // starting threads set the context pointer of this thread
+        while (!thread_is_running(threads + i) && !thread_is_stopped(threads + i))
+            ;
+
+        set_context_pointer(ctx);
+    }
+
+    __atomic_store_n(&release, 1, __ATOMIC_SEQ_CST);
+
+    for (s64 i = 0; i < thread_count; ++i)
+        assert_equal(thread_stop(threads + i), true);
+
+    // thread_stop returns slightly before the threads stop using their stack
+    sleep_ms(20);
+
+    for (s64 i = 0; i < thread_count; ++i)
+        assert_equal(thread_destroy(threads + i), true);
+
+    assert_equal(_slot_cleanups, (s32)thread_count);
+
+    for (s64 i = 0; i < thread_count; ++i)
+    {
+        assert_not_equal(args[i].slot, nullptr);
+
+        for (s64 j = 0; j < i; ++j)
+            assert_not_equal(args[i].slot, args[j].slot);
+    }
+}
+
 template<typename T>
 void assert_equal_within_thread(T *arg, T expected)
 {
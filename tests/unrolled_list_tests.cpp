@@ -0,0 +1,233 @@
+#include <t1/t1.hpp>
+
+#include "shl/unrolled_list.hpp"
+
+template<typename T, s64 K>
+void assert_list_integrity(const unrolled_list<T, K> *list)
+{
+    s64 size = 0;
+
+    for (auto *node = list->first; node != nullptr; node = node->next)
+    {
+        assert_greater(node->count, 0);
+        assert_less_or_equal(node->count, K);
+
+        if (node->previous != nullptr)
+        {
+            assert_equal(node->previous->next, node);
+        }
+        else
+            assert_equal(node, list->first);
+
+        if (node->next != nullptr)
+        {
+            assert_equal(node->next->previous, node);
+        }
+        else
+            assert_equal(node, list->last);
+
+        size += node->count;
+    }
+
+    assert_equal(size, list->size);
+}
+
+define_test(init_initializes_unrolled_list)
+{
+    unrolled_list<int> list;
+
+    init(&list);
+
+    assert_equal(list.first, nullptr);
+    assert_equal(list.last, nullptr);
+    assert_equal(list.size, 0);
+
+    free(&list);
+}
+
+define_test(init_initializes_unrolled_list2)
+{
+    unrolled_list<int, 4> list;
+
+    init(&list, 10);
+
+    assert_not_equal(list.first, nullptr);
+    assert_not_equal(list.last, nullptr);
+    assert_equal(list.size, 10);
+    assert_equal(list.first->count, 4);
+    assert_equal(list.last->count, 2);
+    assert_list_integrity(&list);
+
+    free(&list);
+
+    assert_equal(list.first, nullptr);
+    assert_equal(list.last, nullptr);
+    assert_equal(list.size, 0);
+}
+
+define_test(add_at_end_adds_elements_at_end)
+{
+    unrolled_list<int, 4> list{};
+
+    for (int i = 0; i < 10; ++i)
+        add_at_end(&list, i);
+
+    assert_equal(list.size, 10);
+    assert_list_integrity(&list);
+
+    for (int i = 0; i < 10; ++i)
+        assert_equal(list[i], i);
+
+    free(&list);
+}
+
+define_test(add_at_start_adds_elements_at_start)
+{
+    unrolled_list<int, 4> list{};
+
+    for (int i = 0; i < 10; ++i)
+        add_at_start(&list, i);
+
+    assert_equal(list.size, 10);
+    assert_list_integrity(&list);
+
+    for (int i = 0; i < 10; ++i)
+        assert_equal(list[i], 9 - i);
+
+    free(&list);
+}
+
+define_test(insert_elements_splits_full_nodes)
+{
+    unrolled_list<int, 4> list{};
+
+    for (int i = 0; i < 8; ++i)
+        add_at_end(&list, i < 3 ? i : i + 2);
+
+    // 0 1 2 5 | 6 7 8 9
+    int *v = insert_elements(&list, 3, 2);
+    assert_not_equal(v, nullptr);
+
+    list[3] = 3;
+    list[4] = 4;
+
+    assert_equal(list.size, 10);
+    assert_list_integrity(&list);
+
+    for (int i = 0; i < 10; ++i)
+        assert_equal(list[i], i);
+
+    assert_equal(insert_elements(&list, 11, 1), nullptr);
+
+    free(&list);
+}
+
+define_test(remove_elements_removes_elements)
+{
+    unrolled_list<int, 4> list{};
+
+    for (int i = 0; i < 20; ++i)
+        add_at_end(&list, i);
+
+    // spans multiple nodes
+    remove_elements(&list, 2, 9);
+
+    assert_equal(list.size, 11);
+    assert_list_integrity(&list);
+
+    assert_equal(list[0], 0);
+    assert_equal(list[1], 1);
+
+    for (int i = 2; i < 11; ++i)
+        assert_equal(list[i], i + 9);
+
+    remove_from_start(&list);
+    remove_from_end(&list);
+
+    assert_equal(list.size, 9);
+    assert_list_integrity(&list);
+    assert_equal(list[0], 1);
+    assert_equal(list[8], 18);
+
+    remove_elements(&list, 0, 100);
+
+    assert_equal(list.size, 0);
+    assert_equal(list.first, nullptr);
+    assert_equal(list.last, nullptr);
+
+    free(&list);
+}
+
+define_test(remove_elements_merges_nodes)
+{
+    unrolled_list<int, 4> list{};
+
+    for (int i = 0; i < 8; ++i)
+        add_at_end(&list, i);
+
+    // 0 1 2 3 | 4 5 6 7
+    remove_elements(&list, 1, 2);
+    remove_elements(&list, 3, 2);
+
+    // 0 3 | 4 7 -> 0 3 4 7
+    assert_equal(list.size, 4);
+    assert_equal(list.first, list.last);
+    assert_list_integrity(&list);
+
+    assert_equal(list[0], 0);
+    assert_equal(list[1], 3);
+    assert_equal(list[2], 4);
+    assert_equal(list[3], 7);
+
+    free(&list);
+}
+
+define_test(for_unrolled_list_iterates_list)
+{
+    unrolled_list<int, 3> list{};
+
+    for (int i = 0; i < 10; ++i)
+        add_at_end(&list, i);
+
+    s64 count = 0;
+
+    for_unrolled_list(i, v, &list)
+    {
+        assert_equal(*v, (int)i);
+        count++;
+    }
+
+    assert_equal(count, 10);
+
+    for_unrolled_list(v, &list)
+        *v = 1;
+
+    for (int i = 0; i < 10; ++i)
+        assert_equal(list[i], 1);
+
+    free(&list);
+
+    count = 0;
+
+    for_unrolled_list(v, &list)
+        count++;
+
+    assert_equal(count, 0);
+}
+
+define_test(index_of_returns_index)
+{
+    unrolled_list<int, 4> list{};
+
+    for (int i = 0; i < 10; ++i)
+        add_at_end(&list, i * 2);
+
+    assert_equal(index_of(&list, 6), 3);
+    assert_equal(index_of(&list, 7), -1);
+    assert_equal(contains(&list, 18), true);
+    assert_equal(*search(&list, 10), 10);
+
+    free(&list);
+}
+
+define_default_test_main();
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# generates src/shl/unicode_tables.cpp from the Unicode Character Database
+# shipped with Python (unicodedata).
+#
+# usage: python3 tools/generate_unicode_tables.py > src/shl/unicode_tables.cpp
+
+import sys
+import unicodedata
+
+BLOCK_SHIFT = 7
+BLOCK_SIZE = 1 << BLOCK_SHIFT
+
+# must match unicode_tables.hpp
+PROP_ALPHA = 1 << 0
+PROP_DIGIT = 1 << 1
+PROP_SPACE = 1 << 2
+PROP_UPPER = 1 << 3
+PROP_LOWER = 1 << 4
+
+# White_Space property from PropList.txt
+WHITE_SPACE = set(range(0x09, 0x0E)) | {0x20, 0x85, 0xA0, 0x1680} \
+            | set(range(0x2000, 0x200B)) | {0x2028, 0x2029, 0x202F, 0x205F, 0x3000}
+
+def simple_mapping(c, mapped):
+    # only single codepoint (simple) case mappings, e.g. no U+00DF -> "SS"
+    if len(mapped) != 1:
+        return 0
+
+    return ord(mapped) - ord(c)
+
+def record_of(cp):
+    c = chr(cp)
+    props = 0
+
+    if c.isalpha():            props |= PROP_ALPHA
+    if c.isdecimal():          props |= PROP_DIGIT
+    if cp in WHITE_SPACE:      props |= PROP_SPACE
+    if c.isupper():            props |= PROP_UPPER
+    if c.islower():            props |= PROP_LOWER
+
+    return (props, simple_mapping(c, c.upper()), simple_mapping(c, c.lower()))
+
+def main():
+    records = [(0, 0, 0)]
+    record_index = {records[0]: 0}
+    blocks = []
+    block_index = {}
+    stage1 = []
+
+    for block_start in range(0, 0x110000, BLOCK_SIZE):
+        block = []
+
+        for cp in range(block_start, block_start + BLOCK_SIZE):
+            r = record_of(cp)
+
+            if r not in record_index:
+                record_index[r] = len(records)
+                records.append(r)
+
+            block.append(record_index[r])
+
+        block = tuple(block)
+
+        if block not in block_index:
+            block_index[block] = len(blocks)
+            blocks.append(block)
+
+        stage1.append(block_index[block])
+
+    # everything after the last block with properties uses record 0
+    empty = block_index[tuple([0] * BLOCK_SIZE)]
+
+    while stage1[-1] == empty:
+        stage1.pop()
+
+    # stage 1 and stage 2 entries are u8
+    assert len(records) <= 256
+    assert len(blocks) <= 256
+    out = sys.stdout
+
+    out.write('\n// generated by tools/generate_unicode_tables.py, do not edit.\n')
+    out.write('// Unicode %s\n\n' % unicodedata.unidata_version)
+    out.write('#include "shl/unicode_tables.hpp"\n\n')
+
+    out.write('const u32 _unicode_table_limit = 0x%x;\n\n' % (len(stage1) << BLOCK_SHIFT))
+
+    out.write('const unicode_codepoint_info _unicode_codepoint_infos[%d] = {\n' % len(records))
+    for props, upper, lower in records:
+        out.write('    {%d, %d, %d},\n' % (props, upper, lower))
+    out.write('};\n\n')
+
+    out.write('const u8 _unicode_stage1[%d] = {\n' % len(stage1))
+    for i in range(0, len(stage1), 16):
+        out.write('    ' + ' '.join('%d,' % x for x in stage1[i:i + 16]) + '\n')
+    out.write('};\n\n')
+
+    out.write('const u8 _unicode_stage2[%d] = {\n' % (len(blocks) * BLOCK_SIZE))
+    for block in blocks:
+        for i in range(0, BLOCK_SIZE, 32):
+            out.write('    ' + ','.join('%d' % x for x in block[i:i + 32]) + ',\n')
+    out.write('};\n')
+
+    sys.stderr.write('%d records, %d blocks, %d stage1 entries\n'
+                     % (len(records), len(blocks), len(stage1)))
+
+if __name__ == '__main__':
+    main()